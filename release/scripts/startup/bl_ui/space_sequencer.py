@@ -2288,6 +2288,9 @@ class SEQUENCER_PT_cache_settings(SequencerButtonsPanel, Panel):
         col.prop(ed, "use_cache_composite")
         col.prop(ed, "use_cache_final")
 
+        col.separator()
+        col.prop(ed, "use_cache_compression")
+
 
 class SEQUENCER_PT_proxy_settings(SequencerButtonsPanel, Panel):
     bl_label = "Proxy Settings"
@@ -2463,6 +2466,9 @@ class SEQUENCER_PT_view(SequencerButtonsPanel_Output, Panel):
             col.use_property_split = False
             col.prop(ed, "use_prefetch")
             col.use_property_split = True
+            sub = col.column()
+            sub.active = ed.use_prefetch
+            sub.prop(ed, "prefetch_threads")
 
         col.prop(st, "display_channel", text="Channel")
 
@@ -366,6 +366,13 @@ void BKE_animsys_eval_driver(struct Depsgraph *depsgraph,
 
 void BKE_animsys_update_driver_array(struct ID *id);
 
+/**
+ * Free the cache used to evaluate the action of the copy-on-write data-block which owns the
+ * animation data. Is to be called when data which is animated gets re-allocated outside of
+ * copy-on-write updates.
+ */
+void BKE_animsys_action_eval_cache_free(struct AnimData *adt);
+
 /* ************************************* */
 
 #ifdef __cplusplus
@@ -611,6 +611,21 @@ void BKE_pose_constraints_evaluate(struct Depsgraph *depsgraph,
 
 void BKE_pose_bone_done(struct Depsgraph *depsgraph, struct Object *object, int pchan_index);
 
+/**
+ * Evaluate bones without constraints and IK like #BKE_pose_eval_bone followed by
+ * #BKE_pose_bone_done, for a sub-tree of bones at once.
+ *
+ * \param pchan_indices: Indices of the pose channels, ordered by their depth in the sub-tree.
+ * \param level_offsets: Start of every depth level in \a pchan_indices,
+ * followed by the number of indices (`levels_num + 1` items).
+ */
+void BKE_pose_eval_bones_batch(struct Depsgraph *depsgraph,
+                               struct Scene *scene,
+                               struct Object *object,
+                               const int *pchan_indices,
+                               const int *level_offsets,
+                               int levels_num);
+
 void BKE_pose_eval_bbone_segments(struct Depsgraph *depsgraph,
                                   struct Object *object,
                                   int pchan_index);
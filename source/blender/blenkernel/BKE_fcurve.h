@@ -221,6 +221,18 @@ int BKE_fcm_envelope_find_index(struct FCM_EnvelopeData *array,
  * but should become userpref */
 #define BEZT_BINARYSEARCH_THRESH 0.01f /* was 0.00001, but giving errors */
 
+/* Threshold for binary-searching keyframes when evaluating F-Curves.
+ *
+ * The threshold here has the following constraints:
+ * - 0.001 is too coarse:
+ *   We get artifacts with 2cm driver movements at 1BU = 1m (see T40332).
+ *
+ * - 0.00001 is too fine:
+ *   Weird errors, like selecting the wrong keyframe range (see T39207), occur.
+ *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
+ */
+#define BEZT_BINARYSEARCH_THRESH_EVAL 0.0001f
+
 /* -------- Data Management  -------- */
 struct FCurve *BKE_fcurve_create(void);
 /**
@@ -532,6 +544,14 @@ void BKE_fcurve_correct_bezpart(const float v1[2], float v2[2], float v3[2], con
 /* evaluate fcurve */
 float evaluate_fcurve(struct FCurve *fcu, float evaltime);
 float evaluate_fcurve_only_curve(struct FCurve *fcu, float evaltime);
+/**
+ * Evaluate the keyframes of an F-Curve at a time between its first and last keyframe, where
+ * \a index and \a exact are the result of searching the keyframes for \a evaltime like
+ * #BKE_fcurve_bezt_binarysearch_index does, with #BEZT_BINARYSEARCH_THRESH_EVAL as threshold.
+ * F-Modifiers and integer values of the curve are not taken into account. Allows callers which
+ * keep track of the keyframe segments between evaluations to skip the binary search.
+ */
+float BKE_fcurve_eval_keyframes_segment(struct FCurve *fcu, float evaltime, int index, bool exact);
 float evaluate_fcurve_driver(struct PathResolvedRNA *anim_rna,
                              struct FCurve *fcu,
                              struct ChannelDriver *driver_orig,
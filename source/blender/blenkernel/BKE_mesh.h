@@ -1011,9 +1011,21 @@ void BKE_mesh_eval_geometry(struct Depsgraph *depsgraph, struct Mesh *mesh);
 /* Draw Cache */
 void BKE_mesh_batch_cache_dirty_tag(struct Mesh *me, eMeshBatchDirtyMode mode);
 void BKE_mesh_batch_cache_free(struct Mesh *me);
+/**
+ * Detach the draw cache from a mesh, so that it is not freed together with the mesh.
+ */
+void *BKE_mesh_batch_cache_take(struct Mesh *me);
+/**
+ * Give a draw cache detached with #BKE_mesh_batch_cache_take to the mesh which replaces its
+ * previous owner. When both meshes have the same topology only buffers which depend on vertex
+ * positions are updated when drawing, see #BKE_MESH_BATCH_DIRTY_DEFORM. The cache is freed when
+ * it can not be given to the mesh.
+ */
+void BKE_mesh_batch_cache_reuse_deformed(struct Mesh *me, void *batch_cache);
 
 extern void (*BKE_mesh_batch_cache_dirty_tag_cb)(struct Mesh *me, eMeshBatchDirtyMode mode);
 extern void (*BKE_mesh_batch_cache_free_cb)(struct Mesh *me);
+extern void (*BKE_mesh_batch_cache_free_data_cb)(void *batch_cache);
 
 /* mesh_debug.c */
 
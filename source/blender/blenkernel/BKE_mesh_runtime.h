@@ -59,6 +59,12 @@ void BKE_mesh_runtime_clear_geometry(struct Mesh *mesh);
  * Call this function to recalculate runtime data when used.
  */
 void BKE_mesh_runtime_clear_cache(struct Mesh *mesh);
+/**
+ * Compute #Mesh_Runtime.topology_hash from the edges, face corners and faces of the mesh, unless
+ * it is already computed. Meshes with the same hash are expected to have the same topology, so
+ * that their draw caches only differ in data which depends on vertex positions.
+ */
+void BKE_mesh_runtime_topology_hash_ensure(struct Mesh *mesh);
 
 /* This is a copy of DM_verttri_from_looptri(). */
 void BKE_mesh_runtime_verttri_from_looptri(struct MVertTri *r_verttri,
@@ -1588,6 +1588,15 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
+  /* The draw cache of a mesh which is only deformed is kept when the object is evaluated again
+   * with the same topology, see #BKE_object_eval_uber_data. */
+  if (is_mesh_eval_owned && mesh_eval->runtime.deformed_only &&
+      mesh_eval->runtime.wrapper_type == ME_WRAPPER_TYPE_MDATA &&
+      mesh_eval->runtime.subsurf_runtime_data == nullptr &&
+      DEG_get_mode(depsgraph) == DAG_EVAL_VIEWPORT) {
+    BKE_mesh_runtime_topology_hash_ensure(mesh_eval);
+  }
+
   /* Add the final mesh as a non-owning component to the geometry set. */
   MeshComponent &mesh_component = geometry_set_eval->get_component_for_write<MeshComponent>();
   mesh_component.replace(mesh_eval, GeometryOwnershipType::Editable);
@@ -0,0 +1,297 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ *
+ * Cache for evaluating the active action of copy-on-write data-blocks.
+ *
+ * The dependency graph evaluates the animation of copy-on-write data-blocks for every frame,
+ * while the action and the animated data rarely change between frames. The cache keeps the key
+ * times of all F-Curves in a single array, so finding the keyframe segment to evaluate does not
+ * touch the #BezTriple data, together with the segment found for the previous frame and the RNA
+ * paths resolved for properties which stay valid until the next copy-on-write update.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_index_range.hh"
+#include "BLI_listbase.h"
+#include "BLI_span.hh"
+#include "BLI_task.hh"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "DNA_ID.h"
+#include "DNA_anim_types.h"
+
+#include "BKE_animsys.h"
+#include "BKE_fcurve.h"
+
+#include "RNA_access.h"
+#include "RNA_prototypes.h"
+
+#include "nla_private.h"
+
+using blender::IndexRange;
+using blender::Span;
+using blender::Vector;
+
+struct ActionEvalCache {
+  /** Action and its curves the cache was built for, to detect changes. */
+  const bAction *action = nullptr;
+  const FCurve *first_fcurve = nullptr;
+  const FCurve *last_fcurve = nullptr;
+  int fcurves_num = 0;
+
+  /** Curves which are evaluated, in the order of the action. */
+  Vector<FCurve *> fcurves;
+  /** Key times of the curves which are evaluated with the cached keyframe segments. */
+  Vector<float> key_times;
+  /**
+   * Per curve: start of its key times in #key_times, or -1 for curves which are evaluated by
+   * #calculate_fcurve (F-Modifiers, baked samples, ...).
+   */
+  Vector<int> key_times_offset;
+  /** Per curve: keyframe segment found for the previous evaluation. */
+  Vector<int> segment_hint;
+  /** Per curve: RNA path resolved when building the cache, only used when #rna_is_cached. */
+  Vector<PathResolvedRNA> rna;
+  Vector<bool> rna_is_cached;
+  /** Per curve: value of the curves with cached key times for the current evaluation. */
+  Vector<float> values;
+};
+
+/* Number of curves evaluated by a single task. */
+static constexpr int64_t ACTION_EVAL_CACHE_GRAIN_SIZE = 256;
+
+/* -------------------------------------------------------------------- */
+/** \name Cache Building
+ * \{ */
+
+static bool action_eval_cache_is_valid(const ActionEvalCache *cache, const bAction *act)
+{
+  if (cache == nullptr) {
+    return false;
+  }
+  /* Curves of the copy-on-write action are re-allocated on every change of the action. */
+  if (act->id.recalc & ID_RECALC_COPY_ON_WRITE) {
+    return false;
+  }
+  return cache->action == act && cache->first_fcurve == act->curves.first &&
+         cache->last_fcurve == act->curves.last &&
+         cache->fcurves_num == BLI_listbase_count(&act->curves);
+}
+
+/**
+ * Curves with keyframes only can be evaluated from the cached key times. The keyframes are
+ * required to be sorted and further apart than the threshold used when searching for them, so
+ * the search in the key times finds the same keyframe as #BKE_fcurve_bezt_binarysearch_index_ex
+ * (with a margin for rounding errors).
+ */
+static bool action_eval_cache_fcurve_keys_supported(const FCurve *fcu)
+{
+  if (fcu->bezt == nullptr || fcu->totvert < 2 || fcu->driver != nullptr ||
+      !BLI_listbase_is_empty(&fcu->modifiers)) {
+    return false;
+  }
+  for (const int i : IndexRange(1, fcu->totvert - 1)) {
+    if (!(fcu->bezt[i].vec[1][0] - fcu->bezt[i - 1].vec[1][0] >
+          4.0f * BEZT_BINARYSEARCH_THRESH_EVAL)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Check whether the resolved path stays valid until the owner is updated by copy-on-write.
+ * Only paths to the owner itself and to data which is known to not be re-allocated during
+ * evaluation are cached, others are resolved for every evaluation.
+ */
+static bool action_eval_cache_rna_path_supported(const PointerRNA *id_ptr,
+                                                 const PathResolvedRNA &anim_rna)
+{
+  if (anim_rna.ptr.owner_id != id_ptr->owner_id) {
+    return false;
+  }
+  if (anim_rna.ptr.data == id_ptr->owner_id) {
+    return true;
+  }
+  /* Pose channels are re-allocated by #BKE_pose_rebuild, which frees the cache. */
+  if (anim_rna.ptr.type == &RNA_PoseBone) {
+    return true;
+  }
+  /* Shape keys only change with the copy-on-write update of the shape key data-block. */
+  if (anim_rna.ptr.type == &RNA_ShapeKey) {
+    return true;
+  }
+  return false;
+}
+
+static void action_eval_cache_build(ActionEvalCache &cache, PointerRNA *ptr, bAction *act)
+{
+  cache.action = act;
+  cache.first_fcurve = static_cast<const FCurve *>(act->curves.first);
+  cache.last_fcurve = static_cast<const FCurve *>(act->curves.last);
+  cache.fcurves_num = BLI_listbase_count(&act->curves);
+
+  cache.fcurves.clear();
+  cache.key_times.clear();
+  cache.key_times_offset.clear();
+  cache.segment_hint.clear();
+  cache.rna.clear();
+  cache.rna_is_cached.clear();
+
+  LISTBASE_FOREACH (FCurve *, fcu, &act->curves) {
+    if (!animsys_is_fcurve_evaluatable(fcu)) {
+      continue;
+    }
+    cache.fcurves.append(fcu);
+
+    if (action_eval_cache_fcurve_keys_supported(fcu)) {
+      cache.key_times_offset.append(int(cache.key_times.size()));
+      for (const int i : IndexRange(fcu->totvert)) {
+        cache.key_times.append(fcu->bezt[i].vec[1][0]);
+      }
+    }
+    else {
+      cache.key_times_offset.append(-1);
+    }
+    cache.segment_hint.append(1);
+
+    PathResolvedRNA anim_rna = {{nullptr}};
+    const bool is_resolved = BKE_animsys_rna_path_resolve(
+        ptr, fcu->rna_path, fcu->array_index, &anim_rna);
+    cache.rna.append(anim_rna);
+    cache.rna_is_cached.append(is_resolved && action_eval_cache_rna_path_supported(ptr, anim_rna));
+  }
+
+  cache.values.resize(cache.fcurves.size());
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Evaluation
+ * \{ */
+
+static bool key_times_segment_contains(const Span<float> key_times,
+                                       const int segment,
+                                       const float evaltime)
+{
+  return segment >= 1 && segment < key_times.size() && key_times[segment - 1] < evaltime &&
+         evaltime <= key_times[segment];
+}
+
+/* Same result as #evaluate_fcurve, for curves with cached key times. */
+static float action_eval_cache_fcurve_value(ActionEvalCache &cache,
+                                            const int index,
+                                            const float evaltime)
+{
+  FCurve *fcu = cache.fcurves[index];
+  const Span<float> key_times = cache.key_times.as_span().slice(cache.key_times_offset[index],
+                                                                fcu->totvert);
+
+  if (!(key_times.first() < evaltime && evaltime < key_times.last())) {
+    /* Extrapolation does not need the keyframe segment. */
+    return evaluate_fcurve(fcu, evaltime);
+  }
+
+  /* Playback mostly evaluates the same segment as before, or the next one. */
+  int segment = cache.segment_hint[index];
+  if (!key_times_segment_contains(key_times, segment, evaltime)) {
+    if (key_times_segment_contains(key_times, segment + 1, evaltime)) {
+      segment++;
+    }
+    else {
+      segment = int(std::lower_bound(key_times.begin(), key_times.end(), evaltime) -
+                    key_times.begin());
+    }
+  }
+  cache.segment_hint[index] = segment;
+
+  /* Keyframes are further apart than the threshold, only the ends of the segment can match. */
+  int key_index = segment;
+  bool exact = false;
+  if (IS_EQT(evaltime, key_times[segment - 1], BEZT_BINARYSEARCH_THRESH_EVAL)) {
+    key_index = segment - 1;
+    exact = true;
+  }
+  else if (IS_EQT(evaltime, key_times[segment], BEZT_BINARYSEARCH_THRESH_EVAL)) {
+    exact = true;
+  }
+
+  float value = BKE_fcurve_eval_keyframes_segment(fcu, evaltime, key_index, exact);
+  if (fcu->flag & FCURVE_INT_VALUES) {
+    value = floorf(value + 0.5f);
+  }
+  return value;
+}
+
+void animsys_evaluate_action_cached(PointerRNA *ptr,
+                                    AnimData *adt,
+                                    const AnimationEvalContext *anim_eval_context,
+                                    const bool flush_to_original)
+{
+  bAction *act = adt->action;
+  if (act == nullptr) {
+    return;
+  }
+
+  if (!action_eval_cache_is_valid(adt->action_eval_cache, act)) {
+    if (adt->action_eval_cache == nullptr) {
+      adt->action_eval_cache = MEM_new<ActionEvalCache>(__func__);
+    }
+    action_eval_cache_build(*adt->action_eval_cache, ptr, act);
+  }
+  ActionEvalCache &cache = *adt->action_eval_cache;
+
+  /* Values of curves with keyframes only do not depend on other properties, so they are
+   * calculated in parallel for actions with many curves. */
+  const float evaltime = anim_eval_context->eval_time;
+  blender::threading::parallel_for(
+      cache.fcurves.index_range(), ACTION_EVAL_CACHE_GRAIN_SIZE, [&](const IndexRange range) {
+        for (const int i : range) {
+          if (cache.key_times_offset[i] != -1) {
+            cache.values[i] = action_eval_cache_fcurve_value(cache, i, evaltime);
+          }
+        }
+      });
+
+  /* Write the values in the order of the curves, like #animsys_evaluate_action. Setting an item
+   * of an array property writes the entire array, so this is not done in parallel. */
+  for (const int i : cache.fcurves.index_range()) {
+    FCurve *fcu = cache.fcurves[i];
+    PathResolvedRNA anim_rna;
+    if (cache.rna_is_cached[i]) {
+      anim_rna = cache.rna[i];
+    }
+    else if (!BKE_animsys_rna_path_resolve(ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
+      continue;
+    }
+
+    float curval;
+    if (cache.key_times_offset[i] != -1) {
+      curval = cache.values[i];
+      fcu->curval = curval;
+    }
+    else {
+      curval = calculate_fcurve(&anim_rna, fcu, anim_eval_context);
+    }
+    BKE_animsys_write_to_rna_path(&anim_rna, curval);
+    if (flush_to_original) {
+      animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, curval);
+    }
+  }
+}
+
+/** \} */
+
+void BKE_animsys_action_eval_cache_free(AnimData *adt)
+{
+  MEM_delete(adt->action_eval_cache);
+  adt->action_eval_cache = nullptr;
+}
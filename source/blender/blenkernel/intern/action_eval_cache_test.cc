@@ -0,0 +1,209 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "BLI_listbase.h"
+#include "BLI_rand.hh"
+#include "BLI_string.h"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_animsys.h"
+#include "BKE_fcurve.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_object_types.h"
+
+#include "ED_keyframing.h"
+
+#include "RNA_access.h"
+#include "RNA_define.h"
+
+#include "nla_private.h"
+
+namespace blender::bke::tests {
+
+class ActionEvalCacheTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    RNA_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    RNA_exit();
+    CLG_exit();
+  }
+
+ protected:
+  Main *bmain = nullptr;
+  bAction *action = nullptr;
+  /* Evaluated with and without the cache. */
+  Object *ob_cached = nullptr;
+  Object *ob_reference = nullptr;
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    action = BKE_action_add(bmain, "Action");
+    ob_cached = BKE_object_add_only_object(bmain, OB_EMPTY, "Cached");
+    ob_reference = BKE_object_add_only_object(bmain, OB_EMPTY, "Reference");
+    for (Object *ob : {ob_cached, ob_reference}) {
+      AnimData *adt = BKE_animdata_ensure_id(&ob->id);
+      adt->action = action;
+      id_us_plus(&action->id);
+    }
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+  }
+
+  FCurve *add_fcurve(const char *rna_path,
+                     const int array_index,
+                     const Span<float> times,
+                     const Span<float> values,
+                     const eBezTriple_Interpolation ipo)
+  {
+    FCurve *fcu = BKE_fcurve_create();
+    fcu->rna_path = BLI_strdup(rna_path);
+    fcu->array_index = array_index;
+    for (const int i : times.index_range()) {
+      insert_vert_fcurve(fcu, times[i], values[i], BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+    }
+    for (const int i : IndexRange(fcu->totvert)) {
+      fcu->bezt[i].ipo = ipo;
+    }
+    BKE_fcurve_handles_recalc(fcu);
+    BLI_addtail(&action->curves, fcu);
+    return fcu;
+  }
+
+  /* Curves covering the cached keyframe segments as well as the curves which are evaluated
+   * without them. */
+  void add_fcurves()
+  {
+    add_fcurve("location",
+               0,
+               {1.0f, 5.0f, 6.0f, 12.0f, 20.0f, 33.0f},
+               {0.0f, 4.0f, -2.0f, 7.5f, 1.0f, 3.0f},
+               BEZT_IPO_BEZ);
+    add_fcurve("location", 1, {0.0f, 2.5f, 3.0f, 10.0f}, {1.0f, -1.0f, 6.0f, 2.0f}, BEZT_IPO_LIN);
+    add_fcurve("location", 2, {2.0f, 8.0f, 9.0f}, {5.0f, 2.0f, 7.0f}, BEZT_IPO_CONST);
+    /* Muted curves are skipped. */
+    FCurve *fcu_muted = add_fcurve("rotation_euler", 0, {1.0f, 9.0f}, {1.0f, 2.0f}, BEZT_IPO_LIN);
+    fcu_muted->flag |= FCURVE_MUTED;
+    /* Keyframes which are too close to be searched in the cached key times. Inserting keyframes
+     * replaces close ones, so the keyframe is moved afterwards. */
+    FCurve *fcu_close = add_fcurve(
+        "rotation_euler", 2, {1.0f, 2.0f, 8.0f}, {0.0f, 1.0f, 3.0f}, BEZT_IPO_LIN);
+    for (float *co : fcu_close->bezt[1].vec) {
+      co[0] -= 0.9997f;
+    }
+    /* F-Modifiers. */
+    FCurve *fcu_cycles = add_fcurve(
+        "scale", 0, {4.0f, 7.0f, 11.0f}, {1.0f, 3.0f, 0.5f}, BEZT_IPO_BEZ);
+    add_fmodifier(&fcu_cycles->modifiers, FMODIFIER_TYPE_CYCLES, fcu_cycles);
+    /* Integer values. */
+    FCurve *fcu_int = add_fcurve(
+        "pass_index", 0, {0.0f, 10.0f, 30.0f}, {0.0f, 7.0f, 2.0f}, BEZT_IPO_LIN);
+    fcu_int->flag |= FCURVE_INT_VALUES | FCURVE_DISCRETE_VALUES;
+  }
+
+  void expect_cached_matches_reference(const float evaltime)
+  {
+    const AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(nullptr,
+                                                                                      evaltime);
+    PointerRNA ptr_cached, ptr_reference;
+    RNA_id_pointer_create(&ob_cached->id, &ptr_cached);
+    RNA_id_pointer_create(&ob_reference->id, &ptr_reference);
+    animsys_evaluate_action_cached(&ptr_cached, ob_cached->adt, &anim_eval_context, false);
+    animsys_evaluate_action(&ptr_reference, action, &anim_eval_context, false);
+
+    for (const int i : IndexRange(3)) {
+      EXPECT_FLOAT_EQ(ob_cached->loc[i], ob_reference->loc[i])
+          << "location[" << i << "] at " << evaltime;
+      EXPECT_FLOAT_EQ(ob_cached->rot[i], ob_reference->rot[i])
+          << "rotation_euler[" << i << "] at " << evaltime;
+      EXPECT_FLOAT_EQ(ob_cached->scale[i], ob_reference->scale[i])
+          << "scale[" << i << "] at " << evaltime;
+    }
+    EXPECT_EQ(ob_cached->index, ob_reference->index) << "pass_index at " << evaltime;
+  }
+};
+
+TEST_F(ActionEvalCacheTest, forward_backward)
+{
+  add_fcurves();
+
+  /* Playback, stepping to the next segment or staying in the same one. */
+  for (float evaltime = -2.0f; evaltime <= 36.0f; evaltime += 0.25f) {
+    expect_cached_matches_reference(evaltime);
+  }
+  for (float evaltime = 36.0f; evaltime >= -2.0f; evaltime -= 0.25f) {
+    expect_cached_matches_reference(evaltime);
+  }
+  /* Skipping segments. */
+  for (float evaltime = -2.0f; evaltime <= 36.0f; evaltime += 7.0f) {
+    expect_cached_matches_reference(evaltime);
+  }
+}
+
+TEST_F(ActionEvalCacheTest, keyframe_times)
+{
+  add_fcurves();
+
+  /* On keyframes and within the search threshold of them, approached from both sides. */
+  const float offsets[] = {0.0f, 0.00008f, -0.00008f, 0.0002f, -0.0002f};
+  LISTBASE_FOREACH (const FCurve *, fcu, &action->curves) {
+    for (const int i : IndexRange(fcu->totvert)) {
+      for (const float offset : offsets) {
+        expect_cached_matches_reference(fcu->bezt[i].vec[1][0] + offset);
+      }
+    }
+    for (int i = fcu->totvert - 1; i >= 0; i--) {
+      for (const float offset : offsets) {
+        expect_cached_matches_reference(fcu->bezt[i].vec[1][0] + offset);
+      }
+    }
+  }
+}
+
+TEST_F(ActionEvalCacheTest, random_jumps)
+{
+  add_fcurves();
+
+  RandomNumberGenerator rng(0);
+  for (int i = 0; i < 500; i++) {
+    expect_cached_matches_reference(rng.get_float() * 40.0f - 3.0f);
+  }
+}
+
+TEST_F(ActionEvalCacheTest, action_change)
+{
+  add_fcurves();
+  expect_cached_matches_reference(4.5f);
+
+  /* The cache is rebuilt when curves are added or removed. */
+  add_fcurve("scale", 1, {3.0f, 6.0f}, {1.0f, 2.0f}, BEZT_IPO_LIN);
+  expect_cached_matches_reference(4.5f);
+  expect_cached_matches_reference(5.5f);
+
+  FCurve *fcu = static_cast<FCurve *>(action->curves.first);
+  BLI_remlink(&action->curves, fcu);
+  BKE_fcurve_free(fcu);
+  expect_cached_matches_reference(5.5f);
+  expect_cached_matches_reference(4.5f);
+}
+
+}  // namespace blender::bke::tests
@@ -350,7 +350,7 @@ void BKE_keyingsets_blend_read_expand(BlendExpander *expander, ListBase *list)
 /* ***************************************** */
 /* Evaluation Data-Setting Backend */
 
-static bool is_fcurve_evaluatable(FCurve *fcu)
+bool animsys_is_fcurve_evaluatable(FCurve *fcu)
 {
   if (fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) {
     return false;
@@ -564,10 +564,10 @@ static bool animsys_construct_orig_pointer_rna(const PointerRNA *ptr, PointerRNA
   return true;
 }
 
-static void animsys_write_orig_anim_rna(PointerRNA *ptr,
-                                        const char *rna_path,
-                                        int array_index,
-                                        float value)
+void animsys_write_orig_anim_rna(PointerRNA *ptr,
+                                 const char *rna_path,
+                                 int array_index,
+                                 float value)
 {
   PointerRNA ptr_orig;
   if (!animsys_construct_orig_pointer_rna(ptr, &ptr_orig)) {
@@ -593,7 +593,7 @@ static void animsys_evaluate_fcurves(PointerRNA *ptr,
   /* Calculate then execute each curve. */
   LISTBASE_FOREACH (FCurve *, fcu, list) {
 
-    if (!is_fcurve_evaluatable(fcu)) {
+    if (!animsys_is_fcurve_evaluatable(fcu)) {
       continue;
     }
 
@@ -665,7 +665,7 @@ static void animsys_blend_in_fcurves(PointerRNA *ptr,
       }
     }
 
-    if (!is_fcurve_evaluatable(fcu)) {
+    if (!animsys_is_fcurve_evaluatable(fcu)) {
       continue;
     }
 
@@ -2587,7 +2587,7 @@ static void nlasnapshot_from_action(PointerRNA *ptr,
       &storage, modifiers, NULL, 0.0f, evaltime);
 
   for (fcu = action->curves.first; fcu; fcu = fcu->next) {
-    if (!is_fcurve_evaluatable(fcu)) {
+    if (!animsys_is_fcurve_evaluatable(fcu)) {
       continue;
     }
 
@@ -3057,7 +3057,7 @@ static void nla_eval_domain_action(PointerRNA *ptr,
 
   LISTBASE_FOREACH (FCurve *, fcu, &act->curves) {
     /* check if this curve should be skipped */
-    if (!is_fcurve_evaluatable(fcu)) {
+    if (!animsys_is_fcurve_evaluatable(fcu)) {
       continue;
     }
 
@@ -3912,7 +3912,15 @@ void BKE_animsys_evaluate_animdata(ID *id,
     }
     /* evaluate Active Action only */
     else if (adt->action) {
-      animsys_evaluate_action(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      if (id->tag & LIB_TAG_COPIED_ON_WRITE) {
+        /* Copy-on-write data-blocks are evaluated for every frame by the dependency graph,
+         * re-use what does not change between the frames. */
+        action_idcode_patch_check(id, adt->action);
+        animsys_evaluate_action_cached(&id_ptr, adt, anim_eval_context, flush_to_original);
+      }
+      else {
+        animsys_evaluate_action(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      }
     }
   }
 
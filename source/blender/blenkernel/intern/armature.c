@@ -33,6 +33,7 @@
 #include "BKE_action.h"
 #include "BKE_anim_data.h"
 #include "BKE_anim_visualization.h"
+#include "BKE_animsys.h"
 #include "BKE_armature.h"
 #include "BKE_constraint.h"
 #include "BKE_curve.h"
@@ -2388,6 +2389,11 @@ void BKE_pose_rebuild(Main *bmain, Object *ob, bArmature *arm, const bool do_id_
   /* and a check for garbage */
   BKE_pose_channels_clear_with_null_bone(pose, do_id_user);
 
+  /* Animation paths resolved to pose channels which were freed are not valid anymore. */
+  if (ob->adt != NULL) {
+    BKE_animsys_action_eval_cache_free(ob->adt);
+  }
+
   BKE_pose_channels_hash_ensure(pose);
 
   for (pchan = pose->chanbase.first; pchan; pchan = pchan->next) {
@@ -18,6 +18,7 @@
 
 #include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_simd.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
 
@@ -47,6 +48,38 @@ static CLG_LogRef LOG = {"bke.armature_deform"};
 /** \name Armature Deform Internal Utilities
  * \{ */
 
+/**
+ * Same as #add_weighted_dq_dq, the rotation and translation are added as one vector each and the
+ * scale matrix by column, since this runs for every bone of every vertex.
+ */
+BLI_INLINE void deform_dq_blend(DualQuat *dq_accum, const DualQuat *deform_dq, float weight)
+{
+#ifdef BLI_HAVE_SSE2
+  const __m128 quat = _mm_loadu_ps(deform_dq->quat);
+  const __m128 quat_accum = _mm_loadu_ps(dq_accum->quat);
+
+  /* Interpolate in the direction of the accumulated rotation, see #add_weighted_dq_dq. */
+  const bool flipped = dot_qtqt(deform_dq->quat, dq_accum->quat) < 0.0f;
+  const __m128 w = _mm_set1_ps(flipped ? -weight : weight);
+  _mm_storeu_ps(dq_accum->quat, _mm_add_ps(quat_accum, _mm_mul_ps(quat, w)));
+  _mm_storeu_ps(dq_accum->trans,
+                _mm_add_ps(_mm_loadu_ps(dq_accum->trans),
+                           _mm_mul_ps(_mm_loadu_ps(deform_dq->trans), w)));
+
+  /* Scale is never interpolated with a negative weight. */
+  if (deform_dq->scale_weight) {
+    const __m128 w_scale = _mm_set1_ps(weight);
+    for (int i = 0; i < 4; i++) {
+      const __m128 col = _mm_mul_ps(_mm_loadu_ps(deform_dq->scale[i]), w_scale);
+      _mm_storeu_ps(dq_accum->scale[i], _mm_add_ps(_mm_loadu_ps(dq_accum->scale[i]), col));
+    }
+    dq_accum->scale_weight += weight;
+  }
+#else
+  add_weighted_dq_dq(dq_accum, deform_dq, weight);
+#endif
+}
+
 /* Add the effect of one bone or B-Bone segment to the accumulated result. */
 static void pchan_deform_accumulate(const DualQuat *deform_dq,
                                     const float deform_mat[4][4],
@@ -63,7 +96,7 @@ static void pchan_deform_accumulate(const DualQuat *deform_dq,
   if (dq_accum) {
     BLI_assert(!co_accum);
 
-    add_weighted_dq_dq(dq_accum, deform_dq, weight);
+    deform_dq_blend(dq_accum, deform_dq, weight);
   }
   else {
     float tmp[3];
@@ -81,6 +114,26 @@ static void pchan_deform_accumulate(const DualQuat *deform_dq,
   }
 }
 
+/**
+ * Add the weighted deform matrix of a bone to the blended matrix of a vertex. Transforming the
+ * coordinate by the blended matrix once gives the same result as accumulating the transformed
+ * coordinate of every bone, see #pchan_deform_accumulate.
+ */
+BLI_INLINE void deform_mat_blend(float blend_mat[4][4],
+                                 const float deform_mat[4][4],
+                                 const float weight)
+{
+#ifdef BLI_HAVE_SSE2
+  const __m128 w = _mm_set1_ps(weight);
+  for (int i = 0; i < 4; i++) {
+    const __m128 col = _mm_mul_ps(_mm_loadu_ps(deform_mat[i]), w);
+    _mm_storeu_ps(blend_mat[i], _mm_add_ps(_mm_loadu_ps(blend_mat[i]), col));
+  }
+#else
+  madd_m4_m4m4fl(blend_mat, blend_mat, deform_mat, weight);
+#endif
+}
+
 static void b_bone_deform(const bPoseChannel *pchan,
                           const float co[3],
                           float weight,
@@ -242,6 +295,12 @@ typedef struct ArmatureUserdata {
   bPoseChannel **pchan_from_defbase;
   int defbase_len;
 
+  /**
+   * Per deform group: deform matrix of the bone when it is blended with #deform_mat_blend,
+   * NULL for groups whose bone is deformed with #pchan_bone_deform.
+   */
+  const float (**defbase_blend_mats)[4];
+
   float premat[4][4];
   float postmat[4][4];
 
@@ -251,6 +310,42 @@ typedef struct ArmatureUserdata {
   } bmesh;
 } ArmatureUserdata;
 
+/* Add the effect of the bone of a deform group, returns false if the group has no bone. */
+static bool armature_vert_group_deform(const ArmatureUserdata *data,
+                                       const uint index,
+                                       float weight,
+                                       const float co[3],
+                                       float vec[3],
+                                       DualQuat *dq,
+                                       float mat[3][3],
+                                       float blend_mat[4][4],
+                                       float *blend_weight,
+                                       float *contrib)
+{
+  const bPoseChannel *pchan;
+  if (index >= data->defbase_len || !(pchan = data->pchan_from_defbase[index])) {
+    return false;
+  }
+
+  if (data->defbase_blend_mats && data->defbase_blend_mats[index]) {
+    if (weight != 0.0f) {
+      deform_mat_blend(blend_mat, data->defbase_blend_mats[index], weight);
+      *blend_weight += weight;
+      *contrib += weight;
+    }
+    return true;
+  }
+
+  const Bone *bone = pchan->bone;
+  if (bone && bone->flag & BONE_MULT_VG_ENV) {
+    weight *= distfactor_to_bone(
+        co, bone->arm_head, bone->arm_tail, bone->rad_head, bone->rad_tail, bone->dist);
+  }
+
+  pchan_bone_deform(pchan, weight, vec, dq, mat, co, contrib);
+  return true;
+}
+
 static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
                                           const int i,
                                           const MDeformVert *dvert)
@@ -312,23 +407,24 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
   mul_m4_v3(data->premat, co);
 
   if (use_dverts && dvert && dvert->totweight) { /* use weight groups ? */
+    float blend_mat[4][4], blend_weight = 0.0f;
+    bool deformed = false;
+    zero_m4(blend_mat);
     const MDeformWeight *dw = dvert->dw;
-    int deformed = 0;
-    unsigned int j;
-    for (j = dvert->totweight; j != 0; j--, dw++) {
-      const uint index = dw->def_nr;
-      if (index < data->defbase_len && (pchan = data->pchan_from_defbase[index])) {
-        float weight = dw->weight;
-        const Bone *bone = pchan->bone;
-
-        deformed = 1;
-
-        if (bone && bone->flag & BONE_MULT_VG_ENV) {
-          weight *= distfactor_to_bone(
-              co, bone->arm_head, bone->arm_tail, bone->rad_head, bone->rad_tail, bone->dist);
-        }
-
-        pchan_bone_deform(pchan, weight, vec, dq, smat, co, &contrib);
+    for (int j = dvert->totweight; j != 0; j--, dw++) {
+      deformed |= armature_vert_group_deform(
+          data, dw->def_nr, dw->weight, co, vec, dq, smat, blend_mat, &blend_weight, &contrib);
+    }
+    if (blend_weight != 0.0f) {
+      float tmp[3];
+      mul_v3_m4v3(tmp, blend_mat, co);
+      madd_v3_v3fl(tmp, co, -blend_weight);
+      add_v3_v3(vec, tmp);
+
+      if (smat) {
+        float tmpmat[3][3];
+        copy_m3_m4(tmpmat, blend_mat);
+        add_m3_m3m3(smat, smat, tmpmat);
       }
     }
     /* If there are vertex-groups but not groups with bones (like for soft-body groups). */
@@ -461,6 +557,7 @@ static void armature_deform_coords_impl(const Object *ob_arm,
 {
   const bArmature *arm = ob_arm->data;
   bPoseChannel **pchan_from_defbase = NULL;
+  const float(**defbase_blend_mats)[4] = NULL;
   const MDeformVert *dverts = NULL;
   const bool use_envelope = (deformflag & ARM_DEF_ENVELOPE) != 0;
   const bool use_quaternion = (deformflag & ARM_DEF_QUATERNION) != 0;
@@ -546,6 +643,23 @@ static void armature_deform_coords_impl(const Object *ob_arm,
             }
           }
         }
+
+        /* Blend the matrices of bones which deform by a single matrix (no B-Bone segments and
+         * envelope multiplication), instead of transforming the coordinate by each of them.
+         * The matrices change with the pose, so only pointers to them are stored. */
+        if (!use_quaternion) {
+          defbase_blend_mats = MEM_calloc_arrayN(
+              defbase_len, sizeof(*defbase_blend_mats), "defbase_blend_mats");
+          for (i = 0; i < defbase_len; i++) {
+            const bPoseChannel *pchan = pchan_from_defbase[i];
+            if (pchan == NULL || pchan->bone->flag & BONE_MULT_VG_ENV ||
+                (pchan->bone->segments > 1 &&
+                 pchan->runtime.bbone_segments == pchan->bone->segments)) {
+              continue;
+            }
+            defbase_blend_mats[i] = pchan->chan_mat;
+          }
+        }
       }
     }
   }
@@ -565,6 +679,7 @@ static void armature_deform_coords_impl(const Object *ob_arm,
       .dverts_len = dverts_len,
       .pchan_from_defbase = pchan_from_defbase,
       .defbase_len = defbase_len,
+      .defbase_blend_mats = defbase_blend_mats,
       .bmesh =
           {
               .cd_dvert_offset = cd_dvert_offset,
@@ -604,6 +719,7 @@ static void armature_deform_coords_impl(const Object *ob_arm,
   if (pchan_from_defbase) {
     MEM_freeN(pchan_from_defbase);
   }
+  MEM_SAFE_FREE(defbase_blend_mats);
 }
 
 void BKE_armature_deform_coords_with_gpencil_stroke(const Object *ob_arm,
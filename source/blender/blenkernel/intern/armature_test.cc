@@ -3,10 +3,29 @@
 
 #include "BKE_armature.hh"
 
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_float3x3.hh"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
-
+#include "BLI_math_vec_types.hh"
+#include "BLI_rand.hh"
+#include "BLI_string.h"
+
+#include "BKE_action.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "DNA_action_types.h"
 #include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
 
 #include "testing/testing.h"
 
@@ -16,6 +35,7 @@ static const float FLOAT_EPSILON = 1.2e-7;
 
 static const float SCALE_EPSILON = 3.71e-5;
 static const float ORTHO_EPSILON = 5e-5;
+static const float DEFORM_EPSILON = 1e-5;
 
 /** Test that the matrix is orthogonal, i.e. has no scale or shear within acceptable precision. */
 static double EXPECT_M3_ORTHOGONAL(const float mat[3][3],
@@ -423,4 +443,280 @@ TEST_F(BKE_armature_find_selected_bones_test, all_bones_selected)
   EXPECT_FALSE(result.no_bones_selected);
 }
 
+class BKE_armature_deform_test : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+ protected:
+  Main *bmain = nullptr;
+  bArmature *armature = nullptr;
+  Object *ob_arm = nullptr;
+  Object *ob_target = nullptr;
+  Mesh *mesh = nullptr;
+
+  /* Bones of every kind of deformation, with vertex groups of the same names. The last vertex
+   * group has no bone. */
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    armature = BKE_armature_add(bmain, "Armature");
+    ob_arm = BKE_object_add_only_object(bmain, OB_ARMATURE, "Rig");
+    ob_arm->data = armature;
+
+    add_bone("Plain1", {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f});
+    add_bone("Plain2", {0.0f, 1.0f, 0.0f}, {0.2f, 2.0f, 0.0f});
+    Bone *bbone = add_bone("BBone", {0.0f, 2.0f, 0.0f}, {0.0f, 3.0f, 0.2f});
+    bbone->segments = 4;
+    Bone *envelope = add_bone("Envelope", {0.5f, 0.0f, 0.0f}, {0.5f, 2.0f, 0.0f});
+    envelope->flag |= BONE_MULT_VG_ENV;
+    envelope->rad_head = 0.6f;
+    envelope->rad_tail = 0.4f;
+    envelope->dist = 0.5f;
+    Bone *no_deform = add_bone("NoDeform", {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f});
+    no_deform->flag |= BONE_NO_DEFORM;
+    BKE_armature_where_is(armature);
+    BKE_pose_rebuild(nullptr, ob_arm, armature, false);
+    ob_arm->pose->flag &= ~POSE_RECALC;
+    unit_m4(ob_arm->obmat);
+
+    mesh = BKE_mesh_new_nomain(64, 0, 0, 0, 0);
+    for (const char *name : {"Plain1", "Plain2", "BBone", "Envelope", "NoDeform", "Missing"}) {
+      bDeformGroup *defgroup = MEM_cnew<bDeformGroup>(__func__);
+      STRNCPY(defgroup->name, name);
+      BLI_addtail(&mesh->vertex_group_names, defgroup);
+    }
+    ob_target = BKE_object_add_only_object(bmain, OB_MESH, "Target");
+    ob_target->data = mesh;
+    unit_m4(ob_target->obmat);
+
+    RandomNumberGenerator rng(0);
+    for (MVert &vert : mesh->verts_for_write()) {
+      vert.co[0] = rng.get_float() * 2.0f - 0.5f;
+      vert.co[1] = rng.get_float() * 4.0f - 0.5f;
+      vert.co[2] = rng.get_float() - 0.5f;
+    }
+    pose_bones(rng);
+  }
+
+  void TearDown() override
+  {
+    ob_target->data = nullptr;
+    BKE_main_free(bmain);
+    BKE_id_free(nullptr, mesh);
+  }
+
+  Bone *add_bone(const char *name, const float3 &head, const float3 &tail)
+  {
+    Bone *bone = MEM_cnew<Bone>(__func__);
+    STRNCPY(bone->name, name);
+    copy_v3_v3(bone->head, head);
+    copy_v3_v3(bone->tail, tail);
+    bone->weight = 1.0f;
+    bone->segments = 1;
+    bone->ease1 = bone->ease2 = 1.0f;
+    copy_v3_fl(bone->scale_in, 1.0f);
+    copy_v3_fl(bone->scale_out, 1.0f);
+    BLI_addtail(&armature->bonebase, bone);
+    return bone;
+  }
+
+  /* Random pose, evaluated like the pose evaluation of the depsgraph does. */
+  void pose_bones(RandomNumberGenerator &rng)
+  {
+    LISTBASE_FOREACH (bPoseChannel *, pchan, &ob_arm->pose->chanbase) {
+      const float euler[3] = {rng.get_float() - 0.5f, rng.get_float() - 0.5f, rng.get_float()};
+      eul_to_quat(pchan->quat, euler);
+      for (const int i : IndexRange(3)) {
+        pchan->loc[i] = rng.get_float() - 0.5f;
+        pchan->size[i] = rng.get_float() + 0.5f;
+      }
+      BKE_pose_where_is_bone(nullptr, nullptr, ob_arm, pchan, 0.0f, true);
+
+      float imat[4][4];
+      invert_m4_m4(imat, pchan->bone->arm_mat);
+      mul_m4_m4m4(pchan->chan_mat, pchan->pose_mat, imat);
+      mat4_to_dquat(&pchan->runtime.deform_dual_quat, pchan->bone->arm_mat, pchan->chan_mat);
+    }
+    LISTBASE_FOREACH (bPoseChannel *, pchan, &ob_arm->pose->chanbase) {
+      if (pchan->bone->segments > 1) {
+        BKE_pchan_bbone_segments_cache_compute(pchan);
+      }
+    }
+  }
+
+  /* Assign random weights of the given vertex groups to every vertex, and a weight of the first
+   * vertex group which is large enough to deform all vertices. */
+  void assign_weights(const Span<int> defgroups)
+  {
+    RandomNumberGenerator rng(1);
+    for (MDeformVert &dvert : mesh->deform_verts_for_write()) {
+      BKE_defvert_add_index_notest(&dvert, 0, rng.get_float() + 0.1f);
+      for (const int defgroup : defgroups) {
+        /* Zero weights are skipped. */
+        const float weight = rng.get_float() < 0.2f ? 0.0f : rng.get_float();
+        BKE_defvert_add_index_notest(&dvert, defgroup, weight);
+      }
+    }
+  }
+
+  /* Add the deformation of a bone or B-Bone segment, like the deformation of every bone without
+   * blending the deform matrices. */
+  static void accumulate(const DualQuat &deform_dq,
+                         const float deform_mat[4][4],
+                         const float3 &co,
+                         const float weight,
+                         float3 &vec,
+                         float3x3 &mat,
+                         DualQuat &dq)
+  {
+    float3 deformed_co;
+    mul_v3_m4v3(deformed_co, deform_mat, co);
+    madd_v3_v3fl(vec, deformed_co - co, weight);
+    float deform_mat3[3][3];
+    copy_m3_m4(deform_mat3, deform_mat);
+    madd_m3_m3m3fl(mat.values, mat.values, deform_mat3, weight);
+    add_weighted_dq_dq(&dq, &deform_dq, weight);
+  }
+
+  /* Deformation of a vertex computed bone by bone, the object matrices are the identity. */
+  void reference_deform(const MDeformVert &dvert,
+                        const bool use_quaternion,
+                        float3 &co,
+                        float3x3 &deform_mat)
+  {
+    float3 vec(0.0f);
+    float3x3 mat;
+    zero_m3(mat.values);
+    DualQuat dq = {};
+    float contrib = 0.0f;
+    for (const MDeformWeight &dw : Span<MDeformWeight>(dvert.dw, dvert.totweight)) {
+      const bDeformGroup *defgroup = static_cast<const bDeformGroup *>(
+          BLI_findlink(&mesh->vertex_group_names, dw.def_nr));
+      const bPoseChannel *pchan = BKE_pose_channel_find_name(ob_arm->pose, defgroup->name);
+      if (pchan == nullptr || pchan->bone->flag & BONE_NO_DEFORM) {
+        continue;
+      }
+      const Bone *bone = pchan->bone;
+      float weight = dw.weight;
+      if (bone->flag & BONE_MULT_VG_ENV) {
+        weight *= distfactor_to_bone(
+            co, bone->arm_head, bone->arm_tail, bone->rad_head, bone->rad_tail, bone->dist);
+      }
+      if (weight == 0.0f) {
+        continue;
+      }
+      contrib += weight;
+
+      if (bone->segments > 1) {
+        const Mat4 *mats = pchan->runtime.bbone_deform_mats;
+        const DualQuat *quats = pchan->runtime.bbone_dual_quats;
+        float3 bone_co;
+        mul_v3_m4v3(bone_co, mats[0].mat, co);
+        int index;
+        float blend;
+        BKE_pchan_bbone_deform_segment_index(pchan, bone_co.y / bone->length, &index, &blend);
+        accumulate(quats[index], mats[index + 1].mat, co, weight * (1.0f - blend), vec, mat, dq);
+        accumulate(quats[index + 1], mats[index + 2].mat, co, weight * blend, vec, mat, dq);
+      }
+      else {
+        accumulate(pchan->runtime.deform_dual_quat, pchan->chan_mat, co, weight, vec, mat, dq);
+      }
+    }
+
+    ASSERT_GT(contrib, 0.0001f);
+    if (use_quaternion) {
+      normalize_dq(&dq, contrib);
+      mul_v3m3_dq(co, deform_mat.values, &dq);
+    }
+    else {
+      madd_v3_v3fl(co, vec, 1.0f / contrib);
+      mul_m3_fl(mat.values, 1.0f / contrib);
+      deform_mat = mat;
+    }
+  }
+
+  /* Deform all vertices and compare the result with the deformation computed bone by bone. */
+  void expect_deform_matches_reference(const int deformflag, const bool use_deform_mats)
+  {
+    const Span<MVert> verts = mesh->verts();
+    Array<float3> coords(verts.size());
+    for (const int i : verts.index_range()) {
+      coords[i] = verts[i].co;
+    }
+    Array<float3x3> deform_mats(verts.size(), float3x3::identity());
+    BKE_armature_deform_coords_with_mesh(
+        ob_arm,
+        ob_target,
+        reinterpret_cast<float(*)[3]>(coords.data()),
+        use_deform_mats ? reinterpret_cast<float(*)[3][3]>(deform_mats.data()) : nullptr,
+        verts.size(),
+        deformflag,
+        nullptr,
+        nullptr,
+        mesh);
+
+    const Span<MDeformVert> dverts = mesh->deform_verts();
+    for (const int i : verts.index_range()) {
+      float3 expected_co = verts[i].co;
+      float3x3 expected_mat = float3x3::identity();
+      reference_deform(dverts[i], deformflag & ARM_DEF_QUATERNION, expected_co, expected_mat);
+      for (const int j : IndexRange(3)) {
+        EXPECT_NEAR(coords[i][j], expected_co[j], DEFORM_EPSILON) << "vertex " << i;
+        if (!use_deform_mats) {
+          continue;
+        }
+        for (const int k : IndexRange(3)) {
+          EXPECT_NEAR(deform_mats[i].values[j][k], expected_mat.values[j][k], DEFORM_EPSILON)
+              << "vertex " << i << " deform_mat[" << j << "][" << k << "]";
+        }
+      }
+    }
+  }
+};
+
+TEST_F(BKE_armature_deform_test, linear)
+{
+  /* Bones with blended deform matrices, bones which don't deform and a group without a bone. */
+  assign_weights({1, 4, 5});
+  expect_deform_matches_reference(ARM_DEF_VGROUP, false);
+}
+
+TEST_F(BKE_armature_deform_test, deform_matrices)
+{
+  assign_weights({1, 4, 5});
+  expect_deform_matches_reference(ARM_DEF_VGROUP, true);
+}
+
+TEST_F(BKE_armature_deform_test, mixed_bbone_envelope)
+{
+  /* Blended deform matrices mixed with bones which are deformed one by one. */
+  assign_weights({1, 2, 3, 4});
+  expect_deform_matches_reference(ARM_DEF_VGROUP, false);
+  expect_deform_matches_reference(ARM_DEF_VGROUP, true);
+}
+
+TEST_F(BKE_armature_deform_test, dual_quaternion)
+{
+  assign_weights({1, 2, 3, 4, 5});
+  expect_deform_matches_reference(ARM_DEF_VGROUP | ARM_DEF_QUATERNION, false);
+  expect_deform_matches_reference(ARM_DEF_VGROUP | ARM_DEF_QUATERNION, true);
+}
+
+TEST_F(BKE_armature_deform_test, dual_quaternion_flipped)
+{
+  /* The negated dual quaternion is the same transformation, it has to be added with a negated
+   * weight to the accumulated rotation, but not to the accumulated scale. */
+  bPoseChannel *pchan = BKE_pose_channel_find_name(ob_arm->pose, "Plain2");
+  DualQuat &dq = pchan->runtime.deform_dual_quat;
+  ASSERT_NE(dq.scale_weight, 0.0f);
+  negate_v4(dq.quat);
+  negate_v4(dq.trans);
+
+  assign_weights({1, 3});
+  expect_deform_matches_reference(ARM_DEF_VGROUP | ARM_DEF_QUATERNION, true);
+}
+
 }  // namespace blender::bke::tests
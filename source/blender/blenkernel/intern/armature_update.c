@@ -9,6 +9,7 @@
 
 #include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_armature_types.h"
@@ -851,15 +852,13 @@ void BKE_pose_eval_init_ik(struct Depsgraph *depsgraph, Scene *scene, Object *ob
   BKE_pose_splineik_init_tree(scene, object, ctime);
 }
 
-void BKE_pose_eval_bone(struct Depsgraph *depsgraph, Scene *scene, Object *object, int pchan_index)
+static void pose_eval_bone_ex(struct Depsgraph *depsgraph,
+                              Scene *scene,
+                              Object *object,
+                              bPoseChannel *pchan,
+                              const float ctime)
 {
   const bArmature *armature = (bArmature *)object->data;
-  if (armature->edbo != NULL) {
-    return;
-  }
-  bPoseChannel *pchan = pose_pchan_get_indexed(object, pchan_index);
-  DEG_debug_print_eval_subdata(
-      depsgraph, __func__, object->id.name, object, "pchan", pchan->name, pchan);
   BLI_assert(object->type == OB_ARMATURE);
   if (armature->flag & ARM_RESTPOS) {
     Bone *bone = pchan->bone;
@@ -878,8 +877,6 @@ void BKE_pose_eval_bone(struct Depsgraph *depsgraph, Scene *scene, Object *objec
       }
       else {
         if ((pchan->flag & POSE_DONE) == 0) {
-          /* TODO(sergey): Use time source node for time. */
-          float ctime = BKE_scene_ctime_get(scene); /* not accurate... */
           BKE_pose_where_is_bone(depsgraph, scene, object, pchan, ctime, 1);
         }
       }
@@ -887,6 +884,20 @@ void BKE_pose_eval_bone(struct Depsgraph *depsgraph, Scene *scene, Object *objec
   }
 }
 
+void BKE_pose_eval_bone(struct Depsgraph *depsgraph, Scene *scene, Object *object, int pchan_index)
+{
+  const bArmature *armature = (bArmature *)object->data;
+  if (armature->edbo != NULL) {
+    return;
+  }
+  bPoseChannel *pchan = pose_pchan_get_indexed(object, pchan_index);
+  DEG_debug_print_eval_subdata(
+      depsgraph, __func__, object->id.name, object, "pchan", pchan->name, pchan);
+  /* TODO(sergey): Use time source node for time. */
+  const float ctime = BKE_scene_ctime_get(scene); /* not accurate... */
+  pose_eval_bone_ex(depsgraph, scene, object, pchan, ctime);
+}
+
 void BKE_pose_constraints_evaluate(struct Depsgraph *depsgraph,
                                    Scene *scene,
                                    Object *object,
@@ -933,16 +944,11 @@ static void pose_channel_flush_to_orig_if_needed(struct Depsgraph *depsgraph,
   copy_v3_v3(pchan_orig->pose_tail, pchan->pose_tail);
 }
 
-void BKE_pose_bone_done(struct Depsgraph *depsgraph, struct Object *object, int pchan_index)
+static void pose_bone_done_ex(struct Depsgraph *depsgraph,
+                              struct Object *object,
+                              bPoseChannel *pchan)
 {
-  const bArmature *armature = (bArmature *)object->data;
-  if (armature->edbo != NULL) {
-    return;
-  }
-  bPoseChannel *pchan = pose_pchan_get_indexed(object, pchan_index);
   float imat[4][4];
-  DEG_debug_print_eval_subdata(
-      depsgraph, __func__, object->id.name, object, "pchan", pchan->name, pchan);
   if (pchan->bone) {
     invert_m4_m4(imat, pchan->bone->arm_mat);
     mul_m4_m4m4(pchan->chan_mat, pchan->pose_mat, imat);
@@ -959,6 +965,69 @@ void BKE_pose_bone_done(struct Depsgraph *depsgraph, struct Object *object, int
   }
 }
 
+void BKE_pose_bone_done(struct Depsgraph *depsgraph, struct Object *object, int pchan_index)
+{
+  const bArmature *armature = (bArmature *)object->data;
+  if (armature->edbo != NULL) {
+    return;
+  }
+  bPoseChannel *pchan = pose_pchan_get_indexed(object, pchan_index);
+  DEG_debug_print_eval_subdata(
+      depsgraph, __func__, object->id.name, object, "pchan", pchan->name, pchan);
+  pose_bone_done_ex(depsgraph, object, pchan);
+}
+
+typedef struct PoseBonesBatchData {
+  struct Depsgraph *depsgraph;
+  Scene *scene;
+  Object *object;
+  const int *pchan_indices;
+  float ctime;
+} PoseBonesBatchData;
+
+static void pose_eval_bones_batch_task(void *__restrict userdata,
+                                       const int index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const PoseBonesBatchData *data = userdata;
+  bPoseChannel *pchan = pose_pchan_get_indexed(data->object, data->pchan_indices[index]);
+  pose_eval_bone_ex(data->depsgraph, data->scene, data->object, pchan, data->ctime);
+  pose_bone_done_ex(data->depsgraph, data->object, pchan);
+}
+
+void BKE_pose_eval_bones_batch(struct Depsgraph *depsgraph,
+                               Scene *scene,
+                               Object *object,
+                               const int *pchan_indices,
+                               const int *level_offsets,
+                               const int levels_num)
+{
+  const bArmature *armature = (bArmature *)object->data;
+  if (armature->edbo != NULL) {
+    return;
+  }
+  DEG_debug_print_eval(depsgraph, __func__, object->id.name, object);
+  PoseBonesBatchData data = {
+      .depsgraph = depsgraph,
+      .scene = scene,
+      .object = object,
+      .pchan_indices = pchan_indices,
+      .ctime = BKE_scene_ctime_get(scene),
+  };
+  /* Bones of a level only depend on their parent in the previous level, so they are evaluated
+   * in parallel. Small levels are evaluated on the calling thread. */
+  for (int level = 0; level < levels_num; level++) {
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 32;
+    BLI_task_parallel_range(level_offsets[level],
+                            level_offsets[level + 1],
+                            &data,
+                            pose_eval_bones_batch_task,
+                            &settings);
+  }
+}
+
 void BKE_pose_eval_bbone_segments(struct Depsgraph *depsgraph,
                                   struct Object *object,
                                   int pchan_index)
@@ -1774,26 +1774,14 @@ static float fcurve_eval_keyframes_extrapolate(
   return endpoint_bezt->vec[1][1] - (fac * dx);
 }
 
-static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, float evaltime)
+/* Evaluate the segment of the curve found by a binary search for 'evaltime' among the keyframes,
+ * see #BKE_fcurve_eval_keyframes_segment. */
+static float fcurve_eval_keyframes_segment(
+    FCurve *fcu, BezTriple *bezts, float evaltime, unsigned int a, bool exact)
 {
   const float eps = 1.e-8f;
   BezTriple *bezt, *prevbezt;
-  unsigned int a;
-
-  /* Evaltime occurs somewhere in the middle of the curve. */
-  bool exact = false;
 
-  /* Use binary search to find appropriate keyframes...
-   *
-   * The threshold here has the following constraints:
-   * - 0.001 is too coarse:
-   *   We get artifacts with 2cm driver movements at 1BU = 1m (see T40332).
-   *
-   * - 0.00001 is too fine:
-   *   Weird errors, like selecting the wrong keyframe range (see T39207), occur.
-   *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
-   */
-  a = BKE_fcurve_bezt_binarysearch_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
   bezt = bezts + a;
 
   if (exact) {
@@ -2035,6 +2023,27 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
   return 0.0f;
 }
 
+static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, float evaltime)
+{
+  /* Evaltime occurs somewhere in the middle of the curve. */
+  bool exact = false;
+
+  /* Use binary search to find appropriate keyframes... */
+  const unsigned int a = BKE_fcurve_bezt_binarysearch_index_ex(
+      bezts, evaltime, fcu->totvert, BEZT_BINARYSEARCH_THRESH_EVAL, &exact);
+
+  return fcurve_eval_keyframes_segment(fcu, bezts, evaltime, a, exact);
+}
+
+float BKE_fcurve_eval_keyframes_segment(FCurve *fcu, float evaltime, int index, bool exact)
+{
+  BLI_assert(fcu->bezt != NULL);
+  BLI_assert(index >= 0 && index < fcu->totvert);
+  BLI_assert(fcu->bezt->vec[1][0] < evaltime && evaltime < fcu->bezt[fcu->totvert - 1].vec[1][0]);
+
+  return fcurve_eval_keyframes_segment(fcu, fcu->bezt, evaltime, (unsigned int)index, exact);
+}
+
 /* Calculate F-Curve value for 'evaltime' using #BezTriple keyframes. */
 static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime)
 {
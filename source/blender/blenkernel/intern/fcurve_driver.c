@@ -1212,6 +1212,33 @@ static void evaluate_driver_min_max(ChannelDriver *driver)
   driver->curval = value;
 }
 
+#ifdef WITH_PYTHON
+/* Report a driver which is evaluated with Python, such drivers are evaluated one at a time.
+ * Done when Python compiles the expression, so once for every driver and change of expression.
+ * Enabled with `--log "bke.fcurve" --log-level 1`. */
+static void driver_report_python_evaluation(PathResolvedRNA *anim_rna, ChannelDriver *driver_orig)
+{
+  if (!CLOG_CHECK(&LOG, 1)) {
+    return;
+  }
+  if (anim_rna == NULL) {
+    CLOG_INFO(&LOG, 1, "Driver evaluated with Python: '%s'", driver_orig->expression);
+    return;
+  }
+
+  const ID *id = anim_rna->ptr.owner_id;
+  char *path = RNA_path_from_ID_to_property(&anim_rna->ptr, anim_rna->prop);
+  CLOG_INFO(&LOG,
+            1,
+            "Driver of '%s' '%s[%d]' evaluated with Python: '%s'",
+            id ? id->name + 2 : "<No ID>",
+            path ? path : RNA_property_identifier(anim_rna->prop),
+            anim_rna->prop_index,
+            driver_orig->expression);
+  MEM_SAFE_FREE(path);
+}
+#endif /* WITH_PYTHON */
+
 static void evaluate_driver_python(PathResolvedRNA *anim_rna,
                                    ChannelDriver *driver,
                                    ChannelDriver *driver_orig,
@@ -1228,6 +1255,10 @@ static void evaluate_driver_python(PathResolvedRNA *anim_rna,
      * - on errors it reports, then returns 0.0f. */
     BLI_mutex_lock(&python_driver_lock);
 
+    if (driver_orig->expr_comp == NULL || (driver_orig->flag & DRIVER_FLAG_RECOMPILE)) {
+      driver_report_python_evaluation(anim_rna, driver_orig);
+    }
+
     driver->curval = BPY_driver_exec(anim_rna, driver, driver_orig, anim_eval_context);
 
     BLI_mutex_unlock(&python_driver_lock);
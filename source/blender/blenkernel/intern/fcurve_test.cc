@@ -196,6 +196,30 @@ TEST(evaluate_fcurve, ExtrapolationBezierKeys)
   BKE_fcurve_free(fcu);
 }
 
+TEST(evaluate_fcurve, KeyframesSegment)
+{
+  FCurve *fcu = BKE_fcurve_create();
+
+  insert_vert_fcurve(fcu, 1.0f, 7.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  insert_vert_fcurve(fcu, 2.0f, 13.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  insert_vert_fcurve(fcu, 4.0f, 2.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  fcu->bezt[1].ipo = BEZT_IPO_LIN;
+
+  /* Evaluating the segment found by the binary search gives the same value as evaluating the
+   * curve, also for times within the search threshold of a keyframe. */
+  const float time_epsilon = 0.00008f;
+  EXPECT_EQ(BKE_fcurve_eval_keyframes_segment(fcu, 1.5f, 1, false), evaluate_fcurve(fcu, 1.5f));
+  EXPECT_EQ(BKE_fcurve_eval_keyframes_segment(fcu, 2.0f - time_epsilon, 1, true),
+            evaluate_fcurve(fcu, 2.0f - time_epsilon));
+  EXPECT_EQ(BKE_fcurve_eval_keyframes_segment(fcu, 2.0f, 1, true), evaluate_fcurve(fcu, 2.0f));
+  EXPECT_EQ(BKE_fcurve_eval_keyframes_segment(fcu, 2.0f + time_epsilon, 1, true),
+            evaluate_fcurve(fcu, 2.0f + time_epsilon));
+  EXPECT_EQ(BKE_fcurve_eval_keyframes_segment(fcu, 3.0f, 2, false), evaluate_fcurve(fcu, 3.0f));
+  EXPECT_NEAR(BKE_fcurve_eval_keyframes_segment(fcu, 3.0f, 2, false), 7.5f, EPSILON);
+
+  BKE_fcurve_free(fcu);
+}
+
 TEST(fcurve_subdivide, BKE_fcurve_bezt_subdivide_handles)
 {
   FCurve *fcu = BKE_fcurve_create();
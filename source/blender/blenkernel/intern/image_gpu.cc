@@ -31,15 +31,25 @@
 
 #include "PIL_time.h"
 
+#include "image_gpu_staging.hh"
+
 using namespace blender::bke::image::partial_update;
+namespace gpu_staging = blender::bke::image::gpu_staging;
 
 extern "C" {
 
 /* Prototypes. */
 static void gpu_free_unused_buffers();
 static void image_free_gpu(Image *ima, const bool immediate);
-static void image_update_gputexture_ex(
-    Image *ima, ImageTile *tile, ImBuf *ibuf, int x, int y, int w, int h);
+static void image_update_gputexture_ex(Image *ima,
+                                       ImageTile *tile,
+                                       ImBuf *ibuf,
+                                       int x,
+                                       int y,
+                                       int w,
+                                       int h,
+                                       gpu_staging::StagingBuffer &staging);
+static void image_gpu_staging_upload(Image *ima, gpu_staging::StagingBuffer &staging);
 
 bool BKE_image_has_gpu_texture_premultiplied_alpha(Image *image, ImBuf *ibuf)
 {
@@ -290,6 +300,8 @@ static GPUTexture *image_gpu_texture_error_create(eGPUTextureTarget textarget)
 static void image_gpu_texture_partial_update_changes_available(
     Image *image, PartialUpdateChecker<ImageTileData>::CollectResult &changes)
 {
+  /* Changes of all tiles are converted on worker threads and uploaded together. */
+  gpu_staging::StagingBuffer staging;
   while (changes.get_next_change() == ePartialUpdateIterResult::ChangeAvailable) {
     /* Calculate the clipping region with the tile buffer.
      * TODO(jbakker): should become part of ImageTileData to deduplicate with image engine. */
@@ -309,8 +321,11 @@ static void image_gpu_texture_partial_update_changes_available(
                                clipped_update_region.xmin,
                                clipped_update_region.ymin,
                                BLI_rcti_size_x(&clipped_update_region),
-                               BLI_rcti_size_y(&clipped_update_region));
+                               BLI_rcti_size_y(&clipped_update_region),
+                               staging);
   }
+
+  image_gpu_staging_upload(image, staging);
 }
 
 static void image_gpu_texture_try_partial_update(Image *image, ImageUser *iuser)
@@ -667,38 +682,27 @@ static void gpu_texture_update_scaled(GPUTexture *tex,
   IMB_freeImBuf(ibuf);
 }
 
-static void gpu_texture_update_unscaled(GPUTexture *tex,
-                                        uchar *rect,
-                                        float *rect_float,
-                                        int x,
-                                        int y,
-                                        int layer,
-                                        const int tile_offset[2],
-                                        int w,
-                                        int h,
-                                        int tex_stride,
-                                        int tex_offset)
+static void gpu_texture_update_finish(GPUTexture *tex, Image *ima)
 {
-  if (layer > -1) {
-    /* Shift to account for tile packing. */
-    x += tile_offset[0];
-    y += tile_offset[1];
+  if (GPU_mipmap_enabled()) {
+    GPU_texture_generate_mipmap(tex);
+  }
+  else {
+    ima->gpuflag &= ~IMA_GPU_MIPMAP_COMPLETE;
   }
 
-  void *data = (rect_float) ? (void *)(rect_float + tex_offset) : (void *)(rect + tex_offset);
-  eGPUDataFormat data_format = (rect_float) ? GPU_DATA_FLOAT : GPU_DATA_UBYTE;
-
-  /* Partial update without scaling. Stride and offset are used to copy only a
-   * subset of a possible larger buffer than what we are updating. */
-  GPU_unpack_row_length_set(tex_stride);
-
-  GPU_texture_update_sub(tex, data_format, data, x, y, layer, w, h, 1);
-  /* Restore default. */
-  GPU_unpack_row_length_set(0);
+  GPU_texture_unbind(tex);
 }
 
-static void gpu_texture_update_from_ibuf(
-    GPUTexture *tex, Image *ima, ImBuf *ibuf, ImageTile *tile, int x, int y, int w, int h)
+static void gpu_texture_update_from_ibuf(GPUTexture *tex,
+                                         Image *ima,
+                                         ImBuf *ibuf,
+                                         ImageTile *tile,
+                                         int x,
+                                         int y,
+                                         int w,
+                                         int h,
+                                         gpu_staging::StagingBuffer &staging)
 {
   bool scaled;
   if (tile != nullptr) {
@@ -710,45 +714,63 @@ static void gpu_texture_update_from_ibuf(
     scaled = (GPU_texture_width(tex) != ibuf->x) || (GPU_texture_height(tex) != ibuf->y);
   }
 
-  if (scaled) {
-    /* Extra padding to account for bleed from neighboring pixels. */
-    const int padding = 4;
-    const int xmax = min_ii(x + w + padding, ibuf->x);
-    const int ymax = min_ii(y + h + padding, ibuf->y);
-    x = max_ii(x - padding, 0);
-    y = max_ii(y - padding, 0);
-    w = xmax - x;
-    h = ymax - y;
+  const bool store_premultiplied = BKE_image_has_gpu_texture_premultiplied_alpha(ima, ibuf);
+
+  if (!scaled) {
+    /* Fast update at same resolution, converted and uploaded together with the other changes. */
+    gpu_staging::StagingTarget target;
+    target.texture = tex;
+    if (tile != nullptr) {
+      /* Shift to account for tile packing. */
+      target.layer = tile->runtime.tilearray_layer;
+      target.offset = blender::int2(tile->runtime.tilearray_offset);
+    }
+    rcti region;
+    BLI_rcti_init(&region, x, x + w, y, y + h);
+    staging.add_region(target, ibuf, region, store_premultiplied);
+    return;
   }
 
+  /* Extra padding to account for bleed from neighboring pixels. */
+  const int padding = 4;
+  const int xmax = min_ii(x + w + padding, ibuf->x);
+  const int ymax = min_ii(y + h + padding, ibuf->y);
+  x = max_ii(x - padding, 0);
+  y = max_ii(y - padding, 0);
+  w = xmax - x;
+  h = ymax - y;
+
   /* Get texture data pointers. */
   float *rect_float = ibuf->rect_float;
   uchar *rect = (uchar *)ibuf->rect;
-  int tex_stride = ibuf->x;
-  int tex_offset = ibuf->channels * (y * ibuf->x + x);
 
-  const bool store_premultiplied = BKE_image_has_gpu_texture_premultiplied_alpha(ima, ibuf);
   if (rect_float) {
     /* Float image is already in scene linear colorspace or non-color data by
      * convention, no colorspace conversion needed. But we do require 4 channels
      * currently. */
-    if (ibuf->channels != 4 || scaled || !store_premultiplied) {
-      rect_float = (float *)MEM_mallocN(sizeof(float[4]) * w * h, __func__);
-      if (rect_float == nullptr) {
-        return;
-      }
-
-      tex_stride = w;
-      tex_offset = 0;
-
-      IMB_colormanagement_imbuf_to_float_texture(
-          rect_float, x, y, w, h, ibuf, store_premultiplied);
+    rect_float = (float *)MEM_mallocN(sizeof(float[4]) * w * h, __func__);
+    if (rect_float == nullptr) {
+      return;
     }
+
+    IMB_colormanagement_imbuf_to_float_texture(rect_float, x, y, w, h, ibuf, store_premultiplied);
   }
   else {
     /* Byte image is in original colorspace from the file, and may need conversion. */
     if (IMB_colormanagement_space_is_data(ibuf->rect_colorspace)) {
-      /* Non-color data, just store buffer as is. */
+      /* Non-color data, store as is. Scaling expects the pixels of the region to be tightly
+       * packed, so they are copied out of the image rows. */
+      rect = (uchar *)MEM_mallocN(sizeof(uchar[4]) * w * h, __func__);
+      if (rect == nullptr) {
+        return;
+      }
+
+      const uchar *src_rect = (const uchar *)ibuf->rect;
+      for (int i = 0; i < h; i++) {
+        memcpy(rect + sizeof(uchar[4]) * i * w,
+               src_rect + sizeof(uchar[4]) * ((size_t)(y + i) * ibuf->x + x),
+               sizeof(uchar[4]) * w);
+      }
     }
     else if (IMB_colormanagement_space_is_srgb(ibuf->rect_colorspace) ||
              IMB_colormanagement_space_is_scene_linear(ibuf->rect_colorspace)) {
@@ -758,9 +780,6 @@ static void gpu_texture_update_from_ibuf(
         return;
       }
 
-      tex_stride = w;
-      tex_offset = 0;
-
       /* Convert to scene linear with sRGB compression, and premultiplied for
        * correct texture interpolation. */
       IMB_colormanagement_imbuf_to_byte_texture(rect, x, y, w, h, ibuf, store_premultiplied);
@@ -772,79 +791,81 @@ static void gpu_texture_update_from_ibuf(
         return;
       }
 
-      tex_stride = w;
-      tex_offset = 0;
-
       IMB_colormanagement_imbuf_to_float_texture(
           rect_float, x, y, w, h, ibuf, store_premultiplied);
     }
   }
 
-  if (scaled) {
-    /* Slower update where we first have to scale the input pixels. */
-    if (tile != nullptr) {
-      ImageTile_Runtime *tile_runtime = &tile->runtime;
-      int *tileoffset = tile_runtime->tilearray_offset;
-      int *tilesize = tile_runtime->tilearray_size;
-      int tilelayer = tile_runtime->tilearray_layer;
-      gpu_texture_update_scaled(
-          tex, rect, rect_float, ibuf->x, ibuf->y, x, y, tilelayer, tileoffset, tilesize, w, h);
-    }
-    else {
-      gpu_texture_update_scaled(
-          tex, rect, rect_float, ibuf->x, ibuf->y, x, y, -1, nullptr, nullptr, w, h);
-    }
+  /* Slower update where we first have to scale the input pixels. */
+  if (tile != nullptr) {
+    ImageTile_Runtime *tile_runtime = &tile->runtime;
+    int *tileoffset = tile_runtime->tilearray_offset;
+    int *tilesize = tile_runtime->tilearray_size;
+    int tilelayer = tile_runtime->tilearray_layer;
+    gpu_texture_update_scaled(
+        tex, rect, rect_float, ibuf->x, ibuf->y, x, y, tilelayer, tileoffset, tilesize, w, h);
   }
   else {
-    /* Fast update at same resolution. */
-    if (tile != nullptr) {
-      ImageTile_Runtime *tile_runtime = &tile->runtime;
-      int *tileoffset = tile_runtime->tilearray_offset;
-      int tilelayer = tile_runtime->tilearray_layer;
-      gpu_texture_update_unscaled(
-          tex, rect, rect_float, x, y, tilelayer, tileoffset, w, h, tex_stride, tex_offset);
-    }
-    else {
-      gpu_texture_update_unscaled(
-          tex, rect, rect_float, x, y, -1, nullptr, w, h, tex_stride, tex_offset);
-    }
+    gpu_texture_update_scaled(
+        tex, rect, rect_float, ibuf->x, ibuf->y, x, y, -1, nullptr, nullptr, w, h);
   }
 
   /* Free buffers if needed. */
-  if (rect && rect != (uchar *)ibuf->rect) {
-    MEM_freeN(rect);
-  }
   if (rect_float && rect_float != ibuf->rect_float) {
     MEM_freeN(rect_float);
   }
-
-  if (GPU_mipmap_enabled()) {
-    GPU_texture_generate_mipmap(tex);
-  }
-  else {
-    ima->gpuflag &= ~IMA_GPU_MIPMAP_COMPLETE;
+  else if (rect && rect != (uchar *)ibuf->rect) {
+    MEM_freeN(rect);
   }
 
-  GPU_texture_unbind(tex);
+  gpu_texture_update_finish(tex, ima);
 }
 
-static void image_update_gputexture_ex(
-    Image *ima, ImageTile *tile, ImBuf *ibuf, int x, int y, int w, int h)
+static void image_update_gputexture_ex(Image *ima,
+                                       ImageTile *tile,
+                                       ImBuf *ibuf,
+                                       int x,
+                                       int y,
+                                       int w,
+                                       int h,
+                                       gpu_staging::StagingBuffer &staging)
 {
   const int eye = 0;
   GPUTexture *tex = ima->gputexture[TEXTARGET_2D][eye];
   /* Check if we need to update the main gputexture. */
   if (tex != nullptr && tile == ima->tiles.first) {
-    gpu_texture_update_from_ibuf(tex, ima, ibuf, nullptr, x, y, w, h);
+    gpu_texture_update_from_ibuf(tex, ima, ibuf, nullptr, x, y, w, h, staging);
   }
 
   /* Check if we need to update the array gputexture. */
   tex = ima->gputexture[TEXTARGET_2D_ARRAY][eye];
   if (tex != nullptr) {
-    gpu_texture_update_from_ibuf(tex, ima, ibuf, tile, x, y, w, h);
+    gpu_texture_update_from_ibuf(tex, ima, ibuf, tile, x, y, w, h, staging);
   }
 }
 
+/* Upload the staged changes, and update the mipmaps of the textures they were uploaded to. */
+static void image_gpu_staging_upload(Image *ima, gpu_staging::StagingBuffer &staging)
+{
+  if (staging.is_empty()) {
+    return;
+  }
+
+  staging.merge_regions();
+  staging.pack();
+  staging.upload();
+
+  blender::Vector<GPUTexture *, 2> textures;
+  for (const gpu_staging::StagedRegion &region : staging.regions()) {
+    textures.append_non_duplicates(region.target.texture);
+  }
+  for (GPUTexture *tex : textures) {
+    gpu_texture_update_finish(tex, ima);
+  }
+
+  staging.clear();
+}
+
 void BKE_image_update_gputexture(Image *ima, ImageUser *iuser, int x, int y, int w, int h)
 {
   ImageTile *image_tile = BKE_image_get_tile_from_iuser(ima, iuser);
@@ -0,0 +1,260 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <algorithm>
+
+#include "BLI_task.hh"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "GPU_texture.h"
+
+#include "image_gpu_staging.hh"
+
+namespace blender::bke::image::gpu_staging {
+
+/** Number of pixels converted by a single task when packing. */
+constexpr int64_t PACK_GRAIN_PIXELS = 64 * 1024;
+
+StagingBuffer::~StagingBuffer()
+{
+  clear();
+}
+
+/* Matches the texture formats chosen by #IMB_touch_gpu_texture. */
+static void staged_region_format_init(StagedRegion &staged)
+{
+  const ImBuf *ibuf = staged.ibuf;
+  if (ibuf->rect_float) {
+    /* Float image is already in scene linear colorspace or non-color data by convention, no
+     * colorspace conversion needed. But we do require 4 channels currently. */
+    staged.format = eStagingDataFormat::Float;
+    staged.use_ibuf_pixels = ibuf->channels == 4 && staged.store_premultiplied;
+  }
+  else if (IMB_colormanagement_space_is_data(ibuf->rect_colorspace)) {
+    /* Non-color data, just store buffer as is. */
+    staged.format = eStagingDataFormat::Byte;
+    staged.use_ibuf_pixels = true;
+  }
+  else if (IMB_colormanagement_space_is_srgb(ibuf->rect_colorspace) ||
+           IMB_colormanagement_space_is_scene_linear(ibuf->rect_colorspace)) {
+    /* sRGB or scene linear, store as byte texture that the GPU can decode directly. */
+    staged.format = eStagingDataFormat::Byte;
+    staged.use_ibuf_pixels = false;
+  }
+  else {
+    /* Other colorspace, store as float texture to avoid precision loss. */
+    staged.format = eStagingDataFormat::Float;
+    staged.use_ibuf_pixels = false;
+  }
+}
+
+void StagingBuffer::add_region(const StagingTarget &target,
+                               ImBuf *ibuf,
+                               const rcti &region,
+                               const bool store_premultiplied)
+{
+  BLI_assert(region.xmin >= 0 && region.ymin >= 0);
+  BLI_assert(region.xmax <= ibuf->x && region.ymax <= ibuf->y);
+  if (BLI_rcti_is_empty(&region)) {
+    return;
+  }
+
+  StagedRegion staged;
+  staged.target = target;
+  staged.ibuf = ibuf;
+  staged.store_premultiplied = store_premultiplied;
+  staged.region = region;
+  staged.buffer_offset = 0;
+  staged_region_format_init(staged);
+
+  IMB_refImBuf(ibuf);
+  regions_.append(staged);
+  is_packed_ = false;
+}
+
+static bool staged_regions_can_merge(const StagedRegion &a, const StagedRegion &b)
+{
+  return a.ibuf == b.ibuf && a.target.texture == b.target.texture &&
+         a.target.layer == b.target.layer && a.target.offset == b.target.offset &&
+         a.store_premultiplied == b.store_premultiplied;
+}
+
+static int64_t rcti_area(const rcti &rect)
+{
+  return int64_t(BLI_rcti_size_x(&rect)) * BLI_rcti_size_y(&rect);
+}
+
+void StagingBuffer::merge_regions()
+{
+  Vector<StagedRegion> merged;
+  Vector<bool> is_merged(regions_.size(), false);
+
+  for (const int64_t i : regions_.index_range()) {
+    if (is_merged[i]) {
+      continue;
+    }
+    StagedRegion group = regions_[i];
+    int64_t group_area = rcti_area(group.region);
+
+    for (const int64_t j : regions_.index_range().drop_front(i + 1)) {
+      const StagedRegion &other = regions_[j];
+      if (is_merged[j] || !staged_regions_can_merge(group, other)) {
+        continue;
+      }
+      rcti bounds = group.region;
+      BLI_rcti_union(&bounds, &other.region);
+      if (rcti_area(bounds) > 2 * (group_area + rcti_area(other.region))) {
+        continue;
+      }
+      group.region = bounds;
+      group_area += rcti_area(other.region);
+      is_merged[j] = true;
+      /* The merged region holds a single user of the image buffer. */
+      IMB_freeImBuf(other.ibuf);
+    }
+    merged.append(group);
+  }
+
+  regions_ = std::move(merged);
+  is_packed_ = false;
+}
+
+static void staged_region_pack_rows(const StagedRegion &staged,
+                                    void *buffer,
+                                    const int ymin,
+                                    const int ymax)
+{
+  const int width = BLI_rcti_size_x(&staged.region);
+  const int64_t row_offset = int64_t(ymin - staged.region.ymin) * width * 4;
+
+  if (staged.format == eStagingDataFormat::Byte) {
+    uchar *rect = static_cast<uchar *>(buffer) + staged.buffer_offset + row_offset;
+    IMB_colormanagement_imbuf_to_byte_texture(rect,
+                                              staged.region.xmin,
+                                              ymin,
+                                              width,
+                                              ymax - ymin,
+                                              staged.ibuf,
+                                              staged.store_premultiplied);
+  }
+  else {
+    float *rect = static_cast<float *>(buffer) + staged.buffer_offset + row_offset;
+    IMB_colormanagement_imbuf_to_float_texture(rect,
+                                               staged.region.xmin,
+                                               ymin,
+                                               width,
+                                               ymax - ymin,
+                                               staged.ibuf,
+                                               staged.store_premultiplied);
+  }
+}
+
+void StagingBuffer::pack()
+{
+  if (is_packed_) {
+    return;
+  }
+
+  /* Lay out the regions in the staging buffers. */
+  int64_t byte_size = 0;
+  int64_t float_size = 0;
+  for (StagedRegion &staged : regions_) {
+    if (staged.use_ibuf_pixels) {
+      continue;
+    }
+    const int64_t size = rcti_area(staged.region) * 4;
+    int64_t &buffer_size = (staged.format == eStagingDataFormat::Byte) ? byte_size : float_size;
+    staged.buffer_offset = buffer_size;
+    buffer_size += size;
+  }
+  byte_buffer_.resize(byte_size);
+  float_buffer_.resize(float_size);
+
+  /* Convert the regions, split into bands of rows. */
+  threading::parallel_for(regions_.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const StagedRegion &staged = regions_[i];
+      if (staged.use_ibuf_pixels) {
+        continue;
+      }
+      void *buffer = (staged.format == eStagingDataFormat::Byte) ?
+                         static_cast<void *>(byte_buffer_.data()) :
+                         static_cast<void *>(float_buffer_.data());
+      const int width = BLI_rcti_size_x(&staged.region);
+      const int64_t grain = std::max<int64_t>(1, PACK_GRAIN_PIXELS / width);
+      const IndexRange rows(staged.region.ymin, BLI_rcti_size_y(&staged.region));
+      threading::parallel_for(rows, grain, [&](const IndexRange band) {
+        staged_region_pack_rows(staged, buffer, band.first(), band.one_after_last());
+      });
+    }
+  });
+
+  is_packed_ = true;
+}
+
+const void *StagingBuffer::region_data(const StagedRegion &region) const
+{
+  BLI_assert(is_packed_);
+  if (region.use_ibuf_pixels) {
+    const ImBuf *ibuf = region.ibuf;
+    const int64_t offset = (int64_t(region.region.ymin) * ibuf->x + region.region.xmin) *
+                           ibuf->channels;
+    return (region.format == eStagingDataFormat::Float) ?
+               static_cast<const void *>(ibuf->rect_float + offset) :
+               static_cast<const void *>(reinterpret_cast<const uchar *>(ibuf->rect) + offset);
+  }
+  return (region.format == eStagingDataFormat::Float) ?
+             static_cast<const void *>(float_buffer_.data() + region.buffer_offset) :
+             static_cast<const void *>(byte_buffer_.data() + region.buffer_offset);
+}
+
+int StagingBuffer::region_row_length(const StagedRegion &region) const
+{
+  return region.use_ibuf_pixels ? region.ibuf->x : BLI_rcti_size_x(&region.region);
+}
+
+void StagingBuffer::upload() const
+{
+  BLI_assert(is_packed_);
+  for (const StagedRegion &staged : regions_) {
+    if (staged.target.texture == nullptr) {
+      continue;
+    }
+    const eGPUDataFormat data_format = (staged.format == eStagingDataFormat::Float) ?
+                                           GPU_DATA_FLOAT :
+                                           GPU_DATA_UBYTE;
+    /* Stride is used to copy only a subset of a possible larger buffer. */
+    GPU_unpack_row_length_set(region_row_length(staged));
+    GPU_texture_update_sub(staged.target.texture,
+                           data_format,
+                           region_data(staged),
+                           staged.region.xmin + staged.target.offset.x,
+                           staged.region.ymin + staged.target.offset.y,
+                           staged.target.layer,
+                           BLI_rcti_size_x(&staged.region),
+                           BLI_rcti_size_y(&staged.region),
+                           1);
+  }
+  /* Restore default. */
+  GPU_unpack_row_length_set(0);
+}
+
+void StagingBuffer::clear()
+{
+  for (const StagedRegion &staged : regions_) {
+    IMB_freeImBuf(staged.ibuf);
+  }
+  regions_.clear();
+  byte_buffer_.clear();
+  float_buffer_.clear();
+  is_packed_ = false;
+}
+
+}  // namespace blender::bke::image::gpu_staging
@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+/** \file
+ * \ingroup bke
+ *
+ * CPU side staging of partial image texture updates.
+ *
+ * Regions of image buffers that changed are collected first. Packing converts them to the
+ * color-space and layout of the GPU texture on worker threads, after which all regions are
+ * uploaded at once. Regions of the same texture are merged to their bounds when that doesn't
+ * upload much more pixels, so a paint stroke results in a single upload per texture and redraw.
+ */
+
+#pragma once
+
+#include "BLI_math_vec_types.hh"
+#include "BLI_rect.h"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+struct GPUTexture;
+struct ImBuf;
+
+namespace blender::bke::image::gpu_staging {
+
+/** Destination of a staged region. */
+struct StagingTarget {
+  GPUTexture *texture = nullptr;
+  /** Layer of array textures, -1 for 2D textures. */
+  int layer = -1;
+  /** Position of the image buffer inside the texture, for tiles packed in array textures. */
+  int2 offset = int2(0, 0);
+};
+
+enum class eStagingDataFormat {
+  /** 4 channel bytes, sRGB or linear depending on the texture format. */
+  Byte,
+  /** 4 channel floats in scene linear. */
+  Float,
+};
+
+struct StagedRegion {
+  StagingTarget target;
+  ImBuf *ibuf;
+  bool store_premultiplied;
+  /** Pixels of `ibuf` to upload. */
+  rcti region;
+
+  eStagingDataFormat format;
+  /** Upload directly from the pixels of `ibuf`, no conversion is needed. */
+  bool use_ibuf_pixels;
+  /** Offset in elements of the packed pixels in the staging buffer of the format. */
+  int64_t buffer_offset;
+};
+
+class StagingBuffer {
+ private:
+  Vector<StagedRegion> regions_;
+  Vector<uchar> byte_buffer_;
+  Vector<float> float_buffer_;
+  bool is_packed_ = false;
+
+ public:
+  StagingBuffer() = default;
+  StagingBuffer(const StagingBuffer &other) = delete;
+  StagingBuffer &operator=(const StagingBuffer &other) = delete;
+  ~StagingBuffer();
+
+  /**
+   * Add a region of an image buffer to update. The region must lie inside the buffer. A user of
+   * the buffer is added until the staging buffer is cleared.
+   */
+  void add_region(const StagingTarget &target,
+                  ImBuf *ibuf,
+                  const rcti &region,
+                  bool store_premultiplied);
+
+  /**
+   * Merge the regions of each target and image buffer into their bounds, when the bounds don't
+   * cover more than twice the pixels of the regions.
+   */
+  void merge_regions();
+
+  /** Convert and pack the pixels of all regions, using worker threads. */
+  void pack();
+
+  /** Upload all packed regions. Must be called from the thread owning the GPU context. */
+  void upload() const;
+
+  /** Remove all regions, releasing the image buffers. */
+  void clear();
+
+  bool is_empty() const
+  {
+    return regions_.is_empty();
+  }
+
+  Span<StagedRegion> regions() const
+  {
+    return regions_;
+  }
+
+  /** Pointer to the first pixel of a packed region. */
+  const void *region_data(const StagedRegion &region) const;
+  /** Number of pixels between rows of the pixel data of a packed region. */
+  int region_row_length(const StagedRegion &region) const;
+};
+
+}  // namespace blender::bke::image::gpu_staging
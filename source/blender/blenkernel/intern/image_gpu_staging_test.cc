@@ -0,0 +1,191 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+#include "testing/testing.h"
+
+#include "BKE_appdir.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "image_gpu_staging.hh"
+
+#if 0
+#  include "BLI_timeit.hh"
+#endif
+
+namespace blender::bke::image::gpu_staging::tests {
+
+class ImageGPUStagingTest : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    BKE_appdir_init();
+    IMB_init();
+  }
+
+  void TearDown() override
+  {
+    IMB_exit();
+    BKE_appdir_exit();
+  }
+};
+
+static ImBuf *create_byte_ibuf(int width, int height)
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rect);
+  uchar *rect = reinterpret_cast<uchar *>(ibuf->rect);
+  for (int64_t i = 0; i < int64_t(width) * height; i++) {
+    rect[i * 4 + 0] = uchar(i % 256);
+    rect[i * 4 + 1] = 200;
+    rect[i * 4 + 2] = 100;
+    rect[i * 4 + 3] = 128;
+  }
+  return ibuf;
+}
+
+static ImBuf *create_float_ibuf(int width, int height)
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rectfloat);
+  for (int64_t i = 0; i < int64_t(width) * height * 4; i++) {
+    ibuf->rect_float[i] = float(i % 7) / 7.0f;
+  }
+  return ibuf;
+}
+
+static StagingTarget test_target()
+{
+  /* Regions are never uploaded in these tests, the texture is only used to identify targets. */
+  StagingTarget target;
+  target.texture = reinterpret_cast<GPUTexture *>(uintptr_t(1));
+  return target;
+}
+
+TEST_F(ImageGPUStagingTest, pack_byte_premultiplied)
+{
+  ImBuf *ibuf = create_byte_ibuf(64, 64);
+  rcti region;
+  BLI_rcti_init(&region, 8, 24, 4, 36);
+
+  StagingBuffer staging;
+  staging.add_region(test_target(), ibuf, region, true);
+  staging.pack();
+
+  ASSERT_EQ(staging.regions().size(), 1);
+  const StagedRegion &staged = staging.regions()[0];
+  EXPECT_EQ(staged.format, eStagingDataFormat::Byte);
+  EXPECT_FALSE(staged.use_ibuf_pixels);
+  EXPECT_EQ(staging.region_row_length(staged), 16);
+
+  const uchar *packed = static_cast<const uchar *>(staging.region_data(staged));
+  const uchar *rect = reinterpret_cast<const uchar *>(ibuf->rect);
+  for (int y = region.ymin; y < region.ymax; y++) {
+    for (int x = region.xmin; x < region.xmax; x++) {
+      const uchar *in = rect + (y * ibuf->x + x) * 4;
+      const uchar *out = packed + ((y - region.ymin) * 16 + (x - region.xmin)) * 4;
+      EXPECT_EQ(out[0], (in[0] * in[3]) >> 8);
+      EXPECT_EQ(out[1], (in[1] * in[3]) >> 8);
+      EXPECT_EQ(out[2], (in[2] * in[3]) >> 8);
+      EXPECT_EQ(out[3], in[3]);
+    }
+  }
+
+  staging.clear();
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImageGPUStagingTest, pack_float_uses_ibuf_pixels)
+{
+  ImBuf *ibuf = create_float_ibuf(32, 32);
+  rcti region;
+  BLI_rcti_init(&region, 4, 12, 10, 20);
+
+  StagingBuffer staging;
+  staging.add_region(test_target(), ibuf, region, true);
+  staging.pack();
+
+  const StagedRegion &staged = staging.regions()[0];
+  EXPECT_EQ(staged.format, eStagingDataFormat::Float);
+  EXPECT_TRUE(staged.use_ibuf_pixels);
+  EXPECT_EQ(staging.region_row_length(staged), 32);
+  EXPECT_EQ(staging.region_data(staged), ibuf->rect_float + (10 * 32 + 4) * 4);
+
+  staging.clear();
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImageGPUStagingTest, merge_regions)
+{
+  ImBuf *ibuf = create_byte_ibuf(256, 256);
+  rcti region_a;
+  rcti region_b;
+  rcti region_far;
+  BLI_rcti_init(&region_a, 0, 16, 0, 16);
+  BLI_rcti_init(&region_b, 16, 32, 0, 16);
+  BLI_rcti_init(&region_far, 200, 216, 200, 216);
+
+  StagingBuffer staging;
+  staging.add_region(test_target(), ibuf, region_a, true);
+  staging.add_region(test_target(), ibuf, region_b, true);
+  staging.add_region(test_target(), ibuf, region_far, true);
+  EXPECT_EQ(ibuf->refcounter, 3);
+
+  staging.merge_regions();
+  ASSERT_EQ(staging.regions().size(), 2);
+  rcti expected_bounds;
+  BLI_rcti_init(&expected_bounds, 0, 32, 0, 16);
+  EXPECT_TRUE(BLI_rcti_compare(&staging.regions()[0].region, &expected_bounds));
+  EXPECT_TRUE(BLI_rcti_compare(&staging.regions()[1].region, &region_far));
+  EXPECT_EQ(ibuf->refcounter, 2);
+
+  staging.clear();
+  EXPECT_TRUE(staging.is_empty());
+  EXPECT_EQ(ibuf->refcounter, 0);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImageGPUStagingTest, merge_regions_different_targets)
+{
+  ImBuf *ibuf = create_byte_ibuf(64, 64);
+  rcti region;
+  BLI_rcti_init(&region, 0, 16, 0, 16);
+
+  StagingTarget layer_target = test_target();
+  layer_target.layer = 1;
+
+  StagingBuffer staging;
+  staging.add_region(test_target(), ibuf, region, true);
+  staging.add_region(layer_target, ibuf, region, true);
+  staging.merge_regions();
+  EXPECT_EQ(staging.regions().size(), 2);
+
+  staging.clear();
+  IMB_freeImBuf(ibuf);
+}
+
+#if 0
+/* Packing of a large image that is painted on in many places, as done on every redraw. */
+TEST_F(ImageGPUStagingTest, pack_performance)
+{
+  const int size = 8192;
+  const int tile_size = 256;
+  ImBuf *ibuf = create_byte_ibuf(size, size);
+
+  for (int iteration = 0; iteration < 5; iteration++) {
+    StagingBuffer staging;
+    for (int y = 0; y < size; y += tile_size * 2) {
+      for (int x = 0; x < size; x += tile_size * 2) {
+        rcti region;
+        BLI_rcti_init(&region, x, x + tile_size, y, y + tile_size);
+        staging.add_region(test_target(), ibuf, region, true);
+      }
+    }
+    SCOPED_TIMER("pack");
+    staging.merge_regions();
+    staging.pack();
+  }
+
+  IMB_freeImBuf(ibuf);
+}
+#endif
+
+}  // namespace blender::bke::image::gpu_staging::tests
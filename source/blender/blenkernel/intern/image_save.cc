@@ -865,7 +865,13 @@ bool BKE_image_render_write_exr(ReportList *reports,
   bool success = IMB_exr_begin_write(
       exrhandle, filepath, rr->rectx, rr->recty, compress, rr->stamp_data);
   if (success) {
-    IMB_exr_write_channels(exrhandle);
+    /* Write in blocks of scan-lines, so half float passes are converted one block at a time
+     * instead of needing a copy of all passes at once. Blocks are large enough for OpenEXR to
+     * compress many line blocks of each in parallel. */
+    const int rows_per_block = 256;
+    for (int rows_done = 0; rows_done < rr->recty; rows_done += rows_per_block) {
+      IMB_exr_write_channels_rows(exrhandle, rows_per_block);
+    }
   }
   else {
     /* TODO: get the error from openexr's exception. */
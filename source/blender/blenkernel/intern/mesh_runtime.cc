@@ -13,6 +13,7 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_hash_mm2a.h"
 #include "BLI_math_geom.h"
 #include "BLI_task.hh"
 
@@ -90,6 +91,7 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   runtime->bvh_cache = nullptr;
   runtime->shrinkwrap_data = nullptr;
   runtime->subsurf_face_dot_tags = nullptr;
+  runtime->topology_hash = 0;
 
   runtime->vert_normals_dirty = true;
   runtime->poly_normals_dirty = true;
@@ -260,6 +262,7 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
   BKE_shrinkwrap_discard_boundary_data(mesh);
 
   MEM_SAFE_FREE(mesh->runtime.subsurf_face_dot_tags);
+  mesh->runtime.topology_hash = 0;
 }
 
 void BKE_mesh_tag_coords_changed(Mesh *mesh)
@@ -289,6 +292,57 @@ void BKE_mesh_tag_coords_changed_uniformly(Mesh *mesh)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Mesh Topology Hash
+ * \{ */
+
+template<typename T> static uint32_t mesh_topology_hash_span(const blender::Span<T> span)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  BLI_hash_mm2a_add(&mm2, (const uchar *)span.data(), size_t(span.size_in_bytes()));
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+void BKE_mesh_runtime_topology_hash_ensure(Mesh *mesh)
+{
+  if (mesh->runtime.topology_hash != 0) {
+    return;
+  }
+
+  /* Polygons are hashed by their offsets only, their flags and material indices are not part of
+   * the topology. */
+  uint32_t edges_hash, loops_hash, polys_hash;
+  blender::threading::parallel_invoke(
+      [&]() { edges_hash = mesh_topology_hash_span(mesh->edges()); },
+      [&]() { loops_hash = mesh_topology_hash_span(mesh->loops()); },
+      [&]() {
+        BLI_HashMurmur2A mm2;
+        BLI_hash_mm2a_init(&mm2, 0);
+        for (const MPoly &poly : mesh->polys()) {
+          BLI_hash_mm2a_add_int(&mm2, poly.loopstart);
+          BLI_hash_mm2a_add_int(&mm2, poly.totloop);
+        }
+        polys_hash = BLI_hash_mm2a_end(&mm2);
+      });
+
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totvert);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totedge);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totpoly);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totloop);
+  BLI_hash_mm2a_add_int(&mm2, int(edges_hash));
+  BLI_hash_mm2a_add_int(&mm2, int(loops_hash));
+  BLI_hash_mm2a_add_int(&mm2, int(polys_hash));
+  const uint32_t hash = BLI_hash_mm2a_end(&mm2);
+
+  /* Zero is reserved for meshes whose hash is not computed. */
+  mesh->runtime.topology_hash = (hash != 0) ? hash : 1;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Mesh Batch Cache Callbacks
  * \{ */
@@ -296,6 +350,7 @@ void BKE_mesh_tag_coords_changed_uniformly(Mesh *mesh)
 /* Draw Engine */
 void (*BKE_mesh_batch_cache_dirty_tag_cb)(Mesh *me, eMeshBatchDirtyMode mode) = nullptr;
 void (*BKE_mesh_batch_cache_free_cb)(Mesh *me) = nullptr;
+void (*BKE_mesh_batch_cache_free_data_cb)(void *batch_cache) = nullptr;
 
 void BKE_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
 {
@@ -310,6 +365,26 @@ void BKE_mesh_batch_cache_free(Mesh *me)
   }
 }
 
+void *BKE_mesh_batch_cache_take(Mesh *me)
+{
+  void *batch_cache = me->runtime.batch_cache;
+  me->runtime.batch_cache = nullptr;
+  return batch_cache;
+}
+
+void BKE_mesh_batch_cache_reuse_deformed(Mesh *me, void *batch_cache)
+{
+  if (batch_cache == nullptr) {
+    return;
+  }
+  if (me->runtime.batch_cache == nullptr && me->runtime.topology_hash != 0) {
+    me->runtime.batch_cache = batch_cache;
+    BKE_mesh_batch_cache_dirty_tag(me, BKE_MESH_BATCH_DIRTY_DEFORM);
+    return;
+  }
+  BKE_mesh_batch_cache_free_data_cb(batch_cache);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -0,0 +1,137 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+#include "testing/testing.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+class MeshTopologyHashTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+ protected:
+  Mesh *mesh = nullptr;
+
+  /* Two quads sharing an edge. */
+  void SetUp() override
+  {
+    mesh = BKE_mesh_new_nomain(6, 7, 0, 8, 2);
+    MutableSpan<MVert> verts = mesh->verts_for_write();
+    for (const int i : verts.index_range()) {
+      verts[i].co[0] = float(i % 3);
+      verts[i].co[1] = float(i / 3);
+    }
+    const int edge_verts[7][2] = {{0, 1}, {1, 2}, {3, 4}, {4, 5}, {0, 3}, {1, 4}, {2, 5}};
+    MutableSpan<MEdge> edges = mesh->edges_for_write();
+    for (const int i : edges.index_range()) {
+      edges[i].v1 = edge_verts[i][0];
+      edges[i].v2 = edge_verts[i][1];
+    }
+    const int loop_verts[8] = {0, 1, 4, 3, 1, 2, 5, 4};
+    const int loop_edges[8] = {0, 5, 2, 4, 1, 6, 3, 5};
+    MutableSpan<MLoop> loops = mesh->loops_for_write();
+    for (const int i : loops.index_range()) {
+      loops[i].v = loop_verts[i];
+      loops[i].e = loop_edges[i];
+    }
+    MutableSpan<MPoly> polys = mesh->polys_for_write();
+    for (const int i : polys.index_range()) {
+      polys[i].loopstart = i * 4;
+      polys[i].totloop = 4;
+    }
+    BKE_mesh_runtime_topology_hash_ensure(mesh);
+  }
+
+  void TearDown() override
+  {
+    BKE_id_free(nullptr, mesh);
+  }
+
+  /* Hash of a copy of the mesh, edited by the given function. */
+  template<typename Func> uint32_t topology_hash_after(const Func &edit)
+  {
+    Mesh *mesh_copy = BKE_mesh_copy_for_eval(mesh, false);
+    EXPECT_EQ(mesh_copy->runtime.topology_hash, 0);
+    edit(mesh_copy);
+    BKE_mesh_runtime_topology_hash_ensure(mesh_copy);
+    const uint32_t hash = mesh_copy->runtime.topology_hash;
+    BKE_id_free(nullptr, mesh_copy);
+    return hash;
+  }
+};
+
+TEST_F(MeshTopologyHashTest, deform)
+{
+  const uint32_t hash = mesh->runtime.topology_hash;
+  EXPECT_NE(hash, 0);
+  EXPECT_EQ(topology_hash_after([](Mesh * /*me*/) {}), hash);
+
+  /* Positions and face attributes which are not part of the topology. */
+  EXPECT_EQ(topology_hash_after([](Mesh *me) {
+              for (MVert &vert : me->verts_for_write()) {
+                vert.co[2] += 1.5f;
+              }
+            }),
+            hash);
+  EXPECT_EQ(topology_hash_after([](Mesh *me) {
+              me->polys_for_write()[1].flag |= ME_SMOOTH;
+              me->polys_for_write()[0].mat_nr_legacy = 2;
+            }),
+            hash);
+
+  /* The hash is kept until the geometry is cleared. */
+  mesh->verts_for_write()[0].co[0] = 10.0f;
+  BKE_mesh_runtime_topology_hash_ensure(mesh);
+  EXPECT_EQ(mesh->runtime.topology_hash, hash);
+  BKE_mesh_runtime_clear_geometry(mesh);
+  EXPECT_EQ(mesh->runtime.topology_hash, 0);
+}
+
+TEST_F(MeshTopologyHashTest, topology_edits)
+{
+  const uint32_t hash = mesh->runtime.topology_hash;
+
+  /* Reversed winding of a face. */
+  EXPECT_NE(topology_hash_after([](Mesh *me) {
+              MutableSpan<MLoop> loops = me->loops_for_write();
+              std::swap(loops[1], loops[3]);
+            }),
+            hash);
+  /* Edge connecting other vertices. */
+  EXPECT_NE(topology_hash_after([](Mesh *me) { me->edges_for_write()[5].v2 = 3; }), hash);
+  /* Same loops in faces of a different size. */
+  EXPECT_NE(topology_hash_after([](Mesh *me) {
+              MutableSpan<MPoly> polys = me->polys_for_write();
+              polys[0].totloop = 3;
+              polys[1].loopstart = 3;
+              polys[1].totloop = 5;
+            }),
+            hash);
+}
+
+TEST_F(MeshTopologyHashTest, element_counts)
+{
+  const uint32_t hash = mesh->runtime.topology_hash;
+
+  /* Loose vertex, which is not used by edges or faces. */
+  Mesh *mesh_loose_vert = BKE_mesh_new_nomain_from_template(
+      mesh, mesh->totvert + 1, mesh->totedge, 0, mesh->totloop, mesh->totpoly);
+  mesh_loose_vert->edges_for_write().copy_from(mesh->edges());
+  mesh_loose_vert->loops_for_write().copy_from(mesh->loops());
+  mesh_loose_vert->polys_for_write().copy_from(mesh->polys());
+  BKE_mesh_runtime_topology_hash_ensure(mesh_loose_vert);
+  EXPECT_NE(mesh_loose_vert->runtime.topology_hash, hash);
+  BKE_id_free(nullptr, mesh_loose_vert);
+}
+
+}  // namespace blender::bke::tests
@@ -319,12 +319,41 @@ void BKE_object_batch_cache_dirty_tag(Object *ob)
   }
 }
 
+/**
+ * Detach the draw cache of the evaluated mesh of the object before it is freed by the
+ * re-evaluation, if the new evaluated mesh might only differ by deformation. This is the case
+ * when the original mesh did not change (any change of the original data-block goes through a
+ * copy-on-write update of the mesh).
+ */
+static void *object_eval_mesh_batch_cache_take(Object *ob)
+{
+  if (ob->type != OB_MESH || ob->runtime.data_eval == NULL || !ob->runtime.is_data_eval_owned) {
+    return NULL;
+  }
+  Mesh *mesh_eval = (Mesh *)ob->runtime.data_eval;
+  const ID *mesh_cow = ob->runtime.data_orig;
+  if (GS(mesh_eval->id.name) != ID_ME || mesh_eval->edit_mesh != NULL ||
+      mesh_eval->runtime.topology_hash == 0) {
+    return NULL;
+  }
+  if (mesh_cow == NULL || (mesh_cow->recalc & ID_RECALC_COPY_ON_WRITE)) {
+    return NULL;
+  }
+  return BKE_mesh_batch_cache_take(mesh_eval);
+}
+
 void BKE_object_eval_uber_data(Depsgraph *depsgraph, Scene *scene, Object *ob)
 {
   DEG_debug_print_eval(depsgraph, __func__, ob->id.name, ob);
   BLI_assert(ob->type != OB_ARMATURE);
+  void *mesh_batch_cache = object_eval_mesh_batch_cache_take(ob);
   BKE_object_handle_data_update(depsgraph, scene, ob);
   BKE_object_batch_cache_dirty_tag(ob);
+  if (mesh_batch_cache != NULL) {
+    /* Update only the deformed data of the previous draw cache when the topology of the new
+     * evaluated mesh is the same. */
+    BKE_mesh_batch_cache_reuse_deformed((Mesh *)ob->data, mesh_batch_cache);
+  }
 }
 
 void BKE_object_eval_ptcache_reset(Depsgraph *depsgraph, Scene *scene, Object *object)
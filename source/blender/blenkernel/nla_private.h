@@ -282,6 +282,27 @@ void nlasnapshot_blend_strip_no_blend(PointerRNA *ptr,
                                       NlaEvalSnapshot *snapshot,
                                       const struct AnimationEvalContext *anim_eval_context);
 
+/* --------------- Action Evaluation ----------------------- */
+
+/** Check whether the F-Curve is to be evaluated: not muted, disabled or empty. */
+bool animsys_is_fcurve_evaluatable(struct FCurve *fcu);
+
+/** Write the value to the property of the original data-block of the evaluated \a ptr. */
+void animsys_write_orig_anim_rna(PointerRNA *ptr,
+                                 const char *rna_path,
+                                 int array_index,
+                                 float value);
+
+/**
+ * Evaluate the active action of the animation data of a copy-on-write data-block, like
+ * #animsys_evaluate_action does, using the #AnimData.action_eval_cache which is built on the
+ * first evaluation and after changes of the action.
+ */
+void animsys_evaluate_action_cached(PointerRNA *ptr,
+                                    struct AnimData *adt,
+                                    const struct AnimationEvalContext *anim_eval_context,
+                                    bool flush_to_original);
+
 #ifdef __cplusplus
 }
 #endif
@@ -14,7 +14,8 @@
 extern "C" {
 #endif
 
-/* Memory-mapped file IO that implements all the OS-specific details and error handling. */
+/* Memory-mapped file IO that implements all the OS-specific details and error handling.
+ * Files can be opened and freed from multiple threads. */
 
 struct BLI_mmap_file;
 
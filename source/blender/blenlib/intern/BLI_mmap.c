@@ -8,6 +8,7 @@
 #include "BLI_mmap.h"
 #include "BLI_fileops.h"
 #include "BLI_listbase.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h"
 
 #include <string.h>
@@ -49,6 +50,10 @@ struct BLI_mmap_file {
  * set after it's done reading.
  * If the error occurred outside of a memory-mapped region, we call the previous
  * handler if one was configured and abort the process otherwise.
+ *
+ * Files are opened and freed from multiple threads (image loading, sequencer disk cache),
+ * so the handler setup and the list of files are protected by a lock. The signal handler
+ * itself can't take the lock.
  */
 
 static struct error_handler_data {
@@ -57,6 +62,8 @@ static struct error_handler_data {
   void (*next_handler)(int, siginfo_t *, void *);
 } error_handler = {0};
 
+static ThreadMutex error_handler_lock = BLI_MUTEX_INITIALIZER;
+
 static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
 {
   /* We only handle SIGBUS here for now. */
@@ -95,6 +102,7 @@ static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
 /* Ensures that the error handler is set up and ready. */
 static bool sigbus_handler_setup(void)
 {
+  BLI_mutex_lock(&error_handler_lock);
   if (!error_handler.configured) {
     struct sigaction newact = {0}, oldact = {0};
 
@@ -102,6 +110,7 @@ static bool sigbus_handler_setup(void)
     newact.sa_flags = SA_SIGINFO;
 
     if (sigaction(SIGBUS, &newact, &oldact)) {
+      BLI_mutex_unlock(&error_handler_lock);
       return false;
     }
 
@@ -110,6 +119,7 @@ static bool sigbus_handler_setup(void)
     error_handler.next_handler = oldact.sa_sigaction;
     error_handler.configured = 1;
   }
+  BLI_mutex_unlock(&error_handler_lock);
 
   return true;
 }
@@ -117,14 +127,20 @@ static bool sigbus_handler_setup(void)
 /* Adds a file to the list that the error handler checks. */
 static void sigbus_handler_add(BLI_mmap_file *file)
 {
-  BLI_addtail(&error_handler.open_mmaps, BLI_genericNodeN(file));
+  LinkData *link = BLI_genericNodeN(file);
+  BLI_mutex_lock(&error_handler_lock);
+  BLI_addtail(&error_handler.open_mmaps, link);
+  BLI_mutex_unlock(&error_handler_lock);
 }
 
 /* Removes a file from the list that the error handler checks. */
 static void sigbus_handler_remove(BLI_mmap_file *file)
 {
+  BLI_mutex_lock(&error_handler_lock);
   LinkData *link = BLI_findptr(&error_handler.open_mmaps, file, offsetof(LinkData, data));
-  BLI_freelinkN(&error_handler.open_mmaps, link);
+  BLI_remlink(&error_handler.open_mmaps, link);
+  BLI_mutex_unlock(&error_handler_lock);
+  MEM_freeN(link);
 }
 #endif
 
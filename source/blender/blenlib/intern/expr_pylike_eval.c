@@ -13,14 +13,16 @@
  *  - Literals:
  *      floating point and decimal integer.
  *  - Constants:
- *      pi, True, False
+ *      pi, tau, e, True, False
  *  - Operators:
- *      +, -, *, /, ==, !=, <, <=, >, >=, and, or, not, ternary if
+ *      +, -, *, /, //, %, **, ==, !=, <, <=, >, >=, and, or, not, ternary if
  *  - Functions:
  *      min, max, radians, degrees,
- *      abs, fabs, floor, ceil, trunc, int,
- *      sin, cos, tan, asin, acos, atan, atan2,
- *      exp, log, sqrt, pow, fmod
+ *      abs, fabs, floor, ceil, trunc, int, float, bool, round, copysign,
+ *      sin, cos, tan, asin, acos, atan, atan2, hypot,
+ *      sinh, cosh, tanh, asinh, acosh, atanh,
+ *      exp, expm1, log, log2, log10, log1p, sqrt, pow, fmod,
+ *      lerp, clamp, smoothstep
  *
  * The implementation has no global state and can be used multi-threaded.
  */
@@ -301,6 +303,31 @@ static double op_sub(double a, double b)
   return a - b;
 }
 
+static double op_floordiv(double a, double b)
+{
+  return floor(a / b);
+}
+
+static double op_mod(double a, double b)
+{
+  /* Python modulo: the result has the sign of the divisor. */
+  double result = fmod(a, b);
+  if (result != 0.0 && ((result < 0.0) != (b < 0.0))) {
+    result += b;
+  }
+  return result;
+}
+
+static double op_identity(double arg)
+{
+  return arg;
+}
+
+static double op_bool(double arg)
+{
+  return arg ? 1.0 : 0.0;
+}
+
 static double op_radians(double arg)
 {
   return arg * M_PI / 180.0;
@@ -381,7 +408,13 @@ typedef struct BuiltinConstDef {
 } BuiltinConstDef;
 
 static BuiltinConstDef builtin_consts[] = {
-    {"pi", M_PI}, {"True", 1.0}, {"False", 0.0}, {NULL, 0.0}};
+    {"pi", M_PI},
+    {"tau", 2.0 * M_PI},
+    {"e", M_E},
+    {"True", 1.0},
+    {"False", 0.0},
+    {NULL, 0.0},
+};
 
 typedef struct BuiltinOpDef {
   const char *name;
@@ -406,6 +439,9 @@ static BuiltinOpDef builtin_ops[] = {
     {"trunc", OPCODE_FUNC1, trunc},
     {"round", OPCODE_FUNC1, round},
     {"int", OPCODE_FUNC1, trunc},
+    {"float", OPCODE_FUNC1, op_identity},
+    {"bool", OPCODE_FUNC1, op_bool},
+    {"copysign", OPCODE_FUNC2, copysign},
     {"sin", OPCODE_FUNC1, sin},
     {"cos", OPCODE_FUNC1, cos},
     {"tan", OPCODE_FUNC1, tan},
@@ -413,9 +449,20 @@ static BuiltinOpDef builtin_ops[] = {
     {"acos", OPCODE_FUNC1, acos},
     {"atan", OPCODE_FUNC1, atan},
     {"atan2", OPCODE_FUNC2, atan2},
+    {"hypot", OPCODE_FUNC2, hypot},
+    {"sinh", OPCODE_FUNC1, sinh},
+    {"cosh", OPCODE_FUNC1, cosh},
+    {"tanh", OPCODE_FUNC1, tanh},
+    {"asinh", OPCODE_FUNC1, asinh},
+    {"acosh", OPCODE_FUNC1, acosh},
+    {"atanh", OPCODE_FUNC1, atanh},
     {"exp", OPCODE_FUNC1, exp},
+    {"expm1", OPCODE_FUNC1, expm1},
     {"log", OPCODE_FUNC1, log},
     {"log", OPCODE_FUNC2, op_log2},
+    {"log2", OPCODE_FUNC1, log2},
+    {"log10", OPCODE_FUNC1, log10},
+    {"log1p", OPCODE_FUNC1, log1p},
     {"sqrt", OPCODE_FUNC1, sqrt},
     {"pow", OPCODE_FUNC2, pow},
     {"fmod", OPCODE_FUNC2, fmod},
@@ -448,6 +495,8 @@ static BuiltinOpDef builtin_ops[] = {
 #define TOKEN_LE MAKE_CHAR2('<', '=')
 #define TOKEN_NE MAKE_CHAR2('!', '=')
 #define TOKEN_EQ MAKE_CHAR2('=', '=')
+#define TOKEN_POW MAKE_CHAR2('*', '*')
+#define TOKEN_FLOORDIV MAKE_CHAR2('/', '/')
 #define TOKEN_AND MAKE_CHAR2('A', 'N')
 #define TOKEN_OR MAKE_CHAR2('O', 'R')
 #define TOKEN_NOT MAKE_CHAR2('N', 'O')
@@ -455,6 +504,7 @@ static BuiltinOpDef builtin_ops[] = {
 #define TOKEN_ELSE MAKE_CHAR2('E', 'L')
 
 static const char *token_eq_characters = "!=><";
+static const char *token_double_characters = "*/";
 static const char *token_characters = "~`!@#$%^&*+-=/\\?:;<>(){}[]|.,\"'";
 
 typedef struct KeywordTokenDef {
@@ -696,6 +746,13 @@ static bool parse_next_token(ExprParseState *state)
     return true;
   }
 
+  /* Doubled character tokens */
+  if (state->cur[0] == state->cur[1] && strchr(token_double_characters, state->cur[0])) {
+    state->token = MAKE_CHAR2(state->cur[0], state->cur[1]);
+    state->cur += 2;
+    return true;
+  }
+
   /* Special characters (single character tokens) */
   if (strchr(token_characters, *state->cur)) {
     state->token = *state->cur++;
@@ -768,19 +825,11 @@ static int parse_function_args(ExprParseState *state)
   }
 }
 
-static bool parse_unary(ExprParseState *state)
+static bool parse_primary(ExprParseState *state)
 {
   int i;
 
   switch (state->token) {
-    case '+':
-      return parse_next_token(state) && parse_unary(state);
-
-    case '-':
-      CHECK_ERROR(parse_next_token(state) && parse_unary(state));
-      parse_add_func(state, OPCODE_FUNC1, 1, op_negate);
-      return true;
-
     case '(':
       return parse_next_token(state) && parse_expr(state) && state->token == ')' &&
              parse_next_token(state);
@@ -851,6 +900,38 @@ static bool parse_unary(ExprParseState *state)
   }
 }
 
+static bool parse_unary(ExprParseState *state);
+
+static bool parse_power(ExprParseState *state)
+{
+  CHECK_ERROR(parse_primary(state));
+
+  /* The exponent binds tighter than a unary minus on the left, but not on the right:
+   * -2 ** -1 is -(2 ** (-1)). Chained powers are evaluated right to left. */
+  if (state->token == TOKEN_POW) {
+    CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+    parse_add_func(state, OPCODE_FUNC2, 2, pow);
+  }
+
+  return true;
+}
+
+static bool parse_unary(ExprParseState *state)
+{
+  switch (state->token) {
+    case '+':
+      return parse_next_token(state) && parse_unary(state);
+
+    case '-':
+      CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+      parse_add_func(state, OPCODE_FUNC1, 1, op_negate);
+      return true;
+
+    default:
+      return parse_power(state);
+  }
+}
+
 static bool parse_mul(ExprParseState *state)
 {
   CHECK_ERROR(parse_unary(state));
@@ -867,6 +948,16 @@ static bool parse_mul(ExprParseState *state)
         parse_add_func(state, OPCODE_FUNC2, 2, op_div);
         break;
 
+      case TOKEN_FLOORDIV:
+        CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+        parse_add_func(state, OPCODE_FUNC2, 2, op_floordiv);
+        break;
+
+      case '%':
+        CHECK_ERROR(parse_next_token(state) && parse_unary(state));
+        parse_add_func(state, OPCODE_FUNC2, 2, op_mod);
+        break;
+
       default:
         return true;
     }
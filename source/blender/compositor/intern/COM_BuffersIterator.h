@@ -53,6 +53,25 @@ template<typename T> class BuffersIteratorBuilder {
       return ins_.size();
     }
 
+    int get_out_elem_stride() const
+    {
+      return out_elem_stride_;
+    }
+
+    int get_in_elem_stride(int input_index) const
+    {
+      BLI_assert(input_index < ins_.size());
+      return ins_[input_index].elem_stride;
+    }
+
+    /**
+     * Number of elements left in current row, including current one.
+     */
+    int get_row_remaining() const
+    {
+      return x_end_ - x;
+    }
+
     /**
      * Has the end of the area been reached.
      */
@@ -81,6 +100,21 @@ template<typename T> class BuffersIteratorBuilder {
       }
     }
 
+    /**
+     * Skip given number of elements in current row, it must not be greater than the row remaining
+     * elements. Used to process several contiguous elements at once.
+     */
+    void next(int num_elems)
+    {
+      BLI_assert(num_elems > 0 && num_elems <= get_row_remaining());
+      out += out_elem_stride_ * (num_elems - 1);
+      for (In &in : ins_) {
+        in.in += in.elem_stride * (num_elems - 1);
+      }
+      x += num_elems - 1;
+      next();
+    }
+
     Iterator &operator++()
     {
       this->next();
@@ -13,6 +13,7 @@ CompositorContext::CompositorContext()
   hasActiveOpenCLDevices_ = false;
   fast_calculation_ = false;
   bnodetree_ = nullptr;
+  static_cache_ = nullptr;
 }
 
 int CompositorContext::get_framenumber() const
@@ -13,6 +13,8 @@ struct bNodeInstanceHash;
 
 namespace blender::compositor {
 
+class StaticOperationCache;
+
 /**
  * \brief Overall context of the compositor
  */
@@ -69,6 +71,11 @@ class CompositorContext {
    */
   const char *view_name_;
 
+  /**
+   * \brief Cache of operation buffers shared between executions, null when disabled.
+   */
+  StaticOperationCache *static_cache_;
+
  public:
   /**
    * \brief constructor initializes the context with default values.
@@ -207,6 +214,15 @@ class CompositorContext {
     view_name_ = view_name;
   }
 
+  void set_static_cache(StaticOperationCache *static_cache)
+  {
+    static_cache_ = static_cache;
+  }
+  StaticOperationCache *get_static_cache() const
+  {
+    return static_cache_;
+  }
+
   int get_chunksize() const
   {
     return this->get_bnodetree()->chunksize;
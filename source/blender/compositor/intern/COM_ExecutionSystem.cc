@@ -23,10 +23,12 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
                                  bNodeTree *editingtree,
                                  bool rendering,
                                  bool fastcalculation,
-                                 const char *view_name)
+                                 const char *view_name,
+                                 StaticOperationCache *static_cache)
 {
   num_work_threads_ = WorkScheduler::get_num_cpu_threads();
   context_.set_view_name(view_name);
+  context_.set_static_cache(static_cache);
   context_.set_scene(scene);
   context_.set_bnodetree(editingtree);
   context_.set_preview_hash(editingtree->previews);
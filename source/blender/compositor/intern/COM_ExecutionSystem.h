@@ -107,6 +107,7 @@ namespace blender::compositor {
 class ExecutionGroup;
 class ExecutionModel;
 class NodeOperation;
+class StaticOperationCache;
 
 /**
  * \brief the ExecutionSystem contains the whole compositor tree.
@@ -154,13 +155,15 @@ class ExecutionSystem {
    *
    * \param editingtree: [bNodeTree *]
    * \param rendering: [true false]
+   * \param static_cache: Cache of operation buffers reused between executions, may be null.
    */
   ExecutionSystem(RenderData *rd,
                   Scene *scene,
                   bNodeTree *editingtree,
                   bool rendering,
                   bool fastcalculation,
-                  const char *view_name);
+                  const char *view_name,
+                  StaticOperationCache *static_cache = nullptr);
 
   /**
    * Destructor
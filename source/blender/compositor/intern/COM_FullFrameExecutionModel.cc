@@ -5,7 +5,9 @@
 
 #include "BLT_translation.h"
 
+#include "COM_ConstantOperation.h"
 #include "COM_Debug.h"
+#include "COM_StaticOperationCache.h"
 #include "COM_ViewerOperation.h"
 #include "COM_WorkScheduler.h"
 
@@ -20,7 +22,8 @@ FullFrameExecutionModel::FullFrameExecutionModel(CompositorContext &context,
                                                  Span<NodeOperation *> operations)
     : ExecutionModel(context, operations),
       active_buffers_(shared_buffers),
-      num_operations_finished_(0)
+      num_operations_finished_(0),
+      static_cache_(context.is_rendering() ? context.get_static_cache() : nullptr)
 {
   priorities_.append(eCompositorPriority::High);
   if (!context.is_fast_calculation()) {
@@ -36,6 +39,7 @@ void FullFrameExecutionModel::execute(ExecutionSystem &exec_system)
 
   DebugInfo::graphviz(&exec_system, "compositor_prior_rendering");
 
+  determine_static_cache_usage();
   determine_areas_to_render_and_reads();
   render_operations();
 }
@@ -58,6 +62,82 @@ void FullFrameExecutionModel::determine_areas_to_render_and_reads()
   }
 }
 
+std::optional<size_t> FullFrameExecutionModel::get_static_cache_key(
+    NodeOperation *op, Map<NodeOperation *, std::optional<size_t>> &keys)
+{
+  if (const std::optional<size_t> *key = keys.lookup_ptr(op)) {
+    return *key;
+  }
+
+  std::optional<size_t> key;
+  if (op->get_flags().is_constant_operation) {
+    const DataType data_type = op->get_output_socket()->get_data_type();
+    const float *elem = static_cast<ConstantOperation *>(op)->get_constant_elem();
+    size_t hash = get_default_hash(data_type);
+    for (const int i : IndexRange(COM_data_type_num_channels(data_type))) {
+      hash = BLI_ghashutil_combine_hash(hash, get_default_hash(elem[i]));
+    }
+    key = hash;
+  }
+  else if (std::optional<NodeOperationHash> op_hash = op->generate_hash()) {
+    /* Identify inputs by their keys instead of their ids, which are only valid in current
+     * execution. */
+    size_t hash = op_hash->get_type_and_params_hash();
+    bool has_all_input_keys = true;
+    for (const int i : IndexRange(op->get_number_of_input_sockets())) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      const std::optional<size_t> input_key = input_op ? get_static_cache_key(input_op, keys) :
+                                                         std::nullopt;
+      if (!input_key) {
+        has_all_input_keys = false;
+        break;
+      }
+      hash = BLI_ghashutil_combine_hash(hash, *input_key);
+    }
+    if (has_all_input_keys) {
+      key = hash;
+    }
+  }
+
+  keys.add(op, key);
+  return key;
+}
+
+void FullFrameExecutionModel::determine_static_cache_usage()
+{
+  if (static_cache_ == nullptr) {
+    return;
+  }
+
+  Map<NodeOperation *, std::optional<size_t>> keys;
+  for (NodeOperation *op : operations_) {
+    get_static_cache_key(op, keys);
+  }
+
+  /* Only cache operations read by operations that can't be cached, caching the rest of the
+   * static sub-tree would only use memory. */
+  for (NodeOperation *op : operations_) {
+    if (keys.lookup(op)) {
+      continue;
+    }
+    for (const int i : IndexRange(op->get_number_of_input_sockets())) {
+      NodeOperation *input_op = op->get_input_operation(i);
+      const std::optional<size_t> input_key = keys.lookup(input_op);
+      if (input_key && !input_op->get_flags().is_constant_operation &&
+          input_op->get_number_of_output_sockets() > 0) {
+        static_cache_keys_.add(input_op, *input_key);
+      }
+    }
+  }
+
+  static_cache_->begin_execution();
+  for (const auto item : static_cache_keys_.items()) {
+    if (static_cache_->lookup(item.value)) {
+      cached_operations_.add(item.key);
+    }
+  }
+}
+
 Vector<MemoryBuffer *> FullFrameExecutionModel::get_input_buffers(NodeOperation *op,
                                                                   const int output_x,
                                                                   const int output_y)
@@ -97,6 +177,14 @@ void FullFrameExecutionModel::render_operation(NodeOperation *op)
   constexpr int output_x = 0;
   constexpr int output_y = 0;
 
+  if (cached_operations_.contains(op)) {
+    const MemoryBuffer *cached_buf = static_cache_->lookup(static_cache_keys_.lookup(op));
+    BLI_assert(cached_buf != nullptr);
+    active_buffers_.set_rendered_buffer(op, std::make_unique<MemoryBuffer>(*cached_buf));
+    operation_finished(op);
+    return;
+  }
+
   const bool has_outputs = op->get_number_of_output_sockets() > 0;
   MemoryBuffer *op_buf = has_outputs ? create_operation_buffer(op, output_x, output_y) : nullptr;
   if (op->get_width() > 0 && op->get_height() > 0) {
@@ -107,6 +195,19 @@ void FullFrameExecutionModel::render_operation(NodeOperation *op)
     op->render(op_buf, areas, input_bufs);
     DebugInfo::operation_rendered(op, op_buf);
 
+    /* Partially rendered buffers (e.g. when using a border or cancelled) can't be reused. */
+    const bNodeTree *node_tree = context_.get_bnodetree();
+    const size_t *static_cache_key = static_cache_keys_.lookup_ptr(op);
+    if (static_cache_key && !node_tree->test_break(node_tree->tbh)) {
+      const rcti &buf_rect = op_buf->get_rect();
+      for (const rcti &area : areas) {
+        if (BLI_rcti_inside_rcti(&area, &buf_rect)) {
+          static_cache_->store(*static_cache_key, *op_buf);
+          break;
+        }
+      }
+    }
+
     for (MemoryBuffer *buf : input_bufs) {
       delete buf;
     }
@@ -144,7 +245,8 @@ void FullFrameExecutionModel::render_operations()
  * Returns all dependencies from inputs to outputs. A dependency may be repeated when
  * several operations depend on it.
  */
-static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operation)
+static Vector<NodeOperation *> get_operation_dependencies(
+    NodeOperation *operation, const Set<NodeOperation *> &cached_operations)
 {
   /* Get dependencies from outputs to inputs. */
   Vector<NodeOperation *> dependencies;
@@ -154,6 +256,9 @@ static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operati
     Vector<NodeOperation *> outputs(next_outputs);
     next_outputs.clear();
     for (NodeOperation *output : outputs) {
+      if (cached_operations.contains(output)) {
+        continue;
+      }
       for (int i = 0; i < output->get_number_of_input_sockets(); i++) {
         next_outputs.append(output->get_input_operation(i));
       }
@@ -170,7 +275,8 @@ static Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operati
 void FullFrameExecutionModel::render_output_dependencies(NodeOperation *output_op)
 {
   BLI_assert(output_op->is_output_operation(context_.is_rendering()));
-  Vector<NodeOperation *> dependencies = get_operation_dependencies(output_op);
+  Vector<NodeOperation *> dependencies = get_operation_dependencies(output_op,
+                                                                    cached_operations_);
   for (NodeOperation *op : dependencies) {
     if (!active_buffers_.is_operation_rendered(op)) {
       render_operation(op);
@@ -195,6 +301,9 @@ void FullFrameExecutionModel::determine_areas_to_render(NodeOperation *output_op
     }
 
     active_buffers_.register_area(operation, render_area);
+    if (cached_operations_.contains(operation)) {
+      continue;
+    }
 
     const int num_inputs = operation->get_number_of_input_sockets();
     for (int i = 0; i < num_inputs; i++) {
@@ -218,6 +327,9 @@ void FullFrameExecutionModel::determine_reads(NodeOperation *output_op)
   stack.append(output_op);
   while (stack.size() > 0) {
     NodeOperation *operation = stack.pop_last();
+    if (cached_operations_.contains(operation)) {
+      continue;
+    }
     const int num_inputs = operation->get_number_of_input_sockets();
     for (int i = 0; i < num_inputs; i++) {
       NodeOperation *input_op = operation->get_input_operation(i);
@@ -257,8 +369,10 @@ void FullFrameExecutionModel::get_output_render_area(NodeOperation *output_op, r
 
 void FullFrameExecutionModel::operation_finished(NodeOperation *operation)
 {
-  /* Report inputs reads so that buffers may be freed/reused. */
-  const int num_inputs = operation->get_number_of_input_sockets();
+  /* Report inputs reads so that buffers may be freed/reused. Cached operations don't read. */
+  const int num_inputs = cached_operations_.contains(operation) ?
+                             0 :
+                             operation->get_number_of_input_sockets();
   for (int i = 0; i < num_inputs; i++) {
     active_buffers_.read_finished(operation->get_input_operation(i));
   }
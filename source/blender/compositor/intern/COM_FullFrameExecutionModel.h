@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <optional>
+
+#include "BLI_map.hh"
+#include "BLI_set.hh"
 #include "BLI_vector.hh"
 
 #include "COM_Enums.h"
@@ -20,6 +24,7 @@ class ExecutionSystem;
 class MemoryBuffer;
 class NodeOperation;
 class SharedOperationBuffers;
+class StaticOperationCache;
 
 /**
  * Fully renders operations in order from inputs to outputs.
@@ -42,6 +47,23 @@ class FullFrameExecutionModel : public ExecutionModel {
    */
   Vector<eCompositorPriority> priorities_;
 
+  /**
+   * Cache of buffers shared between executions, null when disabled.
+   */
+  StaticOperationCache *static_cache_;
+
+  /**
+   * Keys of operations which buffers are stored in the static cache. Only operations in the
+   * boundary of a static sub-tree are stored (i.e: read by an operation that can't be cached).
+   */
+  Map<NodeOperation *, size_t> static_cache_keys_;
+
+  /**
+   * Operations which buffers are copied from the static cache instead of being rendered. Their
+   * inputs are not rendered for them.
+   */
+  Set<NodeOperation *> cached_operations_;
+
  public:
   FullFrameExecutionModel(CompositorContext &context,
                           SharedOperationBuffers &shared_buffers,
@@ -51,6 +73,12 @@ class FullFrameExecutionModel : public ExecutionModel {
 
  private:
   void determine_areas_to_render_and_reads();
+  /**
+   * Determines which operations are stored in or taken from the static cache.
+   */
+  void determine_static_cache_usage();
+  std::optional<size_t> get_static_cache_key(NodeOperation *op,
+                                             Map<NodeOperation *, std::optional<size_t>> &keys);
   /**
    * Render output operations in order of priority.
    */
@@ -274,6 +274,15 @@ struct NodeOperationHash {
     return operation_;
   }
 
+  /**
+   * Hash of the operation type and parameters, excluding its inputs. Unlike the full hash it
+   * doesn't depend on operation ids, so it may be compared between executions.
+   */
+  size_t get_type_and_params_hash() const
+  {
+    return BLI_ghashutil_combine_hash(type_hash_, params_hash_);
+  }
+
   bool operator==(const NodeOperationHash &other) const
   {
     return type_hash_ == other.type_hash_ && parents_hash_ == other.parents_hash_ &&
@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "COM_StaticOperationCache.h"
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor {
+
+static size_t get_buffer_mem_size(const MemoryBuffer &buffer)
+{
+  const size_t num_elems = buffer.is_a_single_elem() ?
+                               1 :
+                               size_t(buffer.get_memory_width()) * buffer.get_memory_height();
+  return num_elems * buffer.get_num_channels() * sizeof(float);
+}
+
+StaticOperationCache::StaticOperationCache(const size_t mem_limit)
+    : mem_limit_(mem_limit), mem_in_use_(0), use_counter_(0), execution_start_(UINT64_MAX)
+{
+}
+
+StaticOperationCache::~StaticOperationCache()
+{
+  clear();
+}
+
+void StaticOperationCache::begin_execution()
+{
+  execution_start_ = use_counter_ + 1;
+}
+
+const MemoryBuffer *StaticOperationCache::lookup(const size_t key)
+{
+  CacheEntry *entry = entries_.lookup_ptr(key);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  entry->last_used = ++use_counter_;
+  return entry->buffer.get();
+}
+
+bool StaticOperationCache::contains(const size_t key) const
+{
+  return entries_.contains(key);
+}
+
+void StaticOperationCache::store(const size_t key, const MemoryBuffer &buffer)
+{
+  const size_t mem_size = get_buffer_mem_size(buffer);
+  if (mem_size > mem_limit_ || entries_.contains(key)) {
+    return;
+  }
+
+  while (mem_in_use_ + mem_size > mem_limit_) {
+    if (!free_least_recently_used()) {
+      return;
+    }
+  }
+
+  CacheEntry entry;
+  entry.buffer = std::make_unique<MemoryBuffer>(buffer);
+  entry.mem_size = mem_size;
+  entry.last_used = ++use_counter_;
+  entries_.add_new(key, std::move(entry));
+  mem_in_use_ += mem_size;
+}
+
+bool StaticOperationCache::free_least_recently_used()
+{
+  size_t lru_key = 0;
+  uint64_t lru_last_used = UINT64_MAX;
+  for (auto item : entries_.items()) {
+    if (item.value.last_used < lru_last_used) {
+      lru_key = item.key;
+      lru_last_used = item.value.last_used;
+    }
+  }
+  if (lru_last_used == UINT64_MAX || lru_last_used >= execution_start_) {
+    return false;
+  }
+  mem_in_use_ -= entries_.lookup(lru_key).mem_size;
+  entries_.remove(lru_key);
+  return true;
+}
+
+void StaticOperationCache::clear()
+{
+  entries_.clear();
+  mem_in_use_ = 0;
+}
+
+}  // namespace blender::compositor
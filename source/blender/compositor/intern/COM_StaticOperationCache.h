@@ -0,0 +1,87 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#pragma once
+
+#include <memory>
+
+#include "BLI_map.hh"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+class MemoryBuffer;
+
+/**
+ * Keeps rendered operation buffers alive across executions so that sub-trees which result is
+ * identical between frames (e.g. a static backplate that is blurred and color corrected) are
+ * only rendered once during an animation render.
+ *
+ * Buffers are identified by a key that hashes the operation type, its parameters and the keys of
+ * all its inputs (see #FullFrameExecutionModel). Least recently used buffers are disposed when
+ * the memory limit is exceeded.
+ */
+class StaticOperationCache {
+ private:
+  struct CacheEntry {
+    std::unique_ptr<MemoryBuffer> buffer;
+    size_t mem_size;
+    uint64_t last_used;
+  };
+
+  Map<size_t, CacheEntry> entries_;
+  size_t mem_limit_;
+  size_t mem_in_use_;
+  /** Incremented on every access, used to find the least recently used entry. */
+  uint64_t use_counter_;
+  /** Value of #use_counter_ when current execution started. */
+  uint64_t execution_start_;
+
+ public:
+  StaticOperationCache(size_t mem_limit);
+  ~StaticOperationCache();
+
+  /**
+   * Entries used after this call are not freed to make room for new ones until the next call,
+   * so that buffers looked up before rendering remain valid during the whole execution.
+   */
+  void begin_execution();
+
+  /**
+   * Get the buffer cached for given key or null when there is none. The returned buffer is owned
+   * by the cache and must be copied by the caller.
+   */
+  const MemoryBuffer *lookup(size_t key);
+  bool contains(size_t key) const;
+
+  /**
+   * Stores a copy of given buffer. Least recently used buffers are freed to fit it into the
+   * memory limit. The buffer is not stored if it doesn't fit.
+   */
+  void store(size_t key, const MemoryBuffer &buffer);
+
+  void clear();
+
+  size_t get_mem_in_use() const
+  {
+    return mem_in_use_;
+  }
+
+  int64_t size() const
+  {
+    return entries_.size();
+  }
+
+ private:
+  /** Returns false when all entries are in use by current execution. */
+  bool free_least_recently_used();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:StaticOperationCache")
+#endif
+};
+
+}  // namespace blender::compositor
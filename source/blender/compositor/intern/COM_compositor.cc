@@ -9,12 +9,15 @@
 #include "BKE_scene.h"
 
 #include "COM_ExecutionSystem.h"
+#include "COM_StaticOperationCache.h"
 #include "COM_WorkScheduler.h"
 #include "COM_compositor.h"
 
 static struct {
   bool is_initialized = false;
   ThreadMutex mutex;
+  /** Buffers of static sub-trees kept between frames of a render job, see #COM_clear_caches. */
+  blender::compositor::StaticOperationCache *static_cache = nullptr;
 } g_compositor;
 
 /* Make sure node tree has previews.
@@ -88,18 +91,43 @@ void COM_execute(RenderData *render_data,
     }
   }
 
+  /* Static buffers are only reused while rendering, interactive editing may change image or
+   * tracking data without the operations noticing. */
+  if (rendering) {
+    if (g_compositor.static_cache == nullptr) {
+      g_compositor.static_cache = new blender::compositor::StaticOperationCache(
+          blender::compositor::COM_STATIC_CACHE_MEM_LIMIT);
+    }
+  }
+  else if (g_compositor.static_cache) {
+    delete g_compositor.static_cache;
+    g_compositor.static_cache = nullptr;
+  }
+
   blender::compositor::ExecutionSystem system(
-      render_data, scene, node_tree, rendering, false, view_name);
+      render_data, scene, node_tree, rendering, false, view_name, g_compositor.static_cache);
   system.execute();
 
   BLI_mutex_unlock(&g_compositor.mutex);
 }
 
+void COM_clear_caches()
+{
+  if (g_compositor.is_initialized) {
+    BLI_mutex_lock(&g_compositor.mutex);
+    delete g_compositor.static_cache;
+    g_compositor.static_cache = nullptr;
+    BLI_mutex_unlock(&g_compositor.mutex);
+  }
+}
+
 void COM_deinitialize()
 {
   if (g_compositor.is_initialized) {
     BLI_mutex_lock(&g_compositor.mutex);
     blender::compositor::WorkScheduler::deinitialize();
+    delete g_compositor.static_cache;
+    g_compositor.static_cache = nullptr;
     g_compositor.is_initialized = false;
     BLI_mutex_unlock(&g_compositor.mutex);
     BLI_mutex_end(&g_compositor.mutex);
@@ -15,6 +15,9 @@ class AlphaOverMixedOperation : public MixBaseOperation {
  private:
   float x_;
 
+ protected:
+  void hash_output_params() override;
+
  public:
   /**
    * Default constructor
@@ -72,6 +72,11 @@ class BlurBaseOperation : public MultiThreadedOperation, public QualityStepHelpe
     extend_bounds_ = extend_bounds;
   }
 
+  bool get_extend_bounds() const
+  {
+    return extend_bounds_;
+  }
+
   int get_blur_size(eDimension dim) const;
 
   void determine_canvas(const rcti &preferred_area, rcti &r_area) override;
@@ -4,11 +4,90 @@
 #include "COM_ConvertOperation.h"
 
 #include "BLI_color.hh"
+#include "BLI_simd.h"
 
 #include "IMB_colormanagement.h"
 
 namespace blender::compositor {
 
+#ifdef BLI_HAVE_SSE2
+static inline __m128 select_sse(const __m128 mask, const __m128 a, const __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/**
+ * Applies an affine transform to the color channels of all iterated pixels keeping alpha.
+ * The transform is sampled from `transform_fn(rgb, r_result)`, which must be affine.
+ */
+template<typename TFn>
+static void apply_affine_color_transform_sse(BuffersIterator<float> &it, TFn transform_fn)
+{
+  float offset[4] = {0.0f};
+  float axes[3][4] = {{0.0f}};
+  const float origin[3] = {0.0f, 0.0f, 0.0f};
+  transform_fn(origin, offset);
+  for (int i = 0; i < 3; i++) {
+    float unit[3] = {0.0f, 0.0f, 0.0f};
+    unit[i] = 1.0f;
+    transform_fn(unit, axes[i]);
+    sub_v3_v3(axes[i], offset);
+  }
+
+  const __m128 offset_sse = _mm_loadu_ps(offset);
+  const __m128 axis_x = _mm_loadu_ps(axes[0]);
+  const __m128 axis_y = _mm_loadu_ps(axes[1]);
+  const __m128 axis_z = _mm_loadu_ps(axes[2]);
+  const __m128 rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+  for (; !it.is_end(); ++it) {
+    const __m128 in = _mm_loadu_ps(it.in(0));
+    __m128 result = _mm_add_ps(offset_sse,
+                               _mm_mul_ps(_mm_shuffle_ps(in, in, _MM_SHUFFLE(0, 0, 0, 0)), axis_x));
+    result = _mm_add_ps(result,
+                        _mm_mul_ps(_mm_shuffle_ps(in, in, _MM_SHUFFLE(1, 1, 1, 1)), axis_y));
+    result = _mm_add_ps(result,
+                        _mm_mul_ps(_mm_shuffle_ps(in, in, _MM_SHUFFLE(2, 2, 2, 2)), axis_z));
+    _mm_storeu_ps(it.out, select_sse(rgb_mask, result, in));
+  }
+}
+
+/**
+ * Converts the color channels of four pixels at once, transposing them so that each register
+ * contains a channel. `sse_fn(c0, c1, c2)` converts the channels in place, `fn(in, out)`
+ * converts pixels that can't be grouped. Alpha is kept.
+ */
+template<typename TSSEFn, typename TFn>
+static void convert_pixels_sse(BuffersIterator<float> &it, TSSEFn sse_fn, TFn fn)
+{
+  const int in_stride = it.get_in_elem_stride(0);
+  const int out_stride = it.get_out_elem_stride();
+  while (!it.is_end()) {
+    int row_remaining = it.get_row_remaining();
+    for (; row_remaining >= 4; row_remaining -= 4) {
+      const float *in = it.in(0);
+      __m128 c0 = _mm_loadu_ps(in);
+      __m128 c1 = _mm_loadu_ps(in + in_stride);
+      __m128 c2 = _mm_loadu_ps(in + in_stride * 2);
+      __m128 alpha = _mm_loadu_ps(in + in_stride * 3);
+      _MM_TRANSPOSE4_PS(c0, c1, c2, alpha);
+      sse_fn(c0, c1, c2);
+      _MM_TRANSPOSE4_PS(c0, c1, c2, alpha);
+      _mm_storeu_ps(it.out, c0);
+      _mm_storeu_ps(it.out + out_stride, c1);
+      _mm_storeu_ps(it.out + out_stride * 2, c2);
+      _mm_storeu_ps(it.out + out_stride * 3, alpha);
+      it.next(4);
+    }
+    for (; row_remaining > 0; row_remaining--) {
+      const float *in = it.in(0);
+      fn(in, it.out);
+      it.out[3] = in[3];
+      ++it;
+    }
+  }
+}
+#endif
+
 ConvertBaseOperation::ConvertBaseOperation()
 {
   input_operation_ = nullptr;
@@ -266,6 +345,12 @@ void ConvertRGBToYCCOperation::hash_output_params()
 
 void ConvertRGBToYCCOperation::update_memory_buffer_partial(BuffersIterator<float> &it)
 {
+#ifdef BLI_HAVE_SSE2
+  apply_affine_color_transform_sse(it, [&](const float rgb[3], float r_ycc[3]) {
+    rgb_to_ycc(rgb[0], rgb[1], rgb[2], &r_ycc[0], &r_ycc[1], &r_ycc[2], mode_);
+    mul_v3_fl(r_ycc, 1.0f / 255.0f);
+  });
+#else
   for (; !it.is_end(); ++it) {
     const float *in = it.in(0);
     rgb_to_ycc(in[0], in[1], in[2], &it.out[0], &it.out[1], &it.out[2], mode_);
@@ -274,6 +359,7 @@ void ConvertRGBToYCCOperation::update_memory_buffer_partial(BuffersIterator<floa
     mul_v3_fl(it.out, 1.0f / 255.0f);
     it.out[3] = in[3];
   }
+#endif
 }
 
 /* ******** YCC to RGB ******** */
@@ -325,6 +411,17 @@ void ConvertYCCToRGBOperation::hash_output_params()
 
 void ConvertYCCToRGBOperation::update_memory_buffer_partial(BuffersIterator<float> &it)
 {
+#ifdef BLI_HAVE_SSE2
+  apply_affine_color_transform_sse(it, [&](const float ycc[3], float r_rgb[3]) {
+    ycc_to_rgb(ycc[0] * 255.0f,
+               ycc[1] * 255.0f,
+               ycc[2] * 255.0f,
+               &r_rgb[0],
+               &r_rgb[1],
+               &r_rgb[2],
+               mode_);
+  });
+#else
   for (; !it.is_end(); ++it) {
     const float *in = it.in(0);
     /* Multiply by 255 to un-normalize (#ycc_to_rgb needs input values in 0-255 range). */
@@ -332,6 +429,7 @@ void ConvertYCCToRGBOperation::update_memory_buffer_partial(BuffersIterator<floa
         in[0] * 255.0f, in[1] * 255.0f, in[2] * 255.0f, &it.out[0], &it.out[1], &it.out[2], mode_);
     it.out[3] = in[3];
   }
+#endif
 }
 
 /* ******** RGB to YUV ******** */
@@ -423,11 +521,37 @@ void ConvertRGBToHSVOperation::execute_pixel_sampled(float output[4],
 
 void ConvertRGBToHSVOperation::update_memory_buffer_partial(BuffersIterator<float> &it)
 {
+#ifdef BLI_HAVE_SSE2
+  /* Same as #rgb_to_hsv using masks instead of branches. */
+  convert_pixels_sse(
+      it,
+      [](__m128 &r, __m128 &g, __m128 &b) {
+        const __m128 g_less_b = _mm_cmplt_ps(g, b);
+        const __m128 g1 = select_sse(g_less_b, b, g);
+        const __m128 b1 = select_sse(g_less_b, g, b);
+        const __m128 k1 = _mm_and_ps(g_less_b, _mm_set1_ps(-1.0f));
+        const __m128 r_less_g = _mm_cmplt_ps(r, g1);
+        const __m128 r2 = select_sse(r_less_g, g1, r);
+        const __m128 g2 = select_sse(r_less_g, r, g1);
+        const __m128 k2 = select_sse(r_less_g, _mm_sub_ps(_mm_set1_ps(-2.0f / 6.0f), k1), k1);
+        const __m128 min_gb = select_sse(r_less_g, _mm_min_ps(g2, b1), b1);
+        const __m128 chroma = _mm_sub_ps(r2, min_gb);
+        const __m128 hue = _mm_add_ps(
+            k2,
+            _mm_div_ps(_mm_sub_ps(g2, b1),
+                       _mm_add_ps(_mm_mul_ps(_mm_set1_ps(6.0f), chroma), _mm_set1_ps(1e-20f))));
+        r = _mm_andnot_ps(_mm_set1_ps(-0.0f), hue);
+        g = _mm_div_ps(chroma, _mm_add_ps(r2, _mm_set1_ps(1e-20f)));
+        b = r2;
+      },
+      [](const float *in, float *out) { rgb_to_hsv_v(in, out); });
+#else
   for (; !it.is_end(); ++it) {
     const float *in = it.in(0);
     rgb_to_hsv_v(in, it.out);
     it.out[3] = in[3];
   }
+#endif
 }
 
 /* ******** HSV to RGB ******** */
@@ -454,6 +578,36 @@ void ConvertHSVToRGBOperation::execute_pixel_sampled(float output[4],
 
 void ConvertHSVToRGBOperation::update_memory_buffer_partial(BuffersIterator<float> &it)
 {
+#ifdef BLI_HAVE_SSE2
+  /* Same as #hsv_to_rgb. */
+  convert_pixels_sse(
+      it,
+      [](__m128 &h, __m128 &s, __m128 &v) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 sign_mask = _mm_set1_ps(-0.0f);
+        const __m128 h6 = _mm_mul_ps(h, _mm_set1_ps(6.0f));
+        __m128 nr = _mm_sub_ps(_mm_andnot_ps(sign_mask, _mm_sub_ps(h6, _mm_set1_ps(3.0f))), one);
+        __m128 ng = _mm_sub_ps(two, _mm_andnot_ps(sign_mask, _mm_sub_ps(h6, two)));
+        __m128 nb = _mm_sub_ps(two, _mm_andnot_ps(sign_mask, _mm_sub_ps(h6, _mm_set1_ps(4.0f))));
+        nr = _mm_min_ps(_mm_max_ps(nr, zero), one);
+        ng = _mm_min_ps(_mm_max_ps(ng, zero), one);
+        nb = _mm_min_ps(_mm_max_ps(nb, zero), one);
+        const __m128 r = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(nr, one), s), one), v);
+        const __m128 g = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(ng, one), s), one), v);
+        const __m128 b = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(nb, one), s), one), v);
+        h = _mm_max_ps(r, zero);
+        s = _mm_max_ps(g, zero);
+        v = _mm_max_ps(b, zero);
+      },
+      [](const float *in, float *out) {
+        hsv_to_rgb_v(in, out);
+        out[0] = max_ff(out[0], 0.0f);
+        out[1] = max_ff(out[1], 0.0f);
+        out[2] = max_ff(out[2], 0.0f);
+      });
+#else
   for (; !it.is_end(); ++it) {
     const float *in = it.in(0);
     hsv_to_rgb_v(in, it.out);
@@ -462,6 +616,7 @@ void ConvertHSVToRGBOperation::update_memory_buffer_partial(BuffersIterator<floa
     it.out[2] = max_ff(it.out[2], 0.0f);
     it.out[3] = in[3];
   }
+#endif
 }
 
 /* ******** RGB to HSL ******** */
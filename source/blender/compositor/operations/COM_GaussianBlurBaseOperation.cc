@@ -27,6 +27,15 @@ void GaussianBlurBaseOperation::init_data()
   }
 }
 
+void GaussianBlurBaseOperation::hash_output_params()
+{
+  hash_params(data_.sizex, data_.sizey, data_.relative);
+  hash_params(data_.percentx, data_.percenty, data_.aspect);
+  hash_params(data_.filtertype, data_.fac, int(data_.gamma));
+  hash_params(size_, rad_, filtersize_);
+  hash_params(dimension_, int(get_quality()), get_extend_bounds());
+}
+
 void GaussianBlurBaseOperation::init_execution()
 {
   BlurBaseOperation::init_execution();
@@ -17,6 +17,8 @@ class GaussianBlurBaseOperation : public BlurBaseOperation {
   float rad_;
   eDimension dimension_;
 
+  void hash_output_params() override;
+
  public:
   GaussianBlurBaseOperation(eDimension dim);
 
@@ -90,6 +90,18 @@ void BaseImageOperation::deinit_execution()
   }
 }
 
+void BaseImageOperation::hash_output_params()
+{
+  hash_params(image_ ? image_->id.session_uuid : 0, framenumber_);
+  if (image_user_) {
+    hash_params(image_user_->framenr, image_user_->tile, image_user_->view);
+    hash_params(image_user_->layer, image_user_->pass);
+  }
+  if (view_name_) {
+    hash_param(StringRef(view_name_));
+  }
+}
+
 void BaseImageOperation::determine_canvas(const rcti &UNUSED(preferred_area), rcti &r_area)
 {
   ImBuf *stackbuf = get_im_buf();
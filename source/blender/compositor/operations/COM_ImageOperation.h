@@ -43,6 +43,8 @@ class BaseImageOperation : public MultiThreadedOperation {
 
   virtual ImBuf *get_im_buf();
 
+  void hash_output_params() override;
+
  public:
   void init_execution() override;
   void deinit_execution() override;
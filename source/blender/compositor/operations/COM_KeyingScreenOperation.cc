@@ -23,6 +23,13 @@ KeyingScreenOperation::KeyingScreenOperation()
   cached_triangulation_ = nullptr;
 }
 
+void KeyingScreenOperation::hash_output_params()
+{
+  hash_params(movie_clip_ ? movie_clip_->id.session_uuid : 0,
+              framenumber_,
+              StringRef(tracking_object_));
+}
+
 void KeyingScreenOperation::init_execution()
 {
   init_mutex();
@@ -46,6 +46,8 @@ class KeyingScreenOperation : public MultiThreadedOperation {
 
   TriangulationData *build_voronoi_triangulation();
 
+  void hash_output_params() override;
+
  public:
   KeyingScreenOperation();
 
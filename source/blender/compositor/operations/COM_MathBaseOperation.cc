@@ -135,10 +135,21 @@ void MathDivideOperation::execute_pixel_sampled(float output[4],
 
 void MathDivideOperation::update_memory_buffer_partial(BuffersIterator<float> &it)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_partial_sse(
+      it,
+      [](__m128 dividend, __m128 divisor) {
+        /* Zero where dividing by zero. */
+        return _mm_and_ps(_mm_cmpneq_ps(divisor, _mm_setzero_ps()),
+                          _mm_div_ps(dividend, divisor));
+      },
+      [](float dividend, float divisor) { return (divisor == 0) ? 0 : dividend / divisor; });
+#else
   for (; !it.is_end(); ++it) {
     const float divisor = *it.in(1);
     *it.out = clamp_when_enabled((divisor == 0) ? 0 : *it.in(0) / divisor);
   }
+#endif
 }
 
 void MathSineOperation::execute_pixel_sampled(float output[4],
@@ -472,10 +483,17 @@ void MathMinimumOperation::execute_pixel_sampled(float output[4],
 
 void MathMinimumOperation::update_memory_buffer_partial(BuffersIterator<float> &it)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_partial_sse(
+      it,
+      [](__m128 a, __m128 b) { return _mm_min_ps(a, b); },
+      [](float a, float b) { return MIN2(a, b); });
+#else
   for (; !it.is_end(); ++it) {
     *it.out = MIN2(*it.in(0), *it.in(1));
     clamp_when_enabled(it.out);
   }
+#endif
 }
 
 void MathMaximumOperation::execute_pixel_sampled(float output[4],
@@ -496,10 +514,17 @@ void MathMaximumOperation::execute_pixel_sampled(float output[4],
 
 void MathMaximumOperation::update_memory_buffer_partial(BuffersIterator<float> &it)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_partial_sse(
+      it,
+      [](__m128 a, __m128 b) { return _mm_max_ps(a, b); },
+      [](float a, float b) { return MAX2(a, b); });
+#else
   for (; !it.is_end(); ++it) {
     *it.out = MAX2(*it.in(0), *it.in(1));
     clamp_when_enabled(it.out);
   }
+#endif
 }
 
 void MathRoundOperation::execute_pixel_sampled(float output[4],
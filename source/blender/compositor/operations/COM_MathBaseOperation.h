@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "BLI_simd.h"
+
 #include "COM_MultiThreadedOperation.h"
 
 namespace blender::compositor {
@@ -73,13 +75,88 @@ class MathBaseOperation : public MultiThreadedOperation {
 
  protected:
   virtual void update_memory_buffer_partial(BuffersIterator<float> &it) = 0;
+
+#ifdef BLI_HAVE_SSE2
+  /**
+   * Computes four contiguous elements of a row at once with `sse_fn(in1, in2)`. Elements that
+   * can't be grouped (row ends or non contiguous buffers) are computed with `fn(in1, in2)`.
+   */
+  template<typename TSSEFn, typename TFn>
+  void update_memory_buffer_partial_sse(BuffersIterator<float> &it, TSSEFn sse_fn, TFn fn)
+  {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const int in1_stride = it.get_in_elem_stride(0);
+    const int in2_stride = it.get_in_elem_stride(1);
+    const bool is_contiguous = it.get_out_elem_stride() == 1 && in1_stride <= 1 &&
+                               in2_stride <= 1;
+    while (!it.is_end()) {
+      int row_remaining = it.get_row_remaining();
+      if (is_contiguous) {
+        for (; row_remaining >= 4; row_remaining -= 4) {
+          /* Single element inputs have no stride. */
+          const __m128 in1 = in1_stride ? _mm_loadu_ps(it.in(0)) : _mm_set1_ps(*it.in(0));
+          const __m128 in2 = in2_stride ? _mm_loadu_ps(it.in(1)) : _mm_set1_ps(*it.in(1));
+          __m128 result = sse_fn(in1, in2);
+          if (use_clamp_) {
+            result = _mm_min_ps(_mm_max_ps(result, zero), one);
+          }
+          _mm_storeu_ps(it.out, result);
+          it.next(4);
+        }
+      }
+      for (; row_remaining > 0; row_remaining--) {
+        *it.out = fn(*it.in(0), *it.in(1));
+        clamp_when_enabled(it.out);
+        ++it;
+      }
+    }
+  }
+#endif
+};
+
+#ifdef BLI_HAVE_SSE2
+/** SSE version of standard functors, used to compute several elements at once. */
+template<template<typename> typename TFunctor> struct MathFunctorSSE {
+  static constexpr bool is_supported = false;
+};
+
+template<> struct MathFunctorSSE<std::plus> {
+  static constexpr bool is_supported = true;
+  __m128 operator()(__m128 a, __m128 b) const
+  {
+    return _mm_add_ps(a, b);
+  }
+};
+
+template<> struct MathFunctorSSE<std::minus> {
+  static constexpr bool is_supported = true;
+  __m128 operator()(__m128 a, __m128 b) const
+  {
+    return _mm_sub_ps(a, b);
+  }
 };
 
+template<> struct MathFunctorSSE<std::multiplies> {
+  static constexpr bool is_supported = true;
+  __m128 operator()(__m128 a, __m128 b) const
+  {
+    return _mm_mul_ps(a, b);
+  }
+};
+#endif
+
 template<template<typename> typename TFunctor>
 class MathFunctor2Operation : public MathBaseOperation {
   void update_memory_buffer_partial(BuffersIterator<float> &it) final
   {
     TFunctor functor;
+#ifdef BLI_HAVE_SSE2
+    if constexpr (MathFunctorSSE<TFunctor>::is_supported) {
+      update_memory_buffer_partial_sse(it, MathFunctorSSE<TFunctor>(), functor);
+      return;
+    }
+#endif
     for (; !it.is_end(); ++it) {
       *it.out = functor(*it.in(0), *it.in(1));
       clamp_when_enabled(it.out);
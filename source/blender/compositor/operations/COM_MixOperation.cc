@@ -52,6 +52,11 @@ void MixBaseOperation::execute_pixel_sampled(float output[4],
   output[3] = input_color1[3];
 }
 
+void MixBaseOperation::hash_output_params()
+{
+  hash_params(value_alpha_multiply_, use_clamp_);
+}
+
 void MixBaseOperation::determine_canvas(const rcti &preferred_area, rcti &r_area)
 {
   NodeOperationInput *socket;
@@ -121,6 +126,73 @@ void MixBaseOperation::update_memory_buffer_row(PixelCursor &p)
   }
 }
 
+#ifdef BLI_HAVE_SSE2
+template<typename TBlendFn>
+void MixBaseOperation::update_memory_buffer_row_sse(PixelCursor &p, TBlendFn blend_fn)
+{
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  /* Blend four pixels at once, transposed so that each register contains one channel of all of
+   * them. Alpha is taken from the first color. */
+  int row_remaining = (p.row_end - p.out) / p.out_stride;
+  for (; row_remaining >= 4; row_remaining -= 4) {
+    __m128 r1 = _mm_loadu_ps(p.color1);
+    __m128 g1 = _mm_loadu_ps(p.color1 + p.color1_stride);
+    __m128 b1 = _mm_loadu_ps(p.color1 + p.color1_stride * 2);
+    __m128 a1 = _mm_loadu_ps(p.color1 + p.color1_stride * 3);
+    _MM_TRANSPOSE4_PS(r1, g1, b1, a1);
+    __m128 r2 = _mm_loadu_ps(p.color2);
+    __m128 g2 = _mm_loadu_ps(p.color2 + p.color2_stride);
+    __m128 b2 = _mm_loadu_ps(p.color2 + p.color2_stride * 2);
+    __m128 a2 = _mm_loadu_ps(p.color2 + p.color2_stride * 3);
+    _MM_TRANSPOSE4_PS(r2, g2, b2, a2);
+
+    __m128 value = _mm_setr_ps(p.value[0],
+                               p.value[p.value_stride],
+                               p.value[p.value_stride * 2],
+                               p.value[p.value_stride * 3]);
+    if (this->use_value_alpha_multiply()) {
+      value = _mm_mul_ps(value, a2);
+    }
+    __m128 r = blend_fn(r1, r2, value);
+    __m128 g = blend_fn(g1, g2, value);
+    __m128 b = blend_fn(b1, b2, value);
+    __m128 a = a1;
+    if (use_clamp_) {
+      r = _mm_min_ps(_mm_max_ps(r, zero), one);
+      g = _mm_min_ps(_mm_max_ps(g, zero), one);
+      b = _mm_min_ps(_mm_max_ps(b, zero), one);
+      a = _mm_min_ps(_mm_max_ps(a, zero), one);
+    }
+    _MM_TRANSPOSE4_PS(r, g, b, a);
+    _mm_storeu_ps(p.out, r);
+    _mm_storeu_ps(p.out + p.out_stride, g);
+    _mm_storeu_ps(p.out + p.out_stride * 2, b);
+    _mm_storeu_ps(p.out + p.out_stride * 3, a);
+    p.next(4);
+  }
+
+  /* Remaining pixels of the row, with all channels of a pixel in one register. */
+  const __m128 rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+  for (; row_remaining > 0; row_remaining--) {
+    float value = p.value[0];
+    if (this->use_value_alpha_multiply()) {
+      value *= p.color2[3];
+    }
+    const __m128 color1 = _mm_loadu_ps(p.color1);
+    const __m128 color2 = _mm_loadu_ps(p.color2);
+    __m128 result = blend_fn(color1, color2, _mm_set1_ps(value));
+    result = _mm_or_ps(_mm_and_ps(rgb_mask, result), _mm_andnot_ps(rgb_mask, color1));
+    if (use_clamp_) {
+      result = _mm_min_ps(_mm_max_ps(result, zero), one);
+    }
+    _mm_storeu_ps(p.out, result);
+    p.next();
+  }
+}
+#endif
+
 /* ******** Mix Add Operation ******** */
 
 void MixAddOperation::execute_pixel_sampled(float output[4],
@@ -150,6 +222,11 @@ void MixAddOperation::execute_pixel_sampled(float output[4],
 
 void MixAddOperation::update_memory_buffer_row(PixelCursor &p)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_row_sse(p, [](__m128 color1, __m128 color2, __m128 value) {
+    return _mm_add_ps(color1, _mm_mul_ps(value, color2));
+  });
+#else
   while (p.out < p.row_end) {
     float value = p.value[0];
     if (this->use_value_alpha_multiply()) {
@@ -163,6 +240,7 @@ void MixAddOperation::update_memory_buffer_row(PixelCursor &p)
     clamp_if_needed(p.out);
     p.next();
   }
+#endif
 }
 
 /* ******** Mix Blend Operation ******** */
@@ -196,6 +274,12 @@ void MixBlendOperation::execute_pixel_sampled(float output[4],
 
 void MixBlendOperation::update_memory_buffer_row(PixelCursor &p)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_row_sse(p, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 value_m = _mm_sub_ps(_mm_set1_ps(1.0f), value);
+    return _mm_add_ps(_mm_mul_ps(value_m, color1), _mm_mul_ps(value, color2));
+  });
+#else
   while (p.out < p.row_end) {
     float value = p.value[0];
     if (this->use_value_alpha_multiply()) {
@@ -210,6 +294,7 @@ void MixBlendOperation::update_memory_buffer_row(PixelCursor &p)
     clamp_if_needed(p.out);
     p.next();
   }
+#endif
 }
 
 /* ******** Mix Burn Operation ******** */
@@ -432,6 +517,12 @@ void MixDarkenOperation::execute_pixel_sampled(float output[4],
 
 void MixDarkenOperation::update_memory_buffer_row(PixelCursor &p)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_row_sse(p, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 value_m = _mm_sub_ps(_mm_set1_ps(1.0f), value);
+    return _mm_add_ps(_mm_mul_ps(_mm_min_ps(color1, color2), value), _mm_mul_ps(color1, value_m));
+  });
+#else
   while (p.out < p.row_end) {
     float value = p.value[0];
     if (this->use_value_alpha_multiply()) {
@@ -446,6 +537,7 @@ void MixDarkenOperation::update_memory_buffer_row(PixelCursor &p)
     clamp_if_needed(p.out);
     p.next();
   }
+#endif
 }
 
 /* ******** Mix Difference Operation ******** */
@@ -478,6 +570,13 @@ void MixDifferenceOperation::execute_pixel_sampled(float output[4],
 
 void MixDifferenceOperation::update_memory_buffer_row(PixelCursor &p)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_row_sse(p, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 value_m = _mm_sub_ps(_mm_set1_ps(1.0f), value);
+    const __m128 difference = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(color1, color2));
+    return _mm_add_ps(_mm_mul_ps(value_m, color1), _mm_mul_ps(value, difference));
+  });
+#else
   while (p.out < p.row_end) {
     float value = p.value[0];
     if (this->use_value_alpha_multiply()) {
@@ -492,6 +591,7 @@ void MixDifferenceOperation::update_memory_buffer_row(PixelCursor &p)
     clamp_if_needed(p.out);
     p.next();
   }
+#endif
 }
 
 /* ******** Mix Difference Operation ******** */
@@ -541,6 +641,15 @@ void MixDivideOperation::execute_pixel_sampled(float output[4],
 
 void MixDivideOperation::update_memory_buffer_row(PixelCursor &p)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_row_sse(p, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 value_m = _mm_sub_ps(_mm_set1_ps(1.0f), value);
+    const __m128 divided = _mm_add_ps(_mm_mul_ps(value_m, color1),
+                                      _mm_div_ps(_mm_mul_ps(value, color1), color2));
+    /* Zero where dividing by zero. */
+    return _mm_and_ps(_mm_cmpneq_ps(color2, _mm_setzero_ps()), divided);
+  });
+#else
   while (p.out < p.row_end) {
     float value = p.value[0];
     if (this->use_value_alpha_multiply()) {
@@ -572,6 +681,7 @@ void MixDivideOperation::update_memory_buffer_row(PixelCursor &p)
     clamp_if_needed(p.out);
     p.next();
   }
+#endif
 }
 
 /* ******** Mix Dodge Operation ******** */
@@ -895,6 +1005,11 @@ void MixLightenOperation::execute_pixel_sampled(float output[4],
 
 void MixLightenOperation::update_memory_buffer_row(PixelCursor &p)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_row_sse(p, [](__m128 color1, __m128 color2, __m128 value) {
+    return _mm_max_ps(_mm_mul_ps(value, color2), color1);
+  });
+#else
   while (p.out < p.row_end) {
     float value = p.value[0];
     if (this->use_value_alpha_multiply()) {
@@ -915,6 +1030,7 @@ void MixLightenOperation::update_memory_buffer_row(PixelCursor &p)
     clamp_if_needed(p.out);
     p.next();
   }
+#endif
 }
 
 /* ******** Mix Linear Light Operation ******** */
@@ -962,6 +1078,16 @@ void MixLinearLightOperation::execute_pixel_sampled(float output[4],
 
 void MixLinearLightOperation::update_memory_buffer_row(PixelCursor &p)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_row_sse(p, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 is_bright = _mm_cmpgt_ps(color2, _mm_set1_ps(0.5f));
+    const __m128 bright = _mm_mul_ps(two, _mm_sub_ps(color2, _mm_set1_ps(0.5f)));
+    const __m128 dark = _mm_sub_ps(_mm_mul_ps(two, color2), _mm_set1_ps(1.0f));
+    const __m128 light = _mm_or_ps(_mm_and_ps(is_bright, bright), _mm_andnot_ps(is_bright, dark));
+    return _mm_add_ps(color1, _mm_mul_ps(value, light));
+  });
+#else
   while (p.out < p.row_end) {
     float value = p.value[0];
     if (this->use_value_alpha_multiply()) {
@@ -991,6 +1117,7 @@ void MixLinearLightOperation::update_memory_buffer_row(PixelCursor &p)
     clamp_if_needed(p.out);
     p.next();
   }
+#endif
 }
 
 /* ******** Mix Multiply Operation ******** */
@@ -1023,6 +1150,12 @@ void MixMultiplyOperation::execute_pixel_sampled(float output[4],
 
 void MixMultiplyOperation::update_memory_buffer_row(PixelCursor &p)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_row_sse(p, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 value_m = _mm_sub_ps(_mm_set1_ps(1.0f), value);
+    return _mm_mul_ps(color1, _mm_add_ps(value_m, _mm_mul_ps(value, color2)));
+  });
+#else
   while (p.out < p.row_end) {
     float value = p.value[0];
     if (this->use_value_alpha_multiply()) {
@@ -1038,6 +1171,7 @@ void MixMultiplyOperation::update_memory_buffer_row(PixelCursor &p)
     clamp_if_needed(p.out);
     p.next();
   }
+#endif
 }
 
 /* ******** Mix Overlay Operation ******** */
@@ -1217,6 +1351,15 @@ void MixScreenOperation::execute_pixel_sampled(float output[4],
 
 void MixScreenOperation::update_memory_buffer_row(PixelCursor &p)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_row_sse(p, [](__m128 color1, __m128 color2, __m128 value) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 value_m = _mm_sub_ps(one, value);
+    const __m128 screen = _mm_mul_ps(
+        _mm_add_ps(value_m, _mm_mul_ps(value, _mm_sub_ps(one, color2))), _mm_sub_ps(one, color1));
+    return _mm_sub_ps(one, screen);
+  });
+#else
   while (p.out < p.row_end) {
     float value = p.value[0];
     if (this->use_value_alpha_multiply()) {
@@ -1232,6 +1375,7 @@ void MixScreenOperation::update_memory_buffer_row(PixelCursor &p)
     clamp_if_needed(p.out);
     p.next();
   }
+#endif
 }
 
 /* ******** Mix Soft Light Operation ******** */
@@ -1332,6 +1476,11 @@ void MixSubtractOperation::execute_pixel_sampled(float output[4],
 
 void MixSubtractOperation::update_memory_buffer_row(PixelCursor &p)
 {
+#ifdef BLI_HAVE_SSE2
+  update_memory_buffer_row_sse(p, [](__m128 color1, __m128 color2, __m128 value) {
+    return _mm_sub_ps(color1, _mm_mul_ps(value, color2));
+  });
+#else
   while (p.out < p.row_end) {
     float value = p.value[0];
     if (this->use_value_alpha_multiply()) {
@@ -1345,6 +1494,7 @@ void MixSubtractOperation::update_memory_buffer_row(PixelCursor &p)
     clamp_if_needed(p.out);
     p.next();
   }
+#endif
 }
 
 /* ******** Mix Value Operation ******** */
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "BLI_simd.h"
+
 #include "COM_MultiThreadedOperation.h"
 
 namespace blender::compositor {
@@ -33,6 +35,15 @@ class MixBaseOperation : public MultiThreadedOperation {
       color1 += color1_stride;
       color2 += color2_stride;
     }
+
+    void next(const int num)
+    {
+      BLI_assert(out + out_stride * (num - 1) < row_end);
+      out += out_stride * num;
+      value += value_stride * num;
+      color1 += color1_stride * num;
+      color2 += color2_stride * num;
+    }
   };
 
   /**
@@ -44,6 +55,8 @@ class MixBaseOperation : public MultiThreadedOperation {
   bool value_alpha_multiply_;
   bool use_clamp_;
 
+  void hash_output_params() override;
+
   inline void clamp_if_needed(float color[4])
   {
     if (use_clamp_) {
@@ -93,6 +106,14 @@ class MixBaseOperation : public MultiThreadedOperation {
 
  protected:
   virtual void update_memory_buffer_row(PixelCursor &p);
+#ifdef BLI_HAVE_SSE2
+  /**
+   * Row loop for blend modes that compute every channel independently of the others.
+   * `blend_fn(color1, color2, value)` returns the blended channel values, either of one channel
+   * of four pixels or of all channels of one pixel. Alpha is always taken from first color.
+   */
+  template<typename TBlendFn> void update_memory_buffer_row_sse(PixelCursor &p, TBlendFn blend_fn);
+#endif
 };
 
 class MixAddOperation : public MixBaseOperation {
@@ -44,6 +44,14 @@ void MovieClipBaseOperation::init_execution()
   }
 }
 
+void MovieClipBaseOperation::hash_output_params()
+{
+  hash_params(movie_clip_ ? movie_clip_->id.session_uuid : 0, framenumber_, cache_frame_);
+  if (movie_clip_user_) {
+    hash_params(movie_clip_user_->render_size, movie_clip_user_->render_flag);
+  }
+}
+
 void MovieClipBaseOperation::deinit_execution()
 {
   if (movie_clip_buffer_) {
@@ -27,6 +27,7 @@ class MovieClipBaseOperation : public MultiThreadedOperation {
    * Determine the output resolution. The resolution is retrieved from the Renderer
    */
   void determine_canvas(const rcti &preferred_area, rcti &r_area) override;
+  void hash_output_params() override;
 
  public:
   MovieClipBaseOperation();
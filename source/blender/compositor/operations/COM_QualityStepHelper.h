@@ -32,6 +32,10 @@ class QualityStepHelper {
   {
     return offsetadd_;
   }
+  inline eCompositorQuality get_quality() const
+  {
+    return quality_;
+  }
 
  public:
   QualityStepHelper();
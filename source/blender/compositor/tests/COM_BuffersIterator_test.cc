@@ -281,4 +281,60 @@ TEST_F(BuffersIteratorTest, OutputAndInputsIteration)
       });
 }
 
+static void iterate_coordinates_by_pairs(BuffersIterator<float> &it, const rcti &area)
+{
+  int x = area.xmin;
+  int y = area.ymin;
+  while (!it.is_end()) {
+    EXPECT_EQ(x, it.x);
+    EXPECT_EQ(y, it.y);
+    EXPECT_EQ(it.get_row_remaining(), area.xmax - x);
+    const int num_elems = min_ii(2, it.get_row_remaining());
+    it.next(num_elems);
+    x += num_elems;
+    if (x == area.xmax) {
+      x = area.xmin;
+      y++;
+    }
+  }
+  EXPECT_EQ(x, area.xmin);
+  EXPECT_EQ(y, area.ymax);
+}
+
+TEST_F(BuffersIteratorTest, CoordinatesIterationByPairsWithNoInputs)
+{
+  set_inputs_enabled(false);
+  test_iteration(iterate_coordinates_by_pairs);
+}
+
+TEST_F(BuffersIteratorTest, OutputAndInputsIterationByPairs)
+{
+  set_inputs_enabled(true);
+  test_iteration(
+      [](BuffersIterator<float> &it, const rcti &UNUSED(area)) {
+        EXPECT_EQ(it.get_out_elem_stride(), NUM_CHANNELS);
+        while (!it.is_end()) {
+          const int num_elems = min_ii(2, it.get_row_remaining());
+          for (int i = 0; i < num_elems; i++) {
+            const float *in1 = it.in(0) + i * it.get_in_elem_stride(0);
+            const float *in2 = it.in(1) + i * it.get_in_elem_stride(1);
+            float *out = it.out + i * it.get_out_elem_stride();
+            out[0] = in1[0] + in2[0];
+            out[1] = in1[1] + in2[3];
+            out[2] = in1[2] - in2[2];
+            out[3] = in1[3] - in2[1];
+          }
+          it.next(num_elems);
+        }
+      },
+      [](float *out, Span<const float *> ins, const int UNUSED(x), const int UNUSED(y)) {
+        const float *in1 = ins[0];
+        const float *in2 = ins[1];
+        EXPECT_NEAR(out[0], in1[0] + in2[0], FLT_EPSILON);
+        EXPECT_NEAR(out[1], in1[1] + in2[3], FLT_EPSILON);
+        EXPECT_NEAR(out[2], in1[2] - in2[2], FLT_EPSILON);
+        EXPECT_NEAR(out[3], in1[3] - in2[1], FLT_EPSILON);
+      });
+}
+
 }  // namespace blender::compositor::tests
@@ -0,0 +1,191 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+
+#include "COM_ConvertOperation.h"
+#include "COM_MathBaseOperation.h"
+#include "COM_MixOperation.h"
+
+namespace blender::compositor::tests {
+
+/* Wide enough for areas of every length up to two SSE vectors past the end of a row, starting
+ * at unaligned offsets. */
+static constexpr int BUF_WIDTH = 16;
+static constexpr int BUF_HEIGHT = 2;
+static constexpr int MAX_AREA_OFFSET = 3;
+static constexpr int MAX_AREA_WIDTH = 9;
+
+/** Reads a buffer per pixel, as input operations do in the tiled execution model. */
+class BufferReaderOperation : public NodeOperation {
+ private:
+  const MemoryBuffer *buffer_;
+
+ public:
+  BufferReaderOperation(DataType data_type, const MemoryBuffer *buffer) : buffer_(buffer)
+  {
+    add_output_socket(data_type);
+  }
+
+ protected:
+  void execute_pixel_sampled(float output[4],
+                             float x,
+                             float y,
+                             PixelSampler UNUSED(sampler)) override
+  {
+    buffer_->read_elem_checked(x, y, output);
+  }
+};
+
+static std::unique_ptr<MemoryBuffer> create_random_buffer(DataType data_type,
+                                                          bool is_a_single_elem,
+                                                          float min,
+                                                          float max,
+                                                          RandomNumberGenerator &rng)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, BUF_WIDTH, 0, BUF_HEIGHT);
+  std::unique_ptr<MemoryBuffer> buf = std::make_unique<MemoryBuffer>(
+      data_type, rect, is_a_single_elem);
+  const int64_t num_floats = is_a_single_elem ? buf->get_num_channels() :
+                                                int64_t(BUF_WIDTH) * BUF_HEIGHT *
+                                                    buf->get_num_channels();
+  float *data = buf->get_buffer();
+  for (const int64_t i : IndexRange(num_floats)) {
+    /* Include zeros to cover divisions by zero. */
+    data[i] = (i % 5 == 4) ? 0.0f : min + (max - min) * rng.get_float();
+  }
+  return buf;
+}
+
+/**
+ * Renders areas of all lengths up to #MAX_AREA_WIDTH at aligned and unaligned offsets with the
+ * full frame implementation of the operation, which uses SIMD kernels where available, and
+ * compares every pixel with the per pixel implementation, which has no SIMD code paths.
+ *
+ * `TBaseOperation` is the class declaring the full frame implementation, subclasses hide it.
+ */
+template<typename TBaseOperation>
+static void expect_full_frame_matches_per_pixel(TBaseOperation &op,
+                                                Span<bool> single_elem_inputs,
+                                                float min,
+                                                float max)
+{
+  RandomNumberGenerator rng(0);
+  Vector<std::unique_ptr<MemoryBuffer>> input_bufs;
+  Vector<std::unique_ptr<BufferReaderOperation>> readers;
+  Vector<MemoryBuffer *> inputs;
+  for (const int i : IndexRange(op.get_number_of_input_sockets())) {
+    const DataType data_type = op.get_input_socket(i)->get_data_type();
+    const bool is_a_single_elem = i < single_elem_inputs.size() && single_elem_inputs[i];
+    input_bufs.append(create_random_buffer(data_type, is_a_single_elem, min, max, rng));
+    readers.append(std::make_unique<BufferReaderOperation>(data_type, input_bufs.last().get()));
+    op.get_input_socket(i)->set_link(readers.last()->get_output_socket());
+    inputs.append(input_bufs.last().get());
+  }
+  op.init_execution();
+
+  rcti rect;
+  BLI_rcti_init(&rect, 0, BUF_WIDTH, 0, BUF_HEIGHT);
+  MemoryBuffer output(op.get_output_socket()->get_data_type(), rect);
+  for (const int offset : IndexRange(MAX_AREA_OFFSET + 1)) {
+    for (const int width : IndexRange(1, MAX_AREA_WIDTH)) {
+      rcti area;
+      BLI_rcti_init(&area, offset, offset + width, 0, BUF_HEIGHT);
+      op.update_memory_buffer_partial(&output, area, inputs);
+
+      for (const int y : IndexRange(BUF_HEIGHT)) {
+        for (const int x : IndexRange(offset, width)) {
+          float expected[4];
+          op.read_sampled(expected, x, y, PixelSampler::Nearest);
+          const float *result = output.get_elem(x, y);
+          for (const int c : IndexRange(output.get_num_channels())) {
+            EXPECT_NEAR(result[c], expected[c], 1e-5f * max_ff(1.0f, fabsf(expected[c])))
+                << "offset " << offset << ", width " << width << ", pixel (" << x << ", " << y
+                << "), channel " << c;
+          }
+        }
+      }
+    }
+  }
+  op.deinit_execution();
+}
+
+template<typename TOperation> static void test_mix_operation()
+{
+  for (const bool use_clamp : {false, true}) {
+    for (const bool use_alpha : {false, true}) {
+      for (const bool single_elem_value : {false, true}) {
+        TOperation op;
+        op.set_use_clamp(use_clamp);
+        op.set_use_value_alpha_multiply(use_alpha);
+        expect_full_frame_matches_per_pixel<MixBaseOperation>(
+            op, {single_elem_value, false, false}, -2.0f, 2.0f);
+      }
+    }
+  }
+}
+
+template<typename TOperation> static void test_math_operation()
+{
+  for (const bool use_clamp : {false, true}) {
+    for (const bool single_elem_second : {false, true}) {
+      TOperation op;
+      op.set_use_clamp(use_clamp);
+      expect_full_frame_matches_per_pixel<MathBaseOperation>(
+          op, {false, single_elem_second, false}, -2.0f, 2.0f);
+    }
+  }
+}
+
+template<typename TOperation> static void test_convert_operation(TOperation &op)
+{
+  expect_full_frame_matches_per_pixel<ConvertBaseOperation>(op, {}, 0.0f, 1.0f);
+}
+
+TEST(SIMDOperations, mix)
+{
+  test_mix_operation<MixAddOperation>();
+  test_mix_operation<MixBlendOperation>();
+  test_mix_operation<MixDarkenOperation>();
+  test_mix_operation<MixDifferenceOperation>();
+  test_mix_operation<MixDivideOperation>();
+  test_mix_operation<MixLightenOperation>();
+  test_mix_operation<MixLinearLightOperation>();
+  test_mix_operation<MixMultiplyOperation>();
+  test_mix_operation<MixScreenOperation>();
+  test_mix_operation<MixSubtractOperation>();
+}
+
+TEST(SIMDOperations, math)
+{
+  test_math_operation<MathAddOperation>();
+  test_math_operation<MathSubtractOperation>();
+  test_math_operation<MathMultiplyOperation>();
+  test_math_operation<MathDivideOperation>();
+  test_math_operation<MathMinimumOperation>();
+  test_math_operation<MathMaximumOperation>();
+}
+
+TEST(SIMDOperations, convert)
+{
+  for (const int mode : {0, 1, 2}) {
+    ConvertRGBToYCCOperation rgb_to_ycc;
+    rgb_to_ycc.set_mode(mode);
+    test_convert_operation(rgb_to_ycc);
+
+    ConvertYCCToRGBOperation ycc_to_rgb;
+    ycc_to_rgb.set_mode(mode);
+    test_convert_operation(ycc_to_rgb);
+  }
+
+  ConvertRGBToHSVOperation rgb_to_hsv;
+  test_convert_operation(rgb_to_hsv);
+
+  ConvertHSVToRGBOperation hsv_to_rgb;
+  test_convert_operation(hsv_to_rgb);
+}
+
+}  // namespace blender::compositor::tests
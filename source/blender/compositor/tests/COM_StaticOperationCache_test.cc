@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "testing/testing.h"
+
+#include "COM_MemoryBuffer.h"
+#include "COM_StaticOperationCache.h"
+
+namespace blender::compositor::tests {
+
+static constexpr int BUF_WIDTH = 4;
+static constexpr int BUF_HEIGHT = 2;
+static constexpr size_t BUF_MEM_SIZE = BUF_WIDTH * BUF_HEIGHT * sizeof(float);
+
+static std::unique_ptr<MemoryBuffer> create_value_buffer(float value)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, BUF_WIDTH, 0, BUF_HEIGHT);
+  std::unique_ptr<MemoryBuffer> buf = std::make_unique<MemoryBuffer>(DataType::Value, rect);
+  buf->fill(rect, &value);
+  return buf;
+}
+
+TEST(StaticOperationCache, store_and_lookup)
+{
+  StaticOperationCache cache(BUF_MEM_SIZE * 2);
+  EXPECT_EQ(cache.lookup(1), nullptr);
+
+  std::unique_ptr<MemoryBuffer> buf = create_value_buffer(3.0f);
+  cache.store(1, *buf);
+  buf = nullptr;
+
+  const MemoryBuffer *cached_buf = cache.lookup(1);
+  ASSERT_NE(cached_buf, nullptr);
+  EXPECT_EQ(cached_buf->get_width(), BUF_WIDTH);
+  EXPECT_EQ(cached_buf->get_height(), BUF_HEIGHT);
+  EXPECT_EQ(*cached_buf->get_elem(BUF_WIDTH - 1, BUF_HEIGHT - 1), 3.0f);
+  EXPECT_EQ(cache.get_mem_in_use(), BUF_MEM_SIZE);
+
+  cache.clear();
+  EXPECT_EQ(cache.lookup(1), nullptr);
+  EXPECT_EQ(cache.get_mem_in_use(), 0);
+}
+
+TEST(StaticOperationCache, memory_limit)
+{
+  StaticOperationCache cache(BUF_MEM_SIZE * 2);
+  cache.store(1, *create_value_buffer(1.0f));
+  cache.store(2, *create_value_buffer(2.0f));
+  /* Make 1 the most recently used. */
+  cache.lookup(1);
+
+  cache.store(3, *create_value_buffer(3.0f));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(3));
+  EXPECT_EQ(cache.get_mem_in_use(), BUF_MEM_SIZE * 2);
+
+  /* Buffers bigger than the limit are never stored. */
+  StaticOperationCache small_cache(BUF_MEM_SIZE - 1);
+  small_cache.store(1, *create_value_buffer(1.0f));
+  EXPECT_FALSE(small_cache.contains(1));
+}
+
+TEST(StaticOperationCache, keep_buffers_used_by_execution)
+{
+  StaticOperationCache cache(BUF_MEM_SIZE * 2);
+  cache.store(1, *create_value_buffer(1.0f));
+  cache.store(2, *create_value_buffer(2.0f));
+
+  cache.begin_execution();
+  cache.lookup(1);
+  cache.store(3, *create_value_buffer(3.0f));
+  EXPECT_TRUE(cache.contains(1));
+  EXPECT_FALSE(cache.contains(2));
+  EXPECT_TRUE(cache.contains(3));
+
+  /* All buffers are in use by current execution, nothing can be freed. */
+  cache.store(4, *create_value_buffer(4.0f));
+  EXPECT_FALSE(cache.contains(4));
+  EXPECT_EQ(cache.size(), 2);
+
+  cache.begin_execution();
+  cache.store(4, *create_value_buffer(4.0f));
+  EXPECT_TRUE(cache.contains(4));
+}
+
+}  // namespace blender::compositor::tests
@@ -67,6 +67,16 @@ void DEG_graph_relations_update(struct Depsgraph *graph);
 /** Tag all relations in the database for update. */
 void DEG_relations_tag_update(struct Main *bmain);
 
+/**
+ * Tag relations of the given ID for update in all dependency graphs.
+ *
+ * Unlike #DEG_relations_tag_update, relations of other IDs are kept when the graph is updated,
+ * only relations from and to the given ID are built again. Use when the change only affects how
+ * the ID depends on other IDs, such as adding a constraint or a modifier. Changes which add or
+ * remove IDs from the view layer need #DEG_relations_tag_update.
+ */
+void DEG_id_tag_relations_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /**
@@ -52,6 +52,21 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* ************************************************ */
+/* Evaluation Tracing */
+
+/**
+ * Start recording a timeline of the evaluation of all dependency graphs: every evaluated
+ * operation with the thread it ran on and the time it waited to be evaluated after it got
+ * scheduled. Must not be called while dependency graphs are being evaluated.
+ */
+void DEG_debug_trace_begin(const char *filepath);
+/**
+ * Stop recording and write the timeline to the file passed to #DEG_debug_trace_begin, in the
+ * Chrome trace event format. Does nothing when not recording.
+ */
+void DEG_debug_trace_end(void);
+
 /* ************************************************ */
 
 /** Compare two dependency graphs. */
@@ -0,0 +1,334 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/deg_builder_incremental.h"
+
+#include <cstdio>
+
+#include "BKE_global.h"
+#include "BKE_lib_id.h"
+
+#include "DNA_ID.h"
+
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_physics.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+#include "intern/node/deg_node_time.h"
+
+namespace blender::deg {
+
+namespace {
+
+/* Session UUID of the ID the node belongs to, zero for nodes which do not belong to an ID. */
+uint node_id_session_uuid(const Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return MAIN_ID_SESSION_UUID_UNSET;
+  }
+  const OperationNode *operation_node = static_cast<const OperationNode *>(node);
+  return operation_node->owner->owner->id_orig_session_uuid;
+}
+
+/* Operations of a component of the graph which is being built. */
+template<typename Func> void foreach_built_operation(const IDNode *id_node, const Func &func)
+{
+  for (ComponentNode *comp_node : id_node->components.values()) {
+    for (OperationNode *op_node : comp_node->operations_map->values()) {
+      func(op_node);
+    }
+  }
+}
+
+/* Node identifier which includes the owner ID and component. */
+string node_description(const Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return node->identifier();
+  }
+  const OperationNode *op_node = static_cast<const OperationNode *>(node);
+  const ComponentNode *comp_node = op_node->owner;
+  string description = comp_node->owner->name + "/" + nodeTypeAsString(comp_node->type) + "(" +
+                       comp_node->name + ")/" + op_node->identifier();
+  if (op_node->name_tag != -1) {
+    description += "[" + to_string(op_node->name_tag) + "]";
+  }
+  return description;
+}
+
+}  // namespace
+
+IncrementalRelationsUpdate::IncrementalRelationsUpdate(Depsgraph *graph)
+    : graph_(graph), previous_time_source_(nullptr), num_previous_operations_(0)
+{
+}
+
+IncrementalRelationsUpdate::~IncrementalRelationsUpdate()
+{
+  /* Copy-on-write data-blocks were handed over to the new nodes, so only the nodes and the
+   * relations between them are freed here. */
+  for (IDNode *id_node : previous_id_nodes_) {
+    delete id_node;
+  }
+  delete previous_time_source_;
+}
+
+bool IncrementalRelationsUpdate::is_possible(const Depsgraph *graph)
+{
+  if (!graph->need_update_relations || graph->need_update_all_relations) {
+    return false;
+  }
+  if (graph->id_nodes.is_empty()) {
+    return false;
+  }
+  /* Relations to effectors and colliders are collected from the entire view layer. */
+  for (int i = 0; i < DEG_PHYSICS_RELATIONS_NUM; i++) {
+    if (graph->physics_relations[i] != nullptr) {
+      return false;
+    }
+  }
+  /* Transitive reduction removes relations without them being rebuilt. */
+  if (G.debug_value == 799) {
+    return false;
+  }
+  return true;
+}
+
+void IncrementalRelationsUpdate::take_previous_nodes()
+{
+  BLI_assert(previous_id_nodes_.is_empty());
+  previous_id_nodes_ = std::move(graph_->id_nodes);
+  previous_time_source_ = graph_->time_source;
+  num_previous_operations_ = graph_->operations.size();
+
+  graph_->id_nodes.clear();
+  graph_->id_hash.clear();
+  graph_->time_source = nullptr;
+}
+
+void IncrementalRelationsUpdate::reuse_relations(DepsgraphRelationBuilder &relation_builder)
+{
+  Map<uint, IDNode *> id_nodes_by_session_uuid;
+  id_nodes_by_session_uuid.reserve(graph_->id_nodes.size());
+  for (IDNode *id_node : graph_->id_nodes) {
+    id_nodes_by_session_uuid.add_new(id_node->id_orig_session_uuid, id_node);
+  }
+
+  /* Match nodes of the previous state of the graph with the new ones. IDs are matched by their
+   * session UUID since original data-blocks might have been freed. */
+  node_map_.reserve(num_previous_operations_ + 1);
+  if (previous_time_source_ != nullptr && graph_->time_source != nullptr) {
+    node_map_.add_new(previous_time_source_, graph_->time_source);
+  }
+  Set<uint> previous_id_session_uuids;
+  Set<uint> changed_id_session_uuids = graph_->relations_update_id_session_uuids;
+  for (const IDNode *id_node : previous_id_nodes_) {
+    const uint session_uuid = id_node->id_orig_session_uuid;
+    previous_id_session_uuids.add_new(session_uuid);
+    const IDNode *new_id_node = id_nodes_by_session_uuid.lookup_default(session_uuid, nullptr);
+    if (new_id_node == nullptr) {
+      continue;
+    }
+    bool is_changed = false;
+    int64_t num_operations = 0;
+    for (const ComponentNode *comp_node : id_node->components.values()) {
+      const ComponentNode *new_comp_node = new_id_node->find_component(comp_node->type,
+                                                                       comp_node->name.c_str());
+      for (OperationNode *op_node : comp_node->operations) {
+        num_operations++;
+        OperationNode *new_op_node = nullptr;
+        if (new_comp_node != nullptr) {
+          new_op_node = new_comp_node->find_operation(
+              op_node->opcode, op_node->name.c_str(), op_node->name_tag);
+        }
+        if (new_op_node == nullptr) {
+          is_changed = true;
+          continue;
+        }
+        node_map_.add_new(op_node, new_op_node);
+      }
+    }
+    int64_t num_new_operations = 0;
+    foreach_built_operation(new_id_node, [&](OperationNode * /*op_node*/) {
+      num_new_operations++;
+    });
+    if (is_changed || num_operations != num_new_operations) {
+      changed_id_session_uuids.add(session_uuid);
+    }
+  }
+
+  /* Find IDs whose relations are to be built again. The dependency of an ID on a changed one is
+   * always expressed by a relation between their nodes, so it is enough to look at direct
+   * neighbors of the changed IDs. */
+  Set<uint> rebuild_id_session_uuids = changed_id_session_uuids;
+  for (const IDNode *id_node : previous_id_nodes_) {
+    const bool is_id_changed = changed_id_session_uuids.contains(id_node->id_orig_session_uuid);
+    for (const ComponentNode *comp_node : id_node->components.values()) {
+      for (const OperationNode *op_node : comp_node->operations) {
+        for (const Relation *rel : op_node->inlinks) {
+          const uint owner_session_uuid = rel->owner_session_uuid;
+          if (owner_session_uuid == MAIN_ID_SESSION_UUID_UNSET) {
+            continue;
+          }
+          if (is_id_changed || !node_map_.contains(rel->from) || !node_map_.contains(op_node) ||
+              changed_id_session_uuids.contains(node_id_session_uuid(rel->from))) {
+            rebuild_id_session_uuids.add(owner_session_uuid);
+          }
+        }
+      }
+    }
+  }
+
+  /* Transfer relations of IDs which are not rebuilt. Relations which are not owned by any ID are
+   * always built by the relations builder, so they are not transferred. Relations added by
+   * multiple IDs are kept as long as their nodes exist: an owner which is not rebuilt will not
+   * add them again. */
+  for (const IDNode *id_node : previous_id_nodes_) {
+    for (const ComponentNode *comp_node : id_node->components.values()) {
+      for (const OperationNode *op_node : comp_node->operations) {
+        for (const Relation *rel : op_node->inlinks) {
+          const uint owner_session_uuid = rel->owner_session_uuid;
+          if (owner_session_uuid == MAIN_ID_SESSION_UUID_UNSET) {
+            continue;
+          }
+          if ((rel->flag & RELATION_FLAG_MULTIPLE_OWNERS) == 0 &&
+              (rebuild_id_session_uuids.contains(owner_session_uuid) ||
+               !id_nodes_by_session_uuid.contains(owner_session_uuid))) {
+            continue;
+          }
+          Node *from = node_map_.lookup_default(rel->from, nullptr);
+          Node *to = node_map_.lookup_default(op_node, nullptr);
+          if (from == nullptr || to == nullptr) {
+            continue;
+          }
+          Relation *new_rel = graph_->add_new_relation(
+              from, to, rel->name, rel->flag & ~RELATION_FLAG_CYCLIC);
+          new_rel->owner_session_uuid = owner_session_uuid;
+        }
+      }
+    }
+  }
+
+  for (IDNode *id_node : graph_->id_nodes) {
+    const uint session_uuid = id_node->id_orig_session_uuid;
+    if (!previous_id_session_uuids.contains(session_uuid) ||
+        rebuild_id_session_uuids.contains(session_uuid)) {
+      continue;
+    }
+    relation_builder.tag_id_relations_built(id_node->id_orig);
+    reused_id_session_uuids_.add_new(session_uuid);
+    /* Custom data masks and evaluation flags are requested by the relations builder of the users
+     * of this ID, which might not be rebuilt. Keep the previous ones, this way the masks only
+     * grow until all relations are built again. */
+    id_node->customdata_masks |= id_node->previous_customdata_masks;
+    id_node->eval_flags |= id_node->previous_eval_flags;
+  }
+
+  if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+    printf("Depsgraph relations update: re-using relations of %d out of %d IDs.\n",
+           int(reused_id_session_uuids_.size()),
+           int(graph_->id_nodes.size()));
+  }
+}
+
+bool IncrementalRelationsUpdate::verify_relations(
+    const DepsgraphRelationBuilder &relation_builder) const
+{
+  /* Incoming relations of no-op operations which were not used were removed when the previous
+   * graph was finalized (see #deg_graph_remove_unused_noops), including the ones which were
+   * re-used. They are missing now if such operation is used. */
+  for (const auto item : node_map_.items()) {
+    if (item.key->type != NodeType::OPERATION) {
+      continue;
+    }
+    const OperationNode *op_node = static_cast<const OperationNode *>(item.key);
+    if (op_node->is_noop() && op_node->outlinks.is_empty() &&
+        (op_node->flag & DEPSOP_FLAG_PINNED) == 0 && !item.value->outlinks.is_empty()) {
+      return false;
+    }
+  }
+
+  /* Relations of an ID which were not re-used are only built when the ID is reachable from the
+   * view layer by IDs which are built. */
+  for (const IDNode *id_node : graph_->id_nodes) {
+    if (reused_id_session_uuids_.contains(id_node->id_orig_session_uuid)) {
+      continue;
+    }
+    if (!relation_builder.check_id_relations_built(id_node->id_orig)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void deg_graph_clear_relations(Depsgraph *graph)
+{
+  for (IDNode *id_node : graph->id_nodes) {
+    foreach_built_operation(id_node, [](OperationNode *op_node) {
+      for (Relation *rel : op_node->inlinks) {
+        delete rel;
+      }
+      op_node->inlinks.clear();
+      op_node->outlinks.clear();
+    });
+    id_node->customdata_masks = DEGCustomDataMeshMasks();
+    id_node->eval_flags = 0;
+  }
+  if (graph->time_source != nullptr) {
+    graph->time_source->outlinks.clear();
+  }
+  clear_physics_relations(graph);
+}
+
+Vector<string> deg_graph_relations_describe(const Depsgraph *graph)
+{
+  /* Cycles are only detected after relations are built, and whether a relation has multiple
+   * owners depends on which of the owners were rebuilt. */
+  const int ignored_flags = RELATION_FLAG_CYCLIC | RELATION_FLAG_MULTIPLE_OWNERS;
+  Vector<string> descriptions;
+  for (const IDNode *id_node : graph->id_nodes) {
+    foreach_built_operation(id_node, [&](const OperationNode *op_node) {
+      const string to_description = node_description(op_node);
+      for (const Relation *rel : op_node->inlinks) {
+        descriptions.append(node_description(rel->from) + " -> " + to_description + " (" +
+                            rel->name + ", flag " + to_string(rel->flag & ~ignored_flags) + ")");
+      }
+    });
+  }
+  std::sort(descriptions.begin(), descriptions.end());
+  return descriptions;
+}
+
+int deg_graph_relations_print_difference(Span<string> incremental_relations,
+                                         Span<string> full_relations)
+{
+  int num_differences = 0;
+  int64_t i = 0, j = 0;
+  while (i < incremental_relations.size() || j < full_relations.size()) {
+    if (j == full_relations.size() ||
+        (i < incremental_relations.size() && incremental_relations[i] < full_relations[j])) {
+      printf("  Extra relation: %s\n", incremental_relations[i++].c_str());
+      num_differences++;
+    }
+    else if (i == incremental_relations.size() || full_relations[j] < incremental_relations[i]) {
+      printf("  Missing relation: %s\n", full_relations[j++].c_str());
+      num_differences++;
+    }
+    else {
+      i++;
+      j++;
+    }
+  }
+  return num_differences;
+}
+
+}  // namespace blender::deg
@@ -0,0 +1,83 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "intern/depsgraph_type.h"
+
+namespace blender::deg {
+
+struct Depsgraph;
+struct IDNode;
+struct Node;
+struct TimeSourceNode;
+class DepsgraphRelationBuilder;
+
+/* Update of relations of the graph which re-uses relations of IDs which did not change.
+ *
+ * Nodes are always built from scratch. Nodes from the previous state of the graph are kept alive
+ * until relations are built, so that relations owned by IDs which did not change (see
+ * #Relation::owner_session_uuid) can be transferred to the matching new nodes. Such IDs are then
+ * tagged as built in the relations builder, so that only relations of the following IDs are
+ * built:
+ *
+ * - IDs tagged with #DEG_id_tag_relations_update.
+ * - IDs whose nodes differ from the previous state of the graph.
+ * - IDs owning relations from or to the nodes of the above IDs.
+ * - IDs owning relations between nodes which do not exist anymore.
+ * - IDs which are new in the graph. */
+class IncrementalRelationsUpdate {
+ public:
+  IncrementalRelationsUpdate(Depsgraph *graph);
+  ~IncrementalRelationsUpdate();
+
+  /* Check whether relations of the graph can be updated without building all of them. */
+  static bool is_possible(const Depsgraph *graph);
+
+  /* Take ownership over the nodes of the graph, leaving the graph without nodes.
+   * Called by the nodes builder instead of freeing the nodes. */
+  void take_previous_nodes();
+
+  /* Transfer relations of the IDs which did not change to the nodes of the new graph, and tag
+   * those IDs as built in the relations builder.
+   * Called after all nodes are built, before building relations. */
+  void reuse_relations(DepsgraphRelationBuilder &relation_builder);
+
+  /* Check that the relations which were re-used together with the relations which were built
+   * give the same graph as building all relations would. When false is returned the relations
+   * are to be built from scratch. */
+  bool verify_relations(const DepsgraphRelationBuilder &relation_builder) const;
+
+ protected:
+  Depsgraph *graph_;
+
+  /* Nodes of the previous state of the graph. */
+  Vector<IDNode *> previous_id_nodes_;
+  TimeSourceNode *previous_time_source_;
+  int64_t num_previous_operations_;
+
+  /* Nodes of the previous state of the graph mapped to the corresponding new nodes. */
+  Map<const Node *, Node *> node_map_;
+
+  /* Session UUIDs of IDs whose relations were re-used. */
+  Set<uint> reused_id_session_uuids_;
+};
+
+/* Remove all relations from the graph, keeping the nodes. Undoes all changes done to the graph by
+ * the relations builder. */
+void deg_graph_clear_relations(Depsgraph *graph);
+
+/* Sorted descriptions of all relations of the graph, which do not depend on the order in which
+ * nodes and relations were built. Used to compare the relations of an incremental update with the
+ * ones built from scratch. */
+Vector<string> deg_graph_relations_describe(const Depsgraph *graph);
+
+/* Print relations which are only in one of the descriptions, return the number of them. */
+int deg_graph_relations_print_difference(Span<string> incremental_relations,
+                                         Span<string> full_relations);
+
+}  // namespace blender::deg
@@ -0,0 +1,138 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/deg_builder_incremental.h"
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include "BLI_listbase.h"
+
+#include "BKE_collection.h"
+#include "BKE_constraint.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_constraint_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "intern/depsgraph.h"
+
+namespace blender::deg::tests {
+
+class IncrementalRelationsUpdateTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  Object *target = nullptr;
+  Object *owner = nullptr;
+  Object *child = nullptr;
+
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    target = add_object(OB_EMPTY, "Target");
+    owner = add_object(OB_MESH, "Owner");
+    owner->data = BKE_object_obdata_add_from_type(bmain, OB_MESH, "Mesh");
+    /* Relations of the child are owned by it, but they use operations of the owner, so they are
+     * rebuilt when operations of the owner change. */
+    child = add_object(OB_EMPTY, "Child");
+    child->parent = owner;
+
+    ViewLayer *view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+    BKE_view_layer_synced_ensure(scene, view_layer);
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+  }
+
+  void TearDown() override
+  {
+    BlendfileLoadingBaseTest::TearDown();
+    BKE_main_free(bmain);
+    bmain = nullptr;
+  }
+
+  Object *add_object(const int type, const char *name)
+  {
+    Object *object = BKE_object_add_only_object(bmain, type, name);
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+    return object;
+  }
+
+  /* Update relations of the depsgraph after the owner was edited, and compare them with the
+   * relations of a depsgraph built from scratch. */
+  void expect_relations_update_matches_full_build(const char *edit)
+  {
+    DEG_id_tag_relations_update(bmain, &owner->id);
+    DEG_graph_relations_update(depsgraph);
+    const Vector<string> incremental_relations = deg_graph_relations_describe(
+        reinterpret_cast<const Depsgraph *>(depsgraph));
+
+    ::Depsgraph *full_depsgraph = DEG_graph_new(
+        bmain, scene, DEG_get_input_view_layer(depsgraph), DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(full_depsgraph);
+    const Vector<string> full_relations = deg_graph_relations_describe(
+        reinterpret_cast<const Depsgraph *>(full_depsgraph));
+    DEG_graph_free(full_depsgraph);
+
+    EXPECT_FALSE(full_relations.is_empty());
+    EXPECT_EQ(deg_graph_relations_print_difference(incremental_relations, full_relations), 0)
+        << "relations differ after " << edit;
+  }
+};
+
+TEST_F(IncrementalRelationsUpdateTest, constraint_add_remove)
+{
+  bConstraint *con = BKE_constraint_add_for_object(
+      owner, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+  static_cast<bLocateLikeConstraint *>(con->data)->tar = target;
+  expect_relations_update_matches_full_build("adding a constraint");
+
+  /* Relations to the target are owned by the constraint owner, which is rebuilt. */
+  static_cast<bLocateLikeConstraint *>(con->data)->tar = nullptr;
+  expect_relations_update_matches_full_build("clearing the constraint target");
+
+  static_cast<bLocateLikeConstraint *>(con->data)->tar = target;
+  expect_relations_update_matches_full_build("setting the constraint target");
+
+  BKE_constraint_remove_ex(&owner->constraints, owner, con, true);
+  expect_relations_update_matches_full_build("removing the constraint");
+}
+
+TEST_F(IncrementalRelationsUpdateTest, modifier_add_remove)
+{
+  ModifierData *md = BKE_modifier_new(eModifierType_Hook);
+  BLI_addtail(&owner->modifiers, md);
+  reinterpret_cast<HookModifierData *>(md)->object = target;
+  expect_relations_update_matches_full_build("adding a modifier");
+
+  ModifierData *second_md = BKE_modifier_new(eModifierType_Hook);
+  BLI_addtail(&owner->modifiers, second_md);
+  reinterpret_cast<HookModifierData *>(second_md)->object = child;
+  expect_relations_update_matches_full_build("adding a modifier depending on the child");
+
+  BKE_modifier_remove_from_list(owner, md);
+  BKE_modifier_free(md);
+  expect_relations_update_matches_full_build("removing the first modifier");
+
+  BKE_modifier_remove_from_list(owner, second_md);
+  BKE_modifier_free(second_md);
+  expect_relations_update_matches_full_build("removing all modifiers");
+}
+
+}  // namespace blender::deg::tests
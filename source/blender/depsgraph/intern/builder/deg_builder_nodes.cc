@@ -104,6 +104,7 @@
 #include "SEQ_sequencer.h"
 
 #include "intern/builder/deg_builder.h"
+#include "intern/builder/deg_builder_incremental.h"
 #include "intern/builder/deg_builder_rna.h"
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_tag.h"
@@ -345,7 +346,7 @@ ID *DepsgraphNodeBuilder::ensure_cow_id(ID *id_orig)
 
 /* **** Build functions for entity nodes **** */
 
-void DepsgraphNodeBuilder::begin_build()
+void DepsgraphNodeBuilder::begin_build(IncrementalRelationsUpdate *incremental_update)
 {
   /* Store existing copy-on-write versions of datablock, so we can re-use
    * them for new ID nodes. */
@@ -384,8 +385,15 @@ void DepsgraphNodeBuilder::begin_build()
     saved_entry_tags_.append(entry_tag);
   }
 
-  /* Make sure graph has no nodes left from previous state. */
-  graph_->clear_all_nodes();
+  /* Make sure graph has no nodes left from previous state. When relations are updated
+   * incrementally the nodes are kept alive until relations are built, to transfer relations
+   * between them to the new nodes. */
+  if (incremental_update != nullptr) {
+    incremental_update->take_previous_nodes();
+  }
+  else {
+    graph_->clear_all_nodes();
+  }
   graph_->operations.clear();
   graph_->entry_tags.clear();
 }
@@ -56,6 +56,7 @@ struct ComponentNode;
 struct Depsgraph;
 class DepsgraphBuilderCache;
 struct IDNode;
+class IncrementalRelationsUpdate;
 struct OperationNode;
 struct TimeSourceNode;
 
@@ -82,7 +83,7 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
     return (T *)cow->id.orig_id;
   }
 
-  virtual void begin_build();
+  virtual void begin_build(IncrementalRelationsUpdate *incremental_update);
   virtual void end_build();
 
   /**
@@ -32,6 +32,7 @@
 #include "DEG_depsgraph_build.h"
 
 #include "intern/builder/deg_builder.h"
+#include "intern/builder/deg_builder_pose_batch.h"
 #include "intern/depsgraph_type.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/node/deg_node.h"
@@ -205,6 +206,25 @@ void DepsgraphNodeBuilder::build_rig(Object *object)
       OperationCode::POSE_DONE,
       [object_cow](::Depsgraph *depsgraph) { BKE_pose_eval_done(depsgraph, object_cow); });
   op_node->set_as_exit();
+  /* Sub-trees of bones evaluated by a single operation. */
+  const PoseBonesBatches bones_batches(object);
+  for (const PoseBonesBatch &batch : bones_batches.batches()) {
+    add_operation_node(&object->id,
+                       NodeType::EVAL_POSE,
+                       batch.root->name,
+                       OperationCode::POSE_BONES_BATCH,
+                       [scene_cow,
+                        object_cow,
+                        pchan_indices = batch.pchan_indices,
+                        level_offsets = batch.level_offsets](::Depsgraph *depsgraph) {
+                         BKE_pose_eval_bones_batch(depsgraph,
+                                                   scene_cow,
+                                                   object_cow,
+                                                   pchan_indices.data(),
+                                                   level_offsets.data(),
+                                                   int(level_offsets.size()) - 1);
+                       });
+  }
   /* Bones. */
   int pchan_index = 0;
   LISTBASE_FOREACH (bPoseChannel *, pchan, &object->pose->chanbase) {
@@ -213,24 +233,34 @@ void DepsgraphNodeBuilder::build_rig(Object *object)
         &object->id, NodeType::BONE, pchan->name, OperationCode::BONE_LOCAL);
     op_node->set_as_entry();
 
-    add_operation_node(&object->id,
-                       NodeType::BONE,
-                       pchan->name,
-                       OperationCode::BONE_POSE_PARENT,
-                       [scene_cow, object_cow, pchan_index](::Depsgraph *depsgraph) {
-                         BKE_pose_eval_bone(depsgraph, scene_cow, object_cow, pchan_index);
-                       });
-
-    /* NOTE: Dedicated noop for easier relationship construction. */
-    add_operation_node(&object->id, NodeType::BONE, pchan->name, OperationCode::BONE_READY);
+    if (bones_batches.find_batch(pchan) != nullptr) {
+      /* NOTE: Evaluated by the batch, the operations only exist for relations. */
+      add_operation_node(
+          &object->id, NodeType::BONE, pchan->name, OperationCode::BONE_POSE_PARENT);
+      add_operation_node(&object->id, NodeType::BONE, pchan->name, OperationCode::BONE_READY);
+      op_node = add_operation_node(
+          &object->id, NodeType::BONE, pchan->name, OperationCode::BONE_DONE);
+    }
+    else {
+      add_operation_node(&object->id,
+                         NodeType::BONE,
+                         pchan->name,
+                         OperationCode::BONE_POSE_PARENT,
+                         [scene_cow, object_cow, pchan_index](::Depsgraph *depsgraph) {
+                           BKE_pose_eval_bone(depsgraph, scene_cow, object_cow, pchan_index);
+                         });
+
+      /* NOTE: Dedicated noop for easier relationship construction. */
+      add_operation_node(&object->id, NodeType::BONE, pchan->name, OperationCode::BONE_READY);
 
-    op_node = add_operation_node(&object->id,
-                                 NodeType::BONE,
-                                 pchan->name,
-                                 OperationCode::BONE_DONE,
-                                 [object_cow, pchan_index](::Depsgraph *depsgraph) {
-                                   BKE_pose_bone_done(depsgraph, object_cow, pchan_index);
-                                 });
+      op_node = add_operation_node(&object->id,
+                                   NodeType::BONE,
+                                   pchan->name,
+                                   OperationCode::BONE_DONE,
+                                   [object_cow, pchan_index](::Depsgraph *depsgraph) {
+                                     BKE_pose_bone_done(depsgraph, object_cow, pchan_index);
+                                   });
+    }
 
     /* B-Bone shape computation - the real last step if present. */
     if (check_pchan_has_bbone(object, pchan)) {
@@ -0,0 +1,167 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/deg_builder_pose_batch.h"
+
+#include <algorithm>
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_constraint_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_armature.h"
+
+namespace blender::deg {
+
+namespace {
+
+/* Sub-trees with a single bone keep their own operations, batching them does not save any. */
+constexpr int64_t POSE_BONES_BATCH_MIN_SIZE = 2;
+
+/* Collect names of the bones which have drivers on the pose bone or on the armature bone. Both
+ * are relations to the bone operations which would depend on the result of the batch. */
+void add_driven_bone_names(const AnimData *adt, const char *prefix, Set<std::string> &r_names)
+{
+  if (adt == nullptr) {
+    return;
+  }
+  LISTBASE_FOREACH (const FCurve *, fcu, &adt->drivers) {
+    if (fcu->rna_path == nullptr) {
+      continue;
+    }
+    char bone_name[MAXBONENAME];
+    if (BLI_str_quoted_substr(fcu->rna_path, prefix, bone_name, sizeof(bone_name))) {
+      r_names.add(bone_name);
+    }
+  }
+}
+
+/* Mark bones of the chain from the constrained bone up to the root of the solver. */
+void tag_ik_chain(const bPoseChannel *pchan,
+                  const bPoseChannel *rootchan,
+                  Set<const bPoseChannel *> &r_chain_pchans)
+{
+  for (const bPoseChannel *parchan = pchan; parchan != nullptr; parchan = parchan->parent) {
+    r_chain_pchans.add(parchan);
+    if (parchan == rootchan) {
+      break;
+    }
+  }
+}
+
+}  // namespace
+
+PoseBonesBatches::PoseBonesBatches(const Object *object)
+{
+  BLI_assert(object->type == OB_ARMATURE);
+  const bPose *pose = object->pose;
+  if (pose == nullptr) {
+    return;
+  }
+
+  const bArmature *armature = static_cast<const bArmature *>(object->data);
+  Set<std::string> driven_names;
+  add_driven_bone_names(object->adt, "pose.bones[", driven_names);
+  add_driven_bone_names(armature->adt, "bones[", driven_names);
+
+  Set<const bPoseChannel *> ik_chain_pchans;
+  LISTBASE_FOREACH (bPoseChannel *, pchan, &pose->chanbase) {
+    LISTBASE_FOREACH (bConstraint *, con, &pchan->constraints) {
+      if (con->type == CONSTRAINT_TYPE_KINEMATIC) {
+        bKinematicConstraint *data = static_cast<bKinematicConstraint *>(con->data);
+        const bPoseChannel *rootchan = BKE_armature_ik_solver_find_root(pchan, data);
+        if (rootchan != nullptr) {
+          tag_ik_chain(pchan, rootchan, ik_chain_pchans);
+        }
+      }
+      else if (con->type == CONSTRAINT_TYPE_SPLINEIK) {
+        bSplineIKConstraint *data = static_cast<bSplineIKConstraint *>(con->data);
+        const bPoseChannel *rootchan = BKE_armature_splineik_solver_find_root(pchan, data);
+        if (rootchan != nullptr) {
+          tag_ik_chain(pchan, rootchan, ik_chain_pchans);
+        }
+      }
+    }
+  }
+
+  /* Bones which only depend on their parent. */
+  Map<const bPoseChannel *, int> pchan_indices;
+  int pchan_index = 0;
+  LISTBASE_FOREACH (const bPoseChannel *, pchan, &pose->chanbase) {
+    if (BLI_listbase_is_empty(&pchan->constraints) && !ik_chain_pchans.contains(pchan) &&
+        !driven_names.contains(pchan->name)) {
+      pchan_indices.add_new(pchan, pchan_index);
+    }
+    pchan_index++;
+  }
+
+  /* Group the bones by the topmost bone of their sub-tree. The order of pose channels does not
+   * follow the hierarchy when bones were re-parented, so depths are computed from the parents. */
+  struct BatchBone {
+    const bPoseChannel *pchan;
+    int index;
+    int depth;
+  };
+  Map<const bPoseChannel *, Vector<BatchBone>> bones_by_root;
+  LISTBASE_FOREACH (const bPoseChannel *, pchan, &pose->chanbase) {
+    const int *index = pchan_indices.lookup_ptr(pchan);
+    if (index == nullptr) {
+      continue;
+    }
+    const bPoseChannel *root = pchan;
+    int depth = 0;
+    while (root->parent != nullptr && pchan_indices.contains(root->parent)) {
+      root = root->parent;
+      depth++;
+    }
+    bones_by_root.lookup_or_add_default(root).append({pchan, *index, depth});
+  }
+
+  LISTBASE_FOREACH (const bPoseChannel *, root, &pose->chanbase) {
+    Vector<BatchBone> *bones = bones_by_root.lookup_ptr(root);
+    if (bones == nullptr || bones->size() < POSE_BONES_BATCH_MIN_SIZE) {
+      continue;
+    }
+    std::stable_sort(bones->begin(), bones->end(), [](const BatchBone &a, const BatchBone &b) {
+      return a.depth < b.depth;
+    });
+
+    const int batch_index = int(batches_.size());
+    batches_.append_as();
+    PoseBonesBatch &batch = batches_.last();
+    batch.root = root;
+    for (const BatchBone &bone : *bones) {
+      if (bone.depth == batch.level_offsets.size()) {
+        batch.level_offsets.append(int(batch.pchan_indices.size()));
+      }
+      batch.pchan_indices.append(bone.index);
+      batch_index_by_pchan_.add_new(bone.pchan, batch_index);
+    }
+    batch.level_offsets.append(int(batch.pchan_indices.size()));
+  }
+}
+
+Span<PoseBonesBatch> PoseBonesBatches::batches() const
+{
+  return batches_;
+}
+
+const PoseBonesBatch *PoseBonesBatches::find_batch(const bPoseChannel *pchan) const
+{
+  const int *batch_index = batch_index_by_pchan_.lookup_ptr(pchan);
+  if (batch_index == nullptr) {
+    return nullptr;
+  }
+  return &batches_[*batch_index];
+}
+
+}  // namespace blender::deg
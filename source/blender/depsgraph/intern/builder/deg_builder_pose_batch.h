@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "intern/depsgraph_type.h"
+
+struct Object;
+struct bPoseChannel;
+
+namespace blender::deg {
+
+/* Sub-tree of bones which is evaluated by a single operation. */
+struct PoseBonesBatch {
+  /* Topmost bone of the sub-tree, the operation is named after it. */
+  const bPoseChannel *root;
+  /* Indices of the bones in the pose channels list, ordered by their depth in the sub-tree. */
+  Vector<int> pchan_indices;
+  /* Start of every depth level in #pchan_indices, followed by the number of indices. */
+  Vector<int> level_offsets;
+};
+
+/* Bones of a pose which are evaluated in batches instead of by operations per bone.
+ *
+ * Rigs with many bones spend more time scheduling the operations of the bones than evaluating
+ * them. Bones without constraints, which are not part of an IK chain and which are not driven
+ * only depend on their parent, so every sub-tree of such bones is evaluated by a single
+ * operation, level by level. Operations of the bones themselves are still created as no-ops, so
+ * that relations from and to them do not need to know about the batches.
+ *
+ * Nodes and relations builders use the same batches, they are only computed from the pose and
+ * the drivers of the object and its armature. */
+class PoseBonesBatches {
+ public:
+  PoseBonesBatches(const Object *object);
+
+  Span<PoseBonesBatch> batches() const;
+
+  /* Batch which evaluates the bone, or nullptr if the bone is evaluated by its own operations. */
+  const PoseBonesBatch *find_batch(const bPoseChannel *pchan) const;
+
+ protected:
+  Vector<PoseBonesBatch> batches_;
+  Map<const bPoseChannel *, int> batch_index_by_pchan_;
+};
+
+}  // namespace blender::deg
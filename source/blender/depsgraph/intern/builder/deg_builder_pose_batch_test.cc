@@ -0,0 +1,246 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/deg_builder_pose_batch.h"
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_float4x4.hh"
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_rand.hh"
+#include "BLI_string.h"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_armature.h"
+#include "BKE_constraint.h"
+#include "BKE_fcurve.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_constraint_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+namespace blender::deg::tests {
+
+class PoseBonesBatchesTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  Object *object = nullptr;
+  bArmature *armature = nullptr;
+
+  /* Rig with bones of every kind which is not batched, and bones depending on them:
+   *
+   *   Root
+   *   ├─ Single
+   *   ├─ Spine1 ─ Spine2 (constrained) ─ Spine3 ─ Spine4
+   *   ├─ Arm1 ─ Arm2 ─ Hand (IK chain of two bones) ─ Finger1 ─ Finger2
+   *   └─ Driven (driven) ─ DrivenChild ─ DrivenGrandChild
+   *
+   * Channels of Single and Spine4 are moved before their parents, like after re-parenting. */
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    armature = BKE_armature_add(bmain, "Armature");
+    object = BKE_object_add_only_object(bmain, OB_ARMATURE, "Rig");
+    object->data = armature;
+
+    Bone *root = add_bone("Root", nullptr);
+    add_bone("Single", root);
+    Bone *spine2 = add_bone("Spine2", add_bone("Spine1", root));
+    add_bone("Spine4", add_bone("Spine3", spine2));
+    Bone *hand = add_bone("Hand", add_bone("Arm2", add_bone("Arm1", root)));
+    add_bone("Finger2", add_bone("Finger1", hand));
+    add_bone("DrivenGrandChild", add_bone("DrivenChild", add_bone("Driven", root)));
+    BKE_armature_where_is(armature);
+    BKE_pose_rebuild(nullptr, object, armature, false);
+
+    bPose *pose = object->pose;
+    for (const char *name : {"Spine4", "Single"}) {
+      bPoseChannel *pchan = BKE_pose_channel_find_name(pose, name);
+      BLI_remlink(&pose->chanbase, pchan);
+      BLI_addhead(&pose->chanbase, pchan);
+    }
+    BKE_pose_pchan_index_rebuild(pose);
+
+    bConstraint *limit = BKE_constraint_add_for_pose(
+        object, find_pchan("Spine2"), "Limit Rotation", CONSTRAINT_TYPE_ROTLIMIT);
+    bRotLimitConstraint *limit_data = static_cast<bRotLimitConstraint *>(limit->data);
+    limit_data->flag = LIMIT_XROT | LIMIT_ZROT;
+    limit_data->xmin = limit_data->zmin = -0.2f;
+    limit_data->xmax = limit_data->zmax = 0.1f;
+
+    bConstraint *ik = BKE_constraint_add_for_pose(
+        object, find_pchan("Hand"), "IK", CONSTRAINT_TYPE_KINEMATIC);
+    static_cast<bKinematicConstraint *>(ik->data)->rootbone = 2;
+
+    FCurve *fcu = BKE_fcurve_create();
+    fcu->rna_path = BLI_strdup("pose.bones[\"Driven\"].location");
+    BLI_addtail(&BKE_animdata_ensure_id(&object->id)->drivers, fcu);
+
+    ViewLayer *view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+  }
+
+  void TearDown() override
+  {
+    BlendfileLoadingBaseTest::TearDown();
+    BKE_main_free(bmain);
+    bmain = nullptr;
+  }
+
+  Bone *add_bone(const char *name, Bone *parent)
+  {
+    Bone *bone = MEM_cnew<Bone>(__func__);
+    STRNCPY(bone->name, name);
+    const int num_bones = BLI_listbase_count(parent ? &parent->childbase : &armature->bonebase);
+    const float tail[3] = {0.2f * num_bones, 1.0f, -0.1f * num_bones};
+    copy_v3_v3(bone->tail, tail);
+    bone->roll = 0.3f * num_bones;
+    bone->parent = parent;
+    BLI_addtail(parent ? &parent->childbase : &armature->bonebase, bone);
+    return bone;
+  }
+
+  bPoseChannel *find_pchan(const char *name)
+  {
+    return BKE_pose_channel_find_name(object->pose, name);
+  }
+
+  /* Names of the bones of the batch, with levels separated by '|'. */
+  std::string batch_description(const PoseBonesBatch &batch)
+  {
+    std::string description;
+    for (const int level : IndexRange(batch.level_offsets.size() - 1)) {
+      if (level > 0) {
+        description += " |";
+      }
+      for (const int i :
+           IndexRange(batch.level_offsets[level],
+                      batch.level_offsets[level + 1] - batch.level_offsets[level])) {
+        const bPoseChannel *pchan = static_cast<const bPoseChannel *>(
+            BLI_findlink(&object->pose->chanbase, batch.pchan_indices[i]));
+        description += std::string(" ") + pchan->name;
+      }
+    }
+    return description;
+  }
+
+  /* Evaluate bones like the depsgraph does, with the operations of every bone or with the
+   * batches of bones which are batched, from the root of the hierarchy to the leaves. */
+  void evaluate_bones(const ListBase *bones, const PoseBonesBatches *batches)
+  {
+    LISTBASE_FOREACH (const Bone *, bone, bones) {
+      bPoseChannel *pchan = find_pchan(bone->name);
+      const int pchan_index = BLI_findindex(&object->pose->chanbase, pchan);
+      const PoseBonesBatch *batch = batches ? batches->find_batch(pchan) : nullptr;
+      if (batch == nullptr) {
+        BKE_pose_eval_bone(depsgraph, scene, object, pchan_index);
+        BKE_pose_constraints_evaluate(depsgraph, scene, object, pchan_index);
+        BKE_pose_bone_done(depsgraph, object, pchan_index);
+      }
+      else if (batch->root == pchan) {
+        BKE_pose_eval_bones_batch(depsgraph,
+                                  scene,
+                                  object,
+                                  batch->pchan_indices.data(),
+                                  batch->level_offsets.data(),
+                                  int(batch->level_offsets.size()) - 1);
+      }
+      evaluate_bones(&bone->childbase, batches);
+    }
+  }
+
+  void evaluate_pose(const PoseBonesBatches *batches)
+  {
+    LISTBASE_FOREACH (bPoseChannel *, pchan, &object->pose->chanbase) {
+      zero_m4(pchan->pose_mat);
+      zero_m4(pchan->chan_mat);
+    }
+    BKE_pose_eval_init(depsgraph, scene, object);
+    evaluate_bones(&armature->bonebase, batches);
+  }
+};
+
+TEST_F(PoseBonesBatchesTest, batches)
+{
+  const PoseBonesBatches batches(object);
+
+  /* Batches follow the order of the channels of their root bones, bones of a level follow the
+   * order of their channels. */
+  ASSERT_EQ(batches.batches().size(), 4);
+  EXPECT_EQ(batch_description(batches.batches()[0]), " Root | Single Spine1 Arm1");
+  EXPECT_EQ(batch_description(batches.batches()[1]), " Spine3 | Spine4");
+  EXPECT_EQ(batch_description(batches.batches()[2]), " Finger1 | Finger2");
+  EXPECT_EQ(batch_description(batches.batches()[3]), " DrivenChild | DrivenGrandChild");
+  EXPECT_EQ(batches.batches()[0].root, find_pchan("Root"));
+  EXPECT_EQ(batches.batches()[1].root, find_pchan("Spine3"));
+  EXPECT_EQ(batches.batches()[0].level_offsets, Vector<int>({0, 1, 4}));
+  EXPECT_EQ(batches.batches()[1].level_offsets, Vector<int>({0, 1, 2}));
+
+  for (const char *name : {"Spine2", "Arm2", "Hand", "Driven"}) {
+    EXPECT_EQ(batches.find_batch(find_pchan(name)), nullptr) << name;
+  }
+  for (const PoseBonesBatch &batch : batches.batches()) {
+    for (const int pchan_index : batch.pchan_indices) {
+      const bPoseChannel *pchan = static_cast<const bPoseChannel *>(
+          BLI_findlink(&object->pose->chanbase, pchan_index));
+      EXPECT_EQ(batches.find_batch(pchan), &batch) << pchan->name;
+    }
+  }
+}
+
+TEST_F(PoseBonesBatchesTest, evaluation_matches_bone_operations)
+{
+  RandomNumberGenerator rng(0);
+  LISTBASE_FOREACH (bPoseChannel *, pchan, &object->pose->chanbase) {
+    const float euler[3] = {rng.get_float() - 0.5f, rng.get_float() - 0.5f, rng.get_float()};
+    eul_to_quat(pchan->quat, euler);
+    for (const int i : IndexRange(3)) {
+      pchan->loc[i] = rng.get_float() - 0.5f;
+      pchan->size[i] = rng.get_float() + 0.5f;
+    }
+  }
+
+  evaluate_pose(nullptr);
+  Vector<float4x4> expected_pose_mats, expected_chan_mats;
+  LISTBASE_FOREACH (const bPoseChannel *, pchan, &object->pose->chanbase) {
+    expected_pose_mats.append(float4x4(pchan->pose_mat));
+    expected_chan_mats.append(float4x4(pchan->chan_mat));
+  }
+
+  const PoseBonesBatches batches(object);
+  evaluate_pose(&batches);
+  int pchan_index = 0;
+  LISTBASE_FOREACH (const bPoseChannel *, pchan, &object->pose->chanbase) {
+    for (const int i : IndexRange(4)) {
+      for (const int j : IndexRange(4)) {
+        EXPECT_FLOAT_EQ(pchan->pose_mat[i][j], expected_pose_mats[pchan_index].values[i][j])
+            << pchan->name << " pose_mat[" << i << "][" << j << "]";
+        EXPECT_FLOAT_EQ(pchan->chan_mat[i][j], expected_chan_mats[pchan_index].values[i][j])
+            << pchan->name << " chan_mat[" << i << "][" << j << "]";
+      }
+    }
+    pchan_index++;
+  }
+}
+
+}  // namespace blender::deg::tests
@@ -68,6 +68,7 @@
 #include "BKE_image.h"
 #include "BKE_key.h"
 #include "BKE_layer.h"
+#include "BKE_lib_id.h"
 #include "BKE_material.h"
 #include "BKE_mball.h"
 #include "BKE_modifier.h"
@@ -235,7 +236,10 @@ bool object_have_geometry_component(const Object *object)
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph,
                                                    DepsgraphBuilderCache *cache)
-    : DepsgraphBuilder(bmain, graph, cache), scene_(nullptr), rna_node_query_(graph, this)
+    : DepsgraphBuilder(bmain, graph, cache),
+      scene_(nullptr),
+      rna_node_query_(graph, this),
+      relations_owner_session_uuid_(MAIN_ID_SESSION_UUID_UNSET)
 {
 }
 
@@ -337,7 +341,9 @@ Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       int flags)
 {
   if (timesrc && node_to) {
-    return graph_->add_new_relation(timesrc, node_to, description, flags);
+    Relation *relation = graph_->add_new_relation(timesrc, node_to, description, flags);
+    tag_relation_owner(relation);
+    return relation;
   }
 
   DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -365,7 +371,9 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_f
                                                            int flags)
 {
   if (node_from && node_to) {
-    return graph_->add_new_relation(node_from, node_to, description, flags);
+    Relation *relation = graph_->add_new_relation(node_from, node_to, description, flags);
+    tag_relation_owner(relation);
+    return relation;
   }
 
   DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -479,6 +487,46 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::tag_id_relations_built(ID *id)
+{
+  built_map_.tagBuild(id);
+}
+
+bool DepsgraphRelationBuilder::check_id_relations_built(ID *id) const
+{
+  /* Relations of a scene are built in parts, of which parameters are built for every scene. */
+  const int tag = (GS(id->name) == ID_SCE) ? BuilderMap::TAG_PARAMETERS :
+                                             BuilderMap::TAG_COMPLETE;
+  return built_map_.checkIsBuilt(id, tag);
+}
+
+DepsgraphRelationBuilder::RelationsOwnerScope::RelationsOwnerScope(
+    DepsgraphRelationBuilder &builder, const ID &id)
+    : builder_(builder), previous_owner_session_uuid_(builder.relations_owner_session_uuid_)
+{
+  builder_.relations_owner_session_uuid_ = id.session_uuid;
+}
+
+DepsgraphRelationBuilder::RelationsOwnerScope::~RelationsOwnerScope()
+{
+  builder_.relations_owner_session_uuid_ = previous_owner_session_uuid_;
+}
+
+void DepsgraphRelationBuilder::tag_relation_owner(Relation *relation)
+{
+  if (relations_owner_session_uuid_ == MAIN_ID_SESSION_UUID_UNSET) {
+    return;
+  }
+  /* The relation might have been added before, in which case it is only re-used by the builder
+   * of another ID when it has been added with #RELATION_CHECK_BEFORE_ADD. */
+  if (relation->owner_session_uuid == MAIN_ID_SESSION_UUID_UNSET) {
+    relation->owner_session_uuid = relations_owner_session_uuid_;
+  }
+  else if (relation->owner_session_uuid != relations_owner_session_uuid_) {
+    relation->flag |= RELATION_FLAG_MULTIPLE_OWNERS;
+  }
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
@@ -589,6 +637,7 @@ void DepsgraphRelationBuilder::build_generic_id(ID *id)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(*id);
+  const RelationsOwnerScope owner_scope(*this, *id);
 
   build_idproperties(id->properties);
   build_animdata(id);
@@ -629,6 +678,7 @@ void DepsgraphRelationBuilder::build_collection(LayerCollection *from_layer_coll
                                           OperationCode::TRANSFORM_FINAL);
   ComponentKey duplicator_key(object != nullptr ? &object->id : nullptr, NodeType::DUPLI);
   if (!group_done) {
+    const RelationsOwnerScope owner_scope(*this, collection->id);
     build_idproperties(collection->id.properties);
     OperationKey collection_geometry_key{
         &collection->id, NodeType::GEOMETRY, OperationCode::GEOMETRY_EVAL_DONE};
@@ -688,6 +738,7 @@ void DepsgraphRelationBuilder::build_object(Object *object)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(object->id);
+  const RelationsOwnerScope owner_scope(*this, object->id);
 
   /* Object Transforms. */
   OperationCode base_op = (object->parent) ? OperationCode::TRANSFORM_PARENT :
@@ -932,6 +983,7 @@ void DepsgraphRelationBuilder::build_object_data(Object *object)
   ID *obdata_id = (ID *)object->data;
   /* Object data animation. */
   if (!built_map_.checkIsBuilt(obdata_id)) {
+    const RelationsOwnerScope owner_scope(*this, *obdata_id);
     build_animdata(obdata_id);
   }
   /* type-specific data. */
@@ -1465,7 +1517,7 @@ void DepsgraphRelationBuilder::build_animdata_curves_targets(ID *id,
       add_relation(adt_key, pose_init_key, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
       continue;
     }
-    graph_->add_new_relation(
+    add_operation_relation(
         operation_from, operation_to, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
     /* It is possible that animation is writing to a nested ID data-block,
      * need to make sure animation is evaluated after target ID is copied. */
@@ -1585,6 +1637,7 @@ void DepsgraphRelationBuilder::build_action(bAction *action)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(action->id);
+  const RelationsOwnerScope owner_scope(*this, action->id);
 
   build_idproperties(action->id.properties);
   if (!BLI_listbase_is_empty(&action->curves)) {
@@ -1913,6 +1966,7 @@ void DepsgraphRelationBuilder::build_world(World *world)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(world->id);
+  const RelationsOwnerScope owner_scope(*this, world->id);
 
   build_idproperties(world->id.properties);
   /* animation */
@@ -2140,6 +2194,7 @@ void DepsgraphRelationBuilder::build_particle_settings(ParticleSettings *part)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(part->id);
+  const RelationsOwnerScope owner_scope(*this, part->id);
 
   /* Animation data relations. */
   build_animdata(&part->id);
@@ -2201,6 +2256,7 @@ void DepsgraphRelationBuilder::build_shapekeys(Key *key)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(key->id);
+  const RelationsOwnerScope owner_scope(*this, key->id);
 
   build_idproperties(key->id.properties);
   /* Attach animdata to geometry. */
@@ -2366,6 +2422,7 @@ void DepsgraphRelationBuilder::build_object_data_geometry_datablock(ID *obdata)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(*obdata);
+  const RelationsOwnerScope owner_scope(*this, *obdata);
 
   build_idproperties(obdata->properties);
   /* Animation. */
@@ -2495,6 +2552,7 @@ void DepsgraphRelationBuilder::build_armature(bArmature *armature)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(armature->id);
+  const RelationsOwnerScope owner_scope(*this, armature->id);
 
   build_idproperties(armature->id.properties);
   build_animdata(&armature->id);
@@ -2517,6 +2575,7 @@ void DepsgraphRelationBuilder::build_camera(Camera *camera)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(camera->id);
+  const RelationsOwnerScope owner_scope(*this, camera->id);
 
   build_idproperties(camera->id.properties);
   build_animdata(&camera->id);
@@ -2544,6 +2603,7 @@ void DepsgraphRelationBuilder::build_light(Light *lamp)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(lamp->id);
+  const RelationsOwnerScope owner_scope(*this, lamp->id);
 
   build_idproperties(lamp->id.properties);
   build_animdata(&lamp->id);
@@ -2611,6 +2671,7 @@ void DepsgraphRelationBuilder::build_nodetree(bNodeTree *ntree)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(ntree->id);
+  const RelationsOwnerScope owner_scope(*this, ntree->id);
 
   build_idproperties(ntree->id.properties);
   build_animdata(&ntree->id);
@@ -2738,6 +2799,7 @@ void DepsgraphRelationBuilder::build_material(Material *material)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(material->id);
+  const RelationsOwnerScope owner_scope(*this, material->id);
 
   build_idproperties(material->id.properties);
   /* animation */
@@ -2777,6 +2839,7 @@ void DepsgraphRelationBuilder::build_texture(Tex *texture)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(texture->id);
+  const RelationsOwnerScope owner_scope(*this, texture->id);
 
   /* texture itself */
   ComponentKey texture_key(&texture->id, NodeType::GENERIC_DATABLOCK);
@@ -2821,6 +2884,7 @@ void DepsgraphRelationBuilder::build_image(Image *image)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(image->id);
+  const RelationsOwnerScope owner_scope(*this, image->id);
 
   build_idproperties(image->id.properties);
   build_parameters(&image->id);
@@ -2833,6 +2897,7 @@ void DepsgraphRelationBuilder::build_cachefile(CacheFile *cache_file)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(cache_file->id);
+  const RelationsOwnerScope owner_scope(*this, cache_file->id);
 
   build_idproperties(cache_file->id.properties);
   /* Animation. */
@@ -2865,6 +2930,7 @@ void DepsgraphRelationBuilder::build_mask(Mask *mask)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(mask->id);
+  const RelationsOwnerScope owner_scope(*this, mask->id);
 
   ID *mask_id = &mask->id;
   build_idproperties(mask_id->properties);
@@ -2905,6 +2971,7 @@ void DepsgraphRelationBuilder::build_freestyle_linestyle(FreestyleLineStyle *lin
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(linestyle->id);
+  const RelationsOwnerScope owner_scope(*this, linestyle->id);
 
   ID *linestyle_id = &linestyle->id;
   build_parameters(linestyle_id);
@@ -2920,6 +2987,7 @@ void DepsgraphRelationBuilder::build_movieclip(MovieClip *clip)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(clip->id);
+  const RelationsOwnerScope owner_scope(*this, clip->id);
 
   /* Animation. */
   build_idproperties(clip->id.properties);
@@ -2934,6 +3002,7 @@ void DepsgraphRelationBuilder::build_lightprobe(LightProbe *probe)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(probe->id);
+  const RelationsOwnerScope owner_scope(*this, probe->id);
 
   build_idproperties(probe->id.properties);
   build_animdata(&probe->id);
@@ -2947,6 +3016,7 @@ void DepsgraphRelationBuilder::build_speaker(Speaker *speaker)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(speaker->id);
+  const RelationsOwnerScope owner_scope(*this, speaker->id);
 
   build_idproperties(speaker->id.properties);
   build_animdata(&speaker->id);
@@ -2966,6 +3036,7 @@ void DepsgraphRelationBuilder::build_sound(bSound *sound)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(sound->id);
+  const RelationsOwnerScope owner_scope(*this, sound->id);
 
   build_idproperties(sound->id.properties);
   build_animdata(&sound->id);
@@ -2979,6 +3050,7 @@ void DepsgraphRelationBuilder::build_simulation(Simulation *simulation)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(simulation->id);
+  const RelationsOwnerScope owner_scope(*this, simulation->id);
 
   build_idproperties(simulation->id.properties);
   build_animdata(&simulation->id);
@@ -3045,6 +3117,8 @@ void DepsgraphRelationBuilder::build_scene_sequencer(Scene *scene)
     return;
   }
 
+  const RelationsOwnerScope owner_scope(*this, scene->id);
+
   /* TODO(sergey): Trace as a scene sequencer. */
 
   build_scene_audio(scene);
@@ -3093,6 +3167,7 @@ void DepsgraphRelationBuilder::build_vfont(VFont *vfont)
   }
 
   const BuilderStack::ScopedEntry stack_entry = stack_.trace(vfont->id);
+  const RelationsOwnerScope owner_scope(*this, vfont->id);
 
   build_parameters(&vfont->id);
   build_idproperties(vfont->id.properties);
@@ -212,6 +212,11 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   void begin_build();
 
+  /* Tag relations of the given ID as built, without building them. Used when the relations are
+   * re-used from the previous state of the graph. */
+  void tag_id_relations_built(ID *id);
+  bool check_id_relations_built(ID *id) const;
+
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
                          const KeyTo &key_to,
@@ -395,6 +400,27 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   template<typename KeyType>
   DepsNodeHandle create_node_handle(const KeyType &key, const char *default_name = "");
 
+  /* Relations which are added while an instance of this class is alive are owned by the given
+   * ID, see #Relation::owner_session_uuid.
+   *
+   * The scope is to begin right after the ID is tagged as built, so that the relations owned by
+   * an ID are exactly the ones which are skipped when the ID is already tagged as built. */
+  class RelationsOwnerScope {
+   public:
+    RelationsOwnerScope(DepsgraphRelationBuilder &builder, const ID &id);
+    ~RelationsOwnerScope();
+
+    RelationsOwnerScope(const RelationsOwnerScope &other) = delete;
+    RelationsOwnerScope &operator=(const RelationsOwnerScope &other) = delete;
+
+   private:
+    DepsgraphRelationBuilder &builder_;
+    uint previous_owner_session_uuid_;
+  };
+
+  /* Assign the relation to the ID which is currently being built. */
+  void tag_relation_owner(Relation *relation);
+
   /* TODO(sergey): All those is_same* functions are to be generalized. */
 
   /* Check whether two keys corresponds to the same bone from same armature.
@@ -428,6 +454,9 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
   BuilderStack stack_;
+
+  /* Session UUID of the ID whose relations are being built, zero outside of ID builds. */
+  uint relations_owner_session_uuid_;
 };
 
 struct DepsNodeHandle {
@@ -37,6 +37,7 @@
 #include "intern/builder/deg_builder.h"
 #include "intern/builder/deg_builder_cache.h"
 #include "intern/builder/deg_builder_pchanmap.h"
+#include "intern/builder/deg_builder_pose_batch.h"
 #include "intern/debug/deg_debug.h"
 #include "intern/node/deg_node.h"
 #include "intern/node/deg_node_component.h"
@@ -359,6 +360,7 @@ void DepsgraphRelationBuilder::build_rig(Object *object)
     add_relation(local_transform_key, pose_key, "Local Transforms");
   }
   /* Links between operations for each bone. */
+  const PoseBonesBatches bones_batches(object);
   LISTBASE_FOREACH (bPoseChannel *, pchan, &object->pose->chanbase) {
     const BuilderStack::ScopedEntry stack_entry = stack_.trace(*pchan);
 
@@ -373,10 +375,27 @@ void DepsgraphRelationBuilder::build_rig(Object *object)
     pchan->flag &= ~POSE_DONE;
     /* Pose init to bone local. */
     add_relation(pose_init_key, bone_local_key, "Pose Init - Bone Local", RELATION_FLAG_GODMODE);
-    /* Local to pose parenting operation. */
-    add_relation(bone_local_key, bone_pose_key, "Bone Local - Bone Pose");
+    const PoseBonesBatch *batch = bones_batches.find_batch(pchan);
+    if (batch != nullptr) {
+      /* The batch evaluates the bone after its parent, the bone operations are no-ops which only
+       * pass the result to the users of the bone. */
+      OperationKey batch_key(
+          &object->id, NodeType::EVAL_POSE, batch->root->name, OperationCode::POSE_BONES_BATCH);
+      add_relation(bone_local_key, batch_key, "Bone Local -> Bones Batch");
+      add_relation(batch_key, bone_pose_key, "Bones Batch -> Bone Pose");
+      /* Parents of the topmost bone are not in the batch and have no common IK root with it. */
+      if (pchan == batch->root && pchan->parent != nullptr) {
+        OperationKey parent_key(
+            &object->id, NodeType::BONE, pchan->parent->name, OperationCode::BONE_DONE);
+        add_relation(parent_key, batch_key, "Parent Bone -> Bones Batch");
+      }
+    }
+    else {
+      /* Local to pose parenting operation. */
+      add_relation(bone_local_key, bone_pose_key, "Bone Local - Bone Pose");
+    }
     /* Parent relation. */
-    if (pchan->parent != nullptr) {
+    if (pchan->parent != nullptr && batch == nullptr) {
       OperationCode parent_key_opcode;
       /* NOTE: this difference in handling allows us to prevent lockups
        * while ensuring correct poses for separate chains. */
@@ -37,6 +37,8 @@ void DepsgraphRelationBuilder::build_scene_parameters(Scene *scene)
     return;
   }
 
+  const RelationsOwnerScope owner_scope(*this, scene->id);
+
   /* TODO(sergey): Trace as a scene parameters. */
 
   build_idproperties(scene->id.properties);
@@ -60,6 +62,8 @@ void DepsgraphRelationBuilder::build_scene_compositor(Scene *scene)
     return;
   }
 
+  const RelationsOwnerScope owner_scope(*this, scene->id);
+
   /* TODO(sergey): Trace as a scene compositor. */
 
   build_nodetree(scene->nodetree);
@@ -10,6 +10,7 @@
 #include "DNA_scene_types.h"
 
 #include "deg_builder_cycle.h"
+#include "deg_builder_incremental.h"
 #include "deg_builder_nodes.h"
 #include "deg_builder_relations.h"
 #include "deg_builder_transitive.h"
@@ -24,6 +25,8 @@ AbstractBuilderPipeline::AbstractBuilderPipeline(::Depsgraph *graph)
 {
 }
 
+AbstractBuilderPipeline::~AbstractBuilderPipeline() = default;
+
 void AbstractBuilderPipeline::build()
 {
   double start_time = 0.0;
@@ -50,9 +53,13 @@ void AbstractBuilderPipeline::build_step_sanity_check()
 
 void AbstractBuilderPipeline::build_step_nodes()
 {
+  if (use_incremental_relations_update() && IncrementalRelationsUpdate::is_possible(deg_graph_)) {
+    incremental_update_ = std::make_unique<IncrementalRelationsUpdate>(deg_graph_);
+  }
+
   /* Generate all the nodes in the graph first */
   unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
-  node_builder->begin_build();
+  node_builder->begin_build(incremental_update_.get());
   build_nodes(*node_builder);
   node_builder->end_build();
 }
@@ -62,9 +69,36 @@ void AbstractBuilderPipeline::build_step_relations()
   /* Hook up relationships between operations - to determine evaluation order. */
   unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
   relation_builder->begin_build();
+  if (incremental_update_) {
+    incremental_update_->reuse_relations(*relation_builder);
+  }
   build_relations(*relation_builder);
   relation_builder->build_copy_on_write_relations();
   relation_builder->build_driver_relations();
+
+  if (incremental_update_) {
+    const bool is_valid = incremental_update_->verify_relations(*relation_builder);
+    /* Frees nodes of the previous state of the graph. */
+    incremental_update_.reset();
+    if (!is_valid) {
+      if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+        printf("Depsgraph relations update: building all relations.\n");
+      }
+      deg_graph_clear_relations(deg_graph_);
+      build_step_relations();
+    }
+    else if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+      /* Compare with all relations built from scratch, which are the ones kept in the graph. */
+      const Vector<string> incremental_relations = deg_graph_relations_describe(deg_graph_);
+      deg_graph_clear_relations(deg_graph_);
+      build_step_relations();
+      const Vector<string> full_relations = deg_graph_relations_describe(deg_graph_);
+      const int num_differences = deg_graph_relations_print_difference(incremental_relations,
+                                                                       full_relations);
+      printf("Depsgraph relations update: %d relations differ from building all relations.\n",
+             num_differences);
+    }
+  }
 }
 
 void AbstractBuilderPipeline::build_step_finalize()
@@ -91,6 +125,13 @@ void AbstractBuilderPipeline::build_step_finalize()
 #endif
   /* Relations are up to date. */
   deg_graph_->need_update_relations = false;
+  deg_graph_->need_update_all_relations = false;
+  deg_graph_->relations_update_id_session_uuids.clear();
+}
+
+bool AbstractBuilderPipeline::use_incremental_relations_update() const
+{
+  return false;
 }
 
 unique_ptr<DepsgraphNodeBuilder> AbstractBuilderPipeline::construct_node_builder()
@@ -21,6 +21,7 @@ namespace blender::deg {
 struct Depsgraph;
 class DepsgraphNodeBuilder;
 class DepsgraphRelationBuilder;
+class IncrementalRelationsUpdate;
 
 /* Base class for Depsgraph Builder pipelines.
  *
@@ -33,7 +34,7 @@ class DepsgraphRelationBuilder;
 class AbstractBuilderPipeline {
  public:
   AbstractBuilderPipeline(::Depsgraph *graph);
-  virtual ~AbstractBuilderPipeline() = default;
+  virtual ~AbstractBuilderPipeline();
 
   void build();
 
@@ -43,6 +44,12 @@ class AbstractBuilderPipeline {
   Scene *scene_;
   ViewLayer *view_layer_;
   DepsgraphBuilderCache builder_cache_;
+  /* Set when only relations of some IDs are to be built, see #IncrementalRelationsUpdate. */
+  unique_ptr<IncrementalRelationsUpdate> incremental_update_;
+
+  /* Whether relations of IDs which did not change can be re-used from the previous state of the
+   * graph. */
+  virtual bool use_incremental_relations_update() const;
 
   virtual unique_ptr<DepsgraphNodeBuilder> construct_node_builder();
   virtual unique_ptr<DepsgraphRelationBuilder> construct_relation_builder();
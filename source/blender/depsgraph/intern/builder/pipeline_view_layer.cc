@@ -14,6 +14,12 @@ ViewLayerBuilderPipeline::ViewLayerBuilderPipeline(::Depsgraph *graph)
 {
 }
 
+bool ViewLayerBuilderPipeline::use_incremental_relations_update() const
+{
+  /* Graphs of view layers are the ones which are updated interactively. */
+  return true;
+}
+
 void ViewLayerBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
 {
   node_builder.build_view_layer(scene_, view_layer_, DEG_ID_LINKED_DIRECTLY);
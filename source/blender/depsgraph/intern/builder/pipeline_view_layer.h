@@ -16,6 +16,7 @@ class ViewLayerBuilderPipeline : public AbstractBuilderPipeline {
   ViewLayerBuilderPipeline(::Depsgraph *graph);
 
  protected:
+  virtual bool use_incremental_relations_update() const override;
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
   virtual void build_relations(DepsgraphRelationBuilder &relation_builder) override;
 };
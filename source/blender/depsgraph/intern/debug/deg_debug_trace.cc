@@ -0,0 +1,205 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/debug/deg_debug_trace.h"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+#include "BLI_fileops.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "PIL_time.h"
+
+#include "DEG_depsgraph_debug.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_type.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg {
+
+namespace trace_detail {
+std::atomic<bool> is_enabled = false;
+}
+
+namespace {
+
+struct TraceEvent {
+  string name;
+  /* Category of the event, as shown in the trace viewer. */
+  const char *category;
+  double start_time;
+  double end_time;
+  /* Time between the operation being scheduled and its evaluation starting, negative for events
+   * which are not operations. */
+  double wait_time;
+};
+
+/* Events recorded by a single thread, so that no locking is needed to record them. */
+struct ThreadTrace {
+  int thread_index;
+  Vector<TraceEvent> events;
+};
+
+struct Trace {
+  std::mutex mutex;
+  string filepath;
+  double start_time = 0.0;
+  /* Increased every time tracing begins or ends, invalidating the thread local pointers. */
+  std::atomic<int> generation = 0;
+  Vector<std::unique_ptr<ThreadTrace>> threads;
+};
+
+Trace &trace_get()
+{
+  static Trace trace;
+  return trace;
+}
+
+ThreadTrace &thread_trace_get()
+{
+  thread_local ThreadTrace *thread_trace = nullptr;
+  thread_local int thread_trace_generation = -1;
+
+  Trace &trace = trace_get();
+  if (thread_trace != nullptr && thread_trace_generation == trace.generation) {
+    return *thread_trace;
+  }
+
+  /* First event of this thread, only then locking is needed. */
+  std::scoped_lock lock(trace.mutex);
+  std::unique_ptr<ThreadTrace> new_trace = std::make_unique<ThreadTrace>();
+  new_trace->thread_index = int(trace.threads.size());
+  thread_trace = new_trace.get();
+  thread_trace_generation = trace.generation;
+  trace.threads.append(std::move(new_trace));
+  return *thread_trace;
+}
+
+void trace_write_string(FILE *file, const string &str)
+{
+  fputc('"', file);
+  for (const char c : str) {
+    if (ELEM(c, '"', '\\')) {
+      fputc('\\', file);
+      fputc(c, file);
+    }
+    else if (uchar(c) < 0x20) {
+      fprintf(file, "\\u%04x", uint(uchar(c)));
+    }
+    else {
+      fputc(c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+void trace_write(const Trace &trace, FILE *file)
+{
+  /* Times in the trace event format are in microseconds. */
+  const auto to_microseconds = [&](const double time) { return (time - trace.start_time) * 1e6; };
+
+  fprintf(file, "{\"traceEvents\": [\n");
+  bool is_first_event = true;
+  for (const std::unique_ptr<ThreadTrace> &thread_trace : trace.threads) {
+    fprintf(file,
+            "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %d, "
+            "\"args\": {\"name\": \"Thread %d\"}}",
+            is_first_event ? "" : ",\n",
+            thread_trace->thread_index,
+            thread_trace->thread_index);
+    is_first_event = false;
+
+    for (const TraceEvent &event : thread_trace->events) {
+      fprintf(file, ",\n{\"name\": ");
+      trace_write_string(file, event.name);
+      fprintf(file,
+              ", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %.3f, "
+              "\"dur\": %.3f",
+              event.category,
+              thread_trace->thread_index,
+              to_microseconds(event.start_time),
+              (event.end_time - event.start_time) * 1e6);
+      if (event.wait_time >= 0.0) {
+        fprintf(file, ", \"args\": {\"wait\": %.3f}", event.wait_time * 1e6);
+      }
+      fprintf(file, "}");
+    }
+  }
+  fprintf(file, "\n],\n");
+  fprintf(file, "\"displayTimeUnit\": \"ms\",\n");
+  fprintf(file, "\"otherData\": {\"num_threads\": %d}}\n", BLI_task_scheduler_num_threads());
+}
+
+}  // namespace
+
+void deg_debug_trace_operation(const OperationNode *operation_node,
+                               const double ready_time,
+                               const double start_time,
+                               const double end_time)
+{
+  ThreadTrace &thread_trace = thread_trace_get();
+  thread_trace.events.append({operation_node->full_identifier(),
+                              "operation",
+                              start_time,
+                              end_time,
+                              start_time - ready_time});
+}
+
+void deg_debug_trace_evaluation(const Depsgraph *graph,
+                                const double start_time,
+                                const double end_time)
+{
+  ThreadTrace &thread_trace = thread_trace_get();
+  const string name = graph->debug.name.empty() ? "Depsgraph" : "Depsgraph " + graph->debug.name;
+  thread_trace.events.append({name, "evaluation", start_time, end_time, -1.0});
+}
+
+}  // namespace blender::deg
+
+namespace deg = blender::deg;
+
+void DEG_debug_trace_begin(const char *filepath)
+{
+  deg::Trace &trace = deg::trace_get();
+  {
+    std::scoped_lock lock(trace.mutex);
+    trace.filepath = filepath;
+    trace.start_time = PIL_check_seconds_timer();
+    trace.generation++;
+    trace.threads.clear();
+  }
+  deg::trace_detail::is_enabled = true;
+}
+
+void DEG_debug_trace_end()
+{
+  if (!deg::deg_debug_trace_is_enabled()) {
+    return;
+  }
+  deg::trace_detail::is_enabled = false;
+
+  deg::Trace &trace = deg::trace_get();
+  std::scoped_lock lock(trace.mutex);
+
+  FILE *file = BLI_fopen(trace.filepath.c_str(), "w");
+  if (file == nullptr) {
+    fprintf(stderr, "Error: could not write depsgraph trace to '%s'\n", trace.filepath.c_str());
+  }
+  else {
+    deg::trace_write(trace, file);
+    fclose(file);
+    printf("Depsgraph trace written to '%s'\n", trace.filepath.c_str());
+  }
+
+  trace.generation++;
+  trace.threads.clear();
+}
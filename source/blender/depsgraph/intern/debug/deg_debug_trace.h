@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Recording of a timeline of dependency graph evaluations, enabled with
+ * `--debug-depsgraph-trace`. The timeline is written in the Chrome trace event format, which can
+ * be inspected with `chrome://tracing` or Perfetto.
+ */
+
+#pragma once
+
+#include <atomic>
+
+namespace blender::deg {
+
+struct Depsgraph;
+struct OperationNode;
+
+namespace trace_detail {
+extern std::atomic<bool> is_enabled;
+}
+
+/* Check whether evaluations are to be recorded. Cheap enough to be called for every operation. */
+inline bool deg_debug_trace_is_enabled()
+{
+  return trace_detail::is_enabled.load(std::memory_order_relaxed);
+}
+
+/* Record evaluation of an operation on the current thread.
+ * The ready time is the time the operation got scheduled after its dependencies were evaluated,
+ * all times are as returned by #PIL_check_seconds_timer. */
+void deg_debug_trace_operation(const OperationNode *operation_node,
+                               double ready_time,
+                               double start_time,
+                               double end_time);
+
+/* Record evaluation of an entire dependency graph on the current thread. */
+void deg_debug_trace_evaluation(const Depsgraph *graph, double start_time, double end_time);
+
+}  // namespace blender::deg
@@ -32,8 +32,22 @@ template<int MaxSamples> class AveragedTimeSampler {
     }
   }
 
+  void reset()
+  {
+    num_samples_ = 0;
+    next_sample_index_ = 0;
+  }
+
+  int num_samples() const
+  {
+    return num_samples_;
+  }
+
   double get_averaged() const
   {
+    if (num_samples_ == 0) {
+      return 0.0;
+    }
     double sum = 0.0;
     for (int i = 0; i < num_samples_; ++i) {
       sum += samples_[i];
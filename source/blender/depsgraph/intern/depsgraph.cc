@@ -47,6 +47,7 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
     : time_source(nullptr),
       has_animated_visibility(false),
       need_update_relations(true),
+      need_update_all_relations(true),
       need_update_nodes_visibility(true),
       need_tag_id_on_graph_visibility_update(true),
       need_tag_id_on_graph_visibility_time_update(false),
@@ -286,6 +287,8 @@ void DEG_graph_replace_owners(struct Depsgraph *depsgraph,
   deg_graph->bmain = bmain;
   deg_graph->scene = scene;
   deg_graph->view_layer = view_layer;
+  /* Relations can not be re-used for a different scene or view layer. */
+  deg_graph->need_update_all_relations = true;
 
   if (do_update_register) {
     deg::register_graph(deg_graph);
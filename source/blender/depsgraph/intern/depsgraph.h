@@ -94,6 +94,14 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update_relations;
 
+  /* Indicates whether relations of all IDs are to be built from scratch. When not set, only the
+   * relations of the IDs from #relations_update_id_session_uuids are updated, and the relations
+   * of other IDs are re-used from the current state of the graph. */
+  bool need_update_all_relations;
+
+  /* Session UUIDs of IDs which got their relations tagged for update. */
+  Set<uint> relations_update_id_session_uuids;
+
   /* Indicates whether indirect effect of nodes on a directly visible ones needs to be updated. */
   bool need_update_nodes_visibility;
 
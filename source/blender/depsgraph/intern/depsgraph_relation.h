@@ -9,6 +9,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_sys_types.h"
+
 namespace blender::deg {
 
 struct Node;
@@ -30,6 +32,8 @@ enum RelationFlag {
   RELATION_CHECK_BEFORE_ADD = (1 << 5),
   /* The relation does not participate in visibility checks. */
   RELATION_NO_VISIBILITY_CHANGE = (1 << 6),
+  /* The relation was added by builds of different IDs, see #Relation::owner_session_uuid. */
+  RELATION_FLAG_MULTIPLE_OWNERS = (1 << 7),
 };
 
 /* B depends on A (A -> B) */
@@ -47,6 +51,11 @@ struct Relation {
   const char *name; /* label for debugging */
   int flag;         /* Bitmask of RelationFlag) */
 
+  /* Session UUID of the ID during whose relations build this relation was added.
+   * Zero when the relation was added outside of building of any specific ID. Allows to re-use the
+   * relation when only relations of other IDs are updated. */
+  uint owner_session_uuid;
+
   MEM_CXX_CLASS_ALLOC_FUNCS("Relation");
 };
 
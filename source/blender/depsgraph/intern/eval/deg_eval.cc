@@ -9,12 +9,18 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <algorithm>
+
 #include "PIL_time.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap_simple.h"
+#include "BLI_map.hh"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -31,6 +37,7 @@
 
 #include "atomic_ops.h"
 
+#include "intern/debug/deg_debug_trace.h"
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_tag.h"
@@ -58,11 +65,6 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
-}
-
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -86,25 +88,58 @@ enum class EvaluationStage {
 struct DepsgraphEvalState {
   Depsgraph *graph;
   bool do_stats;
+  bool do_trace;
   EvaluationStage stage;
   bool need_update_pending_parents = true;
   bool need_single_thread_pass = false;
+
+  /* Operations which are ready to be evaluated by the task pool, ordered by their critical path
+   * cost. Used from multiple threads, guarded by the lock. */
+  HeapSimple *ready_queue;
+  SpinLock ready_queue_lock;
+
+  /* Time at which queued operations got scheduled, only stored when tracing. */
+  Map<const OperationNode *, double> ready_times;
 };
 
-void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
+/* Every task pushed to the pool evaluates the ready operation with the longest critical path at
+ * the time the task runs, rather than the operation which caused the task to be pushed. This way
+ * long chains of operations start as early as possible, instead of in the order their
+ * dependencies happened to finish. */
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+
+  BLI_spin_lock(&state->ready_queue_lock);
+  BLI_heapsimple_insert(state->ready_queue, -node->critical_path_cost, node);
+  if (state->do_trace) {
+    state->ready_times.add_overwrite(node, PIL_check_seconds_timer());
+  }
+  BLI_spin_unlock(&state->ready_queue_lock);
+
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
+void evaluate_node(const DepsgraphEvalState *state,
+                   OperationNode *operation_node,
+                   const double ready_time)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
 
   /* Sanity checks. */
   BLI_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
+  /* Perform operation. The time is always measured, it is used to estimate the cost of the
+   * operation for scheduling of the next evaluations. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double evaluation_time = PIL_check_seconds_timer() - start_time;
+  operation_node->stats.averaged_time.add_sample(evaluation_time);
   if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    operation_node->stats.current_time += evaluation_time;
   }
-  else {
-    operation_node->evaluate(depsgraph);
+  if (state->do_trace) {
+    deg_debug_trace_operation(
+        operation_node, ready_time, start_time, start_time + evaluation_time);
   }
 
   /* Clear the flag early on, allowing partial updates without re-evaluating the same node multiple
@@ -115,14 +150,19 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
                             DEPSOP_FLAG_USER_MODIFIED);
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+void deg_task_run_func(TaskPool *pool, void *UNUSED(taskdata))
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
+  /* Pick the most important ready node, there is one queued for every pushed task. */
+  BLI_spin_lock(&state->ready_queue_lock);
+  OperationNode *operation_node = (OperationNode *)BLI_heapsimple_pop_min(state->ready_queue);
+  const double ready_time = state->do_trace ? state->ready_times.pop(operation_node) : 0.0;
+  BLI_spin_unlock(&state->ready_queue_lock);
+
   /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
+  evaluate_node(state, operation_node, ready_time);
 
   /* Schedule children. */
   schedule_children(state, operation_node, schedule_node_to_pool, pool);
@@ -191,6 +231,67 @@ void calculate_pending_parents_if_needed(DepsgraphEvalState *state)
   state->need_update_pending_parents = false;
 }
 
+enum {
+  CRITICAL_PATH_NOT_VISITED = 0,
+  CRITICAL_PATH_IN_PROGRESS = 1,
+  CRITICAL_PATH_DONE = 2,
+};
+
+/* Calculate the estimated cost of the longest chain of operations which need evaluation, starting
+ * at every operation tagged for update. Cyclic relations are ignored. */
+void calculate_critical_paths(Depsgraph *graph)
+{
+  for (OperationNode *node : graph->operations) {
+    node->custom_flags = CRITICAL_PATH_NOT_VISITED;
+  }
+
+  /* Iterative post-order depth-first traversal, so that the cost of all children is known by the
+   * time the cost of an operation is calculated. Long rigs easily exceed the stack size if done
+   * recursively. */
+  struct StackEntry {
+    OperationNode *node;
+    int64_t next_child;
+  };
+  Vector<StackEntry> stack;
+
+  for (OperationNode *root : graph->operations) {
+    if (root->custom_flags != CRITICAL_PATH_NOT_VISITED ||
+        (root->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+      continue;
+    }
+    root->custom_flags = CRITICAL_PATH_IN_PROGRESS;
+    stack.append({root, 0});
+
+    while (!stack.is_empty()) {
+      StackEntry &entry = stack.last();
+      OperationNode *node = entry.node;
+
+      if (entry.next_child < node->outlinks.size()) {
+        const Relation *rel = node->outlinks[entry.next_child++];
+        OperationNode *child = (OperationNode *)rel->to;
+        if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 &&
+            child->custom_flags == CRITICAL_PATH_NOT_VISITED &&
+            (child->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0) {
+          child->custom_flags = CRITICAL_PATH_IN_PROGRESS;
+          stack.append({child, 0});
+        }
+        continue;
+      }
+
+      float children_cost = 0.0f;
+      for (const Relation *rel : node->outlinks) {
+        const OperationNode *child = (const OperationNode *)rel->to;
+        if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 && child->custom_flags == CRITICAL_PATH_DONE) {
+          children_cost = std::max(children_cost, child->critical_path_cost);
+        }
+      }
+      node->critical_path_cost = float(deg_eval_stats_operation_cost(node)) + children_cost;
+      node->custom_flags = CRITICAL_PATH_DONE;
+      stack.remove_last();
+    }
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   /* Clear tags and other things which needs to be clear. */
@@ -199,6 +300,9 @@ void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
       node->stats.reset_current();
     }
   }
+
+  /* Needs to happen before any of the evaluation stages clears the update tags. */
+  calculate_critical_paths(graph);
 }
 
 bool is_metaball_object_operation(const OperationNode *operation_node)
@@ -357,7 +461,9 @@ void evaluate_graph_single_threaded_if_needed(DepsgraphEvalState *state)
     OperationNode *operation_node;
     BLI_gsqueue_pop(evaluation_queue, &operation_node);
 
-    evaluate_node(state, operation_node);
+    /* Nodes are evaluated in the order they got ready, the time spent waiting in the queue is not
+     * interesting for tracing. */
+    evaluate_node(state, operation_node, PIL_check_seconds_timer());
     schedule_children(state, operation_node, schedule_node_to_queue, evaluation_queue);
   }
 
@@ -399,6 +505,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   }
 
   graph->debug.begin_graph_evaluation();
+  const double start_time = PIL_check_seconds_timer();
 
 #ifdef WITH_PYTHON
   /* Release the GIL so that Python drivers can be evaluated. See T91046. */
@@ -412,6 +519,9 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   DepsgraphEvalState state;
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
+  state.do_trace = deg_debug_trace_is_enabled();
+  state.ready_queue = BLI_heapsimple_new();
+  BLI_spin_init(&state.ready_queue_lock);
 
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
@@ -457,6 +567,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   evaluate_graph_threaded_stage(&state, task_pool, EvaluationStage::THREADED_EVALUATION);
 
   BLI_task_pool_free(task_pool);
+  BLI_heapsimple_free(state.ready_queue, nullptr);
+  BLI_spin_end(&state.ready_queue_lock);
 
   evaluate_graph_single_threaded_if_needed(&state);
 
@@ -475,6 +587,10 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   BPy_END_ALLOW_THREADS;
 #endif
 
+  if (state.do_trace) {
+    deg_debug_trace_evaluation(graph, start_time, PIL_check_seconds_timer());
+  }
+
   graph->debug.end_graph_evaluation();
 }
 
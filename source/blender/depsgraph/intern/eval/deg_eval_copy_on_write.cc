@@ -41,6 +41,9 @@
 #include "DNA_ID.h"
 #include "DNA_anim_types.h"
 #include "DNA_armature_types.h"
+#include "DNA_color_types.h"
+#include "DNA_genfile.h"
+#include "DNA_sdna_types.h"
 #include "DNA_gpencil_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_modifier_types.h"
@@ -67,6 +70,12 @@
 #  include "DNA_world_types.h"
 #endif
 
+/* Needed by the in-place update of existing copies, regardless of the workaround above. */
+#include "DNA_light_types.h"
+#include "DNA_material_types.h"
+#include "DNA_node_types.h"
+#include "DNA_world_types.h"
+
 #include "BKE_action.h"
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
@@ -74,6 +83,7 @@
 #include "BKE_editmesh.h"
 #include "BKE_lib_query.h"
 #include "BKE_modifier.h"
+#include "BKE_node.h"
 #include "BKE_object.h"
 #include "BKE_pointcache.h"
 #include "BKE_sound.h"
@@ -857,6 +867,391 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode
   return id_cow;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name In-place update of existing copies
+ *
+ * Edits of properties, like dragging a slider of a material used by many objects, only change
+ * values of a datablock. Instead of freeing the copy and copying the entire datablock again, the
+ * changed values are copied into the existing copy, as long as the structure of the data (nodes,
+ * sockets, links and other owned data) did not change.
+ *
+ * The DNA struct info is used to find the values and pointers of every struct. All pointers must
+ * be known here: references to other datablocks must point to their copy, and owned data must
+ * be handled explicitly. Anything unexpected falls back to a full copy.
+ * \{ */
+
+bool patch_pointer_is_compatible(const void *orig_pointer,
+                                 const void *cow_pointer,
+                                 const bool is_id,
+                                 void *UNUSED(user_data))
+{
+  if (orig_pointer == nullptr || cow_pointer == nullptr) {
+    return false;
+  }
+  if (is_id) {
+    return ((const ID *)cow_pointer)->orig_id == orig_pointer;
+  }
+  /* Owned data which is not handled explicitly. */
+  return false;
+}
+
+bool patch_struct(const char *struct_name,
+                  const void *orig,
+                  void *cow,
+                  const char **skip_members,
+                  bool *r_changed)
+{
+  const SDNA *sdna = DNA_sdna_current_get();
+  const int struct_nr = DNA_struct_find_nr(sdna, struct_name);
+  BLI_assert(struct_nr != -1);
+  return DNA_struct_patch_values(
+      sdna, struct_nr, orig, cow, skip_members, patch_pointer_is_compatible, nullptr, r_changed);
+}
+
+/* Owned data of which the struct is not known, or which is not expected to change through
+ * property edits. */
+bool patch_opaque_data_is_equal(const void *orig, const void *cow)
+{
+  if (orig == nullptr || cow == nullptr) {
+    return orig == cow;
+  }
+  const size_t size = MEM_allocN_len(orig);
+  return size == MEM_allocN_len(cow) && memcmp(orig, cow, size) == 0;
+}
+
+/* Owned data of a known struct type, which is allocated as a single struct. */
+bool patch_owned_struct(const char *struct_name, const void *orig, void *cow, bool *r_changed)
+{
+  if (orig == nullptr || cow == nullptr) {
+    return orig == cow;
+  }
+  const SDNA *sdna = DNA_sdna_current_get();
+  const int struct_nr = DNA_struct_find_nr(sdna, struct_name);
+  const size_t struct_size = size_t(sdna->types_size[sdna->structs[struct_nr]->type]);
+  if (MEM_allocN_len(orig) != struct_size || MEM_allocN_len(cow) != struct_size) {
+    return patch_opaque_data_is_equal(orig, cow);
+  }
+  return patch_struct(struct_name, orig, cow, nullptr, r_changed);
+}
+
+bool patch_id_properties(const IDProperty *orig, const IDProperty *cow)
+{
+  if (orig == nullptr || cow == nullptr) {
+    return orig == cow;
+  }
+  return IDP_EqualsProperties(const_cast<IDProperty *>(orig), const_cast<IDProperty *>(cow));
+}
+
+bool patch_string(const char *orig, const char *cow)
+{
+  if (orig == nullptr || cow == nullptr) {
+    return orig == cow;
+  }
+  return STREQ(orig, cow);
+}
+
+/* The ID struct itself is skipped when patching, it holds runtime data and pointers set up by the
+ * copy. Its name and custom properties are user data though, edits of those need a full copy. */
+bool patch_id_is_equal(const ID *id_orig, const ID *id_cow)
+{
+  return STREQ(id_orig->name, id_cow->name) &&
+         patch_id_properties(id_orig->properties, id_cow->properties);
+}
+
+const char *node_socket_value_struct_name(const int socket_type)
+{
+  switch (socket_type) {
+    case SOCK_FLOAT:
+      return "bNodeSocketValueFloat";
+    case SOCK_INT:
+      return "bNodeSocketValueInt";
+    case SOCK_BOOLEAN:
+      return "bNodeSocketValueBoolean";
+    case SOCK_VECTOR:
+      return "bNodeSocketValueVector";
+    case SOCK_RGBA:
+      return "bNodeSocketValueRGBA";
+    case SOCK_STRING:
+      return "bNodeSocketValueString";
+    case SOCK_OBJECT:
+      return "bNodeSocketValueObject";
+    case SOCK_IMAGE:
+      return "bNodeSocketValueImage";
+    case SOCK_COLLECTION:
+      return "bNodeSocketValueCollection";
+    case SOCK_TEXTURE:
+      return "bNodeSocketValueTexture";
+    case SOCK_MATERIAL:
+      return "bNodeSocketValueMaterial";
+  }
+  return nullptr;
+}
+
+bool patch_node_socket(const bNodeSocket *socket_orig, bNodeSocket *socket_cow, bool *r_changed)
+{
+  if (!STREQ(socket_orig->identifier, socket_cow->identifier) ||
+      socket_orig->type != socket_cow->type) {
+    return false;
+  }
+  /* Links are checked as part of the tree. */
+  if ((socket_orig->link == nullptr) != (socket_cow->link == nullptr)) {
+    return false;
+  }
+  if (!patch_id_properties(socket_orig->prop, socket_cow->prop) ||
+      !patch_opaque_data_is_equal(socket_orig->storage, socket_cow->storage) ||
+      !patch_string(socket_orig->default_attribute_name, socket_cow->default_attribute_name)) {
+    return false;
+  }
+
+  const char *value_struct_name = node_socket_value_struct_name(socket_orig->type);
+  if (value_struct_name == nullptr) {
+    if (!patch_opaque_data_is_equal(socket_orig->default_value, socket_cow->default_value)) {
+      return false;
+    }
+  }
+  else if (!patch_owned_struct(value_struct_name,
+                                socket_orig->default_value,
+                                socket_cow->default_value,
+                                r_changed)) {
+    return false;
+  }
+
+  static const char *skip_members[] = {"next",
+                                       "prev",
+                                       "prop",
+                                       "storage",
+                                       "default_value",
+                                       "default_attribute_name",
+                                       "cache",
+                                       "groupsock",
+                                       "link",
+                                       "runtime",
+                                       nullptr};
+  return patch_struct("bNodeSocket", socket_orig, socket_cow, skip_members, r_changed);
+}
+
+bool patch_node_sockets(const ListBase *sockets_orig, ListBase *sockets_cow, bool *r_changed)
+{
+  const bNodeSocket *socket_orig = (const bNodeSocket *)sockets_orig->first;
+  bNodeSocket *socket_cow = (bNodeSocket *)sockets_cow->first;
+  while (socket_orig && socket_cow) {
+    if (!patch_node_socket(socket_orig, socket_cow, r_changed)) {
+      return false;
+    }
+    socket_orig = socket_orig->next;
+    socket_cow = socket_cow->next;
+  }
+  return socket_orig == nullptr && socket_cow == nullptr;
+}
+
+bool patch_node_links(const ListBase *links_orig, ListBase *links_cow, bool *r_changed)
+{
+  static const char *skip_members[] = {
+      "next", "prev", "fromnode", "tonode", "fromsock", "tosock", nullptr};
+
+  const bNodeLink *link_orig = (const bNodeLink *)links_orig->first;
+  bNodeLink *link_cow = (bNodeLink *)links_cow->first;
+  for (; link_orig && link_cow; link_orig = link_orig->next, link_cow = link_cow->next) {
+    if (!STREQ(link_orig->fromnode->name, link_cow->fromnode->name) ||
+        !STREQ(link_orig->tonode->name, link_cow->tonode->name) ||
+        !STREQ(link_orig->fromsock->identifier, link_cow->fromsock->identifier) ||
+        !STREQ(link_orig->tosock->identifier, link_cow->tosock->identifier)) {
+      return false;
+    }
+    if (!patch_struct("bNodeLink", link_orig, link_cow, skip_members, r_changed)) {
+      return false;
+    }
+  }
+  return link_orig == nullptr && link_cow == nullptr;
+}
+
+bool patch_node(const bNode *node_orig, bNode *node_cow, bool *r_changed)
+{
+  if (!STREQ(node_orig->name, node_cow->name) || !STREQ(node_orig->idname, node_cow->idname)) {
+    return false;
+  }
+  if ((node_orig->parent == nullptr) != (node_cow->parent == nullptr) ||
+      (node_orig->parent && !STREQ(node_orig->parent->name, node_cow->parent->name))) {
+    return false;
+  }
+  if (!patch_id_properties(node_orig->prop, node_cow->prop)) {
+    return false;
+  }
+
+  const char *storage_struct_name = node_orig->typeinfo->storagename;
+  if (storage_struct_name[0] && DNA_struct_find(DNA_sdna_current_get(), storage_struct_name)) {
+    if (!patch_owned_struct(
+            storage_struct_name, node_orig->storage, node_cow->storage, r_changed)) {
+      return false;
+    }
+  }
+  else if (!patch_opaque_data_is_equal(node_orig->storage, node_cow->storage)) {
+    return false;
+  }
+
+  if (!patch_node_sockets(&node_orig->inputs, &node_cow->inputs, r_changed) ||
+      !patch_node_sockets(&node_orig->outputs, &node_cow->outputs, r_changed) ||
+      !patch_node_links(&node_orig->internal_links, &node_cow->internal_links, r_changed)) {
+    return false;
+  }
+
+  static const char *skip_members[] = {"next",
+                                       "prev",
+                                       "prop",
+                                       "inputs",
+                                       "outputs",
+                                       "parent",
+                                       "storage",
+                                       "original",
+                                       "internal_links",
+                                       "runtime",
+                                       nullptr};
+  return patch_struct("bNode", node_orig, node_cow, skip_members, r_changed);
+}
+
+bool patch_node_tree(const bNodeTree *ntree_orig, bNodeTree *ntree_cow, bool *r_changed)
+{
+  if (ntree_orig == nullptr || ntree_cow == nullptr) {
+    return ntree_orig == ntree_cow;
+  }
+  if (!patch_id_is_equal(&ntree_orig->id, &ntree_cow->id)) {
+    return false;
+  }
+
+  const bNode *node_orig = (const bNode *)ntree_orig->nodes.first;
+  bNode *node_cow = (bNode *)ntree_cow->nodes.first;
+  for (; node_orig && node_cow; node_orig = node_orig->next, node_cow = node_cow->next) {
+    if (!patch_node(node_orig, node_cow, r_changed)) {
+      return false;
+    }
+  }
+  if (node_orig != nullptr || node_cow != nullptr) {
+    return false;
+  }
+
+  if (!patch_node_links(&ntree_orig->links, &ntree_cow->links, r_changed) ||
+      !patch_node_sockets(&ntree_orig->inputs, &ntree_cow->inputs, r_changed) ||
+      !patch_node_sockets(&ntree_orig->outputs, &ntree_cow->outputs, r_changed)) {
+    return false;
+  }
+
+  static const char *skip_members[] = {"id",
+                                       "interface_type",
+                                       "nodes",
+                                       "links",
+                                       "inputs",
+                                       "outputs",
+                                       "previews",
+                                       "execdata",
+                                       "tbh",
+                                       "prh",
+                                       "sdh",
+                                       "udh",
+                                       "preview",
+                                       "runtime",
+                                       nullptr};
+  return patch_struct("bNodeTree", ntree_orig, ntree_cow, skip_members, r_changed);
+}
+
+bool patch_curve_mapping(const CurveMapping *cumap_orig, CurveMapping *cumap_cow, bool *r_changed)
+{
+  if (cumap_orig == nullptr || cumap_cow == nullptr) {
+    return cumap_orig == cumap_cow;
+  }
+
+  static const char *skip_members[] = {"curve", "table", "premultable", nullptr};
+  for (int i = 0; i < CM_TOT; i++) {
+    const CurveMap *cuma_orig = &cumap_orig->cm[i];
+    CurveMap *cuma_cow = &cumap_cow->cm[i];
+    if (cuma_orig->totpoint != cuma_cow->totpoint ||
+        (cuma_orig->table == nullptr) != (cuma_cow->table == nullptr) ||
+        (cuma_orig->premultable == nullptr) != (cuma_cow->premultable == nullptr)) {
+      return false;
+    }
+    /* Curve points and the tables evaluated from them contain no pointers. */
+    const std::pair<const CurveMapPoint *, CurveMapPoint *> arrays[] = {
+        {cuma_orig->curve, cuma_cow->curve},
+        {cuma_orig->table, cuma_cow->table},
+        {cuma_orig->premultable, cuma_cow->premultable}};
+    const int arrays_len[] = {cuma_orig->totpoint, CM_TABLE + 1, CM_TABLE + 1};
+    for (int a = 0; a < int(ARRAY_SIZE(arrays)); a++) {
+      const size_t size = sizeof(CurveMapPoint) * arrays_len[a];
+      if (arrays[a].first && memcmp(arrays[a].first, arrays[a].second, size) != 0) {
+        memcpy(arrays[a].second, arrays[a].first, size);
+        *r_changed = true;
+      }
+    }
+    if (!patch_struct("CurveMap", cuma_orig, cuma_cow, skip_members, r_changed)) {
+      return false;
+    }
+  }
+
+  static const char *cumap_skip_members[] = {"cm", nullptr};
+  return patch_struct("CurveMapping", cumap_orig, cumap_cow, cumap_skip_members, r_changed);
+}
+
+/* Try to update the existing copy of the datablock in place.
+ * Returns false when the full copy is needed. */
+bool deg_patch_copy_on_write_datablock(const ID *id_orig, ID *id_cow)
+{
+  if (!patch_id_is_equal(id_orig, id_cow)) {
+    return false;
+  }
+
+  bool changed = false;
+  bool patched = false;
+  switch (GS(id_orig->name)) {
+    case ID_MA: {
+      const Material *material_orig = (const Material *)id_orig;
+      Material *material_cow = (Material *)id_cow;
+      static const char *skip_members[] = {
+          "id", "nodetree", "preview", "texpaintslot", "gpumaterial", "gp_style", nullptr};
+      patched = patch_node_tree(material_orig->nodetree, material_cow->nodetree, &changed) &&
+                patch_owned_struct("MaterialGPencilStyle",
+                                   material_orig->gp_style,
+                                   material_cow->gp_style,
+                                   &changed) &&
+                patch_struct("Material", material_orig, material_cow, skip_members, &changed);
+      break;
+    }
+    case ID_WO: {
+      const World *world_orig = (const World *)id_orig;
+      World *world_cow = (World *)id_cow;
+      static const char *skip_members[] = {
+          "id", "nodetree", "preview", "lightgroup", "gpumaterial", nullptr};
+      patched = patch_node_tree(world_orig->nodetree, world_cow->nodetree, &changed) &&
+                patch_owned_struct("LightgroupMembership",
+                                   world_orig->lightgroup,
+                                   world_cow->lightgroup,
+                                   &changed) &&
+                patch_struct("World", world_orig, world_cow, skip_members, &changed);
+      break;
+    }
+    case ID_LA: {
+      const Light *light_orig = (const Light *)id_orig;
+      Light *light_cow = (Light *)id_cow;
+      static const char *skip_members[] = {"id", "nodetree", "preview", "curfalloff", nullptr};
+      patched = patch_node_tree(light_orig->nodetree, light_cow->nodetree, &changed) &&
+                patch_curve_mapping(light_orig->curfalloff, light_cow->curfalloff, &changed) &&
+                patch_struct("Light", light_orig, light_cow, skip_members, &changed);
+      break;
+    }
+    default:
+      break;
+  }
+
+  if (patched) {
+    DEG_COW_PRINT("Patched datablock %s in place: changed=%d id_orig=%p id_cow=%p\n",
+                  id_orig->name,
+                  int(changed),
+                  id_orig,
+                  id_cow);
+  }
+  return patched;
+}
+
+/** \} */
+
 }  // namespace
 
 ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode *id_node)
@@ -899,6 +1294,11 @@ ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode
     }
   }
 
+  /* Property edits only change values, which can be copied into the existing copy. */
+  if (check_datablock_expanded(id_cow) && deg_patch_copy_on_write_datablock(id_orig, id_cow)) {
+    return id_cow;
+  }
+
   RuntimeBackup backup(depsgraph);
   backup.init_from_id(id_cow);
   deg_free_copy_on_write_datablock(id_cow);
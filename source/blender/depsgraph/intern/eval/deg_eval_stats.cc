@@ -38,4 +38,34 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+/* Rough evaluation time of operations which were never evaluated yet, only the relative cost of
+ * the different kinds of operations matters. */
+static double operation_cost_static_estimate(const OperationNode *op_node)
+{
+  switch (op_node->owner->type) {
+    case NodeType::GEOMETRY:
+    case NodeType::PARTICLE_SYSTEM:
+    case NodeType::POINT_CACHE:
+    case NodeType::SIMULATION:
+      return 1e-3;
+    case NodeType::SEQUENCER:
+    case NodeType::AUDIO:
+    case NodeType::COPY_ON_WRITE:
+      return 1e-4;
+    default:
+      return 1e-5;
+  }
+}
+
+double deg_eval_stats_operation_cost(const OperationNode *op_node)
+{
+  if (op_node->is_noop()) {
+    return 0.0;
+  }
+  if (op_node->stats.averaged_time.num_samples() != 0) {
+    return op_node->stats.averaged_time.get_averaged();
+  }
+  return operation_cost_static_estimate(op_node);
+}
+
 }  // namespace blender::deg
@@ -10,8 +10,13 @@
 namespace blender::deg {
 
 struct Depsgraph;
+struct OperationNode;
 
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Estimated evaluation time of the operation in seconds. Uses the timing of previous evaluations
+ * when available, and a static estimate based on the kind of operation otherwise. */
+double deg_eval_stats_operation_cost(const OperationNode *op_node);
+
 }  // namespace blender::deg
@@ -9,6 +9,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "intern/debug/deg_time_average.h"
 #include "intern/depsgraph_type.h"
 
 #include "BLI_utildefines.h"
@@ -163,6 +164,9 @@ struct Node {
     void reset_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Evaluation time of the last evaluations of the node, gathered regardless of whether time
+     * debugging is enabled. Used to estimate the cost of operations for scheduling. */
+    AveragedTimeSampler<4> averaged_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
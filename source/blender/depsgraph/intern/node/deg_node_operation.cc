@@ -114,6 +114,8 @@ const char *operationCodeAsString(OperationCode opcode)
       return "POSE_IK_SOLVER";
     case OperationCode::POSE_SPLINE_IK_SOLVER:
       return "POSE_SPLINE_IK_SOLVER";
+    case OperationCode::POSE_BONES_BATCH:
+      return "POSE_BONES_BATCH";
     /* Bone. */
     case OperationCode::BONE_LOCAL:
       return "BONE_LOCAL";
@@ -202,7 +204,7 @@ const char *operationCodeAsString(OperationCode opcode)
   return "UNKNOWN";
 }
 
-OperationNode::OperationNode() : name_tag(-1), flag(0)
+OperationNode::OperationNode() : critical_path_cost(0.0f), name_tag(-1), flag(0)
 {
 }
 
@@ -112,6 +112,8 @@ enum class OperationCode {
   /* IK/Spline Solvers */
   POSE_IK_SOLVER,
   POSE_SPLINE_IK_SOLVER,
+  /* Evaluation of a sub-tree of bones without constraints, instead of an operation per bone. */
+  POSE_BONES_BATCH,
 
   /* Bone. ---------------------------------------------------------------- */
   /* Bone local transforms - entry point */
@@ -268,6 +270,10 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated time in seconds of the longest chain of operations which starts at this operation
+   * and needs to be evaluated. Operations with the longest chains are evaluated first. */
+  float critical_path_cost;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
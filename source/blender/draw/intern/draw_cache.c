@@ -3330,6 +3330,43 @@ void drw_batch_cache_generate_requested_delayed(Object *ob)
   BLI_gset_add(DST.delayed_extraction, ob);
 }
 
+void drw_batch_cache_generate_requested_scheduled(Object *ob)
+{
+  /* NOTE: Conditions match the ones of #drw_batch_cache_generate_requested where neither paint
+   * mode nor hiding are used. Meshes in edit mode can be shared with the edited object. */
+  if (ob->type == OB_MESH && ((Mesh *)ob->data)->edit_mesh == NULL) {
+    const DRWContextState *draw_ctx = DRW_context_state_get();
+    const enum eContextObjectMode mode = CTX_data_mode_enum_ex(
+        draw_ctx->object_edit, draw_ctx->obact, draw_ctx->object_mode);
+    const bool is_paint_mode = ELEM(mode,
+                                    CTX_MODE_SCULPT,
+                                    CTX_MODE_PAINT_TEXTURE,
+                                    CTX_MODE_PAINT_VERTEX,
+                                    CTX_MODE_PAINT_WEIGHT);
+    if (!is_paint_mode) {
+      BLI_gset_add(DST.scheduled_extraction, ob);
+      return;
+    }
+  }
+  drw_batch_cache_generate_requested(ob);
+}
+
+void drw_batch_cache_generate_scheduled(void)
+{
+  const DRWContextState *draw_ctx = DRW_context_state_get();
+  struct DRWMeshExtractScheduler *scheduler = DRW_mesh_extract_scheduler_create(DST.task_graph);
+
+  GSetIterator gs_iter;
+  GSET_ITER (gs_iter, DST.scheduled_extraction) {
+    Object *ob = BLI_gsetIterator_getKey(&gs_iter);
+    DRW_mesh_batch_cache_create_requested_scheduled(
+        scheduler, ob, (Mesh *)ob->data, draw_ctx->scene);
+  }
+
+  DRW_mesh_extract_scheduler_free(scheduler);
+  BLI_gset_clear(DST.scheduled_extraction, NULL);
+}
+
 void DRW_batch_cache_free_old(Object *ob, int ctime)
 {
   switch (ob->type) {
@@ -286,6 +286,8 @@ struct MeshBatchCache {
   int poly_len;
   int vert_len;
   int mat_len;
+  /* Topology hash of the mesh the cache was created for, see #Mesh_Runtime.topology_hash. */
+  uint32_t topology_hash;
   /* Instantly invalidates cache, skipping mesh check */
   bool is_dirty;
   bool is_editmode;
@@ -320,7 +322,46 @@ struct MeshBatchCache {
 
 namespace blender::draw {
 
+struct ExtractSmallMeshesTaskData;
+struct ExtractTaskData;
+struct MeshRenderDataUpdateTaskData;
+
+/**
+ * Schedules extraction of meshes of multiple objects in a shared task graph.
+ *
+ * Meshes which are too small to split their extraction into ranges are grouped, so that a single
+ * task extracts many of them instead of each mesh paying for the overhead of its own tasks.
+ */
+class MeshExtractScheduler {
+ public:
+  MeshExtractScheduler(TaskGraph *task_graph);
+  /** Pushes remaining extraction work to the task graph, waiting for it is up to the caller. */
+  ~MeshExtractScheduler();
+
+  TaskGraph *task_graph() const
+  {
+    return task_graph_;
+  }
+
+  /** Add extraction of a small mesh, taking ownership of the task data. */
+  void add_small_mesh(MeshRenderDataUpdateTaskData *update_task_data,
+                      ExtractTaskData *extract_task_data);
+
+  /** Push the pending group of small meshes to the task graph. */
+  void flush();
+
+ private:
+  TaskGraph *task_graph_;
+  ExtractSmallMeshesTaskData *pending_ = nullptr;
+  int pending_loops_len_ = 0;
+};
+
+/**
+ * \param scheduler: When not null, extraction of small meshes is grouped with other meshes
+ * extracted by the scheduler, see #MeshExtractScheduler.
+ */
 void mesh_buffer_cache_create_requested(TaskGraph *task_graph,
+                                        MeshExtractScheduler *scheduler,
                                         MeshBatchCache *cache,
                                         MeshBufferCache *mbc,
                                         Object *object,
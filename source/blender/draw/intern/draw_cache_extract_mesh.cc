@@ -547,11 +547,96 @@ static struct TaskNode *mesh_extract_render_data_node_create(struct TaskGraph *t
 
 /** \} */
 
+/* ---------------------------------------------------------------------- */
+/** \name Extract Scheduler
+ * \{ */
+
+/** Number of loops of small meshes that are extracted by a single task. */
+#define SMALL_MESHES_TASK_LOOPS_LEN (MIN_RANGE_LEN * 16)
+
+struct SmallMeshTaskData {
+  MeshRenderDataUpdateTaskData *update_task_data;
+  ExtractTaskData *extract_task_data;
+};
+
+struct ExtractSmallMeshesTaskData {
+  Vector<SmallMeshTaskData> meshes;
+
+  ~ExtractSmallMeshesTaskData()
+  {
+    for (const SmallMeshTaskData &mesh : meshes) {
+      delete mesh.extract_task_data;
+      delete mesh.update_task_data;
+    }
+  }
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("DRW:ExtractSmallMeshesTaskData")
+#endif
+};
+
+static void extract_small_meshes_task_data_free(void *data)
+{
+  ExtractSmallMeshesTaskData *taskdata = static_cast<ExtractSmallMeshesTaskData *>(data);
+  delete taskdata;
+}
+
+static void extract_small_meshes_task_run(void *__restrict taskdata)
+{
+  ExtractSmallMeshesTaskData *data = static_cast<ExtractSmallMeshesTaskData *>(taskdata);
+  for (const SmallMeshTaskData &mesh : data->meshes) {
+    mesh_extract_render_data_node_exec(mesh.update_task_data);
+    extract_task_range_run(mesh.extract_task_data);
+  }
+}
+
+MeshExtractScheduler::MeshExtractScheduler(TaskGraph *task_graph) : task_graph_(task_graph)
+{
+}
+
+MeshExtractScheduler::~MeshExtractScheduler()
+{
+  flush();
+}
+
+void MeshExtractScheduler::add_small_mesh(MeshRenderDataUpdateTaskData *update_task_data,
+                                          ExtractTaskData *extract_task_data)
+{
+  if (pending_ == nullptr) {
+    pending_ = new ExtractSmallMeshesTaskData();
+  }
+  pending_->meshes.append({update_task_data, extract_task_data});
+
+  const MeshRenderData *mr = update_task_data->mr;
+  pending_loops_len_ += mr->loop_len + mr->loop_loose_len;
+  if (pending_loops_len_ >= SMALL_MESHES_TASK_LOOPS_LEN) {
+    flush();
+  }
+}
+
+void MeshExtractScheduler::flush()
+{
+  if (pending_ == nullptr) {
+    return;
+  }
+  struct TaskNode *task_node = BLI_task_graph_node_create(
+      task_graph_,
+      extract_small_meshes_task_run,
+      pending_,
+      (TaskGraphNodeFreeFunction)extract_small_meshes_task_data_free);
+  BLI_task_graph_node_push_work(task_node);
+  pending_ = nullptr;
+  pending_loops_len_ = 0;
+}
+
+/** \} */
+
 /* ---------------------------------------------------------------------- */
 /** \name Extract Loop
  * \{ */
 
 void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
+                                        MeshExtractScheduler *scheduler,
                                         MeshBatchCache *cache,
                                         MeshBufferCache *mbc,
                                         Object *object,
@@ -695,12 +780,20 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
   eMRIterType iter_type = extractors.iter_types();
   eMRDataType data_flag = extractors.data_types();
 
-  struct TaskNode *task_node_mesh_render_data = mesh_extract_render_data_node_create(
-      task_graph, mr, mbc, iter_type, data_flag);
-
   /* Simple heuristic. */
   const bool use_thread = (mr->loop_len + mr->loop_loose_len) > MIN_RANGE_LEN;
 
+  if (scheduler != nullptr && !use_thread) {
+    /* Extract together with other small meshes, all requests run on the same thread. */
+    scheduler->add_small_mesh(
+        new MeshRenderDataUpdateTaskData(mr, mbc, iter_type, data_flag),
+        new ExtractTaskData(mr, cache, new ExtractorRunDatas(extractors), mbuflist, false));
+    return;
+  }
+
+  struct TaskNode *task_node_mesh_render_data = mesh_extract_render_data_node_create(
+      task_graph, mr, mbc, iter_type, data_flag);
+
   if (use_thread) {
     /* First run the requested extractors that do not support asynchronous ranges. */
     for (const ExtractorRunData &run_data : extractors) {
@@ -14,6 +14,7 @@ struct GPUVertBuf;
 struct ListBase;
 struct ModifierData;
 struct PTCacheEdit;
+struct DRWMeshExtractScheduler;
 struct ParticleSystem;
 struct TaskGraph;
 
@@ -43,6 +44,8 @@ void DRW_curve_batch_cache_free(struct Curve *cu);
 void DRW_mesh_batch_cache_dirty_tag(struct Mesh *me, eMeshBatchDirtyMode mode);
 void DRW_mesh_batch_cache_validate(struct Object *object, struct Mesh *me);
 void DRW_mesh_batch_cache_free(struct Mesh *me);
+/** Free a draw cache which is not owned by any mesh, see #BKE_mesh_batch_cache_take. */
+void DRW_mesh_batch_cache_free_data(void *batch_cache);
 
 void DRW_lattice_batch_cache_dirty_tag(struct Lattice *lt, int mode);
 void DRW_lattice_batch_cache_validate(struct Lattice *lt);
@@ -179,6 +182,22 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
                                            bool is_paint_mode,
                                            bool use_hide);
 
+/**
+ * Extraction of meshes of many objects sharing the same task graph.
+ *
+ * Unlike #DRW_mesh_batch_cache_create_requested, the extraction is not waited for and small
+ * meshes are extracted together, so that extraction of all meshes runs in parallel. Requests of
+ * the meshes must not change until the task graph is waited for, so this is only to be used once
+ * all batches are requested. Not to be used for objects in edit or paint modes.
+ */
+struct DRWMeshExtractScheduler *DRW_mesh_extract_scheduler_create(struct TaskGraph *task_graph);
+/** Push the remaining extraction work, the task graph is still to be waited for. */
+void DRW_mesh_extract_scheduler_free(struct DRWMeshExtractScheduler *scheduler);
+void DRW_mesh_batch_cache_create_requested_scheduled(struct DRWMeshExtractScheduler *scheduler,
+                                                     struct Object *ob,
+                                                     struct Mesh *me,
+                                                     const struct Scene *scene);
+
 struct GPUBatch *DRW_mesh_batch_cache_get_all_verts(struct Mesh *me);
 struct GPUBatch *DRW_mesh_batch_cache_get_all_edges(struct Mesh *me);
 struct GPUBatch *DRW_mesh_batch_cache_get_loose_edges(struct Mesh *me);
@@ -196,7 +196,7 @@ static constexpr DRWBatchFlag batches_that_use_buffer(const int buffer_index)
 }
 
 static void mesh_batch_cache_discard_surface_batches(MeshBatchCache *cache);
-static void mesh_batch_cache_clear(Mesh *me);
+static void mesh_batch_cache_clear(MeshBatchCache *cache);
 
 static void mesh_batch_cache_discard_batch(MeshBatchCache *cache, const DRWBatchFlag batch_map)
 {
@@ -607,6 +607,7 @@ static void mesh_batch_cache_init(Object *object, Mesh *me)
   }
 
   cache->mat_len = mesh_render_mat_len_get(object, me);
+  cache->topology_hash = me->runtime.topology_hash;
   cache->surface_per_mat = static_cast<GPUBatch **>(
       MEM_callocN(sizeof(*cache->surface_per_mat) * cache->mat_len, __func__));
   cache->tris_per_mat = static_cast<GPUIndexBuf **>(
@@ -622,7 +623,7 @@ static void mesh_batch_cache_init(Object *object, Mesh *me)
 void DRW_mesh_batch_cache_validate(Object *object, Mesh *me)
 {
   if (!mesh_batch_cache_valid(object, me)) {
-    mesh_batch_cache_clear(me);
+    mesh_batch_cache_clear(static_cast<MeshBatchCache *>(me->runtime.batch_cache));
     mesh_batch_cache_init(object, me);
   }
 }
@@ -716,6 +717,36 @@ static void mesh_batch_cache_discard_uvedit(MeshBatchCache *cache)
   cache->cd_used.edit_uv = 0;
 }
 
+/* Discard buffers which depend on vertex positions, keeping the ones which only depend on the
+ * topology or on other attributes. */
+static void mesh_batch_cache_discard_deformed(MeshBatchCache *cache)
+{
+  FOREACH_MESH_BUFFER_CACHE (cache, mbc) {
+    GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.pos_nor);
+    GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.lnor);
+    GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.tan);
+    GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.edge_fac);
+    GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.mesh_analysis);
+    GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.fdots_pos);
+    GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.fdots_nor);
+    GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.edituv_stretch_area);
+    GPU_VERTBUF_DISCARD_SAFE(mbc->buff.vbo.edituv_stretch_angle);
+  }
+  DRWBatchFlag batch_map = BATCH_MAP(vbo.pos_nor,
+                                     vbo.lnor,
+                                     vbo.tan,
+                                     vbo.edge_fac,
+                                     vbo.mesh_analysis,
+                                     vbo.fdots_pos,
+                                     vbo.fdots_nor,
+                                     vbo.edituv_stretch_area,
+                                     vbo.edituv_stretch_angle);
+  mesh_batch_cache_discard_batch(cache, batch_map);
+
+  cache->tot_area = 0.0f;
+  cache->tot_uv_area = 0.0f;
+}
+
 static void mesh_batch_cache_discard_uvedit_select(MeshBatchCache *cache)
 {
   FOREACH_MESH_BUFFER_CACHE (cache, mbc) {
@@ -768,6 +799,13 @@ void DRW_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
     case BKE_MESH_BATCH_DIRTY_ALL:
       cache->is_dirty = true;
       break;
+    case BKE_MESH_BATCH_DIRTY_DEFORM:
+      if (cache->topology_hash == 0 || cache->topology_hash != me->runtime.topology_hash) {
+        cache->is_dirty = true;
+        break;
+      }
+      mesh_batch_cache_discard_deformed(cache);
+      break;
     case BKE_MESH_BATCH_DIRTY_SHADING:
       mesh_batch_cache_discard_shaded_tri(cache);
       mesh_batch_cache_discard_uvedit(cache);
@@ -823,9 +861,8 @@ static void mesh_batch_cache_free_subdiv_cache(MeshBatchCache *cache)
   }
 }
 
-static void mesh_batch_cache_clear(Mesh *me)
+static void mesh_batch_cache_clear(MeshBatchCache *cache)
 {
-  MeshBatchCache *cache = static_cast<MeshBatchCache *>(me->runtime.batch_cache);
   if (!cache) {
     return;
   }
@@ -856,8 +893,15 @@ static void mesh_batch_cache_clear(Mesh *me)
 
 void DRW_mesh_batch_cache_free(Mesh *me)
 {
-  mesh_batch_cache_clear(me);
-  MEM_SAFE_FREE(me->runtime.batch_cache);
+  DRW_mesh_batch_cache_free_data(me->runtime.batch_cache);
+  me->runtime.batch_cache = nullptr;
+}
+
+void DRW_mesh_batch_cache_free_data(void *batch_cache)
+{
+  MeshBatchCache *cache = static_cast<MeshBatchCache *>(batch_cache);
+  mesh_batch_cache_clear(cache);
+  MEM_SAFE_FREE(cache);
 }
 
 /** \} */
@@ -1329,12 +1373,13 @@ static void drw_mesh_batch_cache_check_available(struct TaskGraph *task_graph, M
 }
 #endif
 
-void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
-                                           Object *ob,
-                                           Mesh *me,
-                                           const Scene *scene,
-                                           const bool is_paint_mode,
-                                           const bool use_hide)
+static void mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
+                                              blender::draw::MeshExtractScheduler *scheduler,
+                                              Object *ob,
+                                              Mesh *me,
+                                              const Scene *scene,
+                                              const bool is_paint_mode,
+                                              const bool use_hide)
 {
   BLI_assert(task_graph);
   const ToolSettings *ts = nullptr;
@@ -1347,7 +1392,9 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
   /* Early out */
   if (cache->batch_requested == 0) {
 #ifdef DEBUG
-    drw_mesh_batch_cache_check_available(task_graph, me);
+    if (scheduler == nullptr) {
+      drw_mesh_batch_cache_check_available(task_graph, me);
+    }
 #endif
     return;
   }
@@ -1489,7 +1536,9 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
   /* Second chance to early out */
   if ((batch_requested & ~cache->batch_ready) == 0) {
 #ifdef DEBUG
-    drw_mesh_batch_cache_check_available(task_graph, me);
+    if (scheduler == nullptr) {
+      drw_mesh_batch_cache_check_available(task_graph, me);
+    }
 #endif
     return;
   }
@@ -1851,6 +1900,7 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
 
   if (do_uvcage) {
     blender::draw::mesh_buffer_cache_create_requested(task_graph,
+                                                      scheduler,
                                                       cache,
                                                       &cache->uv_cage,
                                                       ob,
@@ -1868,6 +1918,7 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
 
   if (do_cage) {
     blender::draw::mesh_buffer_cache_create_requested(task_graph,
+                                                      scheduler,
                                                       cache,
                                                       &cache->cage,
                                                       ob,
@@ -1905,6 +1956,7 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
   }
 
   blender::draw::mesh_buffer_cache_create_requested(task_graph,
+                                                    scheduler,
                                                     cache,
                                                     &cache->final,
                                                     ob,
@@ -1925,11 +1977,50 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
    *
    * An idea to improve this is to separate the Object mode from the edit mode draw caches. And
    * based on the mode the correct one will be updated. Other option is to look into using
-   * drw_batch_cache_generate_requested_delayed. */
+   * drw_batch_cache_generate_requested_delayed.
+   *
+   * The scheduled extraction is only used once all batches are requested, and the task graph is
+   * waited for by the caller. */
+  if (scheduler != nullptr) {
+    return;
+  }
   BLI_task_graph_work_and_wait(task_graph);
 #ifdef DEBUG
   drw_mesh_batch_cache_check_available(task_graph, me);
 #endif
 }
 
+void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
+                                           Object *ob,
+                                           Mesh *me,
+                                           const Scene *scene,
+                                           const bool is_paint_mode,
+                                           const bool use_hide)
+{
+  mesh_batch_cache_create_requested(task_graph, nullptr, ob, me, scene, is_paint_mode, use_hide);
+}
+
+DRWMeshExtractScheduler *DRW_mesh_extract_scheduler_create(struct TaskGraph *task_graph)
+{
+  blender::draw::MeshExtractScheduler *scheduler = new blender::draw::MeshExtractScheduler(
+      task_graph);
+  return reinterpret_cast<DRWMeshExtractScheduler *>(scheduler);
+}
+
+void DRW_mesh_extract_scheduler_free(DRWMeshExtractScheduler *scheduler)
+{
+  delete reinterpret_cast<blender::draw::MeshExtractScheduler *>(scheduler);
+}
+
+void DRW_mesh_batch_cache_create_requested_scheduled(DRWMeshExtractScheduler *scheduler,
+                                                     Object *ob,
+                                                     Mesh *me,
+                                                     const Scene *scene)
+{
+  blender::draw::MeshExtractScheduler *mesh_scheduler =
+      reinterpret_cast<blender::draw::MeshExtractScheduler *>(scheduler);
+  mesh_batch_cache_create_requested(
+      mesh_scheduler->task_graph(), mesh_scheduler, ob, me, scene, false, false);
+}
+
 /** \} */
@@ -158,10 +158,14 @@ static void drw_task_graph_init(void)
   BLI_assert(DST.task_graph == NULL);
   DST.task_graph = BLI_task_graph_create();
   DST.delayed_extraction = BLI_gset_ptr_new(__func__);
+  DST.scheduled_extraction = BLI_gset_ptr_new(__func__);
 }
 
 static void drw_task_graph_deinit(void)
 {
+  drw_batch_cache_generate_scheduled();
+  BLI_gset_free(DST.scheduled_extraction, NULL);
+  DST.scheduled_extraction = NULL;
   BLI_task_graph_work_and_wait(DST.task_graph);
 
   BLI_gset_free(DST.delayed_extraction,
@@ -719,7 +723,7 @@ static void duplidata_key_free(void *key)
 {
   DupliKey *dupli_key = (DupliKey *)key;
   if (dupli_key->ob_data == dupli_key->ob->data) {
-    drw_batch_cache_generate_requested(dupli_key->ob);
+    drw_batch_cache_generate_requested_scheduled(dupli_key->ob);
   }
   else {
     Object temp_object = *dupli_key->ob;
@@ -1059,7 +1063,7 @@ static void drw_engines_cache_populate(Object *ob)
   /* TODO: in the future it would be nice to generate once for all viewports.
    * But we need threaded DRW manager first. */
   if (!DST.dupli_source) {
-    drw_batch_cache_generate_requested(ob);
+    drw_batch_cache_generate_requested_scheduled(ob);
   }
 
   /* ... and clearing it here too because this draw data is
@@ -2063,7 +2067,7 @@ void DRW_render_object_iter(
       }
       callback(vedata, ob, engine, depsgraph);
       if (!DST.dupli_source) {
-        drw_batch_cache_generate_requested(ob);
+        drw_batch_cache_generate_requested_scheduled(ob);
       }
     }
   }
@@ -2998,6 +3002,7 @@ void DRW_engines_register(void)
 
     BKE_mesh_batch_cache_dirty_tag_cb = DRW_mesh_batch_cache_dirty_tag;
     BKE_mesh_batch_cache_free_cb = DRW_mesh_batch_cache_free;
+    BKE_mesh_batch_cache_free_data_cb = DRW_mesh_batch_cache_free_data;
 
     BKE_lattice_batch_cache_dirty_tag_cb = DRW_lattice_batch_cache_dirty_tag;
     BKE_lattice_batch_cache_free_cb = DRW_lattice_batch_cache_free;
@@ -629,6 +629,9 @@ typedef struct DRWManager {
   struct TaskGraph *task_graph;
   /* Contains list of objects that needs to be extracted from other objects. */
   struct GSet *delayed_extraction;
+  /* Contains list of objects whose meshes are extracted together once all objects are populated,
+   * see #drw_batch_cache_generate_requested_scheduled. */
+  struct GSet *scheduled_extraction;
 
   /* ---------- Nothing after this point is cleared after use ----------- */
 
@@ -672,6 +675,15 @@ void drw_batch_cache_generate_requested(struct Object *ob);
 void drw_batch_cache_generate_requested_delayed(Object *ob);
 void drw_batch_cache_generate_requested_evaluated_mesh_or_curve(Object *ob);
 
+/**
+ * Same as #drw_batch_cache_generate_requested, but extraction of meshes is scheduled to run
+ * together for all objects in #drw_batch_cache_generate_scheduled, instead of each object waiting
+ * for its extraction to finish.
+ * \warning The object is to stay valid until the scheduled generation.
+ */
+void drw_batch_cache_generate_requested_scheduled(Object *ob);
+void drw_batch_cache_generate_scheduled(void);
+
 void drw_resource_buffer_finish(DRWData *vmempool);
 
 /* Procedural Drawing */
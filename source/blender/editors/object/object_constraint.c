@@ -1343,7 +1343,7 @@ void ED_object_constraint_dependency_update(Main *bmain, Object *ob)
   if (ob->pose) {
     object_pose_tag_update(bmain, ob);
   }
-  DEG_relations_tag_update(bmain);
+  DEG_id_tag_relations_update(bmain, &ob->id);
 }
 
 void ED_object_constraint_tag_update(Main *bmain, Object *ob, bConstraint *con)
@@ -1376,7 +1376,7 @@ void ED_object_constraint_dependency_tag_update(Main *bmain, Object *ob, bConstr
   if (ob->pose) {
     object_pose_tag_update(bmain, ob);
   }
-  DEG_relations_tag_update(bmain);
+  DEG_id_tag_relations_update(bmain, &ob->id);
 }
 
 bool ED_object_constraint_move_to_index(Object *ob, bConstraint *con, const int index)
@@ -2126,7 +2126,13 @@ static int pose_constraint_copy_exec(bContext *C, wmOperator *op)
   CTX_DATA_END;
 
   /* force depsgraph to get recalculated since new relationships added */
-  DEG_relations_tag_update(bmain);
+  if (setTarget) {
+    /* The target might be a newly added object. */
+    DEG_relations_tag_update(bmain);
+  }
+  else {
+    DEG_id_tag_relations_update(bmain, &ob->id);
+  }
 
   WM_event_add_notifier(C, NC_OBJECT | ND_CONSTRAINT, NULL);
 
@@ -2170,7 +2176,13 @@ static int object_constraint_copy_exec(bContext *C, wmOperator *UNUSED(op))
   CTX_DATA_END;
 
   /* force depsgraph to get recalculated since new relationships added */
-  DEG_relations_tag_update(bmain);
+  if (setTarget) {
+    /* The target might be a newly added object. */
+    DEG_relations_tag_update(bmain);
+  }
+  else {
+    DEG_id_tag_relations_update(bmain, &ob->id);
+  }
 
   /* notifiers for updates */
   WM_event_add_notifier(C, NC_OBJECT | ND_CONSTRAINT | NA_ADDED, NULL);
@@ -2441,7 +2453,13 @@ static int constraint_add_exec(
   }
 
   /* force depsgraph to get recalculated since new relationships added */
-  DEG_relations_tag_update(bmain);
+  if (setTarget) {
+    /* The target might be a newly added object. */
+    DEG_relations_tag_update(bmain);
+  }
+  else {
+    DEG_id_tag_relations_update(bmain, &ob->id);
+  }
 
   if ((ob->type == OB_ARMATURE) && (pchan)) {
     BKE_pose_tag_recalc(bmain, ob->pose); /* sort pose channels */
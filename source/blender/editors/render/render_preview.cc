@@ -30,6 +30,7 @@
 #include "DNA_brush_types.h"
 #include "DNA_camera_types.h"
 #include "DNA_collection_types.h"
+#include "DNA_image_types.h"
 #include "DNA_light_types.h"
 #include "DNA_material_types.h"
 #include "DNA_mesh_types.h"
@@ -1408,6 +1409,35 @@ static void set_alpha(char *cp, int sizex, int sizey, char alpha)
   }
 }
 
+/**
+ * Load a mipmap level of a single image file through the image tile cache, at least as big as
+ * the preview. Returns null for images which are already loaded or not read from a single file.
+ */
+static ImBuf *icon_preview_image_load_reduced(
+    Main *bmain, Image *ima, ImageUser *iuser, const int sizex, const int sizey)
+{
+  if (ima->source != IMA_SRC_FILE || BKE_image_has_packedfile(ima) ||
+      BKE_image_is_multilayer(ima) || BKE_image_is_multiview(ima) ||
+      BKE_image_has_loaded_ibuf(ima)) {
+    return nullptr;
+  }
+
+  char filepath[FILE_MAX];
+  BKE_image_user_file_path_ex(bmain, iuser, ima, filepath, false, false);
+
+  char colorspace[IM_MAX_SPACE];
+  STRNCPY(colorspace, ima->colorspace_settings.name);
+  ImTileCacheImage *image = IMB_tile_cache_image_open(filepath, colorspace);
+  if (image == nullptr) {
+    return nullptr;
+  }
+
+  const int level = IMB_tile_cache_image_level_for_size(image, sizex, sizey);
+  ImBuf *ibuf = IMB_tile_cache_load_level(image, level);
+  IMB_tile_cache_image_close(image);
+  return ibuf;
+}
+
 static void icon_preview_startjob(void *customdata, short *stop, short *do_update)
 {
   ShaderPreview *sp = static_cast<ShaderPreview *>(customdata);
@@ -1436,9 +1466,16 @@ static void icon_preview_startjob(void *customdata, short *stop, short *do_updat
     iuser.framenr = 1;
     iuser.scene = sp->scene;
 
-    /* NOTE(@elubie): this needs to be changed: here image is always loaded if not
-     * already there. Very expensive for large images. Need to find a way to
-     * only get existing `ibuf`. */
+    /* Images which are not loaded yet are read at a reduced size, so large images don't take up
+     * their full size in memory just for the preview. */
+    ibuf = icon_preview_image_load_reduced(sp->bmain, ima, &iuser, sp->sizex, sp->sizey);
+    if (ibuf) {
+      icon_copy_rect(ibuf, sp->sizex, sp->sizey, sp->pr_rect);
+      IMB_freeImBuf(ibuf);
+      *do_update = true;
+      return;
+    }
+
     ibuf = BKE_image_acquire_ibuf(ima, &iuser, nullptr);
     if (ibuf == nullptr || (ibuf->rect == nullptr && ibuf->rect_float == nullptr)) {
       BKE_image_release_ibuf(ima, ibuf, nullptr);
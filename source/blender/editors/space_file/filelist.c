@@ -31,7 +31,6 @@
 #include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_stack.h"
-#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #include "BLI_uuid.h"
@@ -321,11 +320,11 @@ typedef struct FileListEntryCache {
   GHash *uids;
 
   /* Previews handling. */
-  TaskPool *previews_pool;
+  ThumbService *previews_service;
   ThreadQueue *previews_done;
   /** Counter for previews that are not fully loaded and ready to display yet. So includes all
-   * previews either in `previews_pool` or `previews_done`. #filelist_cache_previews_update() makes
-   * previews in `preview_done` ready for display, so the counter is decremented there. */
+   * previews either in `previews_service` or `previews_done`. #filelist_cache_previews_update()
+   * makes previews in `preview_done` ready for display, so the counter is decremented there. */
   int previews_todo_count;
 } FileListEntryCache;
 
@@ -343,11 +342,8 @@ typedef struct FileListEntryPreview {
   int icon_id;
 } FileListEntryPreview;
 
-/* Dummy wrapper around FileListEntryPreview to ensure we do not access freed memory when freeing
- * tasks' data (see T74609). */
-typedef struct FileListEntryPreviewTaskData {
-  FileListEntryPreview *preview;
-} FileListEntryPreviewTaskData;
+/** Memory used by generated previews that were not turned into icons yet. */
+#define FILELIST_PREVIEWS_MEM_LIMIT (64 * 1024 * 1024)
 
 typedef struct FileListFilter {
   uint64_t filter;
@@ -1612,81 +1608,53 @@ static int filelist_intern_free_main_files(FileListIntern *filelist_intern)
   return removed_counter;
 }
 
-static void filelist_cache_preview_runf(TaskPool *__restrict pool, void *taskdata)
+static ThumbSource filelist_cache_preview_thumb_source(const uint flags)
 {
-  FileListEntryCache *cache = BLI_task_pool_user_data(pool);
-  FileListEntryPreviewTaskData *preview_taskdata = taskdata;
-  FileListEntryPreview *preview = preview_taskdata->preview;
-
-  ThumbSource source = 0;
-
-  //  printf("%s: Start (%d)...\n", __func__, threadid);
-
-  //  printf("%s: %d - %s - %p\n", __func__, preview->index, preview->path, preview->img);
-  BLI_assert(preview->flags &
-             (FILE_TYPE_IMAGE | FILE_TYPE_MOVIE | FILE_TYPE_FTFONT | FILE_TYPE_BLENDER |
-              FILE_TYPE_BLENDER_BACKUP | FILE_TYPE_BLENDERLIB));
+  BLI_assert(flags & (FILE_TYPE_IMAGE | FILE_TYPE_MOVIE | FILE_TYPE_FTFONT | FILE_TYPE_BLENDER |
+                      FILE_TYPE_BLENDER_BACKUP | FILE_TYPE_BLENDERLIB));
 
-  if (preview->flags & FILE_TYPE_IMAGE) {
-    source = THB_SOURCE_IMAGE;
+  if (flags & FILE_TYPE_IMAGE) {
+    return THB_SOURCE_IMAGE;
   }
-  else if (preview->flags &
-           (FILE_TYPE_BLENDER | FILE_TYPE_BLENDER_BACKUP | FILE_TYPE_BLENDERLIB)) {
-    source = THB_SOURCE_BLEND;
+  if (flags & (FILE_TYPE_BLENDER | FILE_TYPE_BLENDER_BACKUP | FILE_TYPE_BLENDERLIB)) {
+    return THB_SOURCE_BLEND;
   }
-  else if (preview->flags & FILE_TYPE_MOVIE) {
-    source = THB_SOURCE_MOVIE;
-  }
-  else if (preview->flags & FILE_TYPE_FTFONT) {
-    source = THB_SOURCE_FONT;
-  }
-
-  IMB_thumb_path_lock(preview->filepath);
-  /* Always generate biggest preview size for now, it's simpler and avoids having to re-generate
-   * in case user switch to a bigger preview size. Do not create preview when file is offline. */
-  ImBuf *imbuf = (preview->attributes & FILE_ATTR_OFFLINE) ?
-                     IMB_thumb_read(preview->filepath, THB_LARGE) :
-                     IMB_thumb_manage(preview->filepath, THB_LARGE, source);
-  IMB_thumb_path_unlock(preview->filepath);
-  if (imbuf) {
-    preview->icon_id = BKE_icon_imbuf_create(imbuf);
+  if (flags & FILE_TYPE_MOVIE) {
+    return THB_SOURCE_MOVIE;
   }
-
-  /* Move ownership to the done queue. */
-  preview_taskdata->preview = NULL;
-
-  BLI_thread_queue_push(cache->previews_done, preview);
-
-  //  printf("%s: End (%d)...\n", __func__, threadid);
-}
-
-static void filelist_cache_preview_freef(TaskPool *__restrict UNUSED(pool), void *taskdata)
-{
-  FileListEntryPreviewTaskData *preview_taskdata = taskdata;
-
-  /* In case the preview wasn't moved to the "done" queue yet. */
-  if (preview_taskdata->preview) {
-    MEM_freeN(preview_taskdata->preview);
+  if (flags & FILE_TYPE_FTFONT) {
+    return THB_SOURCE_FONT;
   }
-
-  MEM_freeN(preview_taskdata);
+  return 0;
 }
 
 static void filelist_cache_preview_ensure_running(FileListEntryCache *cache)
 {
-  if (!cache->previews_pool) {
-    cache->previews_pool = BLI_task_pool_create_background(cache, TASK_PRIORITY_LOW);
+  if (!cache->previews_service) {
+    cache->previews_service = IMB_thumb_service_create(
+        0, FILELIST_PREVIEWS_MEM_LIMIT, MEM_freeN);
     cache->previews_done = BLI_thread_queue_init();
     cache->previews_todo_count = 0;
+  }
+}
 
-    IMB_thumb_locks_acquire();
+/* Move finished previews of the thumbnail service into the done queue. */
+static void filelist_cache_previews_collect(FileListEntryCache *cache)
+{
+  FileListEntryPreview *preview;
+  ImBuf *imbuf;
+  while (IMB_thumb_service_pop(cache->previews_service, (void **)&preview, &imbuf)) {
+    if (imbuf) {
+      preview->icon_id = BKE_icon_imbuf_create(imbuf);
+    }
+    BLI_thread_queue_push(cache->previews_done, preview);
   }
 }
 
 static void filelist_cache_previews_clear(FileListEntryCache *cache)
 {
-  if (cache->previews_pool) {
-    BLI_task_pool_cancel(cache->previews_pool);
+  if (cache->previews_service) {
+    IMB_thumb_service_cancel(cache->previews_service);
 
     FileListEntryPreview *preview;
     while ((preview = BLI_thread_queue_pop_timeout(cache->previews_done, 0))) {
@@ -1703,24 +1671,29 @@ static void filelist_cache_previews_clear(FileListEntryCache *cache)
 
 static void filelist_cache_previews_free(FileListEntryCache *cache)
 {
-  if (cache->previews_pool) {
+  if (cache->previews_service) {
     BLI_thread_queue_nowait(cache->previews_done);
 
     filelist_cache_previews_clear(cache);
 
     BLI_thread_queue_free(cache->previews_done);
-    BLI_task_pool_free(cache->previews_pool);
-    cache->previews_pool = NULL;
+    IMB_thumb_service_free(cache->previews_service);
+    cache->previews_service = NULL;
     cache->previews_done = NULL;
     cache->previews_todo_count = 0;
-
-    IMB_thumb_locks_release();
   }
 
   cache->flags &= ~FLC_PREVIEWS_ACTIVE;
 }
 
-static void filelist_cache_previews_push(FileList *filelist, FileDirEntry *entry, const int index)
+/**
+ * \param priority: Previews with a lower priority value are generated first, typically the
+ * distance to the item in the middle of the view.
+ */
+static void filelist_cache_previews_push(FileList *filelist,
+                                         FileDirEntry *entry,
+                                         const int index,
+                                         const int priority)
 {
   FileListEntryCache *cache = &filelist->filelist_cache;
 
@@ -1775,14 +1748,15 @@ static void filelist_cache_previews_push(FileList *filelist, FileDirEntry *entry
     }
     // printf("%s: %d - %s\n", __func__, preview->index, preview->filepath);
 
-    FileListEntryPreviewTaskData *preview_taskdata = MEM_mallocN(sizeof(*preview_taskdata),
-                                                                 __func__);
-    preview_taskdata->preview = preview;
-    BLI_task_pool_push(cache->previews_pool,
-                       filelist_cache_preview_runf,
-                       preview_taskdata,
-                       true,
-                       filelist_cache_preview_freef);
+    /* Always generate biggest preview size for now, it's simpler and avoids having to re-generate
+     * in case user switch to a bigger preview size. Do not create preview when file is offline. */
+    IMB_thumb_service_request(cache->previews_service,
+                              preview->filepath,
+                              THB_LARGE,
+                              filelist_cache_preview_thumb_source(preview->flags),
+                              (preview->attributes & FILE_ATTR_OFFLINE) != 0,
+                              (float)priority,
+                              preview);
   }
   cache->previews_todo_count++;
 }
@@ -2264,8 +2238,8 @@ FileDirEntry *filelist_file_ex(struct FileList *filelist, const int index, const
   cache->misc_cursor = (cache->misc_cursor + 1) % cache_size;
 
 #if 0 /* Actually no, only block cached entries should have preview IMHO. */
-  if (cache->previews_pool) {
-    filelist_cache_previews_push(filelist, ret, index);
+  if (cache->previews_service) {
+    filelist_cache_previews_push(filelist, ret, index, 0);
   }
 #endif
 
@@ -2609,7 +2583,8 @@ bool filelist_file_cache_block(struct FileList *filelist, const int index)
         int offs_idx = index + offs;
         if (start_index <= offs_idx && offs_idx < end_index) {
           int offs_block_idx = (block_index + offs) % (int)cache_size;
-          filelist_cache_previews_push(filelist, cache->block_entries[offs_block_idx], offs_idx);
+          filelist_cache_previews_push(
+              filelist, cache->block_entries[offs_block_idx], offs_idx, i);
         }
       } while ((offs = -offs) < 0); /* Switch between negative and positive offset. */
     }
@@ -2633,7 +2608,7 @@ void filelist_cache_previews_set(FileList *filelist, const bool use_previews)
   if (use_previews && (filelist->flags & FL_IS_READY)) {
     cache->flags |= FLC_PREVIEWS_ACTIVE;
 
-    BLI_assert((cache->previews_pool == NULL) && (cache->previews_done == NULL) &&
+    BLI_assert((cache->previews_service == NULL) && (cache->previews_done == NULL) &&
                (cache->previews_todo_count == 0));
 
     //      printf("%s: Init Previews...\n", __func__);
@@ -2650,15 +2625,16 @@ void filelist_cache_previews_set(FileList *filelist, const bool use_previews)
 bool filelist_cache_previews_update(FileList *filelist)
 {
   FileListEntryCache *cache = &filelist->filelist_cache;
-  TaskPool *pool = cache->previews_pool;
   bool changed = false;
 
-  if (!pool) {
+  if (!cache->previews_service) {
     return changed;
   }
 
   //  printf("%s: Update Previews...\n", __func__);
 
+  filelist_cache_previews_collect(cache);
+
   while (!BLI_thread_queue_is_empty(cache->previews_done)) {
     FileListEntryPreview *preview = BLI_thread_queue_pop(cache->previews_done);
     FileDirEntry *entry;
@@ -2708,7 +2684,7 @@ bool filelist_cache_previews_running(FileList *filelist)
 {
   FileListEntryCache *cache = &filelist->filelist_cache;
 
-  return (cache->previews_pool != NULL);
+  return (cache->previews_service != NULL);
 }
 
 bool filelist_cache_previews_done(FileList *filelist)
@@ -2719,7 +2695,7 @@ bool filelist_cache_previews_done(FileList *filelist)
     return false;
   }
 
-  return (cache->previews_pool == NULL) || (cache->previews_done == NULL) ||
+  return (cache->previews_service == NULL) || (cache->previews_done == NULL) ||
          (cache->previews_todo_count == 0);
 }
 
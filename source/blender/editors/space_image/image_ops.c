@@ -3731,7 +3731,7 @@ static int image_read_viewlayers_exec(bContext *C, wmOperator *UNUSED(op))
     ED_space_image_set(bmain, sima, ima, false);
   }
 
-  RE_ReadRenderResult(scene, scene);
+  RE_ReadRenderResult(scene, scene, NULL, NULL);
 
   WM_event_add_notifier(C, NC_IMAGE | NA_EDITED, ima);
   return OPERATOR_FINISHED;
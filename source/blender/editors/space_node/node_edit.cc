@@ -1480,6 +1480,35 @@ void NODE_OT_duplicate(wmOperatorType *ot)
 
 /* XXX: some code needing updating to operators. */
 
+struct ReadViewLayersFilterData {
+  const bNodeTree *ntree;
+  const Scene *scene;
+};
+
+/* Only read the view layers of a scene that nodes of the tree use. */
+static bool node_read_viewlayers_filter(void *userdata, const char *layname)
+{
+  const ReadViewLayersFilterData *data = static_cast<const ReadViewLayersFilterData *>(userdata);
+
+  LISTBASE_FOREACH (const bNode *, node, &data->ntree->nodes) {
+    if (node->id != &data->scene->id) {
+      continue;
+    }
+    if (node->type == CMP_NODE_CRYPTOMATTE && node->custom1 == CMP_CRYPTOMATTE_SRC_RENDER) {
+      /* Cryptomatte layers are looked up by pass name prefix, read all of them. */
+      return true;
+    }
+    if (node->type == CMP_NODE_R_LAYERS) {
+      const ViewLayer *view_layer = static_cast<const ViewLayer *>(
+          BLI_findlink(&data->scene->view_layers, node->custom1));
+      if (view_layer && STREQ(view_layer->name, layname)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 /* goes over all scenes, reads render layers */
 static int node_read_viewlayers_exec(bContext *C, wmOperator *UNUSED(op))
 {
@@ -1502,7 +1531,8 @@ static int node_read_viewlayers_exec(bContext *C, wmOperator *UNUSED(op))
         continue;
       }
       if (id->tag & LIB_TAG_DOIT) {
-        RE_ReadRenderResult(curscene, (Scene *)id);
+        ReadViewLayersFilterData filter_data = {snode->edittree, (Scene *)id};
+        RE_ReadRenderResult(curscene, (Scene *)id, node_read_viewlayers_filter, &filter_data);
         ntreeCompositTagRender((Scene *)id);
         id->tag &= ~LIB_TAG_DOIT;
       }
@@ -78,6 +78,8 @@
 
 #include "BLF_api.h"
 
+#include "BLT_translation.h"
+
 #include "MEM_guardedalloc.h"
 
 /* Own include. */
@@ -2652,6 +2654,46 @@ static void draw_cache_view(const bContext *C)
   GPU_blend(GPU_BLEND_NONE);
 }
 
+/* Show how much memory cache compression saves. */
+static void draw_cache_stats(const bContext *C)
+{
+  Scene *scene = CTX_data_scene(C);
+  const int cache_flag = scene->ed->cache_flag;
+
+  if ((cache_flag & SEQ_CACHE_VIEW_ENABLE) == 0 || (cache_flag & SEQ_CACHE_COMPRESS) == 0) {
+    return;
+  }
+
+  SeqCacheStats stats;
+  SEQ_cache_stats_get(scene, &stats);
+  if (stats.compressed_count == 0) {
+    return;
+  }
+
+  char size_str[15], size_raw_str[15];
+  BLI_str_format_byte_unit(size_str, stats.compressed_size, false);
+  BLI_str_format_byte_unit(size_raw_str, stats.compressed_size_raw, false);
+
+  char text[256];
+  const size_t text_len = BLI_snprintf_rlen(text,
+                                            sizeof(text),
+                                            TIP_("Cache: %d compressed images, %s of %s (%.1f:1)"),
+                                            stats.compressed_count,
+                                            size_str,
+                                            size_raw_str,
+                                            (double)stats.compressed_size_raw /
+                                                MAX2(stats.compressed_size, 1));
+
+  const int font_id = BLF_default();
+  BLF_set_default();
+  uchar text_color[4];
+  UI_GetThemeColor4ubv(TH_TEXT, text_color);
+  BLF_color4ubv(font_id, text_color);
+  const float margin = 0.5f * U.widget_unit;
+  BLF_position(font_id, margin, V2D_SCROLL_HANDLE_HEIGHT + margin, 0.0f);
+  BLF_draw(font_id, text, text_len);
+}
+
 /* Draw sequencer timeline. */
 static void draw_overlap_frame_indicator(const struct Scene *scene, const View2D *v2d)
 {
@@ -2767,6 +2809,7 @@ void draw_timeline_seq_display(const bContext *C, ARegion *region)
       draw_overlap_frame_indicator(scene, v2d);
     }
     UI_view2d_view_restore(C);
+    draw_cache_stats(C);
   }
 
   ED_time_scrub_draw_current_frame(region, scene, !(sseq->flag & SEQ_DRAWFRAMES));
@@ -114,24 +114,25 @@ static int sequencer_rebuild_proxy_exec(bContext *C, wmOperator *UNUSED(op))
 
   file_list = BLI_gset_new(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, "file list");
 
+  ListBase queue = {NULL, NULL};
   LISTBASE_FOREACH (Sequence *, seq, SEQ_active_seqbase_get(ed)) {
     if (seq->flag & SELECT) {
-      ListBase queue = {NULL, NULL};
-      LinkData *link;
-      short stop = 0, do_update;
-      float progress;
-
       SEQ_proxy_rebuild_context(bmain, depsgraph, scene, seq, file_list, &queue, false);
-
-      for (link = queue.first; link; link = link->next) {
-        struct SeqIndexBuildContext *context = link->data;
-        SEQ_proxy_rebuild(context, &stop, &do_update, &progress);
-        SEQ_proxy_rebuild_finish(context, 0);
-      }
-      SEQ_relations_free_imbuf(scene, &ed->seqbase, false);
     }
   }
 
+  /* Build all strips at once, so movies can be processed in parallel. This is also used when
+   * building proxies from command line in background mode. */
+  short stop = 0, do_update;
+  float progress;
+  SEQ_proxy_rebuild_list(&queue, &stop, &do_update, &progress);
+
+  LISTBASE_FOREACH (LinkData *, link, &queue) {
+    SEQ_proxy_rebuild_finish(link->data, false);
+  }
+  BLI_freelistN(&queue);
+  SEQ_relations_free_imbuf(scene, &ed->seqbase, false);
+
   BLI_gset_free(file_list, MEM_freeN);
 
   return OPERATOR_FINISHED;
@@ -409,6 +409,14 @@ void IMB_partial_display_buffer_update_delayed(
 struct ColormanageProcessor *IMB_colormanagement_display_processor_new(
     const struct ColorManagedViewSettings *view_settings,
     const struct ColorManagedDisplaySettings *display_settings);
+/**
+ * Processor for computing display buffers, which approximates the display transform with a
+ * baked lookup table when it is enabled in the view settings. It must not be used for anything
+ * that requires the exact transform, such as saving images.
+ */
+struct ColormanageProcessor *IMB_colormanagement_display_buffer_processor_new(
+    const struct ColorManagedViewSettings *view_settings,
+    const struct ColorManagedDisplaySettings *display_settings);
 struct ColormanageProcessor *IMB_colormanagement_colorspace_processor_new(
     const char *from_colorspace, const char *to_colorspace);
 void IMB_colormanagement_processor_apply_v4(struct ColormanageProcessor *cm_processor,
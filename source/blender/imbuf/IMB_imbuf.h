@@ -463,6 +463,57 @@ void IMB_tile_cache_params(int totthread, int maxmem);
 unsigned int *IMB_gettile(struct ImBuf *ibuf, int tx, int ty, int thread);
 void IMB_tiles_to_rect(struct ImBuf *ibuf);
 
+/**
+ * \attention Defined in tile_cache.c
+ *
+ * Image whose tiles and mipmap levels are loaded on demand through a process wide cache, so only
+ * the parts of an image which are actually used take up memory. Tiles are stored bottom to top
+ * like #ImBuf pixels, tiles at the right and top edges of a level may be smaller than the tile
+ * size.
+ */
+typedef struct ImTileCacheImage ImTileCacheImage;
+
+/**
+ * Open an image for tiled access. Only the header of the file is read for formats which support
+ * reading parts of an image (OpenEXR and tiled TIFF textures).
+ */
+ImTileCacheImage *IMB_tile_cache_image_open(const char *filepath, char colorspace[IM_MAX_SPACE]);
+/**
+ * Close the image and free all its cached tiles, none of them may still be acquired.
+ */
+void IMB_tile_cache_image_close(ImTileCacheImage *image);
+int IMB_tile_cache_image_levels(const ImTileCacheImage *image);
+void IMB_tile_cache_image_size(const ImTileCacheImage *image,
+                               int level,
+                               int *r_width,
+                               int *r_height);
+void IMB_tile_cache_image_tiles(const ImTileCacheImage *image,
+                                int level,
+                                int *r_tile_width,
+                                int *r_tile_height,
+                                int *r_xtiles,
+                                int *r_ytiles);
+/**
+ * Smallest mipmap level which is at least as big as the given size.
+ */
+int IMB_tile_cache_image_level_for_size(const ImTileCacheImage *image, int width, int height);
+/**
+ * Get a tile, loading it when it is not cached. The tile stays in memory until it is released,
+ * every acquire must be followed by #IMB_tile_cache_release, also when loading failed and NULL is
+ * returned.
+ */
+struct ImBuf *IMB_tile_cache_acquire(ImTileCacheImage *image, int level, int tx, int ty);
+void IMB_tile_cache_release(ImTileCacheImage *image, int level, int tx, int ty);
+/**
+ * Assemble a full mipmap level from its tiles into a new image buffer.
+ */
+struct ImBuf *IMB_tile_cache_load_level(ImTileCacheImage *image, int level);
+/**
+ * Memory budget shared by the tiles of all images.
+ */
+void IMB_tile_cache_limit_set(size_t limit);
+size_t IMB_tile_cache_memory_in_use(void);
+
 /**
  * \attention Defined in filter.c
  */
@@ -493,6 +544,43 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
  */
 void IMB_scaleImBuf_threaded(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+typedef enum eIMBScaleFilter {
+  /** Averages the covered pixels when scaling down, nearest neighbor when scaling up. */
+  IMB_SCALE_FILTER_BOX = 0,
+  IMB_SCALE_FILTER_BILINEAR = 1,
+  /** Cubic filter, a good compromise between sharpness and ringing. */
+  IMB_SCALE_FILTER_MITCHELL = 2,
+  /** Three lobed Lanczos filter, sharpest result but may cause ringing around edges. */
+  IMB_SCALE_FILTER_LANCZOS = 3,
+} eIMBScaleFilter;
+
+/**
+ * \attention Defined in scaling.c
+ *
+ * Separable resampling of byte and float buffers with the given filter, the filter is widened
+ * when scaling down so all source pixels contribute to the result.
+ * Rows are resampled in parallel when \a threaded is true.
+ *
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scale(struct ImBuf *ibuf,
+               unsigned int newx,
+               unsigned int newy,
+               eIMBScaleFilter filter,
+               bool threaded);
+
+/**
+ * \attention Defined in scaling.c
+ *
+ * Same as #IMB_scale, but leaves \a ibuf untouched and returns a new image buffer.
+ * Color spaces are carried over, the Z-buffer and metadata are not.
+ */
+struct ImBuf *IMB_scale_into_new(const struct ImBuf *ibuf,
+                                 unsigned int newx,
+                                 unsigned int newy,
+                                 eIMBScaleFilter filter,
+                                 bool threaded);
+
 /**
  * \attention Defined in writeimage.c
  */
@@ -78,7 +78,25 @@ float *IMB_exr_channel_rect(void *handle,
                             const char *view);
 
 void IMB_exr_read_channels(void *handle);
+/**
+ * Read only the passes for which \a pass_filter returns true, other passes keep a NULL rect.
+ * Only applies to handles of which the channels were parsed from the file, the channels of
+ * other handles are read when their rect is set.
+ */
+void IMB_exr_read_channels_filtered(void *handle,
+                                    bool (*pass_filter)(void *userdata,
+                                                        const char *layname,
+                                                        const char *passname,
+                                                        const char *view),
+                                    void *userdata);
 void IMB_exr_write_channels(void *handle);
+/**
+ * Write the next \a num_rows scan-lines, from the top of the image down. This allows saving the
+ * part of the image that is final while the rest is still being computed, and half float channels
+ * only need a temporary buffer for the rows written in one call.
+ * #IMB_exr_write_channels writes all remaining rows.
+ */
+void IMB_exr_write_channels_rows(void *handle, int num_rows);
 /**
  * Temporary function, used for FSA and Save Buffers.
  * called once per `tile * view`.
@@ -105,6 +123,12 @@ void IMB_exr_add_view(void *handle, const char *name);
 
 bool IMB_exr_has_multilayer(void *handle);
 
+/**
+ * Set the number of threads used for decompressing and compressing line blocks and tiles,
+ * zero uses the number of system threads.
+ */
+void IMB_exr_thread_count_set(int num_threads);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -97,6 +97,46 @@ void IMB_thumb_locks_release(void);
 void IMB_thumb_path_lock(const char *path);
 void IMB_thumb_path_unlock(const char *path);
 
+/* Thumbnail service */
+
+/**
+ * Generates thumbnails of many files in background threads, see #IMB_thumb_service_request.
+ */
+typedef struct ThumbService ThumbService;
+
+/**
+ * \param num_threads: Number of worker threads, zero uses the number of system threads up to a
+ * small maximum, as every worker may be decoding a full resolution image.
+ * \param mem_limit: Workers pause while the finished thumbnails that were not collected with
+ * #IMB_thumb_service_pop yet use more memory than this.
+ * \param free_user_data: Frees the user data of requests which are canceled, may be called from
+ * a worker thread.
+ */
+ThumbService *IMB_thumb_service_create(int num_threads,
+                                       size_t mem_limit,
+                                       void (*free_user_data)(void *user_data));
+void IMB_thumb_service_free(ThumbService *service);
+/**
+ * Queue a thumbnail for generation (like #IMB_thumb_manage), or only for reading the existing
+ * thumbnail when \a read_only is set. Requests with a lower \a priority value are handled first.
+ */
+void IMB_thumb_service_request(ThumbService *service,
+                               const char *filepath,
+                               ThumbSize size,
+                               ThumbSource source,
+                               bool read_only,
+                               float priority,
+                               void *user_data);
+/**
+ * Get a finished request, returns false when there is none. The thumbnail is NULL when it could
+ * not be generated, ownership of it and of the user data moves to the caller.
+ */
+bool IMB_thumb_service_pop(ThumbService *service, void **r_user_data, struct ImBuf **r_ibuf);
+/**
+ * Discard all requests that are not done yet and all results which were not collected.
+ */
+void IMB_thumb_service_cancel(ThumbService *service);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
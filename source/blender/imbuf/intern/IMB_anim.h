@@ -119,12 +119,17 @@ struct anim {
   AVFrame *pFrame_backup;
   bool pFrame_backup_complete;
 
-  struct ImBuf *cur_frame_final;
   int64_t cur_pts;
   int64_t cur_key_frame_pts;
   AVPacket *cur_packet;
+  /* Position of the most recently decoded frame. Differs from `cur_position` when frames are
+   * decoded ahead in background. */
+  int cur_decoded_position;
 
   bool seek_before_decode;
+
+  /* Frames decoded around the current position, see #AnimDecodeQueue. */
+  struct AnimDecodeQueue *decode_queue;
 #endif
 
   char index_dir[768];
@@ -140,3 +145,20 @@ struct anim {
 
   struct IDProperty *metadata;
 };
+
+/**
+ * Stop the background decoding thread and drop the frames it decoded ahead. Must be called
+ * before changing state used for decoding, such as time-code indices.
+ *
+ * Decoder state is left as is, the next requested frame is not in the queue, so it is decoded
+ * by #ffmpeg_decode_frame which seeks and flushes codec buffers when needed.
+ */
+void imb_anim_decode_queue_reset(struct anim *anim);
+
+/**
+ * Lock the decoder and time-code index state of the anim, which a background thread may be
+ * using for decoding ahead. Does nothing if no frame was decoded yet, in which case there is no
+ * background thread either.
+ */
+void imb_anim_decoder_lock(struct anim *anim);
+void imb_anim_decoder_unlock(struct anim *anim);
@@ -76,6 +76,9 @@ void imb_filetypes_exit(void);
 void imb_tile_cache_init(void);
 void imb_tile_cache_exit(void);
 
+void imb_image_tile_cache_init(void);
+void imb_image_tile_cache_exit(void);
+
 void imb_loadtile(struct ImBuf *ibuf, int tx, int ty, unsigned int *rect);
 /**
  * External free.
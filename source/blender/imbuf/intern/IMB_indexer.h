@@ -98,6 +98,9 @@ void IMB_indexer_close(struct anim_index *idx);
 void IMB_free_indices(struct anim *anim);
 
 struct anim *IMB_anim_open_proxy(struct anim *anim, IMB_Proxy_Size preview_size);
+/**
+ * The decoder of the anim must be locked, see #imb_anim_decoder_lock.
+ */
 struct anim_index *IMB_anim_open_index(struct anim *anim, IMB_Timecode_Type tc);
 
 int IMB_proxy_size_to_array_index(IMB_Proxy_Size pr_size);
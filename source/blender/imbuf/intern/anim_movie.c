@@ -37,6 +37,7 @@
 #  include <io.h>
 #endif
 
+#include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
@@ -66,6 +67,7 @@
 #  include <libavcodec/avcodec.h>
 #  include <libavformat/avformat.h>
 #  include <libavutil/imgutils.h>
+#  include <libavutil/opt.h>
 #  include <libavutil/rational.h>
 #  include <libswscale/swscale.h>
 
@@ -239,6 +241,8 @@ struct IDProperty *IMB_anim_load_metadata(struct anim *anim)
       BLI_assert(anim->pFormatCtx != NULL);
       av_log(anim->pFormatCtx, AV_LOG_DEBUG, "METADATA FETCH\n");
 
+      imb_anim_decoder_lock(anim);
+
       while (true) {
         entry = av_dict_get(anim->pFormatCtx->metadata, "", entry, AV_DICT_IGNORE_SUFFIX);
         if (entry == NULL) {
@@ -249,6 +253,7 @@ struct IDProperty *IMB_anim_load_metadata(struct anim *anim)
         IMB_metadata_ensure(&anim->metadata);
         IMB_metadata_set_field(anim->metadata, entry->key, entry->value);
       }
+      imb_anim_decoder_unlock(anim);
 #endif
       break;
     }
@@ -487,6 +492,51 @@ static ImBuf *avi_fetchibuf(struct anim *anim, int position)
 
 #ifdef WITH_FFMPEG
 
+static struct SwsContext *ffmpeg_sws_get_context(
+    int width, int height, int src_format, int dst_format, int sws_flags)
+{
+#  if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+  /* Threaded conversion requires the context to be set up through options. */
+  struct SwsContext *ctx = sws_alloc_context();
+  if (ctx == NULL) {
+    return NULL;
+  }
+  av_opt_set_int(ctx, "srcw", width, 0);
+  av_opt_set_int(ctx, "srch", height, 0);
+  av_opt_set_int(ctx, "src_format", src_format, 0);
+  av_opt_set_int(ctx, "dstw", width, 0);
+  av_opt_set_int(ctx, "dsth", height, 0);
+  av_opt_set_int(ctx, "dst_format", dst_format, 0);
+  av_opt_set_int(ctx, "sws_flags", sws_flags, 0);
+  av_opt_set_int(ctx, "threads", BLI_system_thread_count(), 0);
+
+  if (sws_init_context(ctx, NULL, NULL) < 0) {
+    sws_freeContext(ctx);
+    return NULL;
+  }
+  return ctx;
+#  else
+  return sws_getContext(
+      width, height, src_format, width, height, dst_format, sws_flags, NULL, NULL, NULL);
+#  endif
+}
+
+static void ffmpeg_sws_scale_frame(struct SwsContext *ctx, AVFrame *dst, const AVFrame *src)
+{
+#  if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+  /* Converts slices of the image in parallel. */
+  sws_scale_frame(ctx, dst, src);
+#  else
+  sws_scale(ctx,
+            (const uint8_t *const *)src->data,
+            src->linesize,
+            0,
+            src->height,
+            dst->data,
+            dst->linesize);
+#  endif
+}
+
 static int startffmpeg(struct anim *anim)
 {
   int i, video_stream_index;
@@ -675,7 +725,7 @@ static int startffmpeg(struct anim *anim)
   anim->framesize = anim->x * anim->y * 4;
 
   anim->cur_position = 0;
-  anim->cur_frame_final = 0;
+  anim->cur_decoded_position = 0;
   anim->cur_pts = -1;
   anim->cur_key_frame_pts = -1;
   anim->cur_packet = av_packet_alloc();
@@ -731,16 +781,12 @@ static int startffmpeg(struct anim *anim)
                          1);
   }
 
-  anim->img_convert_ctx = sws_getContext(anim->x,
-                                         anim->y,
-                                         anim->pCodecCtx->pix_fmt,
-                                         anim->x,
-                                         anim->y,
-                                         AV_PIX_FMT_RGBA,
-                                         SWS_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT,
-                                         NULL,
-                                         NULL,
-                                         NULL);
+  anim->img_convert_ctx = ffmpeg_sws_get_context(anim->x,
+                                                 anim->y,
+                                                 anim->pCodecCtx->pix_fmt,
+                                                 AV_PIX_FMT_RGBA,
+                                                 SWS_BILINEAR | SWS_PRINT_INFO |
+                                                     SWS_FULL_CHR_H_INT);
 
   if (!anim->img_convert_ctx) {
     fprintf(stderr, "Can't transform color space??? Bailing out...\n");
@@ -842,12 +888,11 @@ static AVFrame *ffmpeg_double_buffer_frame_fallback_get(struct anim *anim)
 /* postprocess the image in anim->pFrame and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->cur_frame_final
+ * Output is written to given `ibuf`.
  */
 
-static void ffmpeg_postprocess(struct anim *anim, AVFrame *input)
+static void ffmpeg_postprocess(struct anim *anim, AVFrame *input, ImBuf *ibuf)
 {
-  ImBuf *ibuf = anim->cur_frame_final;
   int filter_y = 0;
 
   /* This means the data wasn't read properly,
@@ -880,26 +925,48 @@ static void ffmpeg_postprocess(struct anim *anim, AVFrame *input)
     }
   }
 
-  sws_scale(anim->img_convert_ctx,
-            (const uint8_t *const *)input->data,
-            input->linesize,
-            0,
-            anim->y,
-            anim->pFrameRGB->data,
-            anim->pFrameRGB->linesize);
-
-  /* Copy the valid bytes from the aligned buffer vertically flipped into ImBuf */
-  int aligned_stride = anim->pFrameRGB->linesize[0];
-  const uint8_t *const src[4] = {
-      anim->pFrameRGB->data[0] + (anim->y - 1) * aligned_stride, 0, 0, 0};
-  /* NOTE: Negative linesize is used to copy and flip image at once with function
-   * `av_image_copy_to_buffer`. This could cause issues in future and image may need to be flipped
-   * explicitly. */
-  const int src_linesize[4] = {-anim->pFrameRGB->linesize[0], 0, 0, 0};
-  int dst_size = av_image_get_buffer_size(
-      anim->pFrameRGB->format, anim->pFrameRGB->width, anim->pFrameRGB->height, 1);
-  av_image_copy_to_buffer(
-      (uint8_t *)ibuf->rect, dst_size, src, src_linesize, AV_PIX_FMT_RGBA, anim->x, anim->y, 1);
+  /* When the line size of the converted frame matches the image, convert directly into the image
+   * and flip it vertically in the same step by using negative line size. Otherwise the converted
+   * frame has padding and has to be copied. */
+  const int ibuf_linesize = ibuf->x * 4;
+  const int rgb_linesize = anim->pFrameRGB->linesize[0];
+  bool scale_to_ibuf = (rgb_linesize == ibuf_linesize);
+  /* Older versions of libswscale can't handle negative line size on ARM64. */
+#  if (defined(__aarch64__) || defined(_M_ARM64)) && (LIBSWSCALE_VERSION_MAJOR < 7)
+  scale_to_ibuf = false;
+#  endif
+
+  /* `input` may not have dimensions set, `sws_scale_frame` relies on them. */
+  input->width = anim->x;
+  input->height = anim->y;
+
+  if (scale_to_ibuf) {
+    uint8_t *rgb_data = anim->pFrameRGB->data[0];
+    anim->pFrameRGB->data[0] = (uint8_t *)ibuf->rect + (size_t)(anim->y - 1) * ibuf_linesize;
+    anim->pFrameRGB->linesize[0] = -ibuf_linesize;
+
+    ffmpeg_sws_scale_frame(anim->img_convert_ctx, anim->pFrameRGB, input);
+
+    anim->pFrameRGB->data[0] = rgb_data;
+    anim->pFrameRGB->linesize[0] = rgb_linesize;
+  }
+  else {
+    ffmpeg_sws_scale_frame(anim->img_convert_ctx, anim->pFrameRGB, input);
+
+    /* Copy the valid bytes from the aligned buffer vertically flipped into ImBuf */
+    int aligned_stride = anim->pFrameRGB->linesize[0];
+    const uint8_t *const src[4] = {
+        anim->pFrameRGB->data[0] + (anim->y - 1) * aligned_stride, 0, 0, 0};
+    /* NOTE: Negative linesize is used to copy and flip image at once with function
+     * `av_image_copy_to_buffer`. This could cause issues in future and image may need to be
+     * flipped explicitly. */
+    const int src_linesize[4] = {-anim->pFrameRGB->linesize[0], 0, 0, 0};
+    int dst_size = av_image_get_buffer_size(
+        anim->pFrameRGB->format, anim->pFrameRGB->width, anim->pFrameRGB->height, 1);
+    av_image_copy_to_buffer(
+        (uint8_t *)ibuf->rect, dst_size, src, src_linesize, AV_PIX_FMT_RGBA, anim->x, anim->y, 1);
+  }
+
   if (filter_y) {
     IMB_filtery(ibuf);
   }
@@ -1265,7 +1332,7 @@ static bool ffmpeg_seek_buffers_need_flushing(struct anim *anim, int position, i
 
   /* Packet after seeking is same key frame as current, and further in time. No seeking was
    * necessary, so buffers don't have to be flushed. But stream position has to be recovered. */
-  if (gop_pts == anim->cur_key_frame_pts && position > anim->cur_position) {
+  if (gop_pts == anim->cur_key_frame_pts && position > anim->cur_decoded_position) {
     ffmpeg_seek_recover_stream_position(anim);
     return false;
   }
@@ -1288,7 +1355,7 @@ static int ffmpeg_seek_to_key_frame(struct anim *anim,
   if (tc_index) {
     /* We can use timestamps generated from our indexer to seek. */
     int new_frame_index = IMB_indexer_get_frame_index(tc_index, position);
-    int old_frame_index = IMB_indexer_get_frame_index(tc_index, anim->cur_position);
+    int old_frame_index = IMB_indexer_get_frame_index(tc_index, anim->cur_decoded_position);
 
     if (IMB_indexer_can_scan(tc_index, old_frame_index, new_frame_index)) {
       /* No need to seek, return early. */
@@ -1371,17 +1438,15 @@ static int ffmpeg_seek_to_key_frame(struct anim *anim,
 
 static bool ffmpeg_must_seek(struct anim *anim, int position)
 {
-  bool must_seek = position != anim->cur_position + 1 || ffmpeg_is_first_frame_decode(anim);
+  bool must_seek = position != anim->cur_decoded_position + 1 ||
+                   ffmpeg_is_first_frame_decode(anim);
   anim->seek_before_decode = must_seek;
   return must_seek;
 }
 
-static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
+/* Decode frame at given position, returns new image owned by the caller. */
+static ImBuf *ffmpeg_decode_frame(struct anim *anim, int position, IMB_Timecode_Type tc)
 {
-  if (anim == NULL) {
-    return NULL;
-  }
-
   av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: seek_pos=%d\n", position);
 
   struct anim_index *tc_index = IMB_anim_open_index(anim, tc);
@@ -1406,8 +1471,6 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
   ffmpeg_decode_video_frame_scan(anim, pts_to_search);
 
-  IMB_freeImBuf(anim->cur_frame_final);
-
   /* Certain versions of FFmpeg have a bug in libswscale which ends up in crash
    * when destination buffer is not properly aligned. For example, this happens
    * in FFmpeg 4.3.1. It got fixed later on, but for compatibility reasons is
@@ -1434,12 +1497,11 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     planes = R_IMF_PLANES_RGB;
   }
 
-  anim->cur_frame_final = IMB_allocImBuf(anim->x, anim->y, planes, 0);
-  anim->cur_frame_final->rect = MEM_mallocN_aligned(
-      (size_t)4 * anim->x * anim->y, 32, "ffmpeg ibuf");
-  anim->cur_frame_final->mall |= IB_rect;
+  ImBuf *ibuf = IMB_allocImBuf(anim->x, anim->y, planes, 0);
+  ibuf->rect = MEM_mallocN_aligned((size_t)4 * anim->x * anim->y, 32, "ffmpeg ibuf");
+  ibuf->mall |= IB_rect;
 
-  anim->cur_frame_final->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+  ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
 
   AVFrame *final_frame = ffmpeg_frame_by_pts_get(anim, pts_to_search);
   if (final_frame == NULL) {
@@ -1451,16 +1513,319 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   /* Even with the fallback from above it is possible that the current decode frame is NULL. In
    * this case skip post-processing and return current image buffer. */
   if (final_frame != NULL) {
-    ffmpeg_postprocess(anim, final_frame);
+    ffmpeg_postprocess(anim, final_frame, ibuf);
   }
 
-  anim->cur_position = position;
+  anim->cur_decoded_position = position;
 
-  IMB_refImBuf(anim->cur_frame_final);
+  return ibuf;
+}
 
-  return anim->cur_frame_final;
+/* -------------------------------------------------------------------- */
+/** \name Background Decoding
+ *
+ * When frames are requested sequentially (e.g. during playback), following frames are decoded
+ * in a background thread, so they are ready by the time they are requested. A few frames before
+ * the current position are kept as well, so that stepping back doesn't need to seek and decode
+ * the whole GOP again.
+ *
+ * Decoder and time-code index state of the anim is only accessed with the decoder mutex of the
+ * queue locked, see #imb_anim_decoder_lock. Frames decoded ahead by all movies share a memory
+ * limit, so that many movies played at once (e.g. by multiple prefetch workers) don't fill the
+ * memory with frames which might never be used.
+ * \{ */
+
+#  define ANIM_DECODE_AHEAD_FRAMES 4
+#  define ANIM_DECODE_BEHIND_FRAMES 2
+#  define ANIM_DECODE_MEMORY_LIMIT ((size_t)512 * 1024 * 1024)
+
+/* Memory used by decoded frames of all queues. */
+static ThreadMutex decode_memory_mutex = BLI_MUTEX_INITIALIZER;
+static size_t decode_memory_in_use = 0;
+
+typedef struct AnimDecodedFrame {
+  struct AnimDecodedFrame *next, *prev;
+  int position;
+  ImBuf *ibuf;
+  size_t mem_size;
+} AnimDecodedFrame;
+
+typedef struct AnimDecodeQueue {
+  /* Guards the frames and positions of the queue. */
+  ThreadMutex mutex;
+  ThreadCondition cond;
+  ListBase threads;
+  /* Guards the decoder and indices of the anim, held while decoding a frame. Separate from
+   * #mutex, so that decoded frames can be taken while the next one is decoded. Must not be
+   * locked before #mutex. */
+  ThreadMutex decoder_mutex;
+
+  /* Decoded frames sorted by position. */
+  ListBase frames;
+  IMB_Timecode_Type tc;
+  int num_positions;
+  /* Last requested frame. */
+  int position;
+  /* Next frame to be decoded in background. */
+  int next_position;
+  /* Memory used by the last decoded frame, to estimate the size of the next one. */
+  size_t frame_mem_size;
+
+  bool running;
+  bool stop;
+} AnimDecodeQueue;
+
+static AnimDecodedFrame *ffmpeg_decode_queue_find(AnimDecodeQueue *queue, int position)
+{
+  LISTBASE_FOREACH (AnimDecodedFrame *, frame, &queue->frames) {
+    if (frame->position == position) {
+      return frame;
+    }
+  }
+  return NULL;
+}
+
+static void ffmpeg_decode_queue_add(AnimDecodeQueue *queue, int position, ImBuf *ibuf)
+{
+  AnimDecodedFrame *frame = MEM_mallocN(sizeof(AnimDecodedFrame), __func__);
+  frame->position = position;
+  frame->ibuf = ibuf;
+  frame->mem_size = ibuf ? IMB_get_size_in_memory(ibuf) : 0;
+  queue->frame_mem_size = frame->mem_size;
+
+  BLI_mutex_lock(&decode_memory_mutex);
+  decode_memory_in_use += frame->mem_size;
+  BLI_mutex_unlock(&decode_memory_mutex);
+
+  AnimDecodedFrame *next = queue->frames.first;
+  while (next && next->position < position) {
+    next = next->next;
+  }
+  BLI_insertlinkbefore(&queue->frames, next, frame);
 }
 
+static void ffmpeg_decode_queue_remove(AnimDecodeQueue *queue, AnimDecodedFrame *frame)
+{
+  BLI_remlink(&queue->frames, frame);
+  IMB_freeImBuf(frame->ibuf);
+
+  BLI_mutex_lock(&decode_memory_mutex);
+  decode_memory_in_use -= frame->mem_size;
+  BLI_mutex_unlock(&decode_memory_mutex);
+
+  MEM_freeN(frame);
+}
+
+/* Free frames that are too far from the current position. */
+static void ffmpeg_decode_queue_trim(AnimDecodeQueue *queue)
+{
+  LISTBASE_FOREACH_MUTABLE (AnimDecodedFrame *, frame, &queue->frames) {
+    if (frame->position < queue->position - ANIM_DECODE_BEHIND_FRAMES ||
+        frame->position > queue->position + ANIM_DECODE_AHEAD_FRAMES) {
+      ffmpeg_decode_queue_remove(queue, frame);
+    }
+  }
+}
+
+static bool ffmpeg_decode_queue_need_decode(const AnimDecodeQueue *queue)
+{
+  if (queue->stop || queue->next_position >= queue->num_positions ||
+      queue->next_position > queue->position + ANIM_DECODE_AHEAD_FRAMES) {
+    return false;
+  }
+
+  BLI_mutex_lock(&decode_memory_mutex);
+  const bool has_memory = decode_memory_in_use + queue->frame_mem_size <=
+                          ANIM_DECODE_MEMORY_LIMIT;
+  BLI_mutex_unlock(&decode_memory_mutex);
+  return has_memory;
+}
+
+static void *ffmpeg_decode_queue_thread(void *anim_v)
+{
+  struct anim *anim = (struct anim *)anim_v;
+  AnimDecodeQueue *queue = anim->decode_queue;
+
+  BLI_mutex_lock(&queue->mutex);
+  while (ffmpeg_decode_queue_need_decode(queue)) {
+    const int position = queue->next_position;
+
+    BLI_mutex_unlock(&queue->mutex);
+    BLI_mutex_lock(&queue->decoder_mutex);
+    ImBuf *ibuf = ffmpeg_decode_frame(anim, position, queue->tc);
+    BLI_mutex_unlock(&queue->decoder_mutex);
+    BLI_mutex_lock(&queue->mutex);
+
+    ffmpeg_decode_queue_add(queue, position, ibuf);
+    queue->next_position++;
+    BLI_condition_notify_all(&queue->cond);
+  }
+  queue->running = false;
+  BLI_condition_notify_all(&queue->cond);
+  BLI_mutex_unlock(&queue->mutex);
+
+  return NULL;
+}
+
+static AnimDecodeQueue *ffmpeg_decode_queue_create(void)
+{
+  AnimDecodeQueue *queue = MEM_callocN(sizeof(AnimDecodeQueue), __func__);
+  BLI_mutex_init(&queue->mutex);
+  BLI_mutex_init(&queue->decoder_mutex);
+  BLI_condition_init(&queue->cond);
+  BLI_threadpool_init(&queue->threads, ffmpeg_decode_queue_thread, 1);
+  queue->tc = IMB_TC_NONE;
+  queue->position = -1;
+  return queue;
+}
+
+/* Stop background decoding and wait for the thread to finish. */
+static void ffmpeg_decode_queue_stop(struct anim *anim)
+{
+  AnimDecodeQueue *queue = anim->decode_queue;
+
+  BLI_mutex_lock(&queue->mutex);
+  queue->stop = true;
+  while (queue->running) {
+    BLI_condition_wait(&queue->cond, &queue->mutex);
+  }
+  queue->stop = false;
+  BLI_mutex_unlock(&queue->mutex);
+
+  BLI_threadpool_remove(&queue->threads, anim);
+}
+
+/* Must be called with locked mutex. */
+static void ffmpeg_decode_queue_start(struct anim *anim)
+{
+  AnimDecodeQueue *queue = anim->decode_queue;
+
+  if (queue->running || !ffmpeg_decode_queue_need_decode(queue)) {
+    return;
+  }
+
+  /* Join the previous thread which has finished already. */
+  BLI_threadpool_remove(&queue->threads, anim);
+  queue->running = true;
+  BLI_threadpool_insert(&queue->threads, anim);
+}
+
+static void ffmpeg_decode_queue_free(struct anim *anim)
+{
+  AnimDecodeQueue *queue = anim->decode_queue;
+  if (queue == NULL) {
+    return;
+  }
+
+  ffmpeg_decode_queue_stop(anim);
+  BLI_threadpool_end(&queue->threads);
+  LISTBASE_FOREACH_MUTABLE (AnimDecodedFrame *, frame, &queue->frames) {
+    ffmpeg_decode_queue_remove(queue, frame);
+  }
+  BLI_mutex_end(&queue->mutex);
+  BLI_mutex_end(&queue->decoder_mutex);
+  BLI_condition_end(&queue->cond);
+  MEM_freeN(queue);
+  anim->decode_queue = NULL;
+}
+
+static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+  if (anim == NULL) {
+    return NULL;
+  }
+
+  if (anim->decode_queue == NULL) {
+    anim->decode_queue = ffmpeg_decode_queue_create();
+  }
+
+  AnimDecodeQueue *queue = anim->decode_queue;
+  ImBuf *ibuf = NULL;
+
+  BLI_mutex_lock(&queue->mutex);
+  const bool is_sequential = position == queue->position + 1;
+  if (queue->tc == tc) {
+    /* Wait for frame that is being decoded ahead. */
+    if (queue->running && position >= queue->next_position &&
+        position <= queue->position + ANIM_DECODE_AHEAD_FRAMES) {
+      queue->position = position;
+      while (queue->running && queue->next_position <= position) {
+        BLI_condition_wait(&queue->cond, &queue->mutex);
+      }
+    }
+
+    AnimDecodedFrame *frame = ffmpeg_decode_queue_find(queue, position);
+    if (frame) {
+      ibuf = frame->ibuf;
+    }
+  }
+
+  if (ibuf == NULL) {
+    BLI_mutex_unlock(&queue->mutex);
+    ffmpeg_decode_queue_stop(anim);
+    BLI_mutex_lock(&queue->mutex);
+
+    LISTBASE_FOREACH_MUTABLE (AnimDecodedFrame *, frame, &queue->frames) {
+      ffmpeg_decode_queue_remove(queue, frame);
+    }
+    queue->tc = tc;
+    queue->num_positions = IMB_anim_get_duration(anim, tc);
+
+    BLI_mutex_lock(&queue->decoder_mutex);
+    ibuf = ffmpeg_decode_frame(anim, position, tc);
+    BLI_mutex_unlock(&queue->decoder_mutex);
+    ffmpeg_decode_queue_add(queue, position, ibuf);
+    queue->next_position = position + 1;
+  }
+
+  queue->position = position;
+  ffmpeg_decode_queue_trim(queue);
+
+  /* Decode following frames in background during playback. Random access, such as scrubbing or
+   * thumbnail generation, would only waste the decoded frames. */
+  if (is_sequential) {
+    ffmpeg_decode_queue_start(anim);
+  }
+  BLI_mutex_unlock(&queue->mutex);
+
+  /* The queue keeps its own reference. */
+  IMB_refImBuf(ibuf);
+  return ibuf;
+}
+
+void imb_anim_decode_queue_reset(struct anim *anim)
+{
+  AnimDecodeQueue *queue = anim->decode_queue;
+  if (queue == NULL) {
+    return;
+  }
+
+  ffmpeg_decode_queue_stop(anim);
+  LISTBASE_FOREACH_MUTABLE (AnimDecodedFrame *, frame, &queue->frames) {
+    ffmpeg_decode_queue_remove(queue, frame);
+  }
+  /* Next request can't find its frame in the queue and decodes it, setting up the time-code. */
+  queue->tc = IMB_TC_NONE;
+  queue->position = -1;
+  queue->next_position = 0;
+}
+
+void imb_anim_decoder_lock(struct anim *anim)
+{
+  if (anim->decode_queue) {
+    BLI_mutex_lock(&anim->decode_queue->decoder_mutex);
+  }
+}
+
+void imb_anim_decoder_unlock(struct anim *anim)
+{
+  if (anim->decode_queue) {
+    BLI_mutex_unlock(&anim->decode_queue->decoder_mutex);
+  }
+}
+
+/** \} */
+
 static void free_anim_ffmpeg(struct anim *anim)
 {
   if (anim == NULL) {
@@ -1468,6 +1833,7 @@ static void free_anim_ffmpeg(struct anim *anim)
   }
 
   if (anim->pCodecCtx) {
+    ffmpeg_decode_queue_free(anim);
     avcodec_free_context(&anim->pCodecCtx);
     avformat_close_input(&anim->pFormatCtx);
     av_packet_free(&anim->cur_packet);
@@ -1478,11 +1844,24 @@ static void free_anim_ffmpeg(struct anim *anim)
     av_frame_free(&anim->pFrameDeinterlaced);
 
     sws_freeContext(anim->img_convert_ctx);
-    IMB_freeImBuf(anim->cur_frame_final);
   }
   anim->duration_in_frames = 0;
 }
 
+#else
+
+void imb_anim_decode_queue_reset(struct anim *UNUSED(anim))
+{
+}
+
+void imb_anim_decoder_lock(struct anim *UNUSED(anim))
+{
+}
+
+void imb_anim_decoder_unlock(struct anim *UNUSED(anim))
+{
+}
+
 #endif
 
 /**
@@ -1654,12 +2033,12 @@ int IMB_anim_get_duration(struct anim *anim, IMB_Timecode_Type tc)
     return anim->duration_in_frames;
   }
 
+  imb_anim_decoder_lock(anim);
   idx = IMB_anim_open_index(anim, tc);
-  if (!idx) {
-    return anim->duration_in_frames;
-  }
+  const int duration = idx ? IMB_indexer_get_duration(idx) : anim->duration_in_frames;
+  imb_anim_decoder_unlock(anim);
 
-  return IMB_indexer_get_duration(idx);
+  return duration;
 }
 
 double IMD_anim_get_offset(struct anim *anim)
@@ -28,8 +28,10 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_math_color.h"
 #include "BLI_rect.h"
+#include "BLI_simd.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
 
@@ -90,9 +92,13 @@ static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 typedef struct ColormanageProcessor {
   OCIO_ConstCPUProcessorRcPtr *cpu_processor;
   CurveMapping *curve_mapping;
+  /* Approximation of the whole transform used for display buffers, see #display_lut_acquire. */
+  struct ColormanageBakedLUT *baked_lut;
   bool is_data_result;
 } ColormanageProcessor;
 
+static void display_lut_free_global(void);
+
 static struct global_gpu_state {
   /* GPU shader currently bound. */
   bool gpu_shader_bound;
@@ -736,6 +742,8 @@ void colormanagement_exit(void)
   memset(&global_gpu_state, 0, sizeof(global_gpu_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
+  display_lut_free_global();
+
   colormanage_free_config();
 }
 
@@ -1432,6 +1440,358 @@ const float *IMB_colormanagement_get_xyz_to_scene_linear()
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Baked Display Transform
+ *
+ * When enabled in the view settings, the whole display transform (curves, look, view transform,
+ * display, exposure and gamma) is evaluated once on a 3D lattice and display buffers are computed
+ * with tetrahedral interpolation of the lattice, which is much cheaper than running the OCIO
+ * processor chain for every pixel.
+ *
+ * Lattice points are evenly distributed in log2 space over the covered range of stops. Input
+ * values are mapped to lattice coordinates with a 1D shaper table, which is indexed by the
+ * exponent and upper mantissa bits of the value, so no logarithm is computed per pixel.
+ *
+ * The first lattice point is black instead of the lowest stop. Values between black and the
+ * second lattice point are mapped linearly, so that the darkest values are not flushed to black.
+ * Values above the highest stop are clamped, negative and NaN values are mapped to black.
+ * \{ */
+
+#define DISPLAY_LUT_SIZE 65
+/* Range of stops covered by the lattice, values outside of it are clamped. */
+#define DISPLAY_LUT_MIN_STOP (-12)
+#define DISPLAY_LUT_MAX_STOP 8
+#define DISPLAY_LUT_MIN_BITS ((127 + DISPLAY_LUT_MIN_STOP) << 23)
+/* Number of mantissa bits used to index the shaper table. */
+#define DISPLAY_LUT_SHAPER_MANTISSA_BITS 6
+#define DISPLAY_LUT_SHAPER_SHIFT (23 - DISPLAY_LUT_SHAPER_MANTISSA_BITS)
+#define DISPLAY_LUT_SHAPER_SIZE \
+  (((DISPLAY_LUT_MAX_STOP - DISPLAY_LUT_MIN_STOP) << DISPLAY_LUT_SHAPER_MANTISSA_BITS) + 2)
+
+typedef struct ColormanageBakedLUT {
+  /* Settings the table was baked for. */
+  char look[64];
+  char view_transform[64];
+  char display_device[64];
+  float exposure;
+  float gamma;
+  const CurveMapping *curve_mapping;
+  int curve_mapping_timestamp;
+
+  int users;
+
+  /* Lattice coordinate for scene linear values. */
+  float shaper[DISPLAY_LUT_SHAPER_SIZE];
+  /* Lattice coordinate per scene linear unit between black and the second lattice point. */
+  float toe_scale;
+  /* RGB of lattice points padded to 4 floats, red changes fastest. */
+  float *table;
+} ColormanageBakedLUT;
+
+/* Most recently used table, kept so that redraws don't need to bake it again. */
+static ColormanageBakedLUT *global_baked_lut = NULL;
+static ThreadMutex baked_lut_lock = BLI_MUTEX_INITIALIZER;
+
+/* Scene linear value of lattice point. */
+static float display_lut_shaper_inverse(int index)
+{
+  if (index == 0) {
+    /* Map lowest point to zero, so that black stays black. */
+    return 0.0f;
+  }
+  const float range = DISPLAY_LUT_MAX_STOP - DISPLAY_LUT_MIN_STOP;
+  return exp2f(DISPLAY_LUT_MIN_STOP + range * index / (DISPLAY_LUT_SIZE - 1));
+}
+
+static void display_lut_shaper_init(ColormanageBakedLUT *lut)
+{
+  const float range = DISPLAY_LUT_MAX_STOP - DISPLAY_LUT_MIN_STOP;
+  const float toe_value = display_lut_shaper_inverse(1);
+  lut->toe_scale = 1.0f / toe_value;
+  for (int i = 0; i < DISPLAY_LUT_SHAPER_SIZE; i++) {
+    const float value = int_as_float(DISPLAY_LUT_MIN_BITS + (i << DISPLAY_LUT_SHAPER_SHIFT));
+    if (value < toe_value) {
+      lut->shaper[i] = value * lut->toe_scale;
+    }
+    else {
+      const float stop = log2f(value) - DISPLAY_LUT_MIN_STOP;
+      lut->shaper[i] = clamp_f(stop / range, 0.0f, 1.0f) * (DISPLAY_LUT_SIZE - 1);
+    }
+  }
+}
+
+/* Lattice coordinate of scene linear value. */
+BLI_INLINE float display_lut_shaper(const ColormanageBakedLUT *lut, float value)
+{
+  const float min_value = int_as_float(DISPLAY_LUT_MIN_BITS);
+  if (!(value >= min_value)) {
+    /* Below the range of the shaper table, which is still in the linear part of it. NaN and
+     * negative values are mapped to black. */
+    return (value > 0.0f) ? value * lut->toe_scale : 0.0f;
+  }
+  const int max_bits = (DISPLAY_LUT_MAX_STOP - DISPLAY_LUT_MIN_STOP) << 23;
+  const int bits = min_ii(float_as_int(value) - DISPLAY_LUT_MIN_BITS, max_bits);
+  const int index = bits >> DISPLAY_LUT_SHAPER_SHIFT;
+  const float fac = (float)(bits & ((1 << DISPLAY_LUT_SHAPER_SHIFT) - 1)) /
+                    (1 << DISPLAY_LUT_SHAPER_SHIFT);
+  return interpf(lut->shaper[index + 1], lut->shaper[index], fac);
+}
+
+static bool display_lut_matches(const ColormanageBakedLUT *lut,
+                                const ColorManagedViewSettings *view_settings,
+                                const ColorManagedDisplaySettings *display_settings)
+{
+  const CurveMapping *curve_mapping = (view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) ?
+                                          view_settings->curve_mapping :
+                                          NULL;
+  if (curve_mapping != lut->curve_mapping ||
+      (curve_mapping && curve_mapping->changed_timestamp != lut->curve_mapping_timestamp)) {
+    return false;
+  }
+  return STREQ(lut->look, view_settings->look) &&
+         STREQ(lut->view_transform, view_settings->view_transform) &&
+         STREQ(lut->display_device, display_settings->display_device) &&
+         lut->exposure == view_settings->exposure && lut->gamma == view_settings->gamma;
+}
+
+typedef struct DisplayLUTBakeData {
+  ColormanageProcessor *cm_processor;
+  float *table;
+} DisplayLUTBakeData;
+
+/* Bake one slice of constant blue. */
+static void display_lut_bake_slice(void *data_v, int b)
+{
+  DisplayLUTBakeData *data = (DisplayLUTBakeData *)data_v;
+  const int slice_size = DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE;
+  float *slice = data->table + (size_t)4 * slice_size * b;
+  const float blue = display_lut_shaper_inverse(b);
+
+  float *point = slice;
+  for (int g = 0; g < DISPLAY_LUT_SIZE; g++) {
+    const float green = display_lut_shaper_inverse(g);
+    for (int r = 0; r < DISPLAY_LUT_SIZE; r++, point += 4) {
+      point[0] = display_lut_shaper_inverse(r);
+      point[1] = green;
+      point[2] = blue;
+      point[3] = 1.0f;
+    }
+  }
+
+  IMB_colormanagement_processor_apply(
+      data->cm_processor, slice, DISPLAY_LUT_SIZE, DISPLAY_LUT_SIZE, 4, false);
+}
+
+static ColormanageBakedLUT *display_lut_bake(const ColorManagedViewSettings *view_settings,
+                                             const ColorManagedDisplaySettings *display_settings)
+{
+  ColormanageBakedLUT *lut = MEM_callocN(sizeof(ColormanageBakedLUT), "colormanage baked lut");
+  STRNCPY(lut->look, view_settings->look);
+  STRNCPY(lut->view_transform, view_settings->view_transform);
+  STRNCPY(lut->display_device, display_settings->display_device);
+  lut->exposure = view_settings->exposure;
+  lut->gamma = view_settings->gamma;
+  if (view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
+    lut->curve_mapping = view_settings->curve_mapping;
+    lut->curve_mapping_timestamp = view_settings->curve_mapping->changed_timestamp;
+  }
+
+  display_lut_shaper_init(lut);
+
+  const size_t num_points = (size_t)DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE;
+  lut->table = MEM_mallocN_aligned(num_points * 4 * sizeof(float), 16, "colormanage lut table");
+
+  DisplayLUTBakeData data;
+  data.cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+  data.table = lut->table;
+  IMB_processor_apply_threaded_scanlines(DISPLAY_LUT_SIZE, display_lut_bake_slice, &data);
+  IMB_colormanagement_processor_free(data.cm_processor);
+
+  return lut;
+}
+
+static void display_lut_release(ColormanageBakedLUT *lut)
+{
+  BLI_mutex_lock(&baked_lut_lock);
+  lut->users--;
+  if (lut->users == 0) {
+    MEM_freeN(lut->table);
+    MEM_freeN(lut);
+  }
+  BLI_mutex_unlock(&baked_lut_lock);
+}
+
+/**
+ * Get table for given settings, the table is only baked again when the settings changed since
+ * the last call. Must be released with #display_lut_release.
+ */
+static ColormanageBakedLUT *display_lut_acquire(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  BLI_mutex_lock(&baked_lut_lock);
+  if (global_baked_lut == NULL ||
+      !display_lut_matches(global_baked_lut, view_settings, display_settings)) {
+    ColormanageBakedLUT *lut = display_lut_bake(view_settings, display_settings);
+    lut->users = 1;
+
+    if (global_baked_lut) {
+      global_baked_lut->users--;
+      if (global_baked_lut->users == 0) {
+        MEM_freeN(global_baked_lut->table);
+        MEM_freeN(global_baked_lut);
+      }
+    }
+    global_baked_lut = lut;
+  }
+
+  ColormanageBakedLUT *lut = global_baked_lut;
+  lut->users++;
+  BLI_mutex_unlock(&baked_lut_lock);
+
+  return lut;
+}
+
+static void display_lut_free_global(void)
+{
+  if (global_baked_lut) {
+    display_lut_release(global_baked_lut);
+    global_baked_lut = NULL;
+  }
+}
+
+/* Barycentric weights of the tetrahedron for fractions sorted in descending order. */
+BLI_INLINE void display_lut_tetrahedron_weights(float w[4], float f0, float f1, float f2)
+{
+  w[0] = 1.0f - f0;
+  w[1] = f0 - f1;
+  w[2] = f1 - f2;
+  w[3] = f2;
+}
+
+/* Tetrahedral interpolation of the lattice, only RGB of the pixel is modified. */
+static void display_lut_apply_v3(const ColormanageBakedLUT *lut, float pixel[3])
+{
+  const int stride_r = 4;
+  const int stride_g = 4 * DISPLAY_LUT_SIZE;
+  const int stride_b = 4 * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE;
+
+  const float coord_r = display_lut_shaper(lut, pixel[0]);
+  const float coord_g = display_lut_shaper(lut, pixel[1]);
+  const float coord_b = display_lut_shaper(lut, pixel[2]);
+  /* Coordinates are never negative, so truncation is floor. Last lattice cell is used for the
+   * upper boundary. */
+  const int r = min_ii((int)coord_r, DISPLAY_LUT_SIZE - 2);
+  const int g = min_ii((int)coord_g, DISPLAY_LUT_SIZE - 2);
+  const int b = min_ii((int)coord_b, DISPLAY_LUT_SIZE - 2);
+  const float fr = coord_r - r;
+  const float fg = coord_g - g;
+  const float fb = coord_b - b;
+
+  /* Pick the tetrahedron containing the point, it always contains the first and last corner of
+   * the cell and two corners in between. */
+  float w[4];
+  int offset_a, offset_b;
+  if (fr > fg) {
+    if (fg > fb) {
+      display_lut_tetrahedron_weights(w, fr, fg, fb);
+      offset_a = stride_r, offset_b = stride_r + stride_g;
+    }
+    else if (fr > fb) {
+      display_lut_tetrahedron_weights(w, fr, fb, fg);
+      offset_a = stride_r, offset_b = stride_r + stride_b;
+    }
+    else {
+      display_lut_tetrahedron_weights(w, fb, fr, fg);
+      offset_a = stride_b, offset_b = stride_r + stride_b;
+    }
+  }
+  else {
+    if (fb > fg) {
+      display_lut_tetrahedron_weights(w, fb, fg, fr);
+      offset_a = stride_b, offset_b = stride_g + stride_b;
+    }
+    else if (fb > fr) {
+      display_lut_tetrahedron_weights(w, fg, fb, fr);
+      offset_a = stride_g, offset_b = stride_g + stride_b;
+    }
+    else {
+      display_lut_tetrahedron_weights(w, fg, fr, fb);
+      offset_a = stride_g, offset_b = stride_r + stride_g;
+    }
+  }
+
+  const float *p0 = lut->table + (size_t)r * stride_r + (size_t)g * stride_g +
+                    (size_t)b * stride_b;
+  const float *pa = p0 + offset_a;
+  const float *pb = p0 + offset_b;
+  const float *p1 = p0 + stride_r + stride_g + stride_b;
+
+#ifdef BLI_HAVE_SSE2
+  __m128 result = _mm_mul_ps(_mm_set1_ps(w[0]), _mm_load_ps(p0));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w[1]), _mm_load_ps(pa)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w[2]), _mm_load_ps(pb)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w[3]), _mm_load_ps(p1)));
+
+  float rgba[4];
+  _mm_storeu_ps(rgba, result);
+  copy_v3_v3(pixel, rgba);
+#else
+  for (int i = 0; i < 3; i++) {
+    pixel[i] = w[0] * p0[i] + w[1] * pa[i] + w[2] * pb[i] + w[3] * p1[i];
+  }
+#endif
+}
+
+static void display_lut_apply_v4_predivide(const ColormanageBakedLUT *lut, float pixel[4])
+{
+  if (pixel[3] == 1.0f || pixel[3] == 0.0f) {
+    display_lut_apply_v3(lut, pixel);
+  }
+  else {
+    const float alpha = pixel[3];
+    mul_v3_fl(pixel, 1.0f / alpha);
+    display_lut_apply_v3(lut, pixel);
+    mul_v3_fl(pixel, alpha);
+  }
+}
+
+static void display_lut_apply(const ColormanageBakedLUT *lut,
+                              float *buffer,
+                              int width,
+                              int height,
+                              int channels,
+                              bool predivide)
+{
+  const size_t num_pixels = (size_t)width * height;
+  float *pixel = buffer;
+  if (channels == 4 && predivide) {
+    for (size_t i = 0; i < num_pixels; i++, pixel += 4) {
+      display_lut_apply_v4_predivide(lut, pixel);
+    }
+  }
+  else {
+    for (size_t i = 0; i < num_pixels; i++, pixel += channels) {
+      display_lut_apply_v3(lut, pixel);
+    }
+  }
+}
+
+ColormanageProcessor *IMB_colormanagement_display_buffer_processor_new(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  ColormanageProcessor *cm_processor = IMB_colormanagement_display_processor_new(view_settings,
+                                                                                 display_settings);
+  if (view_settings && (view_settings->flag & COLORMANAGE_VIEW_USE_BAKED_LUT) &&
+      cm_processor->cpu_processor && !cm_processor->is_data_result) {
+    cm_processor->baked_lut = display_lut_acquire(view_settings, display_settings);
+  }
+  return cm_processor;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Threaded Display Buffer Transform Routines
  * \{ */
@@ -1762,7 +2122,8 @@ static void colormanage_display_buffer_process_ex(
     float *display_buffer,
     uchar *display_buffer_byte,
     const ColorManagedViewSettings *view_settings,
-    const ColorManagedDisplaySettings *display_settings)
+    const ColorManagedDisplaySettings *display_settings,
+    const bool for_display)
 {
   ColormanageProcessor *cm_processor = NULL;
   bool skip_transform = false;
@@ -1777,7 +2138,10 @@ static void colormanage_display_buffer_process_ex(
   }
 
   if (skip_transform == false) {
-    cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+    cm_processor = for_display ? IMB_colormanagement_display_buffer_processor_new(
+                                     view_settings, display_settings) :
+                                 IMB_colormanagement_display_processor_new(view_settings,
+                                                                           display_settings);
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -1798,7 +2162,7 @@ static void colormanage_display_buffer_process(ImBuf *ibuf,
                                                const ColorManagedDisplaySettings *display_settings)
 {
   colormanage_display_buffer_process_ex(
-      ibuf, NULL, display_buffer, view_settings, display_settings);
+      ibuf, NULL, display_buffer, view_settings, display_settings, true);
 }
 
 /** \} */
@@ -2457,7 +2821,7 @@ static void colormanagement_imbuf_make_display_space(
   }
 
   colormanage_display_buffer_process_ex(
-      ibuf, ibuf->rect_float, (uchar *)ibuf->rect, view_settings, display_settings);
+      ibuf, ibuf->rect_float, (uchar *)ibuf->rect, view_settings, display_settings, false);
 }
 
 void IMB_colormanagement_imbuf_make_display_space(
@@ -3640,7 +4004,8 @@ static void imb_partial_display_buffer_update_ex(
     }
 
     if (!skip_transform) {
-      cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+      cm_processor = IMB_colormanagement_display_buffer_processor_new(view_settings,
+                                                                      display_settings);
     }
 
     if (do_threads) {
@@ -3861,7 +4226,13 @@ void IMB_colormanagement_processor_apply_pixel(struct ColormanageProcessor *cm_p
                                                float *pixel,
                                                int channels)
 {
-  if (channels == 4) {
+  if (cm_processor->baked_lut && channels == 4) {
+    display_lut_apply_v4_predivide(cm_processor->baked_lut, pixel);
+  }
+  else if (cm_processor->baked_lut && channels == 3) {
+    display_lut_apply_v3(cm_processor->baked_lut, pixel);
+  }
+  else if (channels == 4) {
     IMB_colormanagement_processor_apply_v4_predivide(cm_processor, pixel);
   }
   else if (channels == 3) {
@@ -3885,6 +4256,12 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
                                          int channels,
                                          bool predivide)
 {
+  if (cm_processor->baked_lut && channels >= 3) {
+    /* Curve mapping is baked into the table. */
+    display_lut_apply(cm_processor->baked_lut, buffer, width, height, channels, predivide);
+    return;
+  }
+
   /* apply curve mapping */
   if (cm_processor->curve_mapping) {
     int x, y;
@@ -3947,6 +4324,9 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->cpu_processor) {
     OCIO_cpuProcessorRelease(cm_processor->cpu_processor);
   }
+  if (cm_processor->baked_lut) {
+    display_lut_release(cm_processor->baked_lut);
+  }
 
   MEM_freeN(cm_processor);
 }
@@ -590,11 +590,13 @@ void IMB_makemipmap(ImBuf *ibuf, int use_filter)
     if (use_filter) {
       ImBuf *nbuf = IMB_allocImBuf(hbuf->x, hbuf->y, hbuf->planes, hbuf->flags);
       imb_filterN(nbuf, hbuf);
-      ibuf->mipmap[curmap] = IMB_onehalf(nbuf);
+      ibuf->mipmap[curmap] = IMB_scale_into_new(
+          nbuf, max_ii(1, hbuf->x / 2), max_ii(1, hbuf->y / 2), IMB_SCALE_FILTER_BOX, true);
       IMB_freeImBuf(nbuf);
     }
     else {
-      ibuf->mipmap[curmap] = IMB_onehalf(hbuf);
+      ibuf->mipmap[curmap] = IMB_scale_into_new(
+          hbuf, max_ii(1, hbuf->x / 2), max_ii(1, hbuf->y / 2), IMB_SCALE_FILTER_BOX, true);
     }
 
     ibuf->miptot = curmap + 2;
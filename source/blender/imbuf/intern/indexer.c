@@ -13,6 +13,7 @@
 #include "BLI_endian_switch.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_listbase.h"
 #include "BLI_math.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
@@ -474,6 +475,10 @@ typedef struct IndexBuildContext {
 
 #ifdef WITH_FFMPEG
 
+/* Decoded frames are queued for each proxy size, so scaling and encoding of all sizes runs in
+ * parallel with decoding. Decoding waits when a queue is full. */
+#  define PROXY_OUTPUT_QUEUE_MAX 8
+
 struct proxy_output_ctx {
   AVFormatContext *of;
   AVStream *st;
@@ -485,8 +490,94 @@ struct proxy_output_ctx {
   int proxy_size;
   int orig_height;
   struct anim *anim;
+
+  /* Queued frames in #LinkData, encoded by the thread. */
+  ListBase frames;
+  int frames_num;
+  /* No more frames are pushed, the thread finishes when the queue is empty. */
+  bool frames_done;
+  ThreadMutex frames_mutex;
+  /* Notified when a frame is pushed or popped. */
+  ThreadCondition frames_cond;
+  ListBase threads;
 };
 
+static void add_to_proxy_output_ffmpeg(struct proxy_output_ctx *ctx, AVFrame *frame);
+
+static void *proxy_output_ffmpeg_thread(void *ctx_v)
+{
+  struct proxy_output_ctx *ctx = ctx_v;
+
+  BLI_mutex_lock(&ctx->frames_mutex);
+  while (true) {
+    while (BLI_listbase_is_empty(&ctx->frames) && !ctx->frames_done) {
+      BLI_condition_wait(&ctx->frames_cond, &ctx->frames_mutex);
+    }
+    LinkData *link = BLI_pophead(&ctx->frames);
+    if (link == NULL) {
+      break;
+    }
+    ctx->frames_num--;
+    BLI_condition_notify_all(&ctx->frames_cond);
+    BLI_mutex_unlock(&ctx->frames_mutex);
+
+    AVFrame *frame = link->data;
+    MEM_freeN(link);
+    add_to_proxy_output_ffmpeg(ctx, frame);
+    av_frame_free(&frame);
+
+    BLI_mutex_lock(&ctx->frames_mutex);
+  }
+  BLI_mutex_unlock(&ctx->frames_mutex);
+
+  return NULL;
+}
+
+static void proxy_output_ffmpeg_start(struct proxy_output_ctx *ctx)
+{
+  BLI_mutex_init(&ctx->frames_mutex);
+  BLI_condition_init(&ctx->frames_cond);
+  BLI_threadpool_init(&ctx->threads, proxy_output_ffmpeg_thread, 1);
+  BLI_threadpool_insert(&ctx->threads, ctx);
+}
+
+/* Queue decoded frame for scaling and encoding. */
+static void proxy_output_ffmpeg_push(struct proxy_output_ctx *ctx, AVFrame *frame)
+{
+  if (!ctx) {
+    return;
+  }
+
+  /* New reference to the frame data, decoder doesn't reuse buffers which are still referenced. */
+  AVFrame *frame_ref = av_frame_clone(frame);
+  if (frame_ref == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(&ctx->frames_mutex);
+  /* Wait until the thread took a frame from the full queue. */
+  while (ctx->frames_num >= PROXY_OUTPUT_QUEUE_MAX) {
+    BLI_condition_wait(&ctx->frames_cond, &ctx->frames_mutex);
+  }
+  BLI_addtail(&ctx->frames, BLI_genericNodeN(frame_ref));
+  ctx->frames_num++;
+  BLI_condition_notify_all(&ctx->frames_cond);
+  BLI_mutex_unlock(&ctx->frames_mutex);
+}
+
+/* Encode queued frames and wait for the thread to finish. */
+static void proxy_output_ffmpeg_stop(struct proxy_output_ctx *ctx)
+{
+  BLI_mutex_lock(&ctx->frames_mutex);
+  ctx->frames_done = true;
+  BLI_condition_notify_all(&ctx->frames_cond);
+  BLI_mutex_unlock(&ctx->frames_mutex);
+
+  BLI_threadpool_end(&ctx->threads);
+  BLI_mutex_end(&ctx->frames_mutex);
+  BLI_condition_end(&ctx->frames_cond);
+}
+
 static struct proxy_output_ctx *alloc_proxy_output_ffmpeg(
     struct anim *anim, AVStream *st, int proxy_size, int width, int height, int quality)
 {
@@ -650,6 +741,8 @@ static struct proxy_output_ctx *alloc_proxy_output_ffmpeg(
     return NULL;
   }
 
+  proxy_output_ffmpeg_start(rv);
+
   return rv;
 }
 
@@ -730,6 +823,8 @@ static void free_proxy_output_ffmpeg(struct proxy_output_ctx *ctx, int rollback)
     return;
   }
 
+  proxy_output_ffmpeg_stop(ctx);
+
   if (!rollback) {
     /* Flush the remaining packets. */
     add_to_proxy_output_ffmpeg(ctx, NULL);
@@ -956,7 +1051,7 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
   uint64_t pts = av_get_pts_from_frame(in_frame);
 
   for (i = 0; i < context->num_proxy_sizes; i++) {
-    add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+    proxy_output_ffmpeg_push(context->proxy_ctx[i], in_frame);
   }
 
   if (!context->start_pts_set) {
@@ -1348,9 +1443,8 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
         int x = anim->x * proxy_fac[i];
         int y = anim->y * proxy_fac[i];
 
-        struct ImBuf *s_ibuf = IMB_dupImBuf(tmp_ibuf);
-
-        IMB_scalefastImBuf(s_ibuf, x, y);
+        struct ImBuf *s_ibuf = IMB_scale_into_new(
+            tmp_ibuf, x, y, IMB_SCALE_FILTER_BILINEAR, true);
 
         IMB_convert_rgba_to_abgr(s_ibuf);
 
@@ -1506,6 +1600,10 @@ void IMB_free_indices(struct anim *anim)
 {
   int i;
 
+  /* Frames decoded in background use the indices. */
+  imb_anim_decode_queue_reset(anim);
+
+  imb_anim_decoder_lock(anim);
   for (i = 0; i < IMB_PROXY_MAX_SLOT; i++) {
     if (anim->proxy_anim[i]) {
       IMB_close_anim(anim->proxy_anim[i]);
@@ -1522,6 +1620,7 @@ void IMB_free_indices(struct anim *anim)
 
   anim->proxies_tried = 0;
   anim->indices_tried = 0;
+  imb_anim_decoder_unlock(anim);
 }
 
 void IMB_anim_set_index_dir(struct anim *anim, const char *dir)
@@ -1589,13 +1688,12 @@ struct anim_index *IMB_anim_open_index(struct anim *anim, IMB_Timecode_Type tc)
 
 int IMB_anim_index_get_frame_index(struct anim *anim, IMB_Timecode_Type tc, int position)
 {
+  imb_anim_decoder_lock(anim);
   struct anim_index *idx = IMB_anim_open_index(anim, tc);
+  const int frame_index = idx ? IMB_indexer_get_frame_index(idx, position) : position;
+  imb_anim_decoder_unlock(anim);
 
-  if (!idx) {
-    return position;
-  }
-
-  return IMB_indexer_get_frame_index(idx, position);
+  return frame_index;
 }
 
 IMB_Proxy_Size IMB_anim_proxy_get_existing(struct anim *anim)
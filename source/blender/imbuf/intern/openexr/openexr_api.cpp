@@ -13,9 +13,11 @@
 #include <fcntl.h>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 /* The OpenEXR version can reliably be found in this header file from OpenEXR,
  * for both 2.x and 3.x:
@@ -58,6 +60,7 @@
 #include <OpenEXR/ImfOutputPart.h>
 #include <OpenEXR/ImfPartHelper.h>
 #include <OpenEXR/ImfPartType.h>
+#include <OpenEXR/ImfTiledInputPart.h>
 #include <OpenEXR/ImfTiledOutputPart.h>
 
 #include "DNA_scene_types.h" /* For OpenEXR compression constants */
@@ -87,6 +90,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 #include "BLI_math_color.h"
 #include "BLI_mmap.h"
 #include "BLI_string_utils.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 
 #include "BKE_idprop.h"
@@ -710,6 +714,9 @@ struct ExrHandle {
 
   /** Used during file save, allows faster temporary buffers allocation. */
   int num_half_channels;
+
+  /** Number of scan-lines written so far, from the top of the image down. */
+  int write_rows_done;
 };
 
 /* flattened out channel */
@@ -720,6 +727,7 @@ struct ExrChannel {
   struct MultiViewChannelName *m; /* struct to store all multipart channel info */
   int xstride, ystride;           /* step to next pixel, to next scan-line. */
   float *rect;                    /* first pointer to write in */
+  int offset;                     /* offset of the channel in the #ExrPass rect */
   char chan_id;                   /* quick lookup of channel char */
   int view_id;                    /* quick lookup of channel view */
   bool use_half_float;            /* when saving use half float for file storage */
@@ -1164,64 +1172,94 @@ void IMB_exr_clear_channels(void *handle)
   BLI_freelistN(&data->channels);
 }
 
-void IMB_exr_write_channels(void *handle)
+/* Convert rows `[ymin, ymax)` of a half float channel, writing the pixels consecutively. */
+static void imb_exr_convert_half_rows(const ExrChannel *echan,
+                                      half *rect_half,
+                                      const int width,
+                                      const int ymin,
+                                      const int ymax)
 {
-  ExrHandle *data = (ExrHandle *)handle;
-  FrameBuffer frameBuffer;
-  ExrChannel *echan;
+  const float *rect = echan->rect + size_t(ymin) * width * echan->xstride;
+  const int xstride = echan->xstride;
+  blender::threading::parallel_for(
+      blender::IndexRange(size_t(ymax - ymin) * width), 65536, [&](const auto range) {
+        for (const int64_t i : range) {
+          rect_half[i] = float_to_half_safe(rect[i * xstride]);
+        }
+      });
+}
 
-  if (data->channels.first) {
-    const size_t num_pixels = ((size_t)data->width) * data->height;
-    half *rect_half = nullptr, *current_rect_half = nullptr;
+void IMB_exr_write_channels_rows(void *handle, int num_rows)
+{
+  ExrHandle *data = (ExrHandle *)handle;
 
-    /* We allocate temporary storage for half pixels for all the channels at once. */
-    if (data->num_half_channels != 0) {
-      rect_half = (half *)MEM_mallocN(sizeof(half) * data->num_half_channels * num_pixels,
-                                      __func__);
-      current_rect_half = rect_half;
-    }
+  if (data->channels.first == nullptr) {
+    printf("Error: attempt to save MultiLayer without layers.\n");
+    return;
+  }
 
-    for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
-      /* Writing starts from last scan-line, stride negative. */
-      if (echan->use_half_float) {
-        float *rect = echan->rect;
-        half *cur = current_rect_half;
-        for (size_t i = 0; i < num_pixels; i++, cur++) {
-          *cur = float_to_half_safe(rect[i * echan->xstride]);
-        }
-        half *rect_to_write = current_rect_half + (data->height - 1L) * data->width;
-        frameBuffer.insert(
-            echan->name,
-            Slice(Imf::HALF, (char *)rect_to_write, sizeof(half), -data->width * sizeof(half)));
-        current_rect_half += num_pixels;
-      }
-      else {
-        float *rect = echan->rect + echan->xstride * (data->height - 1L) * data->width;
-        frameBuffer.insert(echan->name,
-                           Slice(Imf::FLOAT,
-                                 (char *)rect,
-                                 echan->xstride * sizeof(float),
-                                 -echan->ystride * sizeof(float)));
-      }
-    }
+  num_rows = std::min(num_rows, data->height - data->write_rows_done);
+  if (num_rows <= 0) {
+    return;
+  }
 
-    data->ofile->setFrameBuffer(frameBuffer);
-    try {
-      data->ofile->writePixels(data->height);
-    }
-    catch (const std::exception &exc) {
-      std::cerr << "OpenEXR-writePixels: ERROR: " << exc.what() << std::endl;
+  /* Rows are written from the top of the image, which is the end of Blender's buffers. */
+  const int ymax = data->height - data->write_rows_done;
+  const int ymin = ymax - num_rows;
+  const size_t num_pixels = size_t(data->width) * num_rows;
+  FrameBuffer frameBuffer;
+  half *rect_half = nullptr, *current_rect_half = nullptr;
+
+  /* Half float channels are converted into a temporary buffer shared by all channels, which only
+   * holds the rows written now. */
+  if (data->num_half_channels != 0) {
+    rect_half = (half *)MEM_mallocN(sizeof(half) * data->num_half_channels * num_pixels,
+                                    __func__);
+    current_rect_half = rect_half;
+  }
+
+  LISTBASE_FOREACH (ExrChannel *, echan, &data->channels) {
+    /* Writing starts from last scan-line, stride negative. */
+    if (echan->use_half_float) {
+      imb_exr_convert_half_rows(echan, current_rect_half, data->width, ymin, ymax);
+      /* Offset so that the first scan-line written now maps to the last row of the buffer. */
+      half *rect_to_write = current_rect_half + (data->height - 1L - ymin) * data->width;
+      frameBuffer.insert(
+          echan->name,
+          Slice(Imf::HALF, (char *)rect_to_write, sizeof(half), -data->width * sizeof(half)));
+      current_rect_half += num_pixels;
     }
-    /* Free temporary buffers. */
-    if (rect_half != nullptr) {
-      MEM_freeN(rect_half);
+    else {
+      float *rect = echan->rect + echan->xstride * (data->height - 1L) * data->width;
+      frameBuffer.insert(echan->name,
+                         Slice(Imf::FLOAT,
+                               (char *)rect,
+                               echan->xstride * sizeof(float),
+                               -echan->ystride * sizeof(float)));
     }
   }
-  else {
-    printf("Error: attempt to save MultiLayer without layers.\n");
+
+  data->ofile->setFrameBuffer(frameBuffer);
+  try {
+    data->ofile->writePixels(num_rows);
+  }
+  catch (const std::exception &exc) {
+    std::cerr << "OpenEXR-writePixels: ERROR: " << exc.what() << std::endl;
+  }
+  data->write_rows_done += num_rows;
+
+  /* Free temporary buffers. */
+  if (rect_half != nullptr) {
+    MEM_freeN(rect_half);
   }
 }
 
+void IMB_exr_write_channels(void *handle)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  IMB_exr_write_channels_rows(handle, data->height - data->write_rows_done);
+}
+
 void IMB_exrtile_write_channels(
     void *handle, int partx, int party, int level, const char *viewname, bool empty)
 {
@@ -1273,17 +1311,118 @@ void IMB_exrtile_write_channels(
   }
 }
 
+/* Allocate the buffer of a pass parsed from a file, and point its channels into it. */
+static void imb_exr_pass_ensure_rect(ExrHandle *data, ExrPass *pass)
+{
+  if (pass->rect != nullptr || pass->totchan == 0) {
+    return;
+  }
+
+  pass->rect = (float *)MEM_callocN(
+      sizeof(float) * data->width * data->height * pass->totchan, "pass rect");
+  for (int a = 0; a < pass->totchan; a++) {
+    ExrChannel *echan = pass->chan[a];
+    echan->rect = pass->rect + echan->offset;
+  }
+}
+
+static void imb_exr_read_part(ExrHandle *data, const int part, const bool flip)
+{
+  /* Read part header. */
+  InputPart in(*data->ifile, part);
+  const Box2i dw = in.header().dataWindow();
+
+  /* Insert all matching channel into frame-buffer. */
+  FrameBuffer frameBuffer;
+  ExrChannel *echan;
+  bool has_slices = false;
+
+  for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
+    if (echan->m->part_number != part) {
+      continue;
+    }
+
+    exr_printf("%d %-6s %-22s \"%s\"\n",
+               echan->m->part_number,
+               echan->m->view.c_str(),
+               echan->m->name.c_str(),
+               echan->m->internal_name.c_str());
+
+    if (echan->rect) {
+      float *rect = echan->rect;
+      size_t xstride = echan->xstride * sizeof(float);
+      size_t ystride = echan->ystride * sizeof(float);
+
+      if (!flip) {
+        /* Inverse correct first pixel for data-window coordinates. */
+        rect -= echan->xstride * (dw.min.x - dw.min.y * data->width);
+        /* Move to last scan-line to flip to Blender convention. */
+        rect += echan->xstride * (data->height - 1) * data->width;
+        ystride = -ystride;
+      }
+      else {
+        /* Inverse correct first pixel for data-window coordinates. */
+        rect -= echan->xstride * (dw.min.x + dw.min.y * data->width);
+      }
+
+      frameBuffer.insert(echan->m->internal_name,
+                         Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+      has_slices = true;
+    }
+    else if (BLI_listbase_is_empty(&data->layers)) {
+      /* Passes parsed from the file that were not requested have no rect on purpose. */
+      printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
+    }
+  }
+
+  /* Don't decompress parts of which no channel is needed. */
+  if (!has_slices) {
+    return;
+  }
+
+  /* Read pixels. */
+  try {
+    in.setFrameBuffer(frameBuffer);
+    exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", part, dw.min.y, dw.max.y);
+    in.readPixels(dw.min.y, dw.max.y);
+  }
+  catch (const std::exception &exc) {
+    std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
+  }
+}
+
 void IMB_exr_read_channels(void *handle)
+{
+  IMB_exr_read_channels_filtered(handle, nullptr, nullptr);
+}
+
+void IMB_exr_read_channels_filtered(void *handle,
+                                    bool (*pass_filter)(void *userdata,
+                                                        const char *layname,
+                                                        const char *passname,
+                                                        const char *view),
+                                    void *userdata)
 {
   ExrHandle *data = (ExrHandle *)handle;
-  int numparts = data->ifile->parts();
+  const int numparts = data->ifile->parts();
+
+  /* Only allocate buffers for the requested passes, the other passes are skipped while decoding,
+   * which avoids decompressing parts nobody asked for. */
+  LISTBASE_FOREACH (ExrLayer *, lay, &data->layers) {
+    LISTBASE_FOREACH (ExrPass *, pass, &lay->passes) {
+      if (pass_filter == nullptr ||
+          pass_filter(userdata, lay->name, pass->internal_name, pass->view)) {
+        imb_exr_pass_ensure_rect(data, pass);
+      }
+    }
+  }
 
   /* Check if EXR was saved with previous versions of blender which flipped images. */
   const StringAttribute *ta = data->ifile->header(0).findTypedAttribute<StringAttribute>(
       "BlenderMultiChannel");
 
   /* 'previous multilayer attribute, flipped. */
-  short flip = (ta && STRPREFIX(ta->value().c_str(), "Blender V2.43"));
+  const bool flip = (ta && STRPREFIX(ta->value().c_str(), "Blender V2.43"));
 
   exr_printf(
       "\nIMB_exr_read_channels\n%s %-6s %-22s "
@@ -1293,63 +1432,14 @@ void IMB_exr_read_channels(void *handle)
       "name",
       "internal_name");
 
-  for (int i = 0; i < numparts; i++) {
-    /* Read part header. */
-    InputPart in(*data->ifile, i);
-    Header header = in.header();
-    Box2i dw = header.dataWindow();
-
-    /* Insert all matching channel into frame-buffer. */
-    FrameBuffer frameBuffer;
-    ExrChannel *echan;
-
-    for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
-      if (echan->m->part_number != i) {
-        continue;
-      }
-
-      exr_printf("%d %-6s %-22s \"%s\"\n",
-                 echan->m->part_number,
-                 echan->m->view.c_str(),
-                 echan->m->name.c_str(),
-                 echan->m->internal_name.c_str());
-
-      if (echan->rect) {
-        float *rect = echan->rect;
-        size_t xstride = echan->xstride * sizeof(float);
-        size_t ystride = echan->ystride * sizeof(float);
-
-        if (!flip) {
-          /* Inverse correct first pixel for data-window coordinates. */
-          rect -= echan->xstride * (dw.min.x - dw.min.y * data->width);
-          /* Move to last scan-line to flip to Blender convention. */
-          rect += echan->xstride * (data->height - 1) * data->width;
-          ystride = -ystride;
-        }
-        else {
-          /* Inverse correct first pixel for data-window coordinates. */
-          rect -= echan->xstride * (dw.min.x + dw.min.y * data->width);
-        }
-
-        frameBuffer.insert(echan->m->internal_name,
-                           Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
-      }
-      else {
-        printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
-      }
+  /* Parts (one per view in multi-part files) share the file stream, access to which is serialized
+   * by OpenEXR. Reading them concurrently keeps the line block decompression pool busy while
+   * another part is waiting on the stream. */
+  blender::threading::parallel_for(blender::IndexRange(numparts), 1, [&](const auto range) {
+    for (const int part : range) {
+      imb_exr_read_part(data, part, flip);
     }
-
-    /* Read pixels. */
-    try {
-      in.setFrameBuffer(frameBuffer);
-      exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", i, dw.min.y, dw.max.y);
-      in.readPixels(dw.min.y, dw.max.y);
-    }
-    catch (const std::exception &exc) {
-      std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
-      break;
-    }
-  }
+  });
 }
 
 void IMB_exr_multilayer_convert(void *handle,
@@ -1648,15 +1738,14 @@ static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data)
     return false;
   }
 
-  /* with some heuristics, try to merge the channels in buffers */
+  /* With some heuristics, try to merge the channels in buffers. The buffers themselves are only
+   * allocated when the pass is read, see #imb_exr_pass_ensure_rect. */
   for (ExrLayer *lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
     for (ExrPass *pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
       if (pass->totchan) {
-        pass->rect = (float *)MEM_callocN(
-            data->width * data->height * pass->totchan * sizeof(float), "pass rect");
         if (pass->totchan == 1) {
           ExrChannel *echan = pass->chan[0];
-          echan->rect = pass->rect;
+          echan->offset = 0;
           echan->xstride = 1;
           echan->ystride = data->width;
           pass->chan_id[0] = echan->chan_id;
@@ -1689,7 +1778,7 @@ static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data)
             }
             for (int a = 0; a < pass->totchan; a++) {
               echan = pass->chan[a];
-              echan->rect = pass->rect + lookup[(uint)echan->chan_id];
+              echan->offset = lookup[(uint)echan->chan_id];
               echan->xstride = pass->totchan;
               echan->ystride = data->width * pass->totchan;
               pass->chan_id[(uint)lookup[(uint)echan->chan_id]] = echan->chan_id;
@@ -1698,7 +1787,7 @@ static bool imb_exr_multilayer_parse_channels_from_file(ExrHandle *data)
           else { /* unknown */
             for (int a = 0; a < pass->totchan; a++) {
               ExrChannel *echan = pass->chan[a];
-              echan->rect = pass->rect + a;
+              echan->offset = a;
               echan->xstride = pass->totchan;
               echan->ystride = data->width * pass->totchan;
               pass->chan_id[a] = echan->chan_id;
@@ -2167,6 +2256,42 @@ struct ImBuf *imb_load_openexr(const uchar *mem,
   }
 }
 
+/* Read the smallest mipmap level of a tiled file which is not smaller than the thumbnail,
+ * returns null when that is the full resolution image. */
+static ImBuf *exr_thumbnail_from_mipmap(const char *filepath, const size_t max_thumb_size)
+{
+  int tile_width, tile_height, num_levels;
+  ExrTileReader *reader = imb_exr_tile_reader_open(
+      filepath, &tile_width, &tile_height, &num_levels);
+  if (reader == nullptr) {
+    return nullptr;
+  }
+
+  int level = 0, width = 0, height = 0;
+  for (int l = 1; l < num_levels; l++) {
+    int level_width, level_height;
+    imb_exr_tile_reader_level_size(reader, l, &level_width, &level_height);
+    if (size_t(std::max(level_width, level_height)) < max_thumb_size) {
+      break;
+    }
+    level = l;
+    width = level_width;
+    height = level_height;
+  }
+
+  ImBuf *ibuf = nullptr;
+  if (level > 0) {
+    ibuf = IMB_allocImBuf(width, height, 32, IB_rectfloat);
+    if (!imb_exr_tile_reader_read(reader, level, 0, 0, width, height, ibuf->rect_float)) {
+      IMB_freeImBuf(ibuf);
+      ibuf = nullptr;
+    }
+  }
+
+  imb_exr_tile_reader_close(reader);
+  return ibuf;
+}
+
 struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath,
                                                   const int UNUSED(flags),
                                                   const size_t max_thumb_size,
@@ -2222,6 +2347,18 @@ struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath,
       colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
     }
 
+    /* Files with mipmap levels have a reduced resolution version that can be read directly, the
+     * caller scales it down to the final thumbnail size. */
+    if (file->header().hasTileDescription() &&
+        file->header().tileDescription().mode != ONE_LEVEL) {
+      ImBuf *ibuf = exr_thumbnail_from_mipmap(filepath, max_thumb_size);
+      if (ibuf) {
+        delete file;
+        delete stream;
+        return ibuf;
+      }
+    }
+
     float scale_factor = MIN2((float)max_thumb_size / (float)source_w,
                               (float)max_thumb_size / (float)source_h);
     int dest_w = (int)(source_w * scale_factor);
@@ -2271,12 +2408,268 @@ struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath,
   return nullptr;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Tile Reader
+ *
+ * Reads regions of single part RGBA files for the image tile cache, without decoding the whole
+ * image. Tiled files are read per tile and may contain mipmap levels, scan-line files are read in
+ * blocks of full scan-lines.
+ * \{ */
+
+#define EXR_TILE_READER_SCANLINES 64
+
+struct ExrTileReader {
+  IStream *stream;
+  MultiPartInputFile *file;
+
+  int num_rgb_channels;
+  const char *rgb_channels[3];
+  bool has_luma;
+  bool has_chroma;
+
+  bool is_tiled;
+  int num_levels;
+
+  /** Frame buffer setup and reading of a part is not thread safe. */
+  std::mutex mutex;
+};
+
+static void exr_tile_reader_free(ExrTileReader *reader)
+{
+  delete reader->file;
+  delete reader->stream;
+  delete reader;
+}
+
+ExrTileReader *imb_exr_tile_reader_open(const char *filepath,
+                                        int *r_tile_width,
+                                        int *r_tile_height,
+                                        int *r_num_levels)
+{
+  ExrTileReader *reader = new ExrTileReader();
+
+  try {
+    reader->stream = new IFileStream(filepath);
+    reader->file = new MultiPartInputFile(*reader->stream);
+    MultiPartInputFile &file = *reader->file;
+
+    if (imb_exr_is_multi(file)) {
+      /* Multi-layer files are only used for render results, not for textures. */
+      exr_tile_reader_free(reader);
+      return nullptr;
+    }
+
+    reader->num_rgb_channels = exr_has_rgb(file, reader->rgb_channels);
+    reader->has_luma = exr_has_luma(file);
+    reader->has_chroma = exr_has_chroma(file);
+
+    const Header &header = file.header(0);
+    const Box2i dw = header.dataWindow();
+    reader->is_tiled = header.hasTileDescription();
+
+    if (reader->is_tiled) {
+      TiledInputPart in(file, 0);
+      const TileDescription &tile_description = header.tileDescription();
+      *r_tile_width = tile_description.xSize;
+      *r_tile_height = tile_description.ySize;
+      switch (tile_description.mode) {
+        case MIPMAP_LEVELS:
+          reader->num_levels = in.numLevels();
+          break;
+        case RIPMAP_LEVELS:
+          /* Only the levels scaled equally in both directions are used. */
+          reader->num_levels = std::min(in.numXLevels(), in.numYLevels());
+          break;
+        default:
+          reader->num_levels = 1;
+          break;
+      }
+    }
+    else {
+      *r_tile_width = dw.max.x - dw.min.x + 1;
+      *r_tile_height = EXR_TILE_READER_SCANLINES;
+      reader->num_levels = 1;
+    }
+
+    *r_num_levels = reader->num_levels;
+    return reader;
+  }
+  catch (const std::exception &exc) {
+    std::cerr << exc.what() << std::endl;
+    exr_tile_reader_free(reader);
+    return nullptr;
+  }
+}
+
+void imb_exr_tile_reader_close(ExrTileReader *reader)
+{
+  exr_tile_reader_free(reader);
+}
+
+void imb_exr_tile_reader_level_size(ExrTileReader *reader,
+                                    const int level,
+                                    int *r_width,
+                                    int *r_height)
+{
+  Box2i dw;
+  if (reader->is_tiled) {
+    TiledInputPart in(*reader->file, 0);
+    dw = in.dataWindowForLevel(level, level);
+  }
+  else {
+    dw = reader->file->header(0).dataWindow();
+  }
+  *r_width = dw.max.x - dw.min.x + 1;
+  *r_height = dw.max.y - dw.min.y + 1;
+}
+
+static void exr_tile_reader_insert_slices(ExrTileReader *reader,
+                                          FrameBuffer &frame_buffer,
+                                          float *first,
+                                          const size_t ystride)
+{
+  MultiPartInputFile &file = *reader->file;
+  const size_t xstride = sizeof(float[4]);
+
+  if (reader->num_rgb_channels > 0) {
+    for (int i = 0; i < reader->num_rgb_channels; i++) {
+      frame_buffer.insert(exr_rgba_channelname(file, reader->rgb_channels[i]),
+                          Slice(Imf::FLOAT, (char *)(first + i), xstride, ystride));
+    }
+  }
+  else if (reader->has_luma) {
+    frame_buffer.insert(exr_rgba_channelname(file, "Y"),
+                        Slice(Imf::FLOAT, (char *)first, xstride, ystride));
+    frame_buffer.insert(exr_rgba_channelname(file, "BY"),
+                        Slice(Imf::FLOAT, (char *)(first + 1), xstride, ystride, 1, 1, 0.5f));
+    frame_buffer.insert(exr_rgba_channelname(file, "RY"),
+                        Slice(Imf::FLOAT, (char *)(first + 2), xstride, ystride, 1, 1, 0.5f));
+  }
+  frame_buffer.insert(exr_rgba_channelname(file, "A"),
+                      Slice(Imf::FLOAT, (char *)(first + 3), xstride, ystride, 1, 1, 1.0f));
+}
+
+/** Same conversion as #imb_load_openexr does for full images. */
+static void exr_tile_reader_convert(const ExrTileReader *reader, float *rgba, const size_t len)
+{
+  if (reader->num_rgb_channels == 0 && reader->has_luma && reader->has_chroma) {
+    for (size_t a = 0; a < len; a++) {
+      float *color = rgba + a * 4;
+      ycc_to_rgb(color[0] * 255.0f,
+                 color[1] * 255.0f,
+                 color[2] * 255.0f,
+                 &color[0],
+                 &color[1],
+                 &color[2],
+                 BLI_YCC_ITU_BT709);
+    }
+  }
+  else if (reader->num_rgb_channels <= 1) {
+    for (size_t a = 0; a < len; a++) {
+      float *color = rgba + a * 4;
+      color[1] = color[0];
+      color[2] = color[0];
+    }
+  }
+}
+
+bool imb_exr_tile_reader_read(ExrTileReader *reader,
+                              const int level,
+                              const int x,
+                              const int y,
+                              const int width,
+                              const int height,
+                              float *rgba)
+{
+  std::lock_guard<std::mutex> lock(reader->mutex);
+
+  try {
+    MultiPartInputFile &file = *reader->file;
+    Box2i dw;
+    int block_x, block_y, block_width, block_height;
+    std::vector<float> block;
+    FrameBuffer frame_buffer;
+
+    if (reader->is_tiled) {
+      TiledInputPart in(file, 0);
+      dw = in.dataWindowForLevel(level, level);
+      const int level_height = dw.max.y - dw.min.y + 1;
+      /* Files are stored top to bottom, image buffers bottom to top. */
+      const int top = level_height - y - height;
+      const int dx1 = x / in.tileXSize();
+      const int dx2 = (x + width - 1) / in.tileXSize();
+      const int dy1 = top / in.tileYSize();
+      const int dy2 = (top + height - 1) / in.tileYSize();
+
+      block_x = dx1 * in.tileXSize();
+      block_y = dy1 * in.tileYSize();
+      block_width = (dx2 - dx1 + 1) * in.tileXSize();
+      block_height = (dy2 - dy1 + 1) * in.tileYSize();
+      block.resize(size_t(block_width) * block_height * 4);
+
+      float *first = block.data() - 4 * (ptrdiff_t(dw.min.x + block_x) +
+                                         ptrdiff_t(dw.min.y + block_y) * block_width);
+      exr_tile_reader_insert_slices(reader, frame_buffer, first, sizeof(float[4]) * block_width);
+      in.setFrameBuffer(frame_buffer);
+      in.readTiles(dx1, dx2, dy1, dy2, level, level);
+    }
+    else {
+      BLI_assert(level == 0);
+      InputPart in(file, 0);
+      dw = file.header(0).dataWindow();
+      const int level_height = dw.max.y - dw.min.y + 1;
+
+      /* Scan-lines always have to be read in full. */
+      block_x = 0;
+      block_y = level_height - y - height;
+      block_width = dw.max.x - dw.min.x + 1;
+      block_height = height;
+      block.resize(size_t(block_width) * block_height * 4);
+
+      float *first = block.data() - 4 * (ptrdiff_t(dw.min.x) +
+                                         ptrdiff_t(dw.min.y + block_y) * block_width);
+      exr_tile_reader_insert_slices(reader, frame_buffer, first, sizeof(float[4]) * block_width);
+      in.setFrameBuffer(frame_buffer);
+      in.readPixels(dw.min.y + block_y, dw.min.y + block_y + block_height - 1);
+    }
+
+    /* Copy the requested region, flipping it vertically. */
+    const int top = (dw.max.y - dw.min.y + 1) - y - height;
+    for (int row = 0; row < height; row++) {
+      const int block_row = top + (height - 1 - row) - block_y;
+      const float *from = block.data() + (size_t(block_row) * block_width + (x - block_x)) * 4;
+      memcpy(rgba + size_t(row) * width * 4, from, sizeof(float[4]) * width);
+    }
+
+    exr_tile_reader_convert(reader, rgba, size_t(width) * height);
+    return true;
+  }
+  catch (const std::exception &exc) {
+    std::cerr << exc.what() << std::endl;
+    return false;
+  }
+}
+
+/** \} */
+
 void imb_initopenexr(void)
 {
   /* In a multithreaded program, staticInitialize() must be called once during startup, before the
    * program accesses any other functions or classes in the IlmImf library. */
   Imf::staticInitialize();
-  Imf::setGlobalThreadCount(BLI_system_thread_count());
+  IMB_exr_thread_count_set(0);
+}
+
+void IMB_exr_thread_count_set(int num_threads)
+{
+  if (num_threads <= 0) {
+    num_threads = BLI_system_thread_count();
+  }
+  /* Replacing the pool waits for the tasks of the previous one to finish, so only do that when
+   * the number of threads actually changes. */
+  if (Imf::globalThreadCount() != num_threads) {
+    Imf::setGlobalThreadCount(num_threads);
+  }
 }
 
 void imb_exitopenexr(void)
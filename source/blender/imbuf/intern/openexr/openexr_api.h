@@ -33,6 +33,31 @@ struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath,
                                                   size_t *r_width,
                                                   size_t *r_height);
 
+/**
+ * Reader for regions of tiled or scan-line files, used by the image tile cache.
+ * Returns null for files which can not be read partially (multi-layer files).
+ */
+struct ExrTileReader *imb_exr_tile_reader_open(const char *filepath,
+                                               int *r_tile_width,
+                                               int *r_tile_height,
+                                               int *r_num_levels);
+void imb_exr_tile_reader_close(struct ExrTileReader *reader);
+void imb_exr_tile_reader_level_size(struct ExrTileReader *reader,
+                                    int level,
+                                    int *r_width,
+                                    int *r_height);
+/**
+ * Read a region of a mipmap level into a 4 channel float buffer. Coordinates and the result are
+ * bottom to top, like #ImBuf pixels.
+ */
+bool imb_exr_tile_reader_read(struct ExrTileReader *reader,
+                              int level,
+                              int x,
+                              int y,
+                              int width,
+                              int height,
+                              float *rgba);
+
 #ifdef __cplusplus
 }
 #endif
@@ -74,9 +74,20 @@ float *IMB_exr_channel_rect(void * /*handle*/,
 void IMB_exr_read_channels(void * /*handle*/)
 {
 }
+void IMB_exr_read_channels_filtered(void * /*handle*/,
+                                    bool (*/*pass_filter*/)(void *userdata,
+                                                            const char *layname,
+                                                            const char *passname,
+                                                            const char *view),
+                                    void * /*userdata*/)
+{
+}
 void IMB_exr_write_channels(void * /*handle*/)
 {
 }
+void IMB_exr_write_channels_rows(void * /*handle*/, int /*num_rows*/)
+{
+}
 void IMB_exrtile_write_channels(void * /*handle*/,
                                 int /*partx*/,
                                 int /*party*/,
@@ -114,3 +125,7 @@ bool IMB_exr_has_multilayer(void * /*handle*/)
 {
   return false;
 }
+
+void IMB_exr_thread_count_set(int /*num_threads*/)
+{
+}
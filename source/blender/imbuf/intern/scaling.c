@@ -7,8 +7,12 @@
 
 #include <math.h>
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_math_vector.h"
+#include "BLI_simd.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -1888,3 +1892,464 @@ void IMB_scaleImBuf_threaded(ImBuf *ibuf, uint newx, uint newy)
     ibuf->rect_float = init_data.float_buffer;
   }
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Separable Resampling
+ *
+ * Polyphase resampler: for every output column and row the contributing source samples and their
+ * weights are computed once, after which the image is filtered horizontally into an intermediate
+ * float buffer and then vertically into the output buffer. Rows of both passes are processed in
+ * parallel.
+ *
+ * Byte buffers are filtered in premultiplied space (like #IMB_onehalf), so that fully transparent
+ * pixels do not bleed their color into the result.
+ * \{ */
+
+typedef struct ScaleFilterTable {
+  /** Number of weights stored per output sample. */
+  int taps;
+  /** First source sample contributing to each output sample. */
+  int *first;
+  /** `taps` weights per output sample, zero padded and normalized to sum up to one. */
+  float *weights;
+} ScaleFilterTable;
+
+static float scale_filter_radius(const eIMBScaleFilter filter)
+{
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return 0.5f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return 1.0f;
+    case IMB_SCALE_FILTER_MITCHELL:
+      return 2.0f;
+    case IMB_SCALE_FILTER_LANCZOS:
+      return 3.0f;
+  }
+  return 1.0f;
+}
+
+static float scale_filter_eval(const eIMBScaleFilter filter, float x)
+{
+  x = fabsf(x);
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return (x <= 0.5f) ? 1.0f : 0.0f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return (x < 1.0f) ? 1.0f - x : 0.0f;
+    case IMB_SCALE_FILTER_MITCHELL: {
+      /* Mitchell-Netravali cubic with B = C = 1/3. */
+      const float b = 1.0f / 3.0f;
+      const float c = 1.0f / 3.0f;
+      if (x < 1.0f) {
+        return ((12.0f - 9.0f * b - 6.0f * c) * x * x * x +
+                (-18.0f + 12.0f * b + 6.0f * c) * x * x + (6.0f - 2.0f * b)) /
+               6.0f;
+      }
+      if (x < 2.0f) {
+        return ((-b - 6.0f * c) * x * x * x + (6.0f * b + 30.0f * c) * x * x +
+                (-12.0f * b - 48.0f * c) * x + (8.0f * b + 24.0f * c)) /
+               6.0f;
+      }
+      return 0.0f;
+    }
+    case IMB_SCALE_FILTER_LANCZOS: {
+      /* Lanczos with three lobes. */
+      if (x < 1e-6f) {
+        return 1.0f;
+      }
+      if (x >= 3.0f) {
+        return 0.0f;
+      }
+      const float px = (float)M_PI * x;
+      return 3.0f * sinf(px) * sinf(px / 3.0f) / (px * px);
+    }
+  }
+  return 0.0f;
+}
+
+static void scale_filter_table_init(ScaleFilterTable *table,
+                                    const int src_size,
+                                    const int dst_size,
+                                    const eIMBScaleFilter filter)
+{
+  table->first = MEM_mallocN(sizeof(int) * dst_size, __func__);
+
+  if (src_size == dst_size) {
+    /* Keep the image sharp along axes which are not scaled. */
+    table->taps = 1;
+    table->weights = MEM_mallocN(sizeof(float) * dst_size, __func__);
+    for (int i = 0; i < dst_size; i++) {
+      table->first[i] = i;
+      table->weights[i] = 1.0f;
+    }
+    return;
+  }
+
+  const float scale = (float)src_size / (float)dst_size;
+  /* When minifying the filter is stretched over the source samples covered by one output sample,
+   * so it acts as a low-pass filter instead of skipping samples. */
+  const float filter_scale = max_ff(scale, 1.0f);
+  const float support = scale_filter_radius(filter) * filter_scale;
+  const int taps = min_ii((int)floorf(2.0f * support) + 1, src_size);
+
+  table->taps = taps;
+  table->weights = MEM_calloc_arrayN((size_t)dst_size * taps, sizeof(float), __func__);
+
+  for (int i = 0; i < dst_size; i++) {
+    const float center = ((float)i + 0.5f) * scale - 0.5f;
+    const int lo = (int)ceilf(center - support);
+    const int hi = (int)floorf(center + support);
+    /* Samples outside of the image are clamped to the edge, all of them end up in the range
+     * starting at `first`. */
+    const int first = clamp_i(lo, 0, src_size - taps);
+    float *weights = table->weights + (size_t)i * taps;
+    float total = 0.0f;
+
+    for (int j = lo; j <= hi; j++) {
+      const float weight = scale_filter_eval(filter, ((float)j - center) / filter_scale);
+      weights[clamp_i(j, 0, src_size - 1) - first] += weight;
+      total += weight;
+    }
+
+    if (total != 0.0f) {
+      const float total_inv = 1.0f / total;
+      for (int j = 0; j < taps; j++) {
+        weights[j] *= total_inv;
+      }
+    }
+    else {
+      weights[clamp_i((int)roundf(center), first, first + taps - 1) - first] = 1.0f;
+    }
+
+    table->first[i] = first;
+  }
+}
+
+static void scale_filter_table_free(ScaleFilterTable *table)
+{
+  MEM_SAFE_FREE(table->first);
+  MEM_SAFE_FREE(table->weights);
+}
+
+typedef struct ScaleResampleData {
+  const ScaleFilterTable *table_x;
+  const ScaleFilterTable *table_y;
+
+  int src_x;
+  int dst_x;
+  int channels;
+
+  const uchar *src_byte;
+  const float *src_float;
+  /** Horizontally filtered rows, `src_y * dst_x * channels` premultiplied floats. */
+  float *tmp;
+  uchar *dst_byte;
+  float *dst_float;
+} ScaleResampleData;
+
+#ifdef BLI_HAVE_SSE2
+BLI_INLINE __m128 scale_straight_uchar_to_premul_m128(const uchar color[4])
+{
+  const __m128i zero = _mm_setzero_si128();
+  int packed;
+  memcpy(&packed, color, sizeof(packed));
+  __m128i color_i = _mm_cvtsi32_si128(packed);
+  color_i = _mm_unpacklo_epi16(_mm_unpacklo_epi8(color_i, zero), zero);
+  const __m128 color_f = _mm_mul_ps(_mm_cvtepi32_ps(color_i), _mm_set1_ps(1.0f / 255.0f));
+  /* (b, 1, a, 1) -> (a, a, a, 1). */
+  const __m128 alpha_one = _mm_unpackhi_ps(color_f, _mm_set1_ps(1.0f));
+  return _mm_mul_ps(color_f, _mm_shuffle_ps(alpha_one, alpha_one, _MM_SHUFFLE(1, 2, 2, 2)));
+}
+#endif
+
+static void scale_resample_x_byte_fn(void *__restrict userdata,
+                                     const int y,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleResampleData *data = userdata;
+  const ScaleFilterTable *table = data->table_x;
+  const int taps = table->taps;
+  const uchar *src = data->src_byte + (size_t)y * data->src_x * 4;
+  float *dst = data->tmp + (size_t)y * data->dst_x * 4;
+
+  for (int x = 0; x < data->dst_x; x++, dst += 4) {
+    const uchar *pixel = src + (size_t)table->first[x] * 4;
+    const float *weights = table->weights + (size_t)x * taps;
+#ifdef BLI_HAVE_SSE2
+    __m128 sum = _mm_setzero_ps();
+    for (int i = 0; i < taps; i++, pixel += 4) {
+      sum = _mm_add_ps(
+          sum, _mm_mul_ps(_mm_set1_ps(weights[i]), scale_straight_uchar_to_premul_m128(pixel)));
+    }
+    _mm_storeu_ps(dst, sum);
+#else
+    float premul[4];
+    zero_v4(dst);
+    for (int i = 0; i < taps; i++, pixel += 4) {
+      straight_uchar_to_premul_float(premul, pixel);
+      madd_v4_v4fl(dst, premul, weights[i]);
+    }
+#endif
+  }
+}
+
+static void scale_resample_x_float_fn(void *__restrict userdata,
+                                      const int y,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleResampleData *data = userdata;
+  const ScaleFilterTable *table = data->table_x;
+  const int taps = table->taps;
+  const int channels = data->channels;
+  const float *src = data->src_float + (size_t)y * data->src_x * channels;
+  float *dst = data->tmp + (size_t)y * data->dst_x * channels;
+
+  for (int x = 0; x < data->dst_x; x++, dst += channels) {
+    const float *pixel = src + (size_t)table->first[x] * channels;
+    const float *weights = table->weights + (size_t)x * taps;
+#ifdef BLI_HAVE_SSE2
+    if (channels == 4) {
+      __m128 sum = _mm_setzero_ps();
+      for (int i = 0; i < taps; i++, pixel += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[i]), _mm_loadu_ps(pixel)));
+      }
+      _mm_storeu_ps(dst, sum);
+      continue;
+    }
+#endif
+    for (int c = 0; c < channels; c++) {
+      dst[c] = 0.0f;
+    }
+    for (int i = 0; i < taps; i++, pixel += channels) {
+      for (int c = 0; c < channels; c++) {
+        dst[c] += weights[i] * pixel[c];
+      }
+    }
+  }
+}
+
+static void scale_resample_y_byte_fn(void *__restrict userdata,
+                                     const int y,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleResampleData *data = userdata;
+  const ScaleFilterTable *table = data->table_y;
+  const int taps = table->taps;
+  const size_t row_stride = (size_t)data->dst_x * 4;
+  const float *src = data->tmp + (size_t)table->first[y] * row_stride;
+  const float *weights = table->weights + (size_t)y * taps;
+  uchar *dst = data->dst_byte + (size_t)y * row_stride;
+
+  for (int x = 0; x < data->dst_x; x++, src += 4, dst += 4) {
+    float color[4];
+#ifdef BLI_HAVE_SSE2
+    const float *pixel = src;
+    __m128 sum = _mm_setzero_ps();
+    for (int i = 0; i < taps; i++, pixel += row_stride) {
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[i]), _mm_loadu_ps(pixel)));
+    }
+    /* Negative lobes of the filters can push values out of range, keep the color valid for
+     * un-premultiplying. */
+    __m128 alpha = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm_min_ps(_mm_max_ps(alpha, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    sum = _mm_min_ps(_mm_max_ps(sum, _mm_setzero_ps()), alpha);
+    _mm_storeu_ps(color, sum);
+#else
+    const float *pixel = src;
+    zero_v4(color);
+    for (int i = 0; i < taps; i++, pixel += row_stride) {
+      madd_v4_v4fl(color, pixel, weights[i]);
+    }
+    CLAMP(color[3], 0.0f, 1.0f);
+    CLAMP(color[0], 0.0f, color[3]);
+    CLAMP(color[1], 0.0f, color[3]);
+    CLAMP(color[2], 0.0f, color[3]);
+#endif
+    premul_float_to_straight_uchar(dst, color);
+  }
+}
+
+static void scale_resample_y_float_fn(void *__restrict userdata,
+                                      const int y,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleResampleData *data = userdata;
+  const ScaleFilterTable *table = data->table_y;
+  const int taps = table->taps;
+  const size_t row_stride = (size_t)data->dst_x * data->channels;
+  const float *src = data->tmp + (size_t)table->first[y] * row_stride;
+  const float *weights = table->weights + (size_t)y * taps;
+  float *dst = data->dst_float + (size_t)y * row_stride;
+  size_t i = 0;
+
+#ifdef BLI_HAVE_SSE2
+  /* Rows are independent of the channel layout here, so four values are filtered at once. */
+  for (; i + 4 <= row_stride; i += 4) {
+    const float *value = src + i;
+    __m128 sum = _mm_setzero_ps();
+    for (int tap = 0; tap < taps; tap++, value += row_stride) {
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[tap]), _mm_loadu_ps(value)));
+    }
+    _mm_storeu_ps(dst + i, sum);
+  }
+#endif
+  for (; i < row_stride; i++) {
+    const float *value = src + i;
+    float sum = 0.0f;
+    for (int tap = 0; tap < taps; tap++, value += row_stride) {
+      sum += weights[tap] * *value;
+    }
+    dst[i] = sum;
+  }
+}
+
+static void scale_resample_buffer(ScaleResampleData *data,
+                                  const int src_y,
+                                  const int dst_y,
+                                  const bool threaded,
+                                  TaskParallelRangeFunc x_fn,
+                                  TaskParallelRangeFunc y_fn)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = threaded;
+  settings.min_iter_per_thread = 8;
+
+  data->tmp = MEM_mallocN(sizeof(float) * src_y * data->dst_x * data->channels, __func__);
+  BLI_task_parallel_range(0, src_y, data, x_fn, &settings);
+  BLI_task_parallel_range(0, dst_y, data, y_fn, &settings);
+  MEM_freeN(data->tmp);
+  data->tmp = NULL;
+}
+
+/**
+ * Resample the byte and float buffers of \a ibuf into newly allocated buffers,
+ * \a ibuf itself is not modified.
+ */
+static void scale_resample(const ImBuf *ibuf,
+                           const int newx,
+                           const int newy,
+                           const eIMBScaleFilter filter,
+                           const bool threaded,
+                           uint **r_rect,
+                           float **r_rect_float)
+{
+  ScaleFilterTable table_x, table_y;
+  scale_filter_table_init(&table_x, ibuf->x, newx, filter);
+  scale_filter_table_init(&table_y, ibuf->y, newy, filter);
+
+  ScaleResampleData data = {NULL};
+  data.table_x = &table_x;
+  data.table_y = &table_y;
+  data.src_x = ibuf->x;
+  data.dst_x = newx;
+
+  *r_rect = NULL;
+  *r_rect_float = NULL;
+
+  if (ibuf->rect) {
+    data.channels = 4;
+    data.src_byte = (const uchar *)ibuf->rect;
+    data.dst_byte = MEM_mallocN(sizeof(uint) * newx * newy, "scale byte buffer");
+    scale_resample_buffer(
+        &data, ibuf->y, newy, threaded, scale_resample_x_byte_fn, scale_resample_y_byte_fn);
+    *r_rect = (uint *)data.dst_byte;
+  }
+
+  if (ibuf->rect_float) {
+    data.channels = ibuf->channels;
+    data.src_float = ibuf->rect_float;
+    data.dst_float = MEM_mallocN(sizeof(float) * ibuf->channels * newx * newy,
+                                 "scale float buffer");
+    scale_resample_buffer(
+        &data, ibuf->y, newy, threaded, scale_resample_x_float_fn, scale_resample_y_float_fn);
+    *r_rect_float = data.dst_float;
+  }
+
+  scale_filter_table_free(&table_x);
+  scale_filter_table_free(&table_y);
+}
+
+bool IMB_scale(
+    struct ImBuf *ibuf, uint newx, uint newy, const eIMBScaleFilter filter, const bool threaded)
+{
+  BLI_assert_msg(newx > 0 && newy > 0, "Images must be at least 1 on both dimensions!");
+
+  if (ibuf == NULL) {
+    return false;
+  }
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return false;
+  }
+  if (newx == ibuf->x && newy == ibuf->y) {
+    return false;
+  }
+
+  uint *rect;
+  float *rect_float;
+  scale_resample(ibuf, newx, newy, filter, threaded, &rect, &rect_float);
+
+  /* The Z-buffer is not color data, filtering it would create depths that do not exist. */
+  scalefast_Z_ImBuf(ibuf, newx, newy);
+
+  if (rect) {
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = rect;
+  }
+  if (rect_float) {
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = rect_float;
+  }
+
+  ibuf->x = newx;
+  ibuf->y = newy;
+  return true;
+}
+
+struct ImBuf *IMB_scale_into_new(const struct ImBuf *ibuf,
+                                 uint newx,
+                                 uint newy,
+                                 const eIMBScaleFilter filter,
+                                 const bool threaded)
+{
+  BLI_assert_msg(newx > 0 && newy > 0, "Images must be at least 1 on both dimensions!");
+
+  if (ibuf == NULL) {
+    return NULL;
+  }
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return NULL;
+  }
+
+  ImBuf *ibuf_new = IMB_allocImBuf(newx, newy, ibuf->planes, 0);
+  if (ibuf_new == NULL) {
+    return NULL;
+  }
+  ibuf_new->flags |= ibuf->flags & (IB_alphamode_premul | IB_alphamode_channel_packed |
+                                    IB_alphamode_ignore);
+  ibuf_new->rect_colorspace = ibuf->rect_colorspace;
+  ibuf_new->float_colorspace = ibuf->float_colorspace;
+
+  uint *rect;
+  float *rect_float;
+  scale_resample(ibuf, newx, newy, filter, threaded, &rect, &rect_float);
+
+  if (rect) {
+    ibuf_new->rect = rect;
+    ibuf_new->mall |= IB_rect;
+    ibuf_new->flags |= IB_rect;
+  }
+  if (rect_float) {
+    ibuf_new->rect_float = rect_float;
+    ibuf_new->channels = ibuf->channels;
+    ibuf_new->mall |= IB_rectfloat;
+    ibuf_new->flags |= IB_rectfloat;
+  }
+
+  return ibuf_new;
+}
+
+/** \} */
@@ -11,8 +11,11 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_fileops.h"
+#include "BLI_fileops_types.h"
 #include "BLI_ghash.h"
 #include "BLI_hash_md5.h"
+#include "BLI_heap.h"
+#include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_system.h"
@@ -301,6 +304,119 @@ void IMB_thumb_makedirs(void)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Thumbnail Index
+ *
+ * Names of the thumbnails that exist on disk, read with a single listing of each thumbnail
+ * directory, so checking for existing and failed thumbnails of many files doesn't need to access
+ * the file system for every one of them. The directories themselves are the persistent index.
+ *
+ * Thumbnail directories can contain many files, so they are only listed on first use, which
+ * happens on a worker thread of the thumbnail service.
+ * \{ */
+
+typedef struct ThumbIndex {
+  /** Names of the thumbnail files, per #ThumbSize. */
+  GSet *names[THB_FAIL + 1];
+  /** The thumbnail directories were listed. */
+  bool is_loaded;
+  ThreadRWMutex lock;
+} ThumbIndex;
+
+static ThumbIndex *thumb_index_create(void)
+{
+  ThumbIndex *index = MEM_callocN(sizeof(*index), __func__);
+  BLI_rw_mutex_init(&index->lock);
+  for (int size = 0; size < ARRAY_SIZE(index->names); size++) {
+    index->names[size] = BLI_gset_str_new(__func__);
+  }
+  return index;
+}
+
+/* Fill the index from the thumbnail directories, the write lock must be held. */
+static void thumb_index_load(ThumbIndex *index)
+{
+  for (int size = 0; size < ARRAY_SIZE(index->names); size++) {
+    char dir[FILE_MAX];
+    if (!get_thumb_dir(dir, (ThumbSize)size) || !BLI_is_dir(dir)) {
+      continue;
+    }
+
+    struct direntry *files;
+    const uint files_num = BLI_filelist_dir_contents(dir, &files);
+    for (uint i = 0; i < files_num; i++) {
+      if (S_ISREG(files[i].type)) {
+        BLI_gset_add(index->names[size], BLI_strdup(files[i].relname));
+      }
+    }
+    BLI_filelist_free(files, files_num);
+  }
+  index->is_loaded = true;
+}
+
+static void thumb_index_ensure_loaded(ThumbIndex *index)
+{
+  BLI_rw_mutex_lock(&index->lock, THREAD_LOCK_READ);
+  const bool is_loaded = index->is_loaded;
+  BLI_rw_mutex_unlock(&index->lock);
+  if (is_loaded) {
+    return;
+  }
+
+  BLI_rw_mutex_lock(&index->lock, THREAD_LOCK_WRITE);
+  if (!index->is_loaded) {
+    thumb_index_load(index);
+  }
+  BLI_rw_mutex_unlock(&index->lock);
+}
+
+static void thumb_index_free(ThumbIndex *index)
+{
+  for (int size = 0; size < ARRAY_SIZE(index->names); size++) {
+    BLI_gset_free(index->names[size], MEM_freeN);
+  }
+  BLI_rw_mutex_end(&index->lock);
+  MEM_freeN(index);
+}
+
+static bool thumb_index_has(ThumbIndex *index, ThumbSize size, const char *thumb_name)
+{
+  thumb_index_ensure_loaded(index);
+  BLI_rw_mutex_lock(&index->lock, THREAD_LOCK_READ);
+  const bool found = BLI_gset_haskey(index->names[size], thumb_name);
+  BLI_rw_mutex_unlock(&index->lock);
+  return found;
+}
+
+static void thumb_index_set(ThumbIndex *index,
+                            ThumbSize size,
+                            const char *thumb_name,
+                            const bool exists)
+{
+  thumb_index_ensure_loaded(index);
+  BLI_rw_mutex_lock(&index->lock, THREAD_LOCK_WRITE);
+  if (exists) {
+    if (!BLI_gset_haskey(index->names[size], thumb_name)) {
+      BLI_gset_insert(index->names[size], BLI_strdup(thumb_name));
+    }
+  }
+  else {
+    BLI_gset_remove(index->names[size], thumb_name, MEM_freeN);
+  }
+  BLI_rw_mutex_unlock(&index->lock);
+}
+
+/* Check if a thumbnail exists, using the index when there is one. */
+static bool thumb_exists(ThumbIndex *index, ThumbSize size, const char *thumb_path)
+{
+  if (index == NULL) {
+    return BLI_exists(thumb_path);
+  }
+  return thumb_index_has(index, size, BLI_path_basename(thumb_path));
+}
+
+/** \} */
+
 /* create thumbnail for file and returns new imbuf for thumbnail */
 static ImBuf *thumb_create_ex(const char *file_path,
                               const char *uri,
@@ -407,7 +523,7 @@ static ImBuf *thumb_create_ex(const char *file_path,
           }
           imb_freerectfloatImBuf(img);
         }
-        IMB_scaleImBuf(img, ex, ey);
+        IMB_scale(img, ex, ey, IMB_SCALE_FILTER_BOX, true);
       }
     }
     BLI_snprintf(desc, sizeof(desc), "Thumbnail for %s", uri);
@@ -513,7 +629,10 @@ void IMB_thumb_delete(const char *filepath, ThumbSize size)
   }
 }
 
-ImBuf *IMB_thumb_manage(const char *filepath, ThumbSize size, ThumbSource source)
+static ImBuf *thumb_manage_ex(const char *filepath,
+                              ThumbSize size,
+                              ThumbSource source,
+                              ThumbIndex *index)
 {
   char thumb_path[FILE_MAX];
   char thumb_name[40];
@@ -546,10 +665,13 @@ ImBuf *IMB_thumb_manage(const char *filepath, ThumbSize size, ThumbSource source
   }
   if (thumbpath_from_uri(uri, thumb_path, sizeof(thumb_path), THB_FAIL)) {
     /* failure thumb exists, don't try recreating */
-    if (BLI_exists(thumb_path)) {
+    if (thumb_exists(index, THB_FAIL, thumb_path)) {
       /* clear out of date fail case (note for blen IDs we use blender file itself here) */
       if (BLI_file_older(thumb_path, file_path)) {
         BLI_delete(thumb_path, false, false);
+        if (index) {
+          thumb_index_set(index, THB_FAIL, BLI_path_basename(thumb_path), false);
+        }
       }
       else {
         return NULL;
@@ -563,7 +685,10 @@ ImBuf *IMB_thumb_manage(const char *filepath, ThumbSize size, ThumbSource source
       img = IMB_loadiffname(path, IB_rect, NULL);
     }
     else {
-      img = IMB_loadiffname(thumb_path, IB_rect | IB_metadata, NULL);
+      /* Avoid trying to open thumbnails the index knows don't exist. */
+      if (thumb_exists(index, size, thumb_path)) {
+        img = IMB_loadiffname(thumb_path, IB_rect | IB_metadata, NULL);
+      }
       if (img) {
         bool regenerate = false;
 
@@ -598,8 +723,16 @@ ImBuf *IMB_thumb_manage(const char *filepath, ThumbSize size, ThumbSource source
           IMB_thumb_delete(path, THB_NORMAL);
           IMB_thumb_delete(path, THB_LARGE);
           IMB_thumb_delete(path, THB_FAIL);
+          if (index) {
+            thumb_index_set(index, THB_NORMAL, thumb_name, false);
+            thumb_index_set(index, THB_LARGE, thumb_name, false);
+            thumb_index_set(index, THB_FAIL, thumb_name, false);
+          }
           img = thumb_create_or_fail(
               file_path, uri, thumb_name, use_hash, thumb_hash, blen_group, blen_id, size, source);
+          if (index) {
+            thumb_index_set(index, img ? size : THB_FAIL, thumb_name, true);
+          }
         }
       }
       else {
@@ -608,6 +741,9 @@ ImBuf *IMB_thumb_manage(const char *filepath, ThumbSize size, ThumbSource source
 
         img = thumb_create_or_fail(
             file_path, uri, thumb_name, use_hash, thumb_hash, blen_group, blen_id, size, source);
+        if (index) {
+          thumb_index_set(index, img ? size : THB_FAIL, thumb_name, true);
+        }
       }
     }
   }
@@ -624,6 +760,11 @@ ImBuf *IMB_thumb_manage(const char *filepath, ThumbSize size, ThumbSource source
   return img;
 }
 
+ImBuf *IMB_thumb_manage(const char *filepath, ThumbSize size, ThumbSource source)
+{
+  return thumb_manage_ex(filepath, size, source, NULL);
+}
+
 /* ***** Threading ***** */
 /* Thumbnail handling is not really threadsafe in itself.
  * However, as long as we do not operate on the same file, we shall have no collision.
@@ -699,3 +840,215 @@ void IMB_thumb_path_unlock(const char *path)
 
   BLI_thread_unlock(LOCK_IMAGE);
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Thumbnail Service
+ *
+ * Generates thumbnails of many files in background threads. Requests are handled in order of
+ * priority, so the items in view can go first, and workers pause while the thumbnails that were
+ * not collected yet use more memory than the limit.
+ * \{ */
+
+/**
+ * Workers used when no thread count is given. Every worker may be decoding a full resolution
+ * image, so the number of decodes in flight is limited regardless of the number of cores.
+ */
+#define THUMB_SERVICE_THREADS_DEFAULT_MAX 8
+
+typedef struct ThumbServiceRequest {
+  struct ThumbServiceRequest *next, *prev;
+
+  char filepath[FILE_MAX_LIBEXTRA];
+  ThumbSize size;
+  ThumbSource source;
+  bool read_only;
+  void *user_data;
+
+  /** Result, set once the request is done. */
+  ImBuf *ibuf;
+  size_t mem_size;
+  /** The request was canceled while a worker was handling it, its result is discarded. */
+  bool canceled;
+} ThumbServiceRequest;
+
+struct ThumbService {
+  ListBase threads;
+  ThreadMutex mutex;
+  /** Signaled when requests are added, finished thumbnails are collected or on stopping. */
+  ThreadCondition work_cond;
+  bool stop;
+
+  /** Requests waiting for a worker, lowest priority value first. */
+  Heap *todo;
+  /** Requests handled by a worker. */
+  ListBase running;
+  /** Finished requests, waiting for #IMB_thumb_service_pop. */
+  ListBase done;
+  size_t done_mem_size;
+  size_t mem_limit;
+
+  ThumbIndex *index;
+  void (*free_user_data)(void *user_data);
+};
+
+static void thumb_service_request_free(ThumbService *service, ThumbServiceRequest *request)
+{
+  if (request->ibuf) {
+    IMB_freeImBuf(request->ibuf);
+  }
+  if (service->free_user_data && request->user_data) {
+    service->free_user_data(request->user_data);
+  }
+  MEM_freeN(request);
+}
+
+static void *thumb_service_thread(void *data)
+{
+  ThumbService *service = data;
+
+  BLI_mutex_lock(&service->mutex);
+  while (true) {
+    while (!service->stop && (BLI_heap_is_empty(service->todo) ||
+                              service->done_mem_size >= service->mem_limit)) {
+      BLI_condition_wait(&service->work_cond, &service->mutex);
+    }
+    if (service->stop) {
+      break;
+    }
+
+    ThumbServiceRequest *request = BLI_heap_pop_min(service->todo);
+    BLI_addtail(&service->running, request);
+    BLI_mutex_unlock(&service->mutex);
+
+    IMB_thumb_path_lock(request->filepath);
+    ImBuf *ibuf = request->read_only ?
+                      IMB_thumb_read(request->filepath, request->size) :
+                      thumb_manage_ex(
+                          request->filepath, request->size, request->source, service->index);
+    IMB_thumb_path_unlock(request->filepath);
+
+    BLI_mutex_lock(&service->mutex);
+    BLI_remlink(&service->running, request);
+    request->ibuf = ibuf;
+    if (request->canceled) {
+      thumb_service_request_free(service, request);
+      continue;
+    }
+    request->mem_size = ibuf ? IMB_get_size_in_memory(ibuf) : 0;
+    service->done_mem_size += request->mem_size;
+    BLI_addtail(&service->done, request);
+  }
+  BLI_mutex_unlock(&service->mutex);
+
+  return NULL;
+}
+
+ThumbService *IMB_thumb_service_create(int num_threads,
+                                       size_t mem_limit,
+                                       void (*free_user_data)(void *user_data))
+{
+  ThumbService *service = MEM_callocN(sizeof(*service), __func__);
+
+  BLI_mutex_init(&service->mutex);
+  BLI_condition_init(&service->work_cond);
+  service->todo = BLI_heap_new();
+  service->mem_limit = mem_limit;
+  service->free_user_data = free_user_data;
+  service->index = thumb_index_create();
+
+  IMB_thumb_locks_acquire();
+
+  if (num_threads <= 0) {
+    num_threads = MIN2(BLI_system_thread_count(), THUMB_SERVICE_THREADS_DEFAULT_MAX);
+  }
+  BLI_threadpool_init(&service->threads, thumb_service_thread, num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    BLI_threadpool_insert(&service->threads, service);
+  }
+
+  return service;
+}
+
+void IMB_thumb_service_free(ThumbService *service)
+{
+  BLI_mutex_lock(&service->mutex);
+  service->stop = true;
+  BLI_condition_notify_all(&service->work_cond);
+  BLI_mutex_unlock(&service->mutex);
+
+  /* Wait for the requests being handled to finish, they end up in the done list. */
+  BLI_threadpool_end(&service->threads);
+  IMB_thumb_service_cancel(service);
+
+  IMB_thumb_locks_release();
+
+  thumb_index_free(service->index);
+  BLI_heap_free(service->todo, NULL);
+  BLI_condition_end(&service->work_cond);
+  BLI_mutex_end(&service->mutex);
+  MEM_freeN(service);
+}
+
+void IMB_thumb_service_request(ThumbService *service,
+                               const char *filepath,
+                               ThumbSize size,
+                               ThumbSource source,
+                               const bool read_only,
+                               const float priority,
+                               void *user_data)
+{
+  ThumbServiceRequest *request = MEM_callocN(sizeof(*request), __func__);
+  BLI_strncpy(request->filepath, filepath, sizeof(request->filepath));
+  request->size = size;
+  request->source = source;
+  request->read_only = read_only;
+  request->user_data = user_data;
+
+  BLI_mutex_lock(&service->mutex);
+  BLI_heap_insert(service->todo, priority, request);
+  BLI_condition_notify_one(&service->work_cond);
+  BLI_mutex_unlock(&service->mutex);
+}
+
+bool IMB_thumb_service_pop(ThumbService *service, void **r_user_data, ImBuf **r_ibuf)
+{
+  BLI_mutex_lock(&service->mutex);
+  ThumbServiceRequest *request = BLI_pophead(&service->done);
+  if (request) {
+    service->done_mem_size -= request->mem_size;
+    /* Workers may be waiting for memory to be freed. */
+    BLI_condition_notify_all(&service->work_cond);
+  }
+  BLI_mutex_unlock(&service->mutex);
+
+  if (request == NULL) {
+    return false;
+  }
+
+  *r_user_data = request->user_data;
+  *r_ibuf = request->ibuf;
+  MEM_freeN(request);
+  return true;
+}
+
+void IMB_thumb_service_cancel(ThumbService *service)
+{
+  BLI_mutex_lock(&service->mutex);
+
+  while (!BLI_heap_is_empty(service->todo)) {
+    thumb_service_request_free(service, BLI_heap_pop_min(service->todo));
+  }
+  LISTBASE_FOREACH (ThumbServiceRequest *, request, &service->running) {
+    request->canceled = true;
+  }
+  ThumbServiceRequest *request;
+  while ((request = BLI_pophead(&service->done))) {
+    thumb_service_request_free(service, request);
+  }
+  service->done_mem_size = 0;
+  BLI_condition_notify_all(&service->work_cond);
+
+  BLI_mutex_unlock(&service->mutex);
+}
+
+/** \} */
@@ -0,0 +1,779 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+/** \file
+ * \ingroup imbuf
+ *
+ * Process wide cache of image tiles which are loaded on demand.
+ *
+ * Images are split in tiles for every mipmap level. Tiles are read directly from the file when
+ * the format supports partial reading (OpenEXR, tiled TIFF textures), mipmap levels which are not
+ * stored in the file are generated from the tiles of the level above. Other formats are decoded
+ * as a whole, after which all tiles of the image are put in the cache. When one of those tiles is
+ * needed again after it was freed, the whole image is decoded again.
+ *
+ * All tiles share one memory budget, tiles which are not in use are freed least recently used
+ * first when it is exceeded.
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_filetype.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "IMB_colormanagement_intern.h"
+#include "imbuf.h"
+
+#ifdef WITH_OPENEXR
+#  include "openexr/openexr_api.h"
+#endif
+
+/* -------------------------------------------------------------------- */
+/** \name Local Structs
+ * \{ */
+
+#define TILE_CACHE_DEFAULT_LIMIT ((size_t)1024 * 1024 * 1024)
+/** Tile size used for images which are not tiled in the file. */
+#define TILE_CACHE_TILE_SIZE 256
+#define TILE_CACHE_MAX_LEVELS 32
+
+typedef enum eTileCacheSource {
+  /** Decode the whole image and split it into tiles. */
+  TILE_CACHE_SOURCE_FULL = 0,
+  TILE_CACHE_SOURCE_OPENEXR = 1,
+  /** Tiled TIFF texture, using the tile loading of #ImFileType. */
+  TILE_CACHE_SOURCE_TIFF = 2,
+} eTileCacheSource;
+
+struct ImTileCacheImage {
+  char filepath[IMB_FILENAME_SIZE];
+  char colorspace[IM_MAX_SPACE];
+
+  int tile_size[2];
+  int totlevel;
+  /** Number of levels read from the file, the following levels are generated. */
+  int file_levels;
+  int level_size[TILE_CACHE_MAX_LEVELS][2];
+
+  eTileCacheSource source;
+#ifdef WITH_OPENEXR
+  struct ExrTileReader *exr;
+#endif
+  /** Image buffer without pixels describing the tiles and levels of a TIFF texture. */
+  ImBuf *tiff;
+};
+
+typedef struct ImCachedTile {
+  struct ImCachedTile *next, *prev;
+
+  ImTileCacheImage *image;
+  int level, tx, ty;
+
+  /** Null when loading failed. */
+  ImBuf *ibuf;
+  size_t mem_size;
+
+  int users;
+  bool loading;
+} ImCachedTile;
+
+typedef struct ImTileCache {
+  GHash *tiles;
+  /** Most recently used tiles first. */
+  ListBase lru;
+
+  size_t mem_in_use;
+  size_t mem_limit;
+
+  ThreadMutex mutex;
+  /** Signaled when a tile finished loading. */
+  ThreadCondition loaded_cond;
+
+  bool initialized;
+} ImTileCache;
+
+static ImTileCache TILE_CACHE;
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Hash Functions
+ * \{ */
+
+static uint tile_cache_hash(const void *tile_p)
+{
+  const ImCachedTile *tile = tile_p;
+
+  return ((uint)(intptr_t)tile->image) * 769 + tile->level * 193 + tile->tx * 53 +
+         tile->ty * 97;
+}
+
+static bool tile_cache_cmp(const void *a_p, const void *b_p)
+{
+  const ImCachedTile *a = a_p;
+  const ImCachedTile *b = b_p;
+
+  return ((a->image != b->image) || (a->level != b->level) || (a->tx != b->tx) ||
+          (a->ty != b->ty));
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Initialize/Exit
+ * \{ */
+
+void imb_image_tile_cache_init(void)
+{
+  memset(&TILE_CACHE, 0, sizeof(TILE_CACHE));
+
+  TILE_CACHE.tiles = BLI_ghash_new(tile_cache_hash, tile_cache_cmp, "image tile cache gh");
+  TILE_CACHE.mem_limit = TILE_CACHE_DEFAULT_LIMIT;
+  BLI_mutex_init(&TILE_CACHE.mutex);
+  BLI_condition_init(&TILE_CACHE.loaded_cond);
+  TILE_CACHE.initialized = true;
+}
+
+void imb_image_tile_cache_exit(void)
+{
+  if (!TILE_CACHE.initialized) {
+    return;
+  }
+
+  /* Images are expected to be closed by now, free whatever was left behind. */
+  LISTBASE_FOREACH_MUTABLE (ImCachedTile *, tile, &TILE_CACHE.lru) {
+    if (tile->ibuf) {
+      IMB_freeImBuf(tile->ibuf);
+    }
+    MEM_freeN(tile);
+  }
+
+  BLI_ghash_free(TILE_CACHE.tiles, NULL, NULL);
+  BLI_condition_end(&TILE_CACHE.loaded_cond);
+  BLI_mutex_end(&TILE_CACHE.mutex);
+
+  memset(&TILE_CACHE, 0, sizeof(TILE_CACHE));
+}
+
+void IMB_tile_cache_limit_set(size_t limit)
+{
+  BLI_mutex_lock(&TILE_CACHE.mutex);
+  TILE_CACHE.mem_limit = limit;
+  BLI_mutex_unlock(&TILE_CACHE.mutex);
+}
+
+size_t IMB_tile_cache_memory_in_use(void)
+{
+  BLI_mutex_lock(&TILE_CACHE.mutex);
+  const size_t mem_in_use = TILE_CACHE.mem_in_use;
+  BLI_mutex_unlock(&TILE_CACHE.mutex);
+  return mem_in_use;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Cache Entries
+ *
+ * Functions in this section expect the cache mutex to be locked.
+ * \{ */
+
+static ImCachedTile *tile_cache_lookup(ImTileCacheImage *image, int level, int tx, int ty)
+{
+  ImCachedTile lookup;
+  lookup.image = image;
+  lookup.level = level;
+  lookup.tx = tx;
+  lookup.ty = ty;
+  return BLI_ghash_lookup(TILE_CACHE.tiles, &lookup);
+}
+
+static ImCachedTile *tile_cache_add(ImTileCacheImage *image, int level, int tx, int ty)
+{
+  ImCachedTile *tile = MEM_callocN(sizeof(ImCachedTile), "ImCachedTile");
+  tile->image = image;
+  tile->level = level;
+  tile->tx = tx;
+  tile->ty = ty;
+
+  BLI_ghash_insert(TILE_CACHE.tiles, tile, tile);
+  BLI_addhead(&TILE_CACHE.lru, tile);
+  return tile;
+}
+
+static void tile_cache_set_ibuf(ImCachedTile *tile, ImBuf *ibuf)
+{
+  tile->ibuf = ibuf;
+  tile->mem_size = ibuf ? IMB_get_size_in_memory(ibuf) : 0;
+  TILE_CACHE.mem_in_use += tile->mem_size;
+}
+
+static void tile_cache_remove(ImCachedTile *tile)
+{
+  BLI_assert(tile->users == 0 && !tile->loading);
+
+  BLI_ghash_remove(TILE_CACHE.tiles, tile, NULL, NULL);
+  BLI_remlink(&TILE_CACHE.lru, tile);
+  TILE_CACHE.mem_in_use -= tile->mem_size;
+
+  if (tile->ibuf) {
+    IMB_freeImBuf(tile->ibuf);
+  }
+  MEM_freeN(tile);
+}
+
+static void tile_cache_enforce_limit(void)
+{
+  ImCachedTile *tile = TILE_CACHE.lru.last;
+  while (tile && TILE_CACHE.mem_in_use > TILE_CACHE.mem_limit) {
+    ImCachedTile *prev = tile->prev;
+    if (tile->users == 0 && !tile->loading) {
+      tile_cache_remove(tile);
+    }
+    tile = prev;
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Tile Loading
+ * \{ */
+
+static void tile_cache_tile_rect(
+    const ImTileCacheImage *image, int level, int tx, int ty, int r_rect[4])
+{
+  const int width = image->level_size[level][0];
+  const int height = image->level_size[level][1];
+
+  r_rect[0] = tx * image->tile_size[0];
+  r_rect[1] = ty * image->tile_size[1];
+  r_rect[2] = min_ii(width, r_rect[0] + image->tile_size[0]);
+  r_rect[3] = min_ii(height, r_rect[1] + image->tile_size[1]);
+}
+
+static int tile_cache_xtiles(const ImTileCacheImage *image, int level)
+{
+  return (int)divide_ceil_u(image->level_size[level][0], image->tile_size[0]);
+}
+
+static int tile_cache_ytiles(const ImTileCacheImage *image, int level)
+{
+  return (int)divide_ceil_u(image->level_size[level][1], image->tile_size[1]);
+}
+
+/** Allocate a tile and copy its pixels from a full image of the level. */
+static ImBuf *tile_cache_tile_from_image(const ImTileCacheImage *image,
+                                         const ImBuf *ibuf,
+                                         int level,
+                                         int tx,
+                                         int ty)
+{
+  int rect[4];
+  tile_cache_tile_rect(image, level, tx, ty, rect);
+
+  const int flags = (ibuf->rect ? IB_rect : 0) | (ibuf->rect_float ? IB_rectfloat : 0);
+  ImBuf *tile = IMB_allocImBuf(rect[2] - rect[0], rect[3] - rect[1], ibuf->planes, flags);
+  tile->rect_colorspace = ibuf->rect_colorspace;
+  tile->float_colorspace = ibuf->float_colorspace;
+  tile->flags |= ibuf->flags & (IB_alphamode_premul | IB_alphamode_ignore);
+  IMB_rectcpy(tile, ibuf, 0, 0, rect[0], rect[1], tile->x, tile->y);
+  return tile;
+}
+
+/**
+ * Put all tiles of a fully decoded image in the cache, except the requested one which is
+ * returned. Tiles already in the cache are left untouched.
+ */
+static ImBuf *tile_cache_split_image(ImTileCacheImage *image, ImBuf *ibuf, int tx, int ty)
+{
+  ImBuf *result = NULL;
+
+  for (int y = 0; y < tile_cache_ytiles(image, 0); y++) {
+    for (int x = 0; x < tile_cache_xtiles(image, 0); x++) {
+      if (x == tx && y == ty) {
+        result = tile_cache_tile_from_image(image, ibuf, 0, x, y);
+        continue;
+      }
+
+      BLI_mutex_lock(&TILE_CACHE.mutex);
+      if (tile_cache_lookup(image, 0, x, y) == NULL) {
+        ImCachedTile *tile = tile_cache_add(image, 0, x, y);
+        tile_cache_set_ibuf(tile, tile_cache_tile_from_image(image, ibuf, 0, x, y));
+      }
+      BLI_mutex_unlock(&TILE_CACHE.mutex);
+    }
+  }
+
+  BLI_mutex_lock(&TILE_CACHE.mutex);
+  tile_cache_enforce_limit();
+  BLI_mutex_unlock(&TILE_CACHE.mutex);
+
+  return result;
+}
+
+static ImBuf *tile_cache_load_full(ImTileCacheImage *image, int tx, int ty)
+{
+  char colorspace[IM_MAX_SPACE];
+  STRNCPY(colorspace, image->colorspace);
+
+  ImBuf *ibuf = IMB_loadiffname(image->filepath, IB_rect, colorspace);
+  if (ibuf == NULL) {
+    return NULL;
+  }
+  if (ibuf->x != image->level_size[0][0] || ibuf->y != image->level_size[0][1]) {
+    /* File changed since the image was opened. */
+    IMB_freeImBuf(ibuf);
+    return NULL;
+  }
+  if (ibuf->rect_float && ibuf->channels != 4) {
+    /* Tiles are copied as 4 channel pixels. */
+    if (ibuf->rect == NULL) {
+      IMB_rect_from_float(ibuf);
+    }
+    imb_freerectfloatImBuf(ibuf);
+  }
+
+  ImBuf *tile = tile_cache_split_image(image, ibuf, tx, ty);
+  IMB_freeImBuf(ibuf);
+  return tile;
+}
+
+#ifdef WITH_OPENEXR
+static ImBuf *tile_cache_load_openexr(ImTileCacheImage *image, int level, int tx, int ty)
+{
+  int rect[4];
+  tile_cache_tile_rect(image, level, tx, ty, rect);
+
+  ImBuf *tile = IMB_allocImBuf(rect[2] - rect[0], rect[3] - rect[1], 32, IB_rectfloat);
+  if (!imb_exr_tile_reader_read(
+          image->exr, level, rect[0], rect[1], tile->x, tile->y, tile->rect_float)) {
+    IMB_freeImBuf(tile);
+    return NULL;
+  }
+
+  colormanage_imbuf_make_linear(tile, image->colorspace);
+  return tile;
+}
+#endif
+
+static ImBuf *tile_cache_load_tiff(ImTileCacheImage *image, int level, int tx, int ty)
+{
+  ImBuf *levelbuf = IMB_getmipmap(image->tiff, level);
+  uint *rect = MEM_callocN(sizeof(uint) * levelbuf->tilex * levelbuf->tiley, "tiff tile");
+  imb_loadtile(levelbuf, tx, ty, rect);
+
+  int tile_rect[4];
+  tile_cache_tile_rect(image, level, tx, ty, tile_rect);
+
+  ImBuf *tile = IMB_allocImBuf(
+      tile_rect[2] - tile_rect[0], tile_rect[3] - tile_rect[1], 32, IB_rect);
+  for (int y = 0; y < tile->y; y++) {
+    memcpy(tile->rect + (size_t)y * tile->x,
+           rect + (size_t)y * levelbuf->tilex,
+           sizeof(uint) * tile->x);
+  }
+  MEM_freeN(rect);
+
+  IMB_colormanagement_assign_rect_colorspace(tile, image->colorspace);
+  return tile;
+}
+
+/** Generate a tile of a mipmap level from the (up to four) tiles of the level above. */
+static ImBuf *tile_cache_generate(ImTileCacheImage *image, int level, int tx, int ty)
+{
+  const int parent_level = level - 1;
+  const int parent_width = image->level_size[parent_level][0];
+  const int parent_height = image->level_size[parent_level][1];
+
+  int rect[4];
+  tile_cache_tile_rect(image, level, tx, ty, rect);
+
+  /* Region of the parent level covered by the tile. */
+  const int parent_rect[4] = {
+      rect[0] * 2,
+      rect[1] * 2,
+      min_ii(parent_width, rect[2] * 2),
+      min_ii(parent_height, rect[3] * 2),
+  };
+
+  ImBuf *region = NULL;
+  for (int y = 0; y < 2; y++) {
+    for (int x = 0; x < 2; x++) {
+      const int parent_tx = tx * 2 + x;
+      const int parent_ty = ty * 2 + y;
+      if (parent_tx >= tile_cache_xtiles(image, parent_level) ||
+          parent_ty >= tile_cache_ytiles(image, parent_level)) {
+        continue;
+      }
+
+      const ImBuf *parent = IMB_tile_cache_acquire(image, parent_level, parent_tx, parent_ty);
+      if (parent) {
+        if (region == NULL) {
+          const int flags = (parent->rect ? IB_rect : 0) |
+                            (parent->rect_float ? IB_rectfloat : 0);
+          region = IMB_allocImBuf(parent_rect[2] - parent_rect[0],
+                                  parent_rect[3] - parent_rect[1],
+                                  parent->planes,
+                                  flags);
+          region->rect_colorspace = parent->rect_colorspace;
+          region->float_colorspace = parent->float_colorspace;
+        }
+        IMB_rectcpy(region,
+                    parent,
+                    parent_tx * image->tile_size[0] - parent_rect[0],
+                    parent_ty * image->tile_size[1] - parent_rect[1],
+                    0,
+                    0,
+                    parent->x,
+                    parent->y);
+      }
+      IMB_tile_cache_release(image, parent_level, parent_tx, parent_ty);
+    }
+  }
+
+  if (region == NULL) {
+    return NULL;
+  }
+
+  ImBuf *tile = IMB_scale_into_new(
+      region, rect[2] - rect[0], rect[3] - rect[1], IMB_SCALE_FILTER_BOX, false);
+  IMB_freeImBuf(region);
+  return tile;
+}
+
+static ImBuf *tile_cache_load(ImTileCacheImage *image, int level, int tx, int ty)
+{
+  if (level >= image->file_levels) {
+    return tile_cache_generate(image, level, tx, ty);
+  }
+
+  switch (image->source) {
+    case TILE_CACHE_SOURCE_FULL:
+      return tile_cache_load_full(image, tx, ty);
+    case TILE_CACHE_SOURCE_OPENEXR:
+#ifdef WITH_OPENEXR
+      return tile_cache_load_openexr(image, level, tx, ty);
+#else
+      break;
+#endif
+    case TILE_CACHE_SOURCE_TIFF:
+      return tile_cache_load_tiff(image, level, tx, ty);
+  }
+
+  BLI_assert_unreachable();
+  return NULL;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Images
+ * \{ */
+
+static void tile_cache_image_init_levels(ImTileCacheImage *image, int width, int height)
+{
+  image->level_size[0][0] = width;
+  image->level_size[0][1] = height;
+  image->totlevel = 1;
+
+  while (image->totlevel < TILE_CACHE_MAX_LEVELS && (width > 1 || height > 1)) {
+    const int level = image->totlevel;
+#ifdef WITH_OPENEXR
+    if (image->source == TILE_CACHE_SOURCE_OPENEXR && level < image->file_levels) {
+      imb_exr_tile_reader_level_size(image->exr, level, &width, &height);
+    }
+    else
+#endif
+        if (image->source == TILE_CACHE_SOURCE_TIFF && level < image->file_levels) {
+      const ImBuf *levelbuf = IMB_getmipmap(image->tiff, level);
+      width = levelbuf->x;
+      height = levelbuf->y;
+    }
+    else {
+      width = max_ii(1, width / 2);
+      height = max_ii(1, height / 2);
+    }
+
+    image->level_size[level][0] = width;
+    image->level_size[level][1] = height;
+    image->totlevel++;
+  }
+
+  image->file_levels = min_ii(image->file_levels, image->totlevel);
+}
+
+ImTileCacheImage *IMB_tile_cache_image_open(const char *filepath, char colorspace[IM_MAX_SPACE])
+{
+  ImTileCacheImage *image = MEM_callocN(sizeof(ImTileCacheImage), "ImTileCacheImage");
+  STRNCPY(image->filepath, filepath);
+  if (colorspace) {
+    STRNCPY(image->colorspace, colorspace);
+  }
+  image->file_levels = 1;
+
+  const int ftype = IMB_ispic_type(filepath);
+  ImBuf *full_ibuf = NULL;
+  int width = 0, height = 0;
+
+#ifdef WITH_OPENEXR
+  if (ftype == IMB_FTYPE_OPENEXR) {
+    image->exr = imb_exr_tile_reader_open(
+        filepath, &image->tile_size[0], &image->tile_size[1], &image->file_levels);
+    if (image->exr) {
+      image->source = TILE_CACHE_SOURCE_OPENEXR;
+      if (image->colorspace[0] == '\0') {
+        colorspace_set_default_role(
+            image->colorspace, sizeof(image->colorspace), COLOR_ROLE_DEFAULT_FLOAT);
+      }
+      imb_exr_tile_reader_level_size(image->exr, 0, &width, &height);
+    }
+  }
+#endif
+
+#ifdef WITH_TIFF
+  if (image->source == TILE_CACHE_SOURCE_FULL && ftype == IMB_FTYPE_TIF) {
+    /* Tiled textures are loaded without pixels, other TIFF files are decoded right away. */
+    char tiff_colorspace[IM_MAX_SPACE];
+    STRNCPY(tiff_colorspace, image->colorspace);
+    ImBuf *ibuf = IMB_loadiffname(filepath, IB_tilecache, tiff_colorspace);
+    if (ibuf && (ibuf->flags & IB_tilecache)) {
+      image->source = TILE_CACHE_SOURCE_TIFF;
+      image->tiff = ibuf;
+      image->tile_size[0] = ibuf->tilex;
+      image->tile_size[1] = ibuf->tiley;
+      image->file_levels = ibuf->miptot;
+      STRNCPY(image->colorspace, tiff_colorspace);
+      width = ibuf->x;
+      height = ibuf->y;
+    }
+    else {
+      full_ibuf = ibuf;
+    }
+  }
+#endif
+  UNUSED_VARS(ftype);
+
+  if (image->source == TILE_CACHE_SOURCE_FULL) {
+    ImBuf *ibuf = full_ibuf ? full_ibuf : IMB_testiffname(filepath, IB_rect);
+    if (ibuf == NULL) {
+      MEM_freeN(image);
+      return NULL;
+    }
+    image->tile_size[0] = image->tile_size[1] = TILE_CACHE_TILE_SIZE;
+    width = ibuf->x;
+    height = ibuf->y;
+    if (full_ibuf == NULL) {
+      IMB_freeImBuf(ibuf);
+    }
+  }
+
+  tile_cache_image_init_levels(image, width, height);
+
+  if (full_ibuf) {
+    /* Already decoded, no need to do it again when the first tile is requested. */
+    if (full_ibuf->rect_float && full_ibuf->channels != 4) {
+      if (full_ibuf->rect == NULL) {
+        IMB_rect_from_float(full_ibuf);
+      }
+      imb_freerectfloatImBuf(full_ibuf);
+    }
+    ImBuf *tile = tile_cache_split_image(image, full_ibuf, 0, 0);
+    BLI_mutex_lock(&TILE_CACHE.mutex);
+    if (tile_cache_lookup(image, 0, 0, 0) == NULL) {
+      tile_cache_set_ibuf(tile_cache_add(image, 0, 0, 0), tile);
+      tile_cache_enforce_limit();
+    }
+    else {
+      IMB_freeImBuf(tile);
+    }
+    BLI_mutex_unlock(&TILE_CACHE.mutex);
+    IMB_freeImBuf(full_ibuf);
+  }
+
+  if (colorspace) {
+    BLI_strncpy(colorspace, image->colorspace, IM_MAX_SPACE);
+  }
+
+  return image;
+}
+
+void IMB_tile_cache_image_close(ImTileCacheImage *image)
+{
+  BLI_mutex_lock(&TILE_CACHE.mutex);
+
+  ImCachedTile *tile = TILE_CACHE.lru.first;
+  while (tile) {
+    ImCachedTile *next = tile->next;
+    if (tile->image == image) {
+      if (tile->loading) {
+        /* Wait for the tile and start over, the list may have changed in the meantime. */
+        BLI_condition_wait(&TILE_CACHE.loaded_cond, &TILE_CACHE.mutex);
+        tile = TILE_CACHE.lru.first;
+        continue;
+      }
+      BLI_assert_msg(tile->users == 0, "Image tile is still in use while closing the image");
+      tile_cache_remove(tile);
+    }
+    tile = next;
+  }
+
+  BLI_mutex_unlock(&TILE_CACHE.mutex);
+
+#ifdef WITH_OPENEXR
+  if (image->exr) {
+    imb_exr_tile_reader_close(image->exr);
+  }
+#endif
+  if (image->tiff) {
+    IMB_freeImBuf(image->tiff);
+  }
+  MEM_freeN(image);
+}
+
+int IMB_tile_cache_image_levels(const ImTileCacheImage *image)
+{
+  return image->totlevel;
+}
+
+void IMB_tile_cache_image_size(const ImTileCacheImage *image,
+                               int level,
+                               int *r_width,
+                               int *r_height)
+{
+  BLI_assert(level >= 0 && level < image->totlevel);
+  *r_width = image->level_size[level][0];
+  *r_height = image->level_size[level][1];
+}
+
+void IMB_tile_cache_image_tiles(const ImTileCacheImage *image,
+                                int level,
+                                int *r_tile_width,
+                                int *r_tile_height,
+                                int *r_xtiles,
+                                int *r_ytiles)
+{
+  BLI_assert(level >= 0 && level < image->totlevel);
+  *r_tile_width = image->tile_size[0];
+  *r_tile_height = image->tile_size[1];
+  *r_xtiles = tile_cache_xtiles(image, level);
+  *r_ytiles = tile_cache_ytiles(image, level);
+}
+
+int IMB_tile_cache_image_level_for_size(const ImTileCacheImage *image, int width, int height)
+{
+  int level = 0;
+  while (level + 1 < image->totlevel && image->level_size[level + 1][0] >= width &&
+         image->level_size[level + 1][1] >= height) {
+    level++;
+  }
+  return level;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Tile Access
+ * \{ */
+
+ImBuf *IMB_tile_cache_acquire(ImTileCacheImage *image, int level, int tx, int ty)
+{
+  BLI_assert(level >= 0 && level < image->totlevel);
+  BLI_assert(tx >= 0 && tx < tile_cache_xtiles(image, level));
+  BLI_assert(ty >= 0 && ty < tile_cache_ytiles(image, level));
+
+  BLI_mutex_lock(&TILE_CACHE.mutex);
+
+  ImCachedTile *tile = tile_cache_lookup(image, level, tx, ty);
+  if (tile) {
+    tile->users++;
+    BLI_remlink(&TILE_CACHE.lru, tile);
+    BLI_addhead(&TILE_CACHE.lru, tile);
+
+    /* Another thread is loading the tile. */
+    while (tile->loading) {
+      BLI_condition_wait(&TILE_CACHE.loaded_cond, &TILE_CACHE.mutex);
+    }
+
+    BLI_mutex_unlock(&TILE_CACHE.mutex);
+    return tile->ibuf;
+  }
+
+  tile = tile_cache_add(image, level, tx, ty);
+  tile->users = 1;
+  tile->loading = true;
+
+  /* Load without the lock, so other threads can access the cache meanwhile. */
+  BLI_mutex_unlock(&TILE_CACHE.mutex);
+  ImBuf *ibuf = tile_cache_load(image, level, tx, ty);
+  BLI_mutex_lock(&TILE_CACHE.mutex);
+
+  tile_cache_set_ibuf(tile, ibuf);
+  tile->loading = false;
+  BLI_condition_notify_all(&TILE_CACHE.loaded_cond);
+  tile_cache_enforce_limit();
+
+  BLI_mutex_unlock(&TILE_CACHE.mutex);
+
+  return ibuf;
+}
+
+void IMB_tile_cache_release(ImTileCacheImage *image, int level, int tx, int ty)
+{
+  BLI_mutex_lock(&TILE_CACHE.mutex);
+
+  ImCachedTile *tile = tile_cache_lookup(image, level, tx, ty);
+  BLI_assert(tile && tile->users > 0);
+  if (tile) {
+    tile->users--;
+    tile_cache_enforce_limit();
+  }
+
+  BLI_mutex_unlock(&TILE_CACHE.mutex);
+}
+
+ImBuf *IMB_tile_cache_load_level(ImTileCacheImage *image, int level)
+{
+  BLI_assert(level >= 0 && level < image->totlevel);
+
+  ImBuf *ibuf = NULL;
+  const int xtiles = tile_cache_xtiles(image, level);
+  const int ytiles = tile_cache_ytiles(image, level);
+
+  for (int ty = 0; ty < ytiles; ty++) {
+    for (int tx = 0; tx < xtiles; tx++) {
+      const ImBuf *tile = IMB_tile_cache_acquire(image, level, tx, ty);
+      if (tile) {
+        if (ibuf == NULL) {
+          const int flags = (tile->rect ? IB_rect : 0) | (tile->rect_float ? IB_rectfloat : 0);
+          ibuf = IMB_allocImBuf(
+              image->level_size[level][0], image->level_size[level][1], tile->planes, flags);
+          ibuf->rect_colorspace = tile->rect_colorspace;
+          ibuf->float_colorspace = tile->float_colorspace;
+        }
+        IMB_rectcpy(ibuf,
+                    tile,
+                    tx * image->tile_size[0],
+                    ty * image->tile_size[1],
+                    0,
+                    0,
+                    tile->x,
+                    tile->y);
+      }
+      IMB_tile_cache_release(image, level, tx, ty);
+    }
+  }
+
+  return ibuf;
+}
+
+/** \} */
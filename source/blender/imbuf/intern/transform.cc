@@ -8,8 +8,12 @@
 #include <array>
 #include <type_traits>
 
+#include "BLI_array.hh"
+#include "BLI_index_range.hh"
 #include "BLI_math.h"
 #include "BLI_rect.h"
+#include "BLI_simd.h"
+#include "BLI_task.hh"
 
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
@@ -479,36 +483,43 @@ class ScanlineProcessor {
   }
 };
 
+/**
+ * \brief Function processing a range of destination rows.
+ */
+using TransformRowsFunc = void (*)(const TransformUserData *user_data, IndexRange rows);
+
 /**
  * \brief callback function for threaded transformation.
  */
-template<typename Processor> void transform_scanline_function(void *custom_data, int scanline)
+template<typename Processor>
+void transform_rows_function(const TransformUserData *user_data, const IndexRange rows)
 {
-  const TransformUserData *user_data = static_cast<const TransformUserData *>(custom_data);
   Processor processor;
-  processor.process(user_data, scanline);
+  for (const int64_t scanline : rows) {
+    processor.process(user_data, int(scanline));
+  }
 }
 
 template<eIMBInterpolationFilterMode Filter,
          typename StorageType,
          int SourceNumChannels,
          int DestinationNumChannels>
-ScanlineThreadFunc get_scanline_function(const eIMBTransformMode mode)
+TransformRowsFunc get_rows_function(const eIMBTransformMode mode)
 
 {
   switch (mode) {
     case IMB_TRANSFORM_MODE_REGULAR:
-      return transform_scanline_function<
+      return transform_rows_function<
           ScanlineProcessor<NoDiscard,
                             Sampler<Filter, StorageType, SourceNumChannels, PassThroughUV>,
                             PixelPointer<StorageType, DestinationNumChannels>>>;
     case IMB_TRANSFORM_MODE_CROP_SRC:
-      return transform_scanline_function<
+      return transform_rows_function<
           ScanlineProcessor<CropSource,
                             Sampler<Filter, StorageType, SourceNumChannels, PassThroughUV>,
                             PixelPointer<StorageType, DestinationNumChannels>>>;
     case IMB_TRANSFORM_MODE_WRAP_REPEAT:
-      return transform_scanline_function<
+      return transform_rows_function<
           ScanlineProcessor<NoDiscard,
                             Sampler<Filter, StorageType, SourceNumChannels, WrapRepeatUV>,
                             PixelPointer<StorageType, DestinationNumChannels>>>;
@@ -519,42 +530,470 @@ ScanlineThreadFunc get_scanline_function(const eIMBTransformMode mode)
 }
 
 template<eIMBInterpolationFilterMode Filter>
-ScanlineThreadFunc get_scanline_function(const TransformUserData *user_data,
-                                         const eIMBTransformMode mode)
+TransformRowsFunc get_rows_function(const TransformUserData *user_data,
+                                    const eIMBTransformMode mode)
 {
   const ImBuf *src = user_data->src;
   const ImBuf *dst = user_data->dst;
 
   if (src->channels == 4 && dst->channels == 4) {
-    return get_scanline_function<Filter, float, 4, 4>(mode);
+    return get_rows_function<Filter, float, 4, 4>(mode);
   }
   if (src->channels == 3 && dst->channels == 4) {
-    return get_scanline_function<Filter, float, 3, 4>(mode);
+    return get_rows_function<Filter, float, 3, 4>(mode);
   }
   if (src->channels == 2 && dst->channels == 4) {
-    return get_scanline_function<Filter, float, 2, 4>(mode);
+    return get_rows_function<Filter, float, 2, 4>(mode);
   }
   if (src->channels == 1 && dst->channels == 4) {
-    return get_scanline_function<Filter, float, 1, 4>(mode);
+    return get_rows_function<Filter, float, 1, 4>(mode);
   }
   return nullptr;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Axis Aligned Transform
+ *
+ * When the transformation only scales and translates, the source coordinate of a destination
+ * pixel only depends on its column and row. The samples of all columns and rows are computed
+ * once, reducing the transformation to a separable resample without any per pixel coordinate
+ * math or bounds checking.
+ *
+ * Results match the regular samplers: pixels outside of the source contribute zero.
+ * \{ */
+
+/**
+ * \brief Source pixels contributing to a destination column or row.
+ *
+ * Indices are always valid, source pixels outside of the image have a zero weight.
+ */
+struct AxisSample {
+  int index[2];
+  float weight[2];
+  /** \brief False when the destination pixel is cropped and should not be written. */
+  bool is_used;
+};
+
+template<eIMBInterpolationFilterMode Filter>
+static void init_axis_samples(MutableSpan<AxisSample> samples,
+                              const float start,
+                              const float step,
+                              const int src_size,
+                              const bool use_crop,
+                              const float crop_min,
+                              const float crop_max)
+{
+  for (const int64_t i : samples.index_range()) {
+    const float coord = start + step * i;
+    AxisSample &sample = samples[i];
+    sample.is_used = !use_crop || (coord >= crop_min && coord < crop_max);
+
+    if constexpr (Filter == IMB_FILTER_NEAREST) {
+      const int index = int(coord);
+      const bool inside = index >= 0 && index < src_size;
+      sample.index[0] = sample.index[1] = inside ? index : 0;
+      sample.weight[0] = inside ? 1.0f : 0.0f;
+      sample.weight[1] = 0.0f;
+    }
+    else {
+      const float coord_floor = floorf(coord);
+      const int index = int(coord_floor);
+      const float a = coord - coord_floor;
+      const bool inside1 = index >= 0 && index < src_size;
+      const bool inside2 = index + 1 >= 0 && index + 1 < src_size;
+      sample.index[0] = inside1 ? index : 0;
+      sample.index[1] = inside2 ? index + 1 : 0;
+      sample.weight[0] = inside1 ? 1.0f - a : 0.0f;
+      sample.weight[1] = inside2 ? a : 0.0f;
+    }
+  }
+}
+
+struct AxisAlignedData {
+  const TransformUserData *user_data;
+  Array<AxisSample> columns;
+  Array<AxisSample> rows;
+};
+
+template<eIMBInterpolationFilterMode Filter>
+static void axis_aligned_rows_float(const AxisAlignedData &data, const IndexRange rows)
+{
+  const ImBuf *src = data.user_data->src;
+  const ImBuf *dst = data.user_data->dst;
+  const size_t src_stride = size_t(src->x) * 4;
+
+  for (const int64_t y : rows) {
+    const AxisSample &row = data.rows[y];
+    if (!row.is_used) {
+      continue;
+    }
+    const float *row1 = src->rect_float + row.index[0] * src_stride;
+    const float *row2 = src->rect_float + row.index[1] * src_stride;
+    float *output = dst->rect_float + size_t(y) * dst->x * 4;
+
+    for (const AxisSample &column : data.columns) {
+      if (column.is_used) {
+        if constexpr (Filter == IMB_FILTER_NEAREST) {
+          if (column.weight[0] != 0.0f && row.weight[0] != 0.0f) {
+            copy_v4_v4(output, row1 + column.index[0] * 4);
+          }
+          else {
+            zero_v4(output);
+          }
+        }
+        else {
+          const float w11 = column.weight[0] * row.weight[0];
+          const float w21 = column.weight[1] * row.weight[0];
+          const float w12 = column.weight[0] * row.weight[1];
+          const float w22 = column.weight[1] * row.weight[1];
+          const float *p11 = row1 + column.index[0] * 4;
+          const float *p21 = row1 + column.index[1] * 4;
+          const float *p12 = row2 + column.index[0] * 4;
+          const float *p22 = row2 + column.index[1] * 4;
+#ifdef BLI_HAVE_SSE2
+          __m128 result = _mm_mul_ps(_mm_set1_ps(w11), _mm_loadu_ps(p11));
+          result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w21), _mm_loadu_ps(p21)));
+          result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w12), _mm_loadu_ps(p12)));
+          result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w22), _mm_loadu_ps(p22)));
+          _mm_storeu_ps(output, result);
+#else
+          for (int i = 0; i < 4; i++) {
+            output[i] = w11 * p11[i] + w21 * p21[i] + w12 * p12[i] + w22 * p22[i];
+          }
+#endif
+        }
+      }
+      output += 4;
+    }
+  }
+}
+
+#ifdef BLI_HAVE_SSE2
+BLI_INLINE __m128 load_uchar4_m128(const uchar *pixel)
+{
+  int packed;
+  memcpy(&packed, pixel, sizeof(packed));
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i value = _mm_unpacklo_epi16(
+      _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+  return _mm_cvtepi32_ps(value);
+}
+
+BLI_INLINE void store_uchar4_m128(uchar *pixel, const __m128 value)
+{
+  /* Truncate after adding 0.5 to match #BLI_bilinear_interpolation_char. */
+  const __m128i value_i = _mm_cvttps_epi32(_mm_add_ps(value, _mm_set1_ps(0.5f)));
+  const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(value_i, value_i), value_i);
+  const int result = _mm_cvtsi128_si32(packed);
+  memcpy(pixel, &result, sizeof(result));
+}
+#endif
+
+template<eIMBInterpolationFilterMode Filter>
+static void axis_aligned_rows_uchar(const AxisAlignedData &data, const IndexRange rows)
+{
+  const ImBuf *src = data.user_data->src;
+  const ImBuf *dst = data.user_data->dst;
+  const uchar *src_rect = reinterpret_cast<const uchar *>(src->rect);
+  const size_t src_stride = size_t(src->x) * 4;
+
+  for (const int64_t y : rows) {
+    const AxisSample &row = data.rows[y];
+    if (!row.is_used) {
+      continue;
+    }
+    const uchar *row1 = src_rect + row.index[0] * src_stride;
+    const uchar *row2 = src_rect + row.index[1] * src_stride;
+    uchar *output = reinterpret_cast<uchar *>(dst->rect) + size_t(y) * dst->x * 4;
+
+    for (const AxisSample &column : data.columns) {
+      if (column.is_used) {
+        if constexpr (Filter == IMB_FILTER_NEAREST) {
+          if (column.weight[0] != 0.0f && row.weight[0] != 0.0f) {
+            copy_v4_v4_uchar(output, row1 + column.index[0] * 4);
+          }
+          else {
+            copy_v4_uchar(output, 0);
+          }
+        }
+        else {
+          const float w11 = column.weight[0] * row.weight[0];
+          const float w21 = column.weight[1] * row.weight[0];
+          const float w12 = column.weight[0] * row.weight[1];
+          const float w22 = column.weight[1] * row.weight[1];
+          const uchar *p11 = row1 + column.index[0] * 4;
+          const uchar *p21 = row1 + column.index[1] * 4;
+          const uchar *p12 = row2 + column.index[0] * 4;
+          const uchar *p22 = row2 + column.index[1] * 4;
+#ifdef BLI_HAVE_SSE2
+          __m128 result = _mm_mul_ps(_mm_set1_ps(w11), load_uchar4_m128(p11));
+          result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w21), load_uchar4_m128(p21)));
+          result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w12), load_uchar4_m128(p12)));
+          result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w22), load_uchar4_m128(p22)));
+          store_uchar4_m128(output, result);
+#else
+          for (int i = 0; i < 4; i++) {
+            output[i] = uchar(w11 * p11[i] + w21 * p21[i] + w12 * p12[i] + w22 * p22[i] + 0.5f);
+          }
+#endif
+        }
+      }
+      output += 4;
+    }
+  }
+}
+
+/** \} */
+
+#ifdef BLI_HAVE_SSE2
+
+/* -------------------------------------------------------------------- */
+/** \name Affine Bilinear Transform
+ *
+ * Bilinear sampling of RGBA buffers for arbitrary affine transformations. Source coordinates,
+ * weights and bounds of four destination pixels are computed at once, after which the corner
+ * pixels are gathered and blended per destination pixel.
+ * \{ */
+
+/** \brief Floor of four floats, SSE2 has no rounding instruction. */
+BLI_INLINE __m128i floor_m128(const __m128 value, __m128 *r_floor)
+{
+  const __m128i truncated = _mm_cvttps_epi32(value);
+  const __m128 truncated_f = _mm_cvtepi32_ps(truncated);
+  /* Subtract one where truncation rounded up (negative values). */
+  const __m128 rounded_up = _mm_cmpgt_ps(truncated_f, value);
+  *r_floor = _mm_sub_ps(truncated_f, _mm_and_ps(rounded_up, _mm_set1_ps(1.0f)));
+  return _mm_add_epi32(truncated, _mm_castps_si128(rounded_up));
+}
+
+/** \brief Mask of the lanes where `0 <= index < size`. */
+BLI_INLINE __m128i inside_m128i(const __m128i index, const __m128i size)
+{
+  return _mm_and_si128(_mm_cmpgt_epi32(index, _mm_set1_epi32(-1)), _mm_cmplt_epi32(index, size));
+}
+
+template<typename StorageType, bool UseCrop>
+static void affine_bilinear_rows(const TransformUserData *user_data, const IndexRange rows)
+{
+  const ImBuf *src = user_data->src;
+  const ImBuf *dst = user_data->dst;
+  const int width = dst->x;
+  const __m128i src_width = _mm_set1_epi32(src->x);
+  const __m128i src_height = _mm_set1_epi32(src->y);
+  const __m128 lane_offset = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  const __m128 add_x_u = _mm_set1_ps(user_data->add_x[0]);
+  const __m128 add_x_v = _mm_set1_ps(user_data->add_x[1]);
+
+  for (const int64_t y : rows) {
+    float row_uv[2];
+    madd_v2_v2v2fl(row_uv, user_data->start_uv, user_data->add_y, float(y));
+
+    for (int x = 0; x < width; x += 4) {
+      const __m128 xs = _mm_add_ps(_mm_set1_ps(float(x)), lane_offset);
+      const __m128 u = _mm_add_ps(_mm_set1_ps(row_uv[0]), _mm_mul_ps(xs, add_x_u));
+      const __m128 v = _mm_add_ps(_mm_set1_ps(row_uv[1]), _mm_mul_ps(xs, add_x_v));
+
+      int keep_mask = 0xf;
+      if constexpr (UseCrop) {
+        const rctf &crop = user_data->src_crop;
+        const __m128 keep = _mm_and_ps(
+            _mm_and_ps(_mm_cmpge_ps(u, _mm_set1_ps(crop.xmin)),
+                       _mm_cmplt_ps(u, _mm_set1_ps(crop.xmax))),
+            _mm_and_ps(_mm_cmpge_ps(v, _mm_set1_ps(crop.ymin)),
+                       _mm_cmplt_ps(v, _mm_set1_ps(crop.ymax))));
+        keep_mask = _mm_movemask_ps(keep);
+      }
+      keep_mask &= (1 << min_ii(4, width - x)) - 1;
+      if (keep_mask == 0) {
+        continue;
+      }
+
+      __m128 u_floor, v_floor;
+      const __m128i x1 = floor_m128(u, &u_floor);
+      const __m128i y1 = floor_m128(v, &v_floor);
+      const __m128i x2 = _mm_add_epi32(x1, _mm_set1_epi32(1));
+      const __m128i y2 = _mm_add_epi32(y1, _mm_set1_epi32(1));
+      const __m128 a = _mm_sub_ps(u, u_floor);
+      const __m128 b = _mm_sub_ps(v, v_floor);
+
+      /* Pixels outside of the source contribute nothing, their index is clamped to zero. */
+      const __m128i inside_x1 = inside_m128i(x1, src_width);
+      const __m128i inside_x2 = inside_m128i(x2, src_width);
+      const __m128i inside_y1 = inside_m128i(y1, src_height);
+      const __m128i inside_y2 = inside_m128i(y2, src_height);
+      const __m128 one = _mm_set1_ps(1.0f);
+      const __m128 wx1 = _mm_and_ps(_mm_castsi128_ps(inside_x1), _mm_sub_ps(one, a));
+      const __m128 wx2 = _mm_and_ps(_mm_castsi128_ps(inside_x2), a);
+      const __m128 wy1 = _mm_and_ps(_mm_castsi128_ps(inside_y1), _mm_sub_ps(one, b));
+      const __m128 wy2 = _mm_and_ps(_mm_castsi128_ps(inside_y2), b);
+
+      alignas(16) int ix1[4], ix2[4], iy1[4], iy2[4];
+      alignas(16) float w11[4], w21[4], w12[4], w22[4];
+      _mm_store_si128(reinterpret_cast<__m128i *>(ix1), _mm_and_si128(x1, inside_x1));
+      _mm_store_si128(reinterpret_cast<__m128i *>(ix2), _mm_and_si128(x2, inside_x2));
+      _mm_store_si128(reinterpret_cast<__m128i *>(iy1), _mm_and_si128(y1, inside_y1));
+      _mm_store_si128(reinterpret_cast<__m128i *>(iy2), _mm_and_si128(y2, inside_y2));
+      _mm_store_ps(w11, _mm_mul_ps(wx1, wy1));
+      _mm_store_ps(w21, _mm_mul_ps(wx2, wy1));
+      _mm_store_ps(w12, _mm_mul_ps(wx1, wy2));
+      _mm_store_ps(w22, _mm_mul_ps(wx2, wy2));
+
+      for (int lane = 0; lane < 4; lane++) {
+        if ((keep_mask & (1 << lane)) == 0) {
+          continue;
+        }
+        const size_t row1 = size_t(iy1[lane]) * src->x;
+        const size_t row2 = size_t(iy2[lane]) * src->x;
+        const size_t output_offset = (size_t(y) * width + x + lane) * 4;
+
+        if constexpr (std::is_same_v<StorageType, float>) {
+          const float *pixels = src->rect_float;
+          __m128 result = _mm_mul_ps(_mm_set1_ps(w11[lane]),
+                                     _mm_loadu_ps(pixels + (row1 + ix1[lane]) * 4));
+          result = _mm_add_ps(result,
+                              _mm_mul_ps(_mm_set1_ps(w21[lane]),
+                                         _mm_loadu_ps(pixels + (row1 + ix2[lane]) * 4)));
+          result = _mm_add_ps(result,
+                              _mm_mul_ps(_mm_set1_ps(w12[lane]),
+                                         _mm_loadu_ps(pixels + (row2 + ix1[lane]) * 4)));
+          result = _mm_add_ps(result,
+                              _mm_mul_ps(_mm_set1_ps(w22[lane]),
+                                         _mm_loadu_ps(pixels + (row2 + ix2[lane]) * 4)));
+          _mm_storeu_ps(dst->rect_float + output_offset, result);
+        }
+        else {
+          const uchar *pixels = reinterpret_cast<const uchar *>(src->rect);
+          __m128 result = _mm_mul_ps(_mm_set1_ps(w11[lane]),
+                                     load_uchar4_m128(pixels + (row1 + ix1[lane]) * 4));
+          result = _mm_add_ps(result,
+                              _mm_mul_ps(_mm_set1_ps(w21[lane]),
+                                         load_uchar4_m128(pixels + (row1 + ix2[lane]) * 4)));
+          result = _mm_add_ps(result,
+                              _mm_mul_ps(_mm_set1_ps(w12[lane]),
+                                         load_uchar4_m128(pixels + (row2 + ix1[lane]) * 4)));
+          result = _mm_add_ps(result,
+                              _mm_mul_ps(_mm_set1_ps(w22[lane]),
+                                         load_uchar4_m128(pixels + (row2 + ix2[lane]) * 4)));
+          store_uchar4_m128(reinterpret_cast<uchar *>(dst->rect) + output_offset, result);
+        }
+      }
+    }
+  }
+}
+
+/** \} */
+
+#endif /* BLI_HAVE_SSE2 */
+
+/**
+ * \brief Number of destination rows processed by a single task.
+ *
+ * Chunks of roughly 64K pixels amortize the scheduling overhead while keeping enough chunks for
+ * all threads on typical output sizes.
+ */
+static int64_t transform_grain_size(const ImBuf *dst)
+{
+  return max_ii(1, 65536 / max_ii(1, dst->x));
+}
+
+/**
+ * \brief Try the specialized transformation paths, returns false when none of them applies.
+ */
+template<eIMBInterpolationFilterMode Filter>
+static bool transform_specialized(const TransformUserData *user_data, const eIMBTransformMode mode)
+{
+  if (mode == IMB_TRANSFORM_MODE_WRAP_REPEAT) {
+    return false;
+  }
+
+  const ImBuf *src = user_data->src;
+  const ImBuf *dst = user_data->dst;
+  const bool use_float = src->rect_float && dst->rect_float;
+  const bool use_byte = !use_float && src->rect && dst->rect;
+  if (use_float && (src->channels != 4 || dst->channels != 4)) {
+    return false;
+  }
+  if (!use_float && !use_byte) {
+    return false;
+  }
+
+  const bool use_crop = mode == IMB_TRANSFORM_MODE_CROP_SRC;
+  const int64_t grain_size = transform_grain_size(dst);
+
+  if (user_data->add_x[1] == 0.0f && user_data->add_y[0] == 0.0f) {
+    AxisAlignedData data;
+    data.user_data = user_data;
+    data.columns.reinitialize(dst->x);
+    data.rows.reinitialize(dst->y);
+    const rctf &crop = user_data->src_crop;
+    init_axis_samples<Filter>(data.columns,
+                              user_data->start_uv[0],
+                              user_data->add_x[0],
+                              src->x,
+                              use_crop,
+                              use_crop ? crop.xmin : 0.0f,
+                              use_crop ? crop.xmax : 0.0f);
+    init_axis_samples<Filter>(data.rows,
+                              user_data->start_uv[1],
+                              user_data->add_y[1],
+                              src->y,
+                              use_crop,
+                              use_crop ? crop.ymin : 0.0f,
+                              use_crop ? crop.ymax : 0.0f);
+
+    threading::parallel_for(IndexRange(dst->y), grain_size, [&](const IndexRange rows) {
+      if (use_float) {
+        axis_aligned_rows_float<Filter>(data, rows);
+      }
+      else {
+        axis_aligned_rows_uchar<Filter>(data, rows);
+      }
+    });
+    return true;
+  }
+
+#ifdef BLI_HAVE_SSE2
+  if constexpr (Filter == IMB_FILTER_BILINEAR) {
+    TransformRowsFunc rows_func;
+    if (use_float) {
+      rows_func = use_crop ? affine_bilinear_rows<float, true> :
+                             affine_bilinear_rows<float, false>;
+    }
+    else {
+      rows_func = use_crop ? affine_bilinear_rows<uchar, true> :
+                             affine_bilinear_rows<uchar, false>;
+    }
+    threading::parallel_for(IndexRange(dst->y), grain_size, [&](const IndexRange rows) {
+      rows_func(user_data, rows);
+    });
+    return true;
+  }
+#endif
+
+  return false;
+}
+
 template<eIMBInterpolationFilterMode Filter>
 static void transform_threaded(TransformUserData *user_data, const eIMBTransformMode mode)
 {
-  ScanlineThreadFunc scanline_func = nullptr;
+  if (transform_specialized<Filter>(user_data, mode)) {
+    return;
+  }
+
+  TransformRowsFunc rows_func = nullptr;
 
   if (user_data->dst->rect_float && user_data->src->rect_float) {
-    scanline_func = get_scanline_function<Filter>(user_data, mode);
+    rows_func = get_rows_function<Filter>(user_data, mode);
   }
   else if (user_data->dst->rect && user_data->src->rect) {
     /* Number of channels is always 4 when using uchar buffers (sRGB + straight alpha). */
-    scanline_func = get_scanline_function<Filter, uchar, 4, 4>(mode);
+    rows_func = get_rows_function<Filter, uchar, 4, 4>(mode);
   }
 
-  if (scanline_func != nullptr) {
-    IMB_processor_apply_threaded_scanlines(user_data->dst->y, scanline_func, user_data);
+  if (rows_func != nullptr) {
+    threading::parallel_for(IndexRange(user_data->dst->y),
+                            transform_grain_size(user_data->dst),
+                            [&](const IndexRange rows) { rows_func(user_data, rows); });
   }
 }
 
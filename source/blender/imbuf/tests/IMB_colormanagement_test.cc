@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "BLI_math_base.h"
+#include "BLI_vector.hh"
+
+#include "DNA_color_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_colortools.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+
+namespace blender::imbuf::tests {
+
+class ColormanagementTest : public testing::Test {
+ protected:
+  ColorManagedDisplaySettings display_settings;
+  ColorManagedViewSettings view_settings;
+
+  void SetUp() override
+  {
+    CLG_init();
+    BKE_appdir_init();
+    IMB_init();
+
+    BKE_color_managed_display_settings_init(&display_settings);
+  }
+
+  void TearDown() override
+  {
+    IMB_exit();
+    BKE_appdir_exit();
+    CLG_exit();
+  }
+
+  /* Colors with channels spread over the whole range of stops covered by the baked lookup
+   * table, with all channel orders so that all tetrahedra of lattice cells are used. */
+  static Vector<float> create_test_colors(float min_stop, float max_stop)
+  {
+    const float scales[6][3] = {
+        {1.0f, 1.0f, 1.0f},
+        {1.0f, 0.5f, 0.25f},
+        {1.0f, 0.25f, 0.5f},
+        {0.5f, 1.0f, 0.25f},
+        {0.25f, 0.5f, 1.0f},
+        {0.1f, 1.0f, 0.7f},
+    };
+    Vector<float> colors;
+    for (float stop = min_stop; stop <= max_stop; stop += 0.125f) {
+      const float value = exp2f(stop);
+      for (const float *scale : scales) {
+        colors.extend({value * scale[0], value * scale[1], value * scale[2], 1.0f});
+      }
+    }
+    return colors;
+  }
+
+  /* Apply the exact and the baked display transform to copies of given pixels. */
+  void apply_display_transforms(const Vector<float> &pixels,
+                                Vector<float> &r_exact,
+                                Vector<float> &r_baked)
+  {
+    r_exact = pixels;
+    r_baked = pixels;
+    const int num_pixels = pixels.size() / 4;
+
+    view_settings.flag &= ~COLORMANAGE_VIEW_USE_BAKED_LUT;
+    ColormanageProcessor *exact_processor = IMB_colormanagement_display_processor_new(
+        &view_settings, &display_settings);
+    IMB_colormanagement_processor_apply(
+        exact_processor, r_exact.data(), num_pixels, 1, 4, false);
+    IMB_colormanagement_processor_free(exact_processor);
+
+    view_settings.flag |= COLORMANAGE_VIEW_USE_BAKED_LUT;
+    ColormanageProcessor *baked_processor = IMB_colormanagement_display_buffer_processor_new(
+        &view_settings, &display_settings);
+    IMB_colormanagement_processor_apply(
+        baked_processor, r_baked.data(), num_pixels, 1, 4, false);
+    IMB_colormanagement_processor_free(baked_processor);
+  }
+
+  void test_view_transform(const char *view_transform)
+  {
+    BKE_color_managed_view_settings_init_render(
+        &view_settings, &display_settings, view_transform);
+    const char *name = view_settings.view_transform;
+
+    /* Accuracy over the range of stops covered by the lattice. */
+    Vector<float> exact, baked;
+    apply_display_transforms(create_test_colors(-12.0f, 8.0f), exact, baked);
+    for (const int i : exact.index_range()) {
+      EXPECT_NEAR(baked[i], exact[i], 0.01f) << name << ", element " << i;
+    }
+
+    /* Values darker than the lowest stop are not flushed to black. */
+    Vector<float> dark_pixels = create_test_colors(-16.0f, -12.0f);
+    dark_pixels.extend({0.0f, 0.0f, 0.0f, 1.0f});
+    Vector<float> dark_exact, dark_baked;
+    apply_display_transforms(dark_pixels, dark_exact, dark_baked);
+    const int black_index = dark_pixels.size() - 4;
+    for (const int i : IndexRange(black_index)) {
+      const int channel = i % 4;
+      EXPECT_NEAR(dark_baked[i], dark_exact[i], 0.001f) << name << ", element " << i;
+      if (channel < 3 && dark_exact[i] > dark_exact[black_index + channel]) {
+        EXPECT_GT(dark_baked[i], dark_baked[black_index + channel])
+            << name << ", element " << i;
+      }
+    }
+  }
+};
+
+TEST_F(ColormanagementTest, baked_display_lut_default_view)
+{
+  test_view_transform(nullptr);
+}
+
+TEST_F(ColormanagementTest, baked_display_lut_standard_view)
+{
+  test_view_transform("Standard");
+}
+
+}  // namespace blender::imbuf::tests
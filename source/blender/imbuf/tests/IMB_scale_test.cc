@@ -0,0 +1,390 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "BLI_array.hh"
+#include "BLI_math.h"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+namespace blender::imbuf::tests {
+
+static constexpr eIMBScaleFilter ALL_FILTERS[] = {
+    IMB_SCALE_FILTER_BOX,
+    IMB_SCALE_FILTER_BILINEAR,
+    IMB_SCALE_FILTER_MITCHELL,
+    IMB_SCALE_FILTER_LANCZOS,
+};
+
+/* Source and destination sizes, odd sizes are not a multiple of the vector width, so rows end in
+ * partially used vectors. */
+static constexpr int SCALE_SIZES[][4] = {
+    /* Down-scaling. */
+    {21, 13, 8, 5},
+    /* Up-scaling. */
+    {7, 5, 19, 11},
+    /* Down-scaling on one axis, up-scaling on the other. */
+    {21, 5, 6, 13},
+    /* Only one axis scaled, the other one is copied. */
+    {21, 13, 21, 6},
+    /* Single pixel sources and destinations. */
+    {1, 1, 5, 3},
+    {9, 7, 1, 1},
+    {13, 1, 4, 1},
+    {1, 11, 1, 4},
+};
+
+static ImBuf *create_random_buffer(const int width,
+                                   const int height,
+                                   const bool use_float,
+                                   const int channels,
+                                   RandomNumberGenerator &rng)
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, use_float ? IB_rectfloat : IB_rect);
+  if (use_float) {
+    ibuf->channels = channels;
+    const int64_t num_values = int64_t(width) * height * channels;
+    for (const int64_t i : IndexRange(num_values)) {
+      ibuf->rect_float[i] = rng.get_float() * 2.0f - 0.5f;
+    }
+  }
+  else {
+    uchar *rect = reinterpret_cast<uchar *>(ibuf->rect);
+    for (const int64_t i : IndexRange(int64_t(width) * height * 4)) {
+      rect[i] = uchar(rng.get_uint32() & 0xff);
+    }
+  }
+  return ibuf;
+}
+
+/** Filter kernels as defined in `scaling.c`, with their support in source samples. */
+static float filter_radius(const eIMBScaleFilter filter)
+{
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return 0.5f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return 1.0f;
+    case IMB_SCALE_FILTER_MITCHELL:
+      return 2.0f;
+    case IMB_SCALE_FILTER_LANCZOS:
+      return 3.0f;
+  }
+  return 1.0f;
+}
+
+static double filter_eval(const eIMBScaleFilter filter, const float x_signed)
+{
+  const double x = std::abs(x_signed);
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return x <= 0.5 ? 1.0 : 0.0;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return x < 1.0 ? 1.0 - x : 0.0;
+    case IMB_SCALE_FILTER_MITCHELL: {
+      const double b = 1.0 / 3.0;
+      const double c = 1.0 / 3.0;
+      if (x < 1.0) {
+        return ((12.0 - 9.0 * b - 6.0 * c) * x * x * x + (-18.0 + 12.0 * b + 6.0 * c) * x * x +
+                (6.0 - 2.0 * b)) /
+               6.0;
+      }
+      if (x < 2.0) {
+        return ((-b - 6.0 * c) * x * x * x + (6.0 * b + 30.0 * c) * x * x +
+                (-12.0 * b - 48.0 * c) * x + (8.0 * b + 24.0 * c)) /
+               6.0;
+      }
+      return 0.0;
+    }
+    case IMB_SCALE_FILTER_LANCZOS: {
+      if (x < 1e-6) {
+        return 1.0;
+      }
+      if (x >= 3.0) {
+        return 0.0;
+      }
+      const double px = M_PI * x;
+      return 3.0 * std::sin(px) * std::sin(px / 3.0) / (px * px);
+    }
+  }
+  return 0.0;
+}
+
+/**
+ * Normalized weights of all source samples for output sample \a i, computed directly from the
+ * filter definition. Samples outside of the image are clamped to the edge.
+ */
+static Vector<double> filter_weights(const eIMBScaleFilter filter,
+                                     const int src_size,
+                                     const int dst_size,
+                                     const int i)
+{
+  Vector<double> weights(src_size, 0.0);
+  if (src_size == dst_size) {
+    weights[i] = 1.0;
+    return weights;
+  }
+
+  /* Sample positions are computed like the resampler does, so that samples exactly on the border
+   * of the box filter are treated the same. */
+  const float scale = float(src_size) / float(dst_size);
+  const float filter_scale = max_ff(scale, 1.0f);
+  const float support = filter_radius(filter) * filter_scale;
+  const float center = (float(i) + 0.5f) * scale - 0.5f;
+  double total = 0.0;
+  for (int j = int(std::ceil(center - support)); j <= int(std::floor(center + support)); j++) {
+    const double weight = filter_eval(filter, (float(j) - center) / filter_scale);
+    weights[clamp_i(j, 0, src_size - 1)] += weight;
+    total += weight;
+  }
+  for (double &weight : weights) {
+    weight /= total;
+  }
+  return weights;
+}
+
+/**
+ * Scalar two dimensional resampling of every output pixel, without intermediate buffers or
+ * vector instructions. Byte colors are filtered in premultiplied space.
+ */
+static ImBuf *scale_reference(const ImBuf *src,
+                              const int newx,
+                              const int newy,
+                              const eIMBScaleFilter filter)
+{
+  const bool use_float = src->rect_float != nullptr;
+  const int channels = use_float ? src->channels : 4;
+  ImBuf *dst = IMB_allocImBuf(newx, newy, 32, use_float ? IB_rectfloat : IB_rect);
+  dst->channels = channels;
+
+  Array<float> src_values(int64_t(src->x) * src->y * channels);
+  if (use_float) {
+    src_values.as_mutable_span().copy_from({src->rect_float, src_values.size()});
+  }
+  else {
+    const uchar *rect = reinterpret_cast<const uchar *>(src->rect);
+    for (const int64_t i : IndexRange(int64_t(src->x) * src->y)) {
+      straight_uchar_to_premul_float(&src_values[i * 4], rect + i * 4);
+    }
+  }
+
+  for (const int y : IndexRange(newy)) {
+    const Vector<double> weights_y = filter_weights(filter, src->y, newy, y);
+    for (const int x : IndexRange(newx)) {
+      const Vector<double> weights_x = filter_weights(filter, src->x, newx, x);
+      double color[4] = {0.0, 0.0, 0.0, 0.0};
+      for (const int src_y : IndexRange(src->y)) {
+        for (const int src_x : IndexRange(src->x)) {
+          const double weight = weights_x[src_x] * weights_y[src_y];
+          const float *value = &src_values[(int64_t(src_y) * src->x + src_x) * channels];
+          for (const int c : IndexRange(channels)) {
+            color[c] += weight * value[c];
+          }
+        }
+      }
+
+      const int64_t offset = (int64_t(y) * newx + x) * channels;
+      if (use_float) {
+        for (const int c : IndexRange(channels)) {
+          dst->rect_float[offset + c] = float(color[c]);
+        }
+      }
+      else {
+        float premul[4];
+        premul[3] = clamp_f(float(color[3]), 0.0f, 1.0f);
+        for (const int c : IndexRange(3)) {
+          premul[c] = clamp_f(float(color[c]), 0.0f, premul[3]);
+        }
+        premul_float_to_straight_uchar(reinterpret_cast<uchar *>(dst->rect) + offset, premul);
+      }
+    }
+  }
+  return dst;
+}
+
+static void expect_buffers_near(const ImBuf *result,
+                                const ImBuf *expected,
+                                const eIMBScaleFilter filter)
+{
+  ASSERT_EQ(result->x, expected->x);
+  ASSERT_EQ(result->y, expected->y);
+  if (expected->rect_float) {
+    ASSERT_NE(result->rect_float, nullptr);
+    ASSERT_EQ(result->channels, expected->channels);
+    const int64_t num_values = int64_t(expected->x) * expected->y * expected->channels;
+    for (const int64_t i : IndexRange(num_values)) {
+      EXPECT_NEAR(result->rect_float[i], expected->rect_float[i], 1e-4f)
+          << "filter " << filter << ", size " << expected->x << "x" << expected->y << ", value "
+          << i;
+    }
+  }
+  else {
+    ASSERT_NE(result->rect, nullptr);
+    const uchar *result_rect = reinterpret_cast<const uchar *>(result->rect);
+    const uchar *expected_rect = reinterpret_cast<const uchar *>(expected->rect);
+    for (const int64_t i : IndexRange(int64_t(expected->x) * expected->y * 4)) {
+      EXPECT_NEAR(int(result_rect[i]), int(expected_rect[i]), 1)
+          << "filter " << filter << ", size " << expected->x << "x" << expected->y << ", value "
+          << i;
+    }
+  }
+}
+
+/**
+ * Compare #IMB_scale, which uses vector instructions where available, and #IMB_scale_into_new
+ * with the scalar reference. Byte results may differ by one because of rounding.
+ */
+static void expect_scale_matches_reference(const bool use_float, const int channels)
+{
+  RandomNumberGenerator rng(0);
+  for (const eIMBScaleFilter filter : ALL_FILTERS) {
+    for (const auto &size : SCALE_SIZES) {
+      ImBuf *src = create_random_buffer(size[0], size[1], use_float, channels, rng);
+      ImBuf *expected = scale_reference(src, size[2], size[3], filter);
+
+      ImBuf *result_new = IMB_scale_into_new(src, size[2], size[3], filter, false);
+      expect_buffers_near(result_new, expected, filter);
+
+      for (const bool threaded : {false, true}) {
+        ImBuf *result = IMB_dupImBuf(src);
+        EXPECT_TRUE(IMB_scale(result, size[2], size[3], filter, threaded));
+        expect_buffers_near(result, expected, filter);
+        IMB_freeImBuf(result);
+      }
+
+      IMB_freeImBuf(src);
+      IMB_freeImBuf(expected);
+      IMB_freeImBuf(result_new);
+    }
+  }
+}
+
+TEST(IMB_scale, byte_matches_reference)
+{
+  expect_scale_matches_reference(false, 4);
+}
+
+TEST(IMB_scale, float_matches_reference)
+{
+  expect_scale_matches_reference(true, 4);
+}
+
+/* Float buffers with other channel counts are filtered without the per pixel vector path. */
+TEST(IMB_scale, float_channels_match_reference)
+{
+  expect_scale_matches_reference(true, 3);
+  expect_scale_matches_reference(true, 1);
+}
+
+/* Filter weights sum up to one, including the negative lobes of Mitchell and Lanczos. */
+TEST(IMB_scale, constant_color)
+{
+  const uchar color_byte[4] = {200, 100, 50, 255};
+  const float color_float[4] = {0.8f, -0.2f, 1.5f, 0.6f};
+  for (const eIMBScaleFilter filter : ALL_FILTERS) {
+    for (const auto &size : SCALE_SIZES) {
+      ImBuf *ibuf = IMB_allocImBuf(size[0], size[1], 32, IB_rect | IB_rectfloat);
+      for (const int64_t i : IndexRange(int64_t(size[0]) * size[1])) {
+        memcpy(reinterpret_cast<uchar *>(ibuf->rect) + i * 4, color_byte, sizeof(color_byte));
+        copy_v4_v4(ibuf->rect_float + i * 4, color_float);
+      }
+
+      ImBuf *result = IMB_scale_into_new(ibuf, size[2], size[3], filter, false);
+      const uchar *rect = reinterpret_cast<const uchar *>(result->rect);
+      for (const int64_t i : IndexRange(int64_t(size[2]) * size[3] * 4)) {
+        EXPECT_EQ(rect[i], color_byte[i % 4]) << "filter " << filter << ", value " << i;
+        EXPECT_NEAR(result->rect_float[i], color_float[i % 4], 1e-5f)
+            << "filter " << filter << ", value " << i;
+      }
+
+      IMB_freeImBuf(ibuf);
+      IMB_freeImBuf(result);
+    }
+  }
+}
+
+/* Byte colors are premultiplied for filtering and converted back to straight alpha, so the color
+ * of fully transparent pixels does not bleed into their neighbors. */
+TEST(IMB_scale, byte_straight_alpha)
+{
+  const uchar opaque[4] = {255, 40, 0, 255};
+  const uchar transparent[4] = {0, 255, 255, 0};
+  ImBuf *ibuf = IMB_allocImBuf(16, 8, 32, IB_rect);
+  uchar *rect = reinterpret_cast<uchar *>(ibuf->rect);
+  for (const int y : IndexRange(ibuf->y)) {
+    for (const int x : IndexRange(ibuf->x)) {
+      memcpy(rect + (y * ibuf->x + x) * 4, ((x + y) % 2) ? opaque : transparent, 4);
+    }
+  }
+
+  for (const eIMBScaleFilter filter : ALL_FILTERS) {
+    ImBuf *result = IMB_scale_into_new(ibuf, 8, 4, filter, false);
+    const uchar *result_rect = reinterpret_cast<const uchar *>(result->rect);
+    for (const int i : IndexRange(result->x * result->y)) {
+      const uchar *pixel = result_rect + i * 4;
+      EXPECT_GT(pixel[3], 0) << "filter " << filter << ", pixel " << i;
+      EXPECT_LT(pixel[3], 255) << "filter " << filter << ", pixel " << i;
+      for (const int c : IndexRange(3)) {
+        EXPECT_NEAR(int(pixel[c]), int(opaque[c]), 1)
+            << "filter " << filter << ", pixel " << i << ", channel " << c;
+      }
+    }
+    IMB_freeImBuf(result);
+  }
+
+  IMB_freeImBuf(ibuf);
+}
+
+/* Semi-transparent colors survive the conversion to premultiplied alpha and back. */
+TEST(IMB_scale, byte_premultiplied_round_trip)
+{
+  const uchar color[4] = {200, 100, 50, 77};
+  ImBuf *ibuf = IMB_allocImBuf(3, 3, 32, IB_rect);
+  for (const int i : IndexRange(9)) {
+    memcpy(reinterpret_cast<uchar *>(ibuf->rect) + i * 4, color, sizeof(color));
+  }
+
+  for (const eIMBScaleFilter filter : ALL_FILTERS) {
+    /* Scale back to the original size, so the image goes through the filters twice. */
+    ImBuf *result = IMB_scale_into_new(ibuf, 7, 5, filter, false);
+    EXPECT_TRUE(IMB_scale(result, 3, 3, filter, false));
+    const uchar *rect = reinterpret_cast<const uchar *>(result->rect);
+    for (const int i : IndexRange(9 * 4)) {
+      EXPECT_NEAR(int(rect[i]), int(color[i % 4]), 1) << "filter " << filter << ", value " << i;
+    }
+    IMB_freeImBuf(result);
+  }
+
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(IMB_scale, into_new_keeps_source)
+{
+  RandomNumberGenerator rng(0);
+  ImBuf *ibuf = create_random_buffer(9, 7, true, 4, rng);
+  ImBuf *copy = IMB_dupImBuf(ibuf);
+
+  ImBuf *result = IMB_scale_into_new(ibuf, 4, 11, IMB_SCALE_FILTER_LANCZOS, true);
+  EXPECT_EQ(result->x, 4);
+  EXPECT_EQ(result->y, 11);
+  EXPECT_EQ(ibuf->x, 9);
+  EXPECT_EQ(ibuf->y, 7);
+  EXPECT_EQ(memcmp(ibuf->rect_float, copy->rect_float, sizeof(float) * 9 * 7 * 4), 0);
+
+  /* Scaling to the same size leaves the image untouched. */
+  EXPECT_FALSE(IMB_scale(ibuf, 9, 7, IMB_SCALE_FILTER_BOX, false));
+  EXPECT_EQ(memcmp(ibuf->rect_float, copy->rect_float, sizeof(float) * 9 * 7 * 4), 0);
+
+  IMB_freeImBuf(ibuf);
+  IMB_freeImBuf(copy);
+  IMB_freeImBuf(result);
+}
+
+}  // namespace blender::imbuf::tests
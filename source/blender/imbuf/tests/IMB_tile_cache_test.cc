@@ -0,0 +1,247 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "CLG_log.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_task.hh"
+
+#include "BKE_appdir.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+namespace blender::imbuf::tests {
+
+/* Not a multiple of the tile size, so tiles at the right and top edges are smaller. */
+static constexpr int IMAGE_WIDTH = 600;
+static constexpr int IMAGE_HEIGHT = 300;
+static constexpr int TILE_SIZE = 256;
+
+class TileCacheTest : public testing::Test {
+ protected:
+  char filepath_[FILE_MAX];
+  ImBuf *ibuf_;
+
+  void SetUp() override
+  {
+    CLG_init();
+    BKE_appdir_init();
+    IMB_init();
+    BKE_tempdir_init("");
+
+    /* PNG files can't be read partially, so their tiles are split from the decoded image. */
+    ibuf_ = IMB_allocImBuf(IMAGE_WIDTH, IMAGE_HEIGHT, 32, IB_rect);
+    uchar *rect = reinterpret_cast<uchar *>(ibuf_->rect);
+    for (const int y : IndexRange(IMAGE_HEIGHT)) {
+      for (const int x : IndexRange(IMAGE_WIDTH)) {
+        uchar *pixel = rect + (size_t(y) * IMAGE_WIDTH + x) * 4;
+        pixel[0] = uchar(x);
+        pixel[1] = uchar(y);
+        pixel[2] = uchar(x / 256 + y / 256 * 3);
+        pixel[3] = 255;
+      }
+    }
+    ibuf_->ftype = IMB_FTYPE_PNG;
+    BLI_path_join(
+        filepath_, sizeof(filepath_), BKE_tempdir_session(), "tile_cache_test.png", nullptr);
+    ASSERT_TRUE(IMB_saveiff(ibuf_, filepath_, IB_rect));
+  }
+
+  void TearDown() override
+  {
+    BLI_delete(filepath_, false, false);
+    IMB_freeImBuf(ibuf_);
+
+    IMB_exit();
+    BKE_tempdir_session_purge();
+    BKE_appdir_exit();
+    CLG_exit();
+  }
+
+  /** Expect the tile to contain the pixels of the source image starting at the given offset. */
+  void expect_tile_pixels(const ImBuf *tile, const int xofs, const int yofs)
+  {
+    ASSERT_NE(tile, nullptr);
+    ASSERT_NE(tile->rect, nullptr);
+    for (const int y : IndexRange(tile->y)) {
+      const uint *expected = ibuf_->rect + size_t(yofs + y) * IMAGE_WIDTH + xofs;
+      const uint *result = tile->rect + size_t(y) * tile->x;
+      EXPECT_EQ(memcmp(result, expected, sizeof(uint) * tile->x), 0) << "row " << y;
+    }
+  }
+};
+
+TEST_F(TileCacheTest, levels)
+{
+  ImTileCacheImage *image = IMB_tile_cache_image_open(filepath_, nullptr);
+  ASSERT_NE(image, nullptr);
+
+  const int expected_sizes[][2] = {
+      {600, 300}, {300, 150}, {150, 75}, {75, 37}, {37, 18},
+      {18, 9},    {9, 4},     {4, 2},    {2, 1},   {1, 1},
+  };
+  ASSERT_EQ(IMB_tile_cache_image_levels(image), int(ARRAY_SIZE(expected_sizes)));
+  for (const int level : IndexRange(ARRAY_SIZE(expected_sizes))) {
+    int width, height;
+    IMB_tile_cache_image_size(image, level, &width, &height);
+    EXPECT_EQ(width, expected_sizes[level][0]) << "level " << level;
+    EXPECT_EQ(height, expected_sizes[level][1]) << "level " << level;
+  }
+
+  int tile_width, tile_height, xtiles, ytiles;
+  IMB_tile_cache_image_tiles(image, 0, &tile_width, &tile_height, &xtiles, &ytiles);
+  EXPECT_EQ(tile_width, TILE_SIZE);
+  EXPECT_EQ(tile_height, TILE_SIZE);
+  EXPECT_EQ(xtiles, 3);
+  EXPECT_EQ(ytiles, 2);
+  IMB_tile_cache_image_tiles(image, 2, &tile_width, &tile_height, &xtiles, &ytiles);
+  EXPECT_EQ(xtiles, 1);
+  EXPECT_EQ(ytiles, 1);
+
+  EXPECT_EQ(IMB_tile_cache_image_level_for_size(image, IMAGE_WIDTH, IMAGE_HEIGHT), 0);
+  EXPECT_EQ(IMB_tile_cache_image_level_for_size(image, 301, 10), 0);
+  EXPECT_EQ(IMB_tile_cache_image_level_for_size(image, 128, 64), 2);
+  EXPECT_EQ(IMB_tile_cache_image_level_for_size(image, 1, 1), 9);
+
+  IMB_tile_cache_image_close(image);
+}
+
+TEST_F(TileCacheTest, open_missing_file)
+{
+  char filepath[FILE_MAX];
+  BLI_path_join(
+      filepath, sizeof(filepath), BKE_tempdir_session(), "tile_cache_missing.png", nullptr);
+  EXPECT_EQ(IMB_tile_cache_image_open(filepath, nullptr), nullptr);
+}
+
+TEST_F(TileCacheTest, acquire_tiles)
+{
+  ImTileCacheImage *image = IMB_tile_cache_image_open(filepath_, nullptr);
+  ASSERT_NE(image, nullptr);
+
+  for (const int ty : IndexRange(2)) {
+    for (const int tx : IndexRange(3)) {
+      const ImBuf *tile = IMB_tile_cache_acquire(image, 0, tx, ty);
+      ASSERT_NE(tile, nullptr);
+      EXPECT_EQ(tile->x, std::min(TILE_SIZE, IMAGE_WIDTH - tx * TILE_SIZE));
+      EXPECT_EQ(tile->y, std::min(TILE_SIZE, IMAGE_HEIGHT - ty * TILE_SIZE));
+      expect_tile_pixels(tile, tx * TILE_SIZE, ty * TILE_SIZE);
+
+      /* Cached tiles are shared. */
+      EXPECT_EQ(IMB_tile_cache_acquire(image, 0, tx, ty), tile);
+      IMB_tile_cache_release(image, 0, tx, ty);
+      IMB_tile_cache_release(image, 0, tx, ty);
+    }
+  }
+  EXPECT_GE(IMB_tile_cache_memory_in_use(), size_t(IMAGE_WIDTH) * IMAGE_HEIGHT * 4);
+
+  IMB_tile_cache_image_close(image);
+  EXPECT_EQ(IMB_tile_cache_memory_in_use(), 0);
+}
+
+/* Levels assembled from generated tiles match down-scaling the whole image, as long as every
+ * level halves the size exactly. */
+TEST_F(TileCacheTest, load_level)
+{
+  ImTileCacheImage *image = IMB_tile_cache_image_open(filepath_, nullptr);
+  ASSERT_NE(image, nullptr);
+
+  ImBuf *level0 = IMB_tile_cache_load_level(image, 0);
+  ASSERT_NE(level0, nullptr);
+  expect_tile_pixels(level0, 0, 0);
+  IMB_freeImBuf(level0);
+
+  for (const int level : {1, 2}) {
+    ImBuf *result = IMB_tile_cache_load_level(image, level);
+    ASSERT_NE(result, nullptr);
+    ImBuf *expected = IMB_scale_into_new(
+        ibuf_, IMAGE_WIDTH >> level, IMAGE_HEIGHT >> level, IMB_SCALE_FILTER_BOX, false);
+    ASSERT_EQ(result->x, expected->x);
+    ASSERT_EQ(result->y, expected->y);
+
+    const uchar *result_rect = reinterpret_cast<const uchar *>(result->rect);
+    const uchar *expected_rect = reinterpret_cast<const uchar *>(expected->rect);
+    for (const int64_t i : IndexRange(int64_t(result->x) * result->y * 4)) {
+      EXPECT_NEAR(int(result_rect[i]), int(expected_rect[i]), 1)
+          << "level " << level << ", value " << i;
+    }
+
+    IMB_freeImBuf(result);
+    IMB_freeImBuf(expected);
+  }
+
+  IMB_tile_cache_image_close(image);
+}
+
+/* Tiles in use are never freed, tiles which are not used are freed to stay within the budget and
+ * loaded again when needed. */
+TEST_F(TileCacheTest, memory_limit)
+{
+  ImTileCacheImage *image = IMB_tile_cache_image_open(filepath_, nullptr);
+  ASSERT_NE(image, nullptr);
+
+  const size_t tile_mem = size_t(TILE_SIZE) * TILE_SIZE * 4;
+  IMB_tile_cache_limit_set(tile_mem * 2);
+
+  const ImBuf *tiles[2][3];
+  for (const int ty : IndexRange(2)) {
+    for (const int tx : IndexRange(3)) {
+      tiles[ty][tx] = IMB_tile_cache_acquire(image, 0, tx, ty);
+    }
+  }
+  EXPECT_GT(IMB_tile_cache_memory_in_use(), tile_mem * 2);
+  for (const int ty : IndexRange(2)) {
+    for (const int tx : IndexRange(3)) {
+      expect_tile_pixels(tiles[ty][tx], tx * TILE_SIZE, ty * TILE_SIZE);
+    }
+  }
+
+  for (const int ty : IndexRange(2)) {
+    for (const int tx : IndexRange(3)) {
+      IMB_tile_cache_release(image, 0, tx, ty);
+    }
+  }
+  EXPECT_LE(IMB_tile_cache_memory_in_use(), tile_mem * 2);
+
+  /* The first tile was used least recently, so it was freed. */
+  const ImBuf *tile = IMB_tile_cache_acquire(image, 0, 0, 0);
+  expect_tile_pixels(tile, 0, 0);
+  IMB_tile_cache_release(image, 0, 0, 0);
+  EXPECT_LE(IMB_tile_cache_memory_in_use(), tile_mem * 2);
+
+  IMB_tile_cache_image_close(image);
+  EXPECT_EQ(IMB_tile_cache_memory_in_use(), 0);
+}
+
+TEST_F(TileCacheTest, threaded_acquire)
+{
+  ImTileCacheImage *image = IMB_tile_cache_image_open(filepath_, nullptr);
+  ASSERT_NE(image, nullptr);
+
+  /* Every tile of the first two levels is requested by several threads at once. */
+  threading::parallel_for(IndexRange(64), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const int level = int(i % 2);
+      const int tx = int(i / 2 % 3) >> level;
+      const int ty = int(i / 6 % 2) >> level;
+      const ImBuf *tile = IMB_tile_cache_acquire(image, level, tx, ty);
+      EXPECT_NE(tile, nullptr);
+      if (level == 0) {
+        expect_tile_pixels(tile, tx * TILE_SIZE, ty * TILE_SIZE);
+      }
+      IMB_tile_cache_release(image, level, tx, ty);
+    }
+  });
+
+  IMB_tile_cache_image_close(image);
+  EXPECT_EQ(IMB_tile_cache_memory_in_use(), 0);
+}
+
+}  // namespace blender::imbuf::tests
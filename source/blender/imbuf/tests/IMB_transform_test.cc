@@ -0,0 +1,215 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "BLI_math.h"
+#include "BLI_rand.hh"
+#include "BLI_rect.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+namespace blender::imbuf::tests {
+
+/* Destination widths are not a multiple of four, so that the last pixels of rows are handled by
+ * partially used vectors. */
+static constexpr int SRC_WIDTH = 21;
+static constexpr int SRC_HEIGHT = 13;
+static constexpr int DST_WIDTH = 37;
+static constexpr int DST_HEIGHT = 23;
+
+/* Destination pixels which are not written keep this value. */
+static constexpr float DST_FILL_FLOAT = 0.5f;
+static constexpr uchar DST_FILL_BYTE = 128;
+
+static ImBuf *create_random_buffer(const int width,
+                                   const int height,
+                                   const bool use_float,
+                                   RandomNumberGenerator &rng)
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, use_float ? IB_rectfloat : IB_rect);
+  const int64_t num_values = int64_t(width) * height * 4;
+  if (use_float) {
+    for (const int64_t i : IndexRange(num_values)) {
+      ibuf->rect_float[i] = rng.get_float() * 2.0f - 0.5f;
+    }
+  }
+  else {
+    uchar *rect = reinterpret_cast<uchar *>(ibuf->rect);
+    for (const int64_t i : IndexRange(num_values)) {
+      rect[i] = uchar(rng.get_uint32() & 0xff);
+    }
+  }
+  return ibuf;
+}
+
+static ImBuf *create_destination_buffer(bool use_float)
+{
+  ImBuf *ibuf = IMB_allocImBuf(DST_WIDTH, DST_HEIGHT, 32, use_float ? IB_rectfloat : IB_rect);
+  const int64_t num_values = int64_t(DST_WIDTH) * DST_HEIGHT * 4;
+  if (use_float) {
+    for (const int64_t i : IndexRange(num_values)) {
+      ibuf->rect_float[i] = DST_FILL_FLOAT;
+    }
+  }
+  else {
+    memset(ibuf->rect, DST_FILL_BYTE, num_values);
+  }
+  return ibuf;
+}
+
+/**
+ * Transformation sampling every destination pixel with the per pixel interpolation functions,
+ * stepping through source coordinates the same way the generic scan-line processors do.
+ */
+static void transform_reference(const ImBuf *src,
+                                ImBuf *dst,
+                                const eIMBTransformMode mode,
+                                const eIMBInterpolationFilterMode filter,
+                                const float transform_matrix[4][4],
+                                const rctf *src_crop)
+{
+  const float origin[3] = {0.0f, 0.0f, 0.0f};
+  const float max_x[3] = {float(src->x), 0.0f, 0.0f};
+  const float max_y[3] = {0.0f, float(src->y), 0.0f};
+  float start_uv[3], add_x[3], add_y[3];
+  mul_v3_m4v3(start_uv, transform_matrix, origin);
+  mul_v3_m4v3(add_x, transform_matrix, max_x);
+  mul_v3_m4v3(add_y, transform_matrix, max_y);
+  sub_v2_v2(add_x, start_uv);
+  sub_v2_v2(add_y, start_uv);
+  mul_v2_fl(add_x, 1.0f / src->x);
+  mul_v2_fl(add_y, 1.0f / src->y);
+
+  for (const int y : IndexRange(dst->y)) {
+    float uv[2];
+    madd_v2_v2v2fl(uv, start_uv, add_y, y);
+    for (const int x : IndexRange(dst->x)) {
+      const size_t offset = (size_t(y) * dst->x + x) * 4;
+      const bool is_cropped = mode == IMB_TRANSFORM_MODE_CROP_SRC &&
+                              (uv[0] < src_crop->xmin || uv[0] >= src_crop->xmax ||
+                               uv[1] < src_crop->ymin || uv[1] >= src_crop->ymax);
+      if (!is_cropped) {
+        float *out_float = dst->rect_float ? dst->rect_float + offset : nullptr;
+        uchar *out_byte = dst->rect_float ? nullptr :
+                                            reinterpret_cast<uchar *>(dst->rect) + offset;
+        if (filter == IMB_FILTER_NEAREST) {
+          nearest_interpolation_color(src, out_byte, out_float, uv[0], uv[1]);
+        }
+        else {
+          bilinear_interpolation_color(src, out_byte, out_float, uv[0], uv[1]);
+        }
+      }
+      add_v2_v2(uv, add_x);
+    }
+  }
+}
+
+/**
+ * Compare #IMB_transform, which picks a specialized kernel where one applies, with the reference
+ * transformation. The kernels compute source coordinates directly instead of accumulating them,
+ * so results differ slightly, byte results may also differ by one because of rounding.
+ */
+static void expect_transform_matches_reference(const bool use_float,
+                                               const eIMBTransformMode mode,
+                                               const eIMBInterpolationFilterMode filter,
+                                               const float transform_matrix[4][4])
+{
+  RandomNumberGenerator rng(0);
+  ImBuf *src = create_random_buffer(SRC_WIDTH, SRC_HEIGHT, use_float, rng);
+  ImBuf *result = create_destination_buffer(use_float);
+  ImBuf *expected = create_destination_buffer(use_float);
+
+  /* Crop partially overlaps the source image, with fractional bounds. */
+  rctf crop;
+  BLI_rctf_init(&crop, 2.5f, SRC_WIDTH + 3.0f, -1.25f, SRC_HEIGHT - 4.5f);
+  const rctf *src_crop = mode == IMB_TRANSFORM_MODE_CROP_SRC ? &crop : nullptr;
+
+  IMB_transform(src, result, mode, filter, transform_matrix, src_crop);
+  transform_reference(src, expected, mode, filter, transform_matrix, src_crop);
+
+  for (const int y : IndexRange(DST_HEIGHT)) {
+    for (const int x : IndexRange(DST_WIDTH)) {
+      for (const int c : IndexRange(4)) {
+        const size_t index = (size_t(y) * DST_WIDTH + x) * 4 + c;
+        if (use_float) {
+          EXPECT_NEAR(result->rect_float[index], expected->rect_float[index], 1e-4f)
+              << "mode " << mode << ", pixel (" << x << ", " << y << "), channel " << c;
+        }
+        else {
+          const uchar *result_rect = reinterpret_cast<const uchar *>(result->rect);
+          const uchar *expected_rect = reinterpret_cast<const uchar *>(expected->rect);
+          EXPECT_NEAR(int(result_rect[index]), int(expected_rect[index]), 1)
+              << "mode " << mode << ", pixel (" << x << ", " << y << "), channel " << c;
+        }
+      }
+    }
+  }
+
+  IMB_freeImBuf(src);
+  IMB_freeImBuf(result);
+  IMB_freeImBuf(expected);
+}
+
+static void expect_all_variants_match_reference(const eIMBInterpolationFilterMode filter,
+                                                const float transform_matrix[4][4])
+{
+  for (const bool use_float : {false, true}) {
+    for (const eIMBTransformMode mode :
+         {IMB_TRANSFORM_MODE_REGULAR, IMB_TRANSFORM_MODE_CROP_SRC}) {
+      expect_transform_matches_reference(use_float, mode, filter, transform_matrix);
+    }
+  }
+}
+
+/* Scale and translation use the separable kernels. Nearest sampling rounds source coordinates
+ * down, so the factors are exact in binary to avoid coordinates landing on either side of a pixel
+ * border depending on how they are accumulated. */
+TEST(IMB_transform, axis_aligned_nearest)
+{
+  float transform_matrix[4][4];
+  unit_m4(transform_matrix);
+  transform_matrix[0][0] = 0.75f;
+  transform_matrix[1][1] = 0.625f;
+  transform_matrix[3][0] = -3.25f;
+  transform_matrix[3][1] = -2.125f;
+  expect_all_variants_match_reference(IMB_FILTER_NEAREST, transform_matrix);
+}
+
+TEST(IMB_transform, axis_aligned_bilinear)
+{
+  float transform_matrix[4][4];
+  unit_m4(transform_matrix);
+  transform_matrix[0][0] = 0.7f;
+  transform_matrix[1][1] = 0.45f;
+  transform_matrix[3][0] = -3.3f;
+  transform_matrix[3][1] = -2.1f;
+  expect_all_variants_match_reference(IMB_FILTER_BILINEAR, transform_matrix);
+
+  /* Upscaling beyond the source image, mirrored on X. */
+  unit_m4(transform_matrix);
+  transform_matrix[0][0] = -1.3f;
+  transform_matrix[1][1] = 1.7f;
+  transform_matrix[3][0] = 30.2f;
+  transform_matrix[3][1] = -5.6f;
+  expect_all_variants_match_reference(IMB_FILTER_BILINEAR, transform_matrix);
+}
+
+/* Rotations use the affine bilinear kernel, and the generic processors for nearest sampling. */
+TEST(IMB_transform, rotated_bilinear)
+{
+  for (const float angle : {0.3f, 2.0f, -1.1f}) {
+    float transform_matrix[4][4];
+    axis_angle_to_mat4_single(transform_matrix, 'Z', angle);
+    mul_m4_fl(transform_matrix, 0.8f);
+    transform_matrix[3][0] = SRC_WIDTH * 0.5f;
+    transform_matrix[3][1] = -3.7f;
+    transform_matrix[3][3] = 1.0f;
+    expect_all_variants_match_reference(IMB_FILTER_BILINEAR, transform_matrix);
+  }
+}
+
+}  // namespace blender::imbuf::tests
@@ -1101,6 +1101,8 @@ typedef struct AnimData {
 
   /** Runtime data, for depsgraph evaluation. */
   FCurve **driver_array;
+  /** Runtime data, for evaluation of the action of copy-on-write data-blocks. */
+  struct ActionEvalCache *action_eval_cache;
 
   /* settings for animation evaluation */
   /** User-defined settings. */
@@ -106,6 +106,35 @@ int DNA_struct_find_nr(const struct SDNA *sdna, const char *str);
  * \param data: Struct data that is to be converted
  */
 void DNA_struct_switch_endian(const struct SDNA *sdna, int struct_nr, char *data);
+
+/**
+ * Called for pointer members which differ between the source and destination struct of
+ * #DNA_struct_patch_values, return false when the destination pointer does not refer to data
+ * corresponding to the source pointer.
+ *
+ * \param is_id: The pointer refers to an ID data-block.
+ */
+typedef bool (*DNAPatchPointerFn)(const void *src_pointer,
+                                  const void *dst_pointer,
+                                  bool is_id,
+                                  void *user_data);
+/**
+ * Copy the values of all members of a struct which differ from \a src to \a dst, recursing into
+ * nested structs. Pointers are not followed nor copied, they are passed to \a pointer_fn instead.
+ *
+ * \param skip_members: Null terminated list of member names (without pointer or array
+ * decoration) of the top level struct to leave untouched, may be null.
+ * \param r_changed: Set to true when any value got copied, may be null.
+ * \return False when \a pointer_fn rejected a pointer, \a dst might be partially updated then.
+ */
+bool DNA_struct_patch_values(const struct SDNA *sdna,
+                             int struct_nr,
+                             const void *src,
+                             void *dst,
+                             const char **skip_members,
+                             DNAPatchPointerFn pointer_fn,
+                             void *user_data,
+                             bool *r_changed);
 /**
  * Constructs and returns an array of byte flags with one element for each struct in oldsdna,
  * indicating how it compares to newsdna.
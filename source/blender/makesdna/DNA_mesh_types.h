@@ -140,12 +140,19 @@ typedef struct Mesh_Runtime {
   struct SubsurfRuntimeData *subsurf_runtime_data;
   void *_pad1;
 
+  /**
+   * Hash of the topology of an evaluated mesh, zero when not computed. Used by drawing code to
+   * only update deformed data when the evaluated mesh is replaced by one with the same topology.
+   * See #BKE_mesh_runtime_topology_hash_ensure.
+   */
+  uint32_t topology_hash;
+
   /**
    * Caches for lazily computed vertex and polygon normals. These are stored here rather than in
    * #CustomData because they can be calculated on a const mesh, and adding custom data layers on a
    * const mesh is not thread-safe.
    */
-  char _pad2[6];
+  char _pad2[2];
   char vert_normals_dirty;
   char poly_normals_dirty;
   float (*vert_normals)[3];
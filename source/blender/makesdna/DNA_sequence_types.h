@@ -307,6 +307,9 @@ typedef struct Editing {
   /* Cache control */
   float recycle_max_cost; /* UNUSED only for versioning. */
   int cache_flag;
+  /** Number of frames rendered concurrently by prefetching, 0 for automatic. */
+  int prefetch_threads;
+  char _pad2[4];
 
   struct PrefetchJob *prefetch_job;
 
@@ -773,6 +776,8 @@ enum {
   SEQ_CACHE_PREFETCH_ENABLE = (1 << 10),
   SEQ_CACHE_DISK_CACHE_ENABLE = (1 << 11),
   SEQ_CACHE_STORE_THUMBNAIL = (1 << 12),
+  /* Store cached images compressed, only used by #Editing.cache_flag. */
+  SEQ_CACHE_COMPRESS = (1 << 13),
 };
 
 /** #Sequence.color_tag. */
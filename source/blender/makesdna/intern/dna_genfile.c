@@ -1074,6 +1074,108 @@ void DNA_struct_switch_endian(const SDNA *sdna, int struct_nr, char *data)
   }
 }
 
+static bool member_name_in_list(const char *member_name, const char **names)
+{
+  for (; *names; names++) {
+    uint offset;
+    if (DNA_elem_id_match(*names, (int)strlen(*names), member_name, &offset)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Whether the type is an ID data-block, which always starts with the ID struct. */
+static bool type_is_id(const SDNA *sdna, const char *type_name)
+{
+  if (STREQ(type_name, "ID")) {
+    return true;
+  }
+  const int struct_nr = DNA_struct_find_nr(sdna, type_name);
+  if (struct_nr == -1) {
+    return false;
+  }
+  const SDNA_Struct *struct_info = sdna->structs[struct_nr];
+  return struct_info->members_len > 0 && STREQ(sdna->types[struct_info->members[0].type], "ID");
+}
+
+bool DNA_struct_patch_values(const SDNA *sdna,
+                             int struct_nr,
+                             const void *src,
+                             void *dst,
+                             const char **skip_members,
+                             DNAPatchPointerFn pointer_fn,
+                             void *user_data,
+                             bool *r_changed)
+{
+  const SDNA_Struct *struct_info = sdna->structs[struct_nr];
+
+  int offset_in_bytes = 0;
+  for (int member_index = 0; member_index < struct_info->members_len; member_index++) {
+    const SDNA_StructMember *member = &struct_info->members[member_index];
+    const int member_size = get_member_size_in_bytes(sdna, member);
+    const char *member_name = sdna->names[member->name];
+    const char *src_data = (const char *)src + offset_in_bytes;
+    char *dst_data = (char *)dst + offset_in_bytes;
+    offset_in_bytes += member_size;
+
+    if (skip_members && member_name_in_list(member_name, skip_members)) {
+      continue;
+    }
+
+    const eStructMemberCategory member_category = get_struct_member_category(sdna, member);
+    const char *member_type_name = sdna->types[member->type];
+    const int member_array_length = sdna->names_array_len[member->name];
+
+    switch (member_category) {
+      case STRUCT_MEMBER_CATEGORY_STRUCT: {
+        const int substruct_size = sdna->types_size[member->type];
+        const int substruct_nr = DNA_struct_find_nr(sdna, member_type_name);
+        BLI_assert(substruct_nr != -1);
+        for (int a = 0; a < member_array_length; a++) {
+          if (!DNA_struct_patch_values(sdna,
+                                       substruct_nr,
+                                       src_data + a * substruct_size,
+                                       dst_data + a * substruct_size,
+                                       NULL,
+                                       pointer_fn,
+                                       user_data,
+                                       r_changed)) {
+            return false;
+          }
+        }
+        break;
+      }
+      case STRUCT_MEMBER_CATEGORY_PRIMITIVE: {
+        if (memcmp(src_data, dst_data, (size_t)member_size) != 0) {
+          memcpy(dst_data, src_data, (size_t)member_size);
+          if (r_changed) {
+            *r_changed = true;
+          }
+        }
+        break;
+      }
+      case STRUCT_MEMBER_CATEGORY_POINTER: {
+        if (member_name[0] == '(') {
+          /* Function pointers are run-time callbacks. */
+          break;
+        }
+        const bool is_id = type_is_id(sdna, member_type_name);
+        const void *const *src_pointers = (const void *const *)src_data;
+        const void *const *dst_pointers = (const void *const *)dst_data;
+        for (int a = 0; a < member_array_length; a++) {
+          if (src_pointers[a] != dst_pointers[a] &&
+              !pointer_fn(src_pointers[a], dst_pointers[a], is_id, user_data)) {
+            return false;
+          }
+        }
+        break;
+      }
+    }
+  }
+  return true;
+}
+
 typedef enum eReconstructStepType {
   RECONSTRUCT_STEP_MEMCPY,
   RECONSTRUCT_STEP_CAST_PRIMITIVE,
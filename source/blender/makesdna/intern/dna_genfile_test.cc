@@ -0,0 +1,160 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "DNA_color_types.h"
+#include "DNA_genfile.h"
+#include "DNA_texture_types.h"
+
+namespace blender::dna::tests {
+
+class DNAPatchValuesTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    DNA_sdna_current_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    DNA_sdna_current_free();
+  }
+
+ protected:
+  /* Pointers passed to the callback, which accepts them when #accept_pointers is set. */
+  struct PointerCalls {
+    int num_calls = 0;
+    int num_id_calls = 0;
+    const void *last_src = nullptr;
+    const void *last_dst = nullptr;
+    bool accept_pointers = true;
+  };
+
+  static bool pointer_fn(const void *src_pointer,
+                         const void *dst_pointer,
+                         const bool is_id,
+                         void *user_data)
+  {
+    PointerCalls *calls = static_cast<PointerCalls *>(user_data);
+    calls->num_calls++;
+    calls->num_id_calls += is_id;
+    calls->last_src = src_pointer;
+    calls->last_dst = dst_pointer;
+    return calls->accept_pointers;
+  }
+
+  static bool patch_values(const char *struct_name,
+                           const void *src,
+                           void *dst,
+                           const char **skip_members,
+                           PointerCalls &calls,
+                           bool *r_changed)
+  {
+    const SDNA *sdna = DNA_sdna_current_get();
+    const int struct_nr = DNA_struct_find_nr(sdna, struct_name);
+    EXPECT_NE(struct_nr, -1);
+    return DNA_struct_patch_values(
+        sdna, struct_nr, src, dst, skip_members, pointer_fn, &calls, r_changed);
+  }
+};
+
+TEST_F(DNAPatchValuesTest, copies_changed_values)
+{
+  CurveMapping src{};
+  CurveMapping dst{};
+  src.preset = 3;
+  src.clipr.xmax = 2.0f;
+  src.cm[2].range = 0.5f;
+  src.white[1] = 0.25f;
+
+  PointerCalls calls;
+  bool changed = false;
+  EXPECT_TRUE(patch_values("CurveMapping", &src, &dst, nullptr, calls, &changed));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(calls.num_calls, 0);
+  /* Top level values, nested structs and arrays of nested structs. */
+  EXPECT_EQ(dst.preset, 3);
+  EXPECT_EQ(dst.clipr.xmax, 2.0f);
+  EXPECT_EQ(dst.cm[2].range, 0.5f);
+  EXPECT_EQ(dst.white[1], 0.25f);
+
+  /* Nothing to do when the values are the same already. */
+  changed = false;
+  EXPECT_TRUE(patch_values("CurveMapping", &src, &dst, nullptr, calls, &changed));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(DNAPatchValuesTest, skip_members)
+{
+  CurveMapping src{};
+  CurveMapping dst{};
+  src.preset = 3;
+  src.clipr.xmax = 2.0f;
+  src.white[1] = 0.25f;
+
+  /* Array members are matched without their array size. */
+  const char *skip_members[] = {"clipr", "white", nullptr};
+  PointerCalls calls;
+  bool changed = false;
+  EXPECT_TRUE(patch_values("CurveMapping", &src, &dst, skip_members, calls, &changed));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(dst.preset, 3);
+  EXPECT_EQ(dst.clipr.xmax, 0.0f);
+  EXPECT_EQ(dst.white[1], 0.0f);
+
+  /* Changes of skipped members only are not reported. */
+  src.preset = 0;
+  dst.preset = 0;
+  changed = false;
+  EXPECT_TRUE(patch_values("CurveMapping", &src, &dst, skip_members, calls, &changed));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(DNAPatchValuesTest, pointers)
+{
+  CurveMapPoint src_points[2] = {};
+  CurveMapPoint dst_points[2] = {};
+  CurveMapping src{};
+  CurveMapping dst{};
+
+  /* Equal pointers are not passed to the callback. */
+  src.cm[1].curve = src_points;
+  dst.cm[1].curve = src_points;
+  PointerCalls calls;
+  EXPECT_TRUE(patch_values("CurveMapping", &src, &dst, nullptr, calls, nullptr));
+  EXPECT_EQ(calls.num_calls, 0);
+
+  /* Pointers are never copied, also when they are accepted. */
+  dst.cm[1].curve = dst_points;
+  EXPECT_TRUE(patch_values("CurveMapping", &src, &dst, nullptr, calls, nullptr));
+  EXPECT_EQ(calls.num_calls, 1);
+  EXPECT_EQ(calls.num_id_calls, 0);
+  EXPECT_EQ(calls.last_src, src_points);
+  EXPECT_EQ(calls.last_dst, dst_points);
+  EXPECT_EQ(dst.cm[1].curve, dst_points);
+
+  /* Rejected pointers stop patching. */
+  calls.accept_pointers = false;
+  EXPECT_FALSE(patch_values("CurveMapping", &src, &dst, nullptr, calls, nullptr));
+}
+
+TEST_F(DNAPatchValuesTest, id_pointers)
+{
+  char src_tex[8], dst_tex[8];
+  MTex src{};
+  MTex dst{};
+  src.tex = reinterpret_cast<Tex *>(src_tex);
+  dst.tex = reinterpret_cast<Tex *>(dst_tex);
+  src.ofs[2] = 1.0f;
+
+  PointerCalls calls;
+  bool changed = false;
+  EXPECT_TRUE(patch_values("MTex", &src, &dst, nullptr, calls, &changed));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(calls.num_calls, 1);
+  EXPECT_EQ(calls.num_id_calls, 1);
+  EXPECT_EQ(dst.tex, reinterpret_cast<Tex *>(dst_tex));
+  EXPECT_EQ(dst.ofs[2], 1.0f);
+}
+
+}  // namespace blender::dna::tests
@@ -2313,6 +2313,14 @@ static void rna_def_editor(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, NULL, "cache_flag", SEQ_CACHE_STORE_FINAL_OUT);
   RNA_def_property_ui_text(prop, "Cache Final", "Cache final image for each frame");
 
+  prop = RNA_def_property(srna, "use_cache_compression", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "cache_flag", SEQ_CACHE_COMPRESS);
+  RNA_def_property_ui_text(prop,
+                           "Compress Cache",
+                           "Store cached images losslessly compressed, so more frames fit into "
+                           "the memory cache at the cost of decompressing them on playback");
+  RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, NULL);
+
   prop = RNA_def_property(srna, "use_prefetch", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "cache_flag", SEQ_CACHE_PREFETCH_ENABLE);
   RNA_def_property_ui_text(
@@ -2321,6 +2329,15 @@ static void rna_def_editor(BlenderRNA *brna)
       "Render frames ahead of current frame in the background for faster playback");
   RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, NULL);
 
+  prop = RNA_def_property(srna, "prefetch_threads", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "prefetch_threads");
+  RNA_def_property_range(prop, 0, 16);
+  RNA_def_property_ui_text(prop,
+                           "Prefetch Threads",
+                           "Number of frames rendered at the same time when prefetching, "
+                           "0 to choose automatically based on the number of processor cores");
+  RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, NULL);
+
   /* functions */
 
   func = RNA_def_function(srna, "display_stack", "rna_SequenceEditor_display_stack");
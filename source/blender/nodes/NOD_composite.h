@@ -147,6 +147,12 @@ void ntreeCompositExecTree(struct Scene *scene,
                            int do_previews,
                            const char *view_name);
 
+/**
+ * Called from render pipeline when a render job ends. Buffers the compositor kept between the
+ * frames of the job are freed, images and clips may change before the next one.
+ */
+void ntreeCompositClearCaches(void);
+
 /**
  * Called from render pipeline, to tag render input and output.
  * need to do all scenes, to prevent errors when you re-render 1 scene.
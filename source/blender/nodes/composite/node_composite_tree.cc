@@ -219,6 +219,13 @@ void ntreeCompositExecTree(Scene *scene,
   UNUSED_VARS(do_preview);
 }
 
+void ntreeCompositClearCaches()
+{
+#ifdef WITH_COMPOSITOR_CPU
+  COM_clear_caches();
+#endif
+}
+
 /* *********************************************** */
 
 void ntreeCompositUpdateRLayers(bNodeTree *ntree)
@@ -314,6 +314,7 @@ void RE_GetViewPlane(struct Render *re, rctf *r_viewplane, rcti *r_disprect);
 
 /**
  * Set the render threads based on the command-line and auto-threads setting.
+ * OpenEXR files are compressed and decompressed with the same number of threads.
  */
 void RE_init_threadcount(Render *re);
 
@@ -377,8 +378,13 @@ void RE_PreviewRender(struct Render *re, struct Main *bmain, struct Scene *scene
 
 /**
  * Only the temp file!
+ * When \a layer_filter is given, only the render layers it accepts are read, the passes of other
+ * layers have no buffer.
  */
-bool RE_ReadRenderResult(struct Scene *scene, struct Scene *scenode);
+bool RE_ReadRenderResult(struct Scene *scene,
+                         struct Scene *scenode,
+                         bool (*layer_filter)(void *userdata, const char *layname),
+                         void *userdata);
 
 struct RenderResult *RE_MultilayerConvert(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
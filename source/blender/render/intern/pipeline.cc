@@ -71,6 +71,7 @@
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_metadata.h"
+#include "IMB_openexr.h"
 #include "PIL_time.h"
 
 #include "RE_engine.h"
@@ -1761,6 +1762,9 @@ static void render_pipeline_free(Render *re)
   /* Destroy the opengl context in the correct thread. */
   RE_gl_context_destroy(re);
 
+  /* Compositor buffers are only valid for the frames of this render. */
+  ntreeCompositClearCaches();
+
   /* In the case the engine did not mark tiles as finished (un-highlight, which could happen in the
    * case of cancelled render) ensure the storage is empty. */
   if (re->highlighted_tiles != nullptr) {
@@ -2415,7 +2419,10 @@ void RE_PreviewRender(Render *re, Main *bmain, Scene *sce)
 
 /* NOTE: repeated win/disprect calc... solve that nicer, also in compo. */
 
-bool RE_ReadRenderResult(Scene *scene, Scene *scenode)
+bool RE_ReadRenderResult(Scene *scene,
+                         Scene *scenode,
+                         bool (*layer_filter)(void *userdata, const char *layname),
+                         void *userdata)
 {
   Render *re;
   int winx, winy;
@@ -2452,7 +2459,7 @@ bool RE_ReadRenderResult(Scene *scene, Scene *scenode)
   re->scene = scene;
 
   BLI_rw_mutex_lock(&re->resultmutex, THREAD_LOCK_WRITE);
-  success = render_result_exr_file_cache_read(re);
+  success = render_result_exr_file_cache_read(re, layer_filter, userdata);
   BLI_rw_mutex_unlock(&re->resultmutex);
 
   render_result_uncrop(re);
@@ -2659,6 +2666,7 @@ bool RE_allow_render_generic_object(Object *ob)
 void RE_init_threadcount(Render *re)
 {
   re->r.threads = BKE_render_num_threads(&re->r);
+  IMB_exr_thread_count_set(re->r.threads);
 }
 
 /** \} */
@@ -726,7 +726,8 @@ RenderResult *render_result_new_from_exr(
       rpass->rectx = rectx;
       rpass->recty = recty;
 
-      if (rpass->channels >= 3) {
+      /* Passes that were not read from the file have no buffer. */
+      if (rpass->rect && rpass->channels >= 3) {
         IMB_colormanagement_transform(rpass->rect,
                                       rpass->rectx,
                                       rpass->recty,
@@ -984,7 +985,23 @@ void render_result_exr_file_cache_write(Render *re)
   BKE_image_render_write_exr(nullptr, rr, str, nullptr, true, nullptr, -1);
 }
 
-bool render_result_exr_file_cache_read(Render *re)
+struct ExrLayerFilterData {
+  bool (*layer_filter)(void *userdata, const char *layname);
+  void *userdata;
+};
+
+static bool render_result_exr_pass_filter(void *userdata,
+                                          const char *layname,
+                                          const char * /*passname*/,
+                                          const char * /*view*/)
+{
+  const ExrLayerFilterData *data = static_cast<const ExrLayerFilterData *>(userdata);
+  return data->layer_filter(data->userdata, layname);
+}
+
+bool render_result_exr_file_cache_read(Render *re,
+                                       bool (*layer_filter)(void *userdata, const char *layname),
+                                       void *userdata)
 {
   /* File path to cache. */
   char filepath[FILE_CACHE_MAX] = "";
@@ -1007,7 +1024,13 @@ bool render_result_exr_file_cache_read(Render *re)
   const char *colorspace = IMB_colormanagement_role_colorspace_name_get(COLOR_ROLE_SCENE_LINEAR);
   RE_FreeRenderResult(re->result);
 
-  IMB_exr_read_channels(exrhandle);
+  if (layer_filter) {
+    ExrLayerFilterData filter_data = {layer_filter, userdata};
+    IMB_exr_read_channels_filtered(exrhandle, render_result_exr_pass_filter, &filter_data);
+  }
+  else {
+    IMB_exr_read_channels(exrhandle);
+  }
   re->result = render_result_new_from_exr(exrhandle, colorspace, false, rectx, recty);
 
   IMB_exr_close(exrhandle);
@@ -105,8 +105,11 @@ int render_result_exr_file_read_path(struct RenderResult *rr,
 void render_result_exr_file_cache_write(struct Render *re);
 /**
  * For cache, makes exact copy of render result.
+ * Only the layers accepted by \a layer_filter are read when it is given.
  */
-bool render_result_exr_file_cache_read(struct Render *re);
+bool render_result_exr_file_cache_read(struct Render *re,
+                                       bool (*layer_filter)(void *userdata, const char *layname),
+                                       void *userdata);
 
 /* Combined Pixel Rect */
 
@@ -54,6 +54,12 @@ void SEQ_modifier_clear(struct Sequence *seq);
 void SEQ_modifier_free(struct SequenceModifierData *smd);
 void SEQ_modifier_unique_name(struct Sequence *seq, struct SequenceModifierData *smd);
 struct SequenceModifierData *SEQ_modifier_find_by_name(struct Sequence *seq, const char *name);
+/**
+ * Apply modifiers of \a seq to \a ibuf. Takes ownership of \a ibuf, which is modified in place
+ * when it has no other users.
+ *
+ * \return The modified image, which can be \a ibuf itself.
+ */
 struct ImBuf *SEQ_modifier_apply_stack(const struct SeqRenderData *context,
                                        struct Sequence *seq,
                                        struct ImBuf *ibuf,
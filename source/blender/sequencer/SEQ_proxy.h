@@ -32,6 +32,14 @@ void SEQ_proxy_rebuild(struct SeqIndexBuildContext *context,
                        short *stop,
                        short *do_update,
                        float *progress);
+/**
+ * Rebuild proxies of all #SeqIndexBuildContext in the queue, multiple movies are built in
+ * parallel.
+ */
+void SEQ_proxy_rebuild_list(struct ListBase *queue,
+                            short *stop,
+                            short *do_update,
+                            float *progress);
 void SEQ_proxy_rebuild_finish(struct SeqIndexBuildContext *context, bool stop);
 void SEQ_proxy_set(struct Sequence *seq, bool value);
 bool SEQ_can_use_proxy(const struct SeqRenderData *context, struct Sequence *seq, int psize);
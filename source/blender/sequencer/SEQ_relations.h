@@ -62,6 +62,15 @@ void SEQ_cache_iterate(
     void *userdata,
     bool callback_init(void *userdata, size_t item_count),
     bool callback_iter(void *userdata, struct Sequence *seq, int timeline_frame, int cache_type));
+
+typedef struct SeqCacheStats {
+  /** Number of compressed images and their size before and after compression. */
+  int compressed_count;
+  size_t compressed_size_raw;
+  size_t compressed_size;
+} SeqCacheStats;
+
+void SEQ_cache_stats_get(struct Scene *scene, SeqCacheStats *r_stats);
 /**
  * Return immediate parent meta of sequence.
  */
@@ -21,6 +21,7 @@ struct rctf;
 
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
+  /* Prefetch workers use consecutive IDs starting at this one. Must be last. */
   SEQ_TASK_PREFETCH_RENDER,
 } eSeqTaskId;
 
@@ -126,6 +127,10 @@ void SEQ_render_pixel_from_sequencer_space_v4(struct Scene *scene, float pixel[4
  * This function also checks `SeqTimelineChannel` flag.
  */
 bool SEQ_render_is_muted(const struct ListBase *channels, const struct Sequence *seq);
+/**
+ * Free pixels kept for reuse by sequencer rendering.
+ */
+void SEQ_render_imbuf_pool_free(void);
 
 #ifdef __cplusplus
 }
@@ -5,12 +5,22 @@
  * \ingroup sequencer
  */
 
+#include <fcntl.h>
 #include <memory.h>
 #include <stddef.h>
 #include <time.h>
+#ifdef WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+#include <zstd.h>
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "DNA_scene_types.h"
 #include "DNA_sequence_types.h"
 #include "DNA_space_types.h" /* for FILE_MAX. */
@@ -27,6 +37,7 @@
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
 #include "BLI_path_util.h"
 #include "BLI_threads.h"
 
@@ -50,22 +61,41 @@
  *
  * Disk cache uses directory specified in user preferences
  * For each cached non-temp image, image data and supplementary info are written to HDD.
- * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
- * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
- * Images are written in order in which they are rendered.
- * Overwriting of individual entry is not possible.
- * Stored images are deleted by invalidation, or when size of all files exceeds maximum
- * size specified in user preferences.
+ * Images of a strip with the same cache type, resolution and view form a stream. Stream is
+ * stored in segment files, which are preallocated to their full size when created, so images
+ * can be appended without growing the file. Each segment starts with header DiskCacheHeader,
+ * which is persistent index of images in the segment, followed by image data.
+ * Zstd compression with user definable level can be used to compress image data (per image).
+ *
+ * Segments are memory-mapped for reading. Headers of all segments of a stream are loaded into
+ * in-memory index when the stream is accessed first time, so looking up an image does not touch
+ * the disk. Readers hold read lock only while looking up the index, image data is copied from
+ * the mapping without locking, so multiple images can be read in parallel.
+ *
+ * Images are written by background thread in order in which they are rendered. Size of the
+ * write queue is limited, so thread producing images only waits when disk can't keep up.
+ * Image data is written before its header entry, and the entry is added to the index only after
+ * that, so readers never see incomplete data.
+ *
+ * Segments are append only, overwriting of individual entry is not possible.
+ * Entries are removed by invalidation, segments without entries are deleted. When size of all
+ * segments exceeds maximum size specified in user preferences, least recently used segments are
+ * deleted. Segments are reference counted, so they can be deleted while being read.
  * To distinguish 2 blend files with same name, scene->ed->disk_cache_timestamp
  * is used as UID. Blend file can still be copied manually which may cause conflict.
  */
 
-/* Format string:
- * `<cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf`. */
-#define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
-#define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 2
+/* Format string: `<cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)`. */
+#define DCACHE_STREAM_FORMAT "%d-%dx%d-%d%%(%d)"
+/* Format string: `<stream>-<segment no>.dcs`. */
+#define DCACHE_FNAME_FORMAT DCACHE_STREAM_FORMAT "-%d.dcs"
+#define DCACHE_IMAGES_PER_SEGMENT 64
+/* Segment is sized to fit half of #DCACHE_IMAGES_PER_SEGMENT images without compression. */
+#define DCACHE_SEGMENT_SIZE_MIN ((size_t)64 * 1024 * 1024)
+#define DCACHE_SEGMENT_SIZE_MAX ((size_t)1024 * 1024 * 1024)
+/* Size of images waiting to be written, after which thread storing images has to wait. */
+#define DCACHE_WRITE_QUEUE_SIZE_MAX ((size_t)512 * 1024 * 1024)
+#define DCACHE_CURRENT_VERSION 3
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in IMB intern. */
 
 typedef struct DiskCacheHeaderEntry {
@@ -78,32 +108,83 @@ typedef struct DiskCacheHeaderEntry {
 } DiskCacheHeaderEntry;
 
 typedef struct DiskCacheHeader {
-  DiskCacheHeaderEntry entry[DCACHE_IMAGES_PER_FILE];
+  DiskCacheHeaderEntry entry[DCACHE_IMAGES_PER_SEGMENT];
 } DiskCacheHeader;
 
-typedef struct SeqDiskCache {
-  Main *bmain;
-  int64_t timestamp;
-  ListBase files;
-  ThreadMutex read_write_mutex;
-  size_t size_total;
-} SeqDiskCache;
-
-typedef struct DiskCacheFile {
-  struct DiskCacheFile *next, *prev;
-  char path[FILE_MAX];
+typedef struct DiskCacheStreamID {
   char dir[FILE_MAXDIR];
-  char file[FILE_MAX];
-  BLI_stat_t fstat;
   int cache_type;
   int rectx;
   int recty;
   int render_size;
   int view_id;
-  int start_frame;
-} DiskCacheFile;
+} DiskCacheStreamID;
+
+typedef struct DiskCacheStream {
+  DiskCacheStreamID id;
+  /* Key in #SeqDiskCache.streams, `<dir>/DCACHE_STREAM_FORMAT`. */
+  char key[FILE_MAX];
+  /* Frame index -> #DiskCacheSegment. Only valid when stream is loaded. */
+  GHash *frames;
+  /* Segment to which new images are appended. */
+  struct DiskCacheSegment *active;
+  int segment_count;
+  bool loaded;
+} DiskCacheStream;
+
+typedef struct DiskCacheSegment {
+  struct DiskCacheSegment *next, *prev;
+  char path[FILE_MAX];
+  DiskCacheStream *stream;
+  int index;
+  /* Preallocated size of the file. Space after #data_end is not written, so it is not counted in
+   * #SeqDiskCache.size_total. */
+  size_t capacity;
+  int64_t last_used;
+  DiskCacheHeader header;
+  bool header_loaded;
+  /* End of image data written to segment. */
+  uint64_t data_end;
+  BLI_mmap_file *mmap;
+  /* Segment is held by cache index and by threads reading from it. */
+  int users;
+  /* File is deleted when last user releases the segment. */
+  bool removed;
+} DiskCacheSegment;
+
+typedef struct DiskCacheWriteJob {
+  struct DiskCacheWriteJob *next, *prev;
+  DiskCacheStreamID id;
+  int frame_index;
+  ImBuf *ibuf;
+  size_t size_raw;
+} DiskCacheWriteJob;
 
-static ThreadMutex cache_create_lock = BLI_MUTEX_INITIALIZER;
+typedef struct SeqDiskCache {
+  Main *bmain;
+  int64_t timestamp;
+  /* All segments in cache directory, including ones from other projects. */
+  ListBase segments;
+  /* Stream key -> #DiskCacheStream. */
+  GHash *streams;
+  /* Protects segments and streams. Image data is read without holding the lock. */
+  ThreadRWMutex index_lock;
+  /* Image data and headers written to segments. */
+  size_t size_total;
+  /* Images written while cache was invalidated are discarded. */
+  int invalidate_count;
+
+  /* Background writing. */
+  ThreadMutex queue_mutex;
+  ThreadCondition queue_cond;
+  ListBase threads;
+  ListBase write_queue;
+  size_t write_queue_size;
+  /* Job being written, images can still be read from it. */
+  DiskCacheWriteJob *writing_job;
+  bool writer_running;
+  bool stop;
+} SeqDiskCache;
 
 static char *seq_disk_cache_base_dir(void)
 {
@@ -136,200 +217,488 @@ bool seq_disk_cache_is_enabled(Main *bmain)
           bmain->filepath[0] != '\0');
 }
 
-static DiskCacheFile *seq_disk_cache_add_file_to_list(SeqDiskCache *disk_cache, const char *path)
+/* Path format:
+ * <cache dir>/<project name>_seq_cache/<scene name>-<timestamp>/<seq name>/DCACHE_FNAME_FORMAT
+ */
+
+static void seq_disk_cache_get_project_dir(SeqDiskCache *disk_cache, char *path, size_t path_len)
+{
+  char cache_dir[FILE_MAX];
+  BLI_split_file_part(BKE_main_blendfile_path(disk_cache->bmain), cache_dir, sizeof(cache_dir));
+  /* Use suffix, so that the cache directory name does not conflict with the bmain's blend file. */
+  const char *suffix = "_seq_cache";
+  strncat(cache_dir, suffix, sizeof(cache_dir) - strlen(cache_dir) - 1);
+  BLI_strncpy(path, seq_disk_cache_base_dir(), path_len);
+  BLI_path_append(path, path_len, cache_dir);
+}
+
+static void seq_disk_cache_get_dir(
+    SeqDiskCache *disk_cache, Scene *scene, Sequence *seq, char *path, size_t path_len)
 {
+  char scene_name[MAX_ID_NAME + 22]; /* + -%PRId64 */
+  char seq_name[SEQ_NAME_MAXSTR];
+  char project_dir[FILE_MAX];
 
-  DiskCacheFile *cache_file = MEM_callocN(sizeof(DiskCacheFile), "SeqDiskCacheFile");
-  char dir[FILE_MAXDIR], file[FILE_MAX];
-  BLI_split_dirfile(path, dir, file, sizeof(dir), sizeof(file));
-  BLI_strncpy(cache_file->path, path, sizeof(cache_file->path));
-  BLI_strncpy(cache_file->dir, dir, sizeof(cache_file->dir));
-  BLI_strncpy(cache_file->file, file, sizeof(cache_file->file));
-  sscanf(file,
-         DCACHE_FNAME_FORMAT,
-         &cache_file->cache_type,
-         &cache_file->rectx,
-         &cache_file->recty,
-         &cache_file->render_size,
-         &cache_file->view_id,
-         &cache_file->start_frame);
-  cache_file->start_frame *= DCACHE_IMAGES_PER_FILE;
-  BLI_addtail(&disk_cache->files, cache_file);
-  return cache_file;
+  seq_disk_cache_get_project_dir(disk_cache, project_dir, sizeof(project_dir));
+  sprintf(scene_name, "%s-%" PRId64, scene->id.name, disk_cache->timestamp);
+  BLI_strncpy(seq_name, seq->name, sizeof(seq_name));
+  BLI_filename_make_safe(scene_name);
+  BLI_filename_make_safe(seq_name);
+  BLI_strncpy(path, project_dir, path_len);
+  BLI_path_append(path, path_len, scene_name);
+  BLI_path_append(path, path_len, seq_name);
+  BLI_path_slash_ensure(path);
 }
 
-static void seq_disk_cache_get_files(SeqDiskCache *disk_cache, char *path)
+static void seq_disk_cache_get_stream_id(SeqDiskCache *disk_cache,
+                                         const SeqCacheKey *key,
+                                         DiskCacheStreamID *r_id)
 {
-  struct direntry *filelist, *fl;
-  uint i;
-  disk_cache->size_total = 0;
+  seq_disk_cache_get_dir(disk_cache, key->context.scene, key->seq, r_id->dir, sizeof(r_id->dir));
+  r_id->cache_type = key->type;
+  r_id->rectx = key->context.rectx;
+  r_id->recty = key->context.recty;
+  r_id->render_size = key->context.preview_render_size;
+  r_id->view_id = key->context.view_id;
+}
 
-  const int filelist_num = BLI_filelist_dir_contents(path, &filelist);
-  i = filelist_num;
-  fl = filelist;
-  while (i--) {
-    /* Don't follow links. */
-    const eFileAttributes file_attrs = BLI_file_attributes(fl->path);
-    if (file_attrs & FILE_ATTR_ANY_LINK) {
-      fl++;
-      continue;
+static bool seq_disk_cache_stream_id_equals(const DiskCacheStreamID *a, const DiskCacheStreamID *b)
+{
+  return a->cache_type == b->cache_type && a->rectx == b->rectx && a->recty == b->recty &&
+         a->render_size == b->render_size && a->view_id == b->view_id && STREQ(a->dir, b->dir);
+}
+
+static void seq_disk_cache_get_stream_key(const DiskCacheStreamID *id, char *key, size_t key_len)
+{
+  BLI_snprintf(key,
+               key_len,
+               "%s" DCACHE_STREAM_FORMAT,
+               id->dir,
+               id->cache_type,
+               id->rectx,
+               id->recty,
+               id->render_size,
+               id->view_id);
+}
+
+static void seq_disk_cache_get_segment_path(const DiskCacheStreamID *id,
+                                            int index,
+                                            char *path,
+                                            size_t path_len)
+{
+  BLI_snprintf(path,
+               path_len,
+               "%s" DCACHE_FNAME_FORMAT,
+               id->dir,
+               id->cache_type,
+               id->rectx,
+               id->recty,
+               id->render_size,
+               id->view_id,
+               index);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Segments
+ * \{ */
+
+static DiskCacheStream *seq_disk_cache_stream_find(SeqDiskCache *disk_cache,
+                                                   const DiskCacheStreamID *id)
+{
+  char key[FILE_MAX];
+  seq_disk_cache_get_stream_key(id, key, sizeof(key));
+  return BLI_ghash_lookup(disk_cache->streams, key);
+}
+
+static DiskCacheStream *seq_disk_cache_stream_ensure(SeqDiskCache *disk_cache,
+                                                     const DiskCacheStreamID *id)
+{
+  DiskCacheStream *stream = seq_disk_cache_stream_find(disk_cache, id);
+  if (stream == NULL) {
+    stream = MEM_callocN(sizeof(DiskCacheStream), "SeqDiskCacheStream");
+    stream->id = *id;
+    seq_disk_cache_get_stream_key(id, stream->key, sizeof(stream->key));
+    BLI_ghash_insert(disk_cache->streams, stream->key, stream);
+  }
+  return stream;
+}
+
+static void seq_disk_cache_stream_free(void *stream_v)
+{
+  DiskCacheStream *stream = stream_v;
+  if (stream->frames) {
+    BLI_ghash_free(stream->frames, NULL, NULL);
+  }
+  MEM_freeN(stream);
+}
+
+static BLI_mmap_file *seq_disk_cache_mmap_open(const char *path)
+{
+  const int file = BLI_open(path, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return NULL;
+  }
+
+  BLI_mmap_file *mmap_file = BLI_mmap_open(file);
+  /* Mapping stays valid after the file is closed. */
+  close(file);
+  return mmap_file;
+}
+
+static DiskCacheSegment *seq_disk_cache_segment_add(SeqDiskCache *disk_cache,
+                                                    DiskCacheStream *stream,
+                                                    int index,
+                                                    const char *path,
+                                                    size_t capacity,
+                                                    uint64_t data_end,
+                                                    int64_t last_used)
+{
+  DiskCacheSegment *segment = MEM_callocN(sizeof(DiskCacheSegment), "SeqDiskCacheSegment");
+  BLI_strncpy(segment->path, path, sizeof(segment->path));
+  segment->stream = stream;
+  segment->index = index;
+  segment->capacity = capacity;
+  segment->data_end = data_end;
+  segment->last_used = last_used;
+  segment->users = 1;
+  stream->segment_count = max_ii(stream->segment_count, index + 1);
+  BLI_addtail(&disk_cache->segments, segment);
+  disk_cache->size_total += data_end;
+  return segment;
+}
+
+static void seq_disk_cache_segment_unref(DiskCacheSegment *segment)
+{
+  if (atomic_sub_and_fetch_int32(&segment->users, 1) != 0) {
+    return;
+  }
+
+  if (segment->mmap) {
+    BLI_mmap_free(segment->mmap);
+  }
+  if (segment->removed) {
+    BLI_delete(segment->path, false, false);
+  }
+  MEM_freeN(segment);
+}
+
+static bool seq_disk_cache_entry_is_used(const DiskCacheHeaderEntry *entry)
+{
+  return entry->size_compressed != 0;
+}
+
+static int seq_disk_cache_get_header_entry(const DiskCacheHeader *header, int frame_index)
+{
+  for (int i = 0; i < DCACHE_IMAGES_PER_SEGMENT; i++) {
+    if (seq_disk_cache_entry_is_used(&header->entry[i]) &&
+        (int)header->entry[i].frameno == frame_index) {
+      return i;
     }
+  }
 
-    char file[FILE_MAX];
-    BLI_split_dirfile(fl->path, NULL, file, 0, sizeof(file));
+  return -1;
+}
 
-    bool is_dir = BLI_is_dir(fl->path);
-    if (is_dir && !FILENAME_IS_CURRPAR(file)) {
-      char subpath[FILE_MAX];
-      BLI_strncpy(subpath, fl->path, sizeof(subpath));
-      BLI_path_slash_ensure(subpath);
-      seq_disk_cache_get_files(disk_cache, subpath);
+static int seq_disk_cache_get_free_header_entry(const DiskCacheHeader *header)
+{
+  for (int i = 0; i < DCACHE_IMAGES_PER_SEGMENT; i++) {
+    if (!seq_disk_cache_entry_is_used(&header->entry[i])) {
+      return i;
     }
+  }
+
+  return -1;
+}
 
-    if (!is_dir) {
-      const char *ext = BLI_path_extension(fl->path);
-      if (ext && ext[1] == 'd' && ext[2] == 'c' && ext[3] == 'f') {
-        DiskCacheFile *cache_file = seq_disk_cache_add_file_to_list(disk_cache, fl->path);
-        cache_file->fstat = fl->s;
-        disk_cache->size_total += cache_file->fstat.st_size;
+/* Remove segment from cache, its file is deleted once it is not being read anymore.
+ * Must be called with index locked for writing. */
+static void seq_disk_cache_segment_remove(SeqDiskCache *disk_cache, DiskCacheSegment *segment)
+{
+  DiskCacheStream *stream = segment->stream;
+
+  if (segment->header_loaded) {
+    for (int i = 0; i < DCACHE_IMAGES_PER_SEGMENT; i++) {
+      const DiskCacheHeaderEntry *entry = &segment->header.entry[i];
+      void *frame_key = POINTER_FROM_INT((int)entry->frameno);
+      if (seq_disk_cache_entry_is_used(entry) &&
+          BLI_ghash_lookup(stream->frames, frame_key) == segment) {
+        BLI_ghash_remove(stream->frames, frame_key, NULL, NULL);
       }
     }
-    fl++;
   }
-  BLI_filelist_free(filelist, filelist_num);
+
+  if (stream->active == segment) {
+    stream->active = NULL;
+  }
+
+  disk_cache->size_total -= segment->data_end;
+  BLI_remlink(&disk_cache->segments, segment);
+  segment->removed = true;
+  seq_disk_cache_segment_unref(segment);
 }
 
-static DiskCacheFile *seq_disk_cache_get_oldest_file(SeqDiskCache *disk_cache)
+static bool seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
 {
-  DiskCacheFile *oldest_file = disk_cache->files.first;
-  if (oldest_file == NULL) {
-    return NULL;
+  BLI_fseek(file, 0LL, SEEK_SET);
+  const size_t num_items_read = fread(header, sizeof(*header), 1, file);
+  if (num_items_read < 1) {
+    BLI_assert_msg(0, "unable to read disk cache header");
+    perror("unable to read disk cache header");
+    return false;
   }
-  for (DiskCacheFile *cache_file = oldest_file->next; cache_file; cache_file = cache_file->next) {
-    if (cache_file->fstat.st_mtime < oldest_file->fstat.st_mtime) {
-      oldest_file = cache_file;
+
+  for (int i = 0; i < DCACHE_IMAGES_PER_SEGMENT; i++) {
+    if ((ENDIAN_ORDER == B_ENDIAN) && header->entry[i].encoding == 0) {
+      BLI_endian_switch_uint64(&header->entry[i].frameno);
+      BLI_endian_switch_uint64(&header->entry[i].offset);
+      BLI_endian_switch_uint64(&header->entry[i].size_compressed);
+      BLI_endian_switch_uint64(&header->entry[i].size_raw);
     }
   }
 
-  return oldest_file;
+  return true;
 }
 
-static void seq_disk_cache_delete_file(SeqDiskCache *disk_cache, DiskCacheFile *file)
+/* End of image data of all entries in the header. */
+static uint64_t seq_disk_cache_header_data_end(const DiskCacheHeader *header)
 {
-  disk_cache->size_total -= file->fstat.st_size;
-  BLI_delete(file->path, false, false);
-  BLI_remlink(&disk_cache->files, file);
-  MEM_freeN(file);
+  uint64_t data_end = sizeof(DiskCacheHeader);
+  for (int i = 0; i < DCACHE_IMAGES_PER_SEGMENT; i++) {
+    const DiskCacheHeaderEntry *entry = &header->entry[i];
+    if (seq_disk_cache_entry_is_used(entry)) {
+      data_end = MAX2(data_end, entry->offset + entry->size_compressed);
+    }
+  }
+  return data_end;
 }
 
-bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
+static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
 {
-  BLI_mutex_lock(&disk_cache->read_write_mutex);
-  while (disk_cache->size_total > seq_disk_cache_size_limit()) {
-    DiskCacheFile *oldest_file = seq_disk_cache_get_oldest_file(disk_cache);
+  BLI_fseek(file, 0LL, SEEK_SET);
+  return fwrite(header, sizeof(*header), 1, file);
+}
 
-    if (!oldest_file) {
-      /* We shouldn't enforce limits with no files, do re-scan. */
-      seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
-      continue;
-    }
+static bool seq_disk_cache_write_header_entry(FILE *file,
+                                              const DiskCacheHeaderEntry *entry,
+                                              int index)
+{
+  BLI_fseek(file, offsetof(DiskCacheHeader, entry) + sizeof(*entry) * index, SEEK_SET);
+  return fwrite(entry, sizeof(*entry), 1, file) == 1 && fflush(file) == 0;
+}
 
-    if (BLI_exists(oldest_file->path) == 0) {
-      /* File may have been manually deleted during runtime, do re-scan. */
-      BLI_freelistN(&disk_cache->files);
-      seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
-      continue;
+static void seq_disk_cache_segment_add_from_file(SeqDiskCache *disk_cache,
+                                                 const char *path,
+                                                 const BLI_stat_t *fstat)
+{
+  DiskCacheStreamID id;
+  char file[FILE_MAX];
+  int index;
+  BLI_split_dirfile(path, id.dir, file, sizeof(id.dir), sizeof(file));
+  if (sscanf(file,
+             DCACHE_FNAME_FORMAT,
+             &id.cache_type,
+             &id.rectx,
+             &id.recty,
+             &id.render_size,
+             &id.view_id,
+             &index) != 6) {
+    return;
+  }
+
+  /* Only count written data, the rest of preallocated segments doesn't use disk space. The whole
+   * file is counted when its header can't be read, it is removed once the stream is loaded. */
+  uint64_t data_end = fstat->st_size;
+  FILE *fp = BLI_fopen(path, "rb");
+  if (fp) {
+    DiskCacheHeader header;
+    if (seq_disk_cache_read_header(fp, &header)) {
+      data_end = seq_disk_cache_header_data_end(&header);
     }
+    fclose(fp);
+  }
+
+  DiskCacheStream *stream = seq_disk_cache_stream_ensure(disk_cache, &id);
+  seq_disk_cache_segment_add(
+      disk_cache, stream, index, path, fstat->st_size, data_end, fstat->st_mtime);
+}
 
-    seq_disk_cache_delete_file(disk_cache, oldest_file);
+static bool seq_disk_cache_segment_load(SeqDiskCache *disk_cache, DiskCacheSegment *segment)
+{
+  FILE *file = BLI_fopen(segment->path, "rb");
+  if (!file) {
+    return false;
+  }
+
+  const bool header_read = seq_disk_cache_read_header(file, &segment->header);
+  fclose(file);
+  if (!header_read) {
+    return false;
+  }
+
+  segment->mmap = seq_disk_cache_mmap_open(segment->path);
+  if (segment->mmap == NULL) {
+    return false;
   }
-  BLI_mutex_unlock(&disk_cache->read_write_mutex);
 
+  /* File may have changed since it was found in the cache directory. */
+  const uint64_t data_end = seq_disk_cache_header_data_end(&segment->header);
+  disk_cache->size_total += data_end - segment->data_end;
+  segment->data_end = data_end;
+  segment->header_loaded = true;
   return true;
 }
 
-static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_cache, char *path)
+/* Read headers of all segments of the stream into the index.
+ * Must be called with index locked for writing. */
+static void seq_disk_cache_stream_load(SeqDiskCache *disk_cache, DiskCacheStream *stream)
 {
-  DiskCacheFile *cache_file = disk_cache->files.first;
+  if (stream->loaded) {
+    return;
+  }
 
-  for (; cache_file; cache_file = cache_file->next) {
-    if (BLI_strcasecmp(cache_file->path, path) == 0) {
-      return cache_file;
+  stream->frames = BLI_ghash_int_new(__func__);
+  stream->loaded = true;
+
+  LISTBASE_FOREACH_MUTABLE (DiskCacheSegment *, segment, &disk_cache->segments) {
+    if (segment->stream != stream) {
+      continue;
     }
-  }
 
-  return NULL;
+    if (!seq_disk_cache_segment_load(disk_cache, segment)) {
+      seq_disk_cache_segment_remove(disk_cache, segment);
+      continue;
+    }
+
+    for (int i = 0; i < DCACHE_IMAGES_PER_SEGMENT; i++) {
+      const DiskCacheHeaderEntry *entry = &segment->header.entry[i];
+      if (seq_disk_cache_entry_is_used(entry)) {
+        BLI_ghash_reinsert(
+            stream->frames, POINTER_FROM_INT((int)entry->frameno), segment, NULL, NULL);
+      }
+    }
+
+    if (stream->active == NULL || segment->index > stream->active->index) {
+      stream->active = segment;
+    }
+  }
 }
 
-/* Update file size and timestamp. */
-static void seq_disk_cache_update_file(SeqDiskCache *disk_cache, char *path)
+/* Create preallocated segment, so it can be mapped once and images are appended without growing
+ * the file. Must be called with index locked for writing. */
+static DiskCacheSegment *seq_disk_cache_segment_create(SeqDiskCache *disk_cache,
+                                                       DiskCacheStream *stream,
+                                                       size_t image_size)
 {
-  DiskCacheFile *cache_file;
-  int64_t size_before;
-  int64_t size_after;
+  char filepath[FILE_MAX];
+  const int index = stream->segment_count;
+  seq_disk_cache_get_segment_path(&stream->id, index, filepath, sizeof(filepath));
+
+  size_t capacity = image_size * (DCACHE_IMAGES_PER_SEGMENT / 2);
+  CLAMP(capacity, DCACHE_SEGMENT_SIZE_MIN, DCACHE_SEGMENT_SIZE_MAX);
+  capacity = sizeof(DiskCacheHeader) + max_zz(capacity, image_size);
+
+  BLI_make_existing_file(filepath);
+  FILE *file = BLI_fopen(filepath, "wb");
+  if (!file) {
+    return NULL;
+  }
 
-  cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, path);
-  size_before = cache_file->fstat.st_size;
+  DiskCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  bool ok = seq_disk_cache_write_header(file, &header) == 1 &&
+            BLI_fseek(file, capacity - 1, SEEK_SET) == 0 && fputc(0, file) != EOF;
+  ok &= fclose(file) == 0;
 
-  if (BLI_stat(path, &cache_file->fstat) == -1) {
-    BLI_assert(false);
-    memset(&cache_file->fstat, 0, sizeof(BLI_stat_t));
+  BLI_mmap_file *mmap_file = ok ? seq_disk_cache_mmap_open(filepath) : NULL;
+  if (mmap_file == NULL) {
+    BLI_delete(filepath, false, false);
+    return NULL;
   }
 
-  size_after = cache_file->fstat.st_size;
-  disk_cache->size_total += size_after - size_before;
+  DiskCacheSegment *segment = seq_disk_cache_segment_add(
+      disk_cache, stream, index, filepath, capacity, sizeof(DiskCacheHeader), time(NULL));
+  segment->header = header;
+  segment->header_loaded = true;
+  segment->mmap = mmap_file;
+  return segment;
 }
 
-/* Path format:
- * <cache dir>/<project name>_seq_cache/<scene name>-<timestamp>/<seq name>/DCACHE_FNAME_FORMAT
- */
-
-static void seq_disk_cache_get_project_dir(SeqDiskCache *disk_cache, char *path, size_t path_len)
+/* Get segment with enough space for image of given size.
+ * Must be called with index locked for writing. */
+static DiskCacheSegment *seq_disk_cache_segment_get_for_write(SeqDiskCache *disk_cache,
+                                                              DiskCacheStream *stream,
+                                                              size_t image_size)
 {
-  char cache_dir[FILE_MAX];
-  BLI_split_file_part(BKE_main_blendfile_path(disk_cache->bmain), cache_dir, sizeof(cache_dir));
-  /* Use suffix, so that the cache directory name does not conflict with the bmain's blend file. */
-  const char *suffix = "_seq_cache";
-  strncat(cache_dir, suffix, sizeof(cache_dir) - strlen(cache_dir) - 1);
-  BLI_strncpy(path, seq_disk_cache_base_dir(), path_len);
-  BLI_path_append(path, path_len, cache_dir);
+  DiskCacheSegment *segment = stream->active;
+  if (segment && segment->data_end + image_size <= segment->capacity &&
+      seq_disk_cache_get_free_header_entry(&segment->header) != -1) {
+    return segment;
+  }
+
+  stream->active = seq_disk_cache_segment_create(disk_cache, stream, image_size);
+  return stream->active;
 }
 
-static void seq_disk_cache_get_dir(
-    SeqDiskCache *disk_cache, Scene *scene, Sequence *seq, char *path, size_t path_len)
+static DiskCacheSegment *seq_disk_cache_get_oldest_segment(SeqDiskCache *disk_cache)
 {
-  char scene_name[MAX_ID_NAME + 22]; /* + -%PRId64 */
-  char seq_name[SEQ_NAME_MAXSTR];
-  char project_dir[FILE_MAX];
+  DiskCacheSegment *oldest_segment = disk_cache->segments.first;
+  if (oldest_segment == NULL) {
+    return NULL;
+  }
+  LISTBASE_FOREACH (DiskCacheSegment *, segment, &disk_cache->segments) {
+    if (segment->last_used < oldest_segment->last_used) {
+      oldest_segment = segment;
+    }
+  }
 
-  seq_disk_cache_get_project_dir(disk_cache, project_dir, sizeof(project_dir));
-  sprintf(scene_name, "%s-%" PRId64, scene->id.name, disk_cache->timestamp);
-  BLI_strncpy(seq_name, seq->name, sizeof(seq_name));
-  BLI_filename_make_safe(scene_name);
-  BLI_filename_make_safe(seq_name);
-  BLI_strncpy(path, project_dir, path_len);
-  BLI_path_append(path, path_len, scene_name);
-  BLI_path_append(path, path_len, seq_name);
+  return oldest_segment;
 }
 
-static void seq_disk_cache_get_file_path(SeqDiskCache *disk_cache,
-                                         SeqCacheKey *key,
-                                         char *path,
-                                         size_t path_len)
+/* Must be called with index locked for writing. */
+static void seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
 {
-  seq_disk_cache_get_dir(disk_cache, key->context.scene, key->seq, path, path_len);
-  int frameno = (int)key->frame_index / DCACHE_IMAGES_PER_FILE;
-  char cache_filename[FILE_MAXFILE];
-  sprintf(cache_filename,
-          DCACHE_FNAME_FORMAT,
-          key->type,
-          key->context.rectx,
-          key->context.recty,
-          key->context.preview_render_size,
-          key->context.view_id,
-          frameno);
+  while (disk_cache->size_total > seq_disk_cache_size_limit()) {
+    DiskCacheSegment *oldest_segment = seq_disk_cache_get_oldest_segment(disk_cache);
+    if (oldest_segment == NULL) {
+      break;
+    }
+    seq_disk_cache_segment_remove(disk_cache, oldest_segment);
+  }
+}
+
+static void seq_disk_cache_get_files(SeqDiskCache *disk_cache, char *path)
+{
+  struct direntry *filelist, *fl;
+  uint i;
+
+  const int filelist_num = BLI_filelist_dir_contents(path, &filelist);
+  i = filelist_num;
+  fl = filelist;
+  while (i--) {
+    /* Don't follow links. */
+    const eFileAttributes file_attrs = BLI_file_attributes(fl->path);
+    if (file_attrs & FILE_ATTR_ANY_LINK) {
+      fl++;
+      continue;
+    }
+
+    char file[FILE_MAX];
+    BLI_split_dirfile(fl->path, NULL, file, 0, sizeof(file));
 
-  BLI_path_append(path, path_len, cache_filename);
+    bool is_dir = BLI_is_dir(fl->path);
+    if (is_dir && !FILENAME_IS_CURRPAR(file)) {
+      char subpath[FILE_MAX];
+      BLI_strncpy(subpath, fl->path, sizeof(subpath));
+      BLI_path_slash_ensure(subpath);
+      seq_disk_cache_get_files(disk_cache, subpath);
+    }
+
+    if (!is_dir && BLI_path_extension_check(fl->path, ".dcs")) {
+      seq_disk_cache_segment_add_from_file(disk_cache, fl->path, &fl->s);
+    }
+    fl++;
+  }
+  BLI_filelist_free(filelist, filelist_num);
 }
 
 static void seq_disk_cache_create_version_file(char *path)
@@ -374,30 +743,70 @@ static void seq_disk_cache_handle_versioning(SeqDiskCache *disk_cache)
   }
 }
 
-static void seq_disk_cache_delete_invalid_files(SeqDiskCache *disk_cache,
-                                                Scene *scene,
-                                                Sequence *seq,
-                                                int invalidate_types,
-                                                int range_start,
-                                                int range_end)
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Invalidation
+ * \{ */
+
+static bool seq_disk_cache_is_invalid(const DiskCacheStreamID *id,
+                                      int frame_index,
+                                      Sequence *seq,
+                                      const char *dir,
+                                      int invalidate_types,
+                                      int range_start,
+                                      int range_end)
 {
-  DiskCacheFile *next_file, *cache_file = disk_cache->files.first;
-  char cache_dir[FILE_MAX];
-  seq_disk_cache_get_dir(disk_cache, scene, seq, cache_dir, sizeof(cache_dir));
-  BLI_path_slash_ensure(cache_dir);
-
-  while (cache_file) {
-    next_file = cache_file->next;
-    if (cache_file->cache_type & invalidate_types) {
-      if (STREQ(cache_dir, cache_file->dir)) {
-        int timeline_frame_start = seq_cache_frame_index_to_timeline_frame(
-            seq, cache_file->start_frame);
-        if (timeline_frame_start > range_start && timeline_frame_start <= range_end) {
-          seq_disk_cache_delete_file(disk_cache, cache_file);
-        }
-      }
+  if ((id->cache_type & invalidate_types) == 0 || !STREQ(id->dir, dir)) {
+    return false;
+  }
+  const int timeline_frame = seq_cache_frame_index_to_timeline_frame(seq, frame_index);
+  return timeline_frame >= range_start && timeline_frame <= range_end;
+}
+
+static void seq_disk_cache_segment_invalidate(SeqDiskCache *disk_cache,
+                                              DiskCacheSegment *segment,
+                                              Sequence *seq,
+                                              const char *dir,
+                                              int invalidate_types,
+                                              int range_start,
+                                              int range_end)
+{
+  DiskCacheStream *stream = segment->stream;
+  FILE *file = NULL;
+  bool is_empty = true;
+
+  for (int i = 0; i < DCACHE_IMAGES_PER_SEGMENT; i++) {
+    DiskCacheHeaderEntry *entry = &segment->header.entry[i];
+    if (!seq_disk_cache_entry_is_used(entry)) {
+      continue;
+    }
+    if (!seq_disk_cache_is_invalid(
+            &stream->id, (int)entry->frameno, seq, dir, invalidate_types, range_start, range_end)) {
+      is_empty = false;
+      continue;
     }
-    cache_file = next_file;
+
+    void *frame_key = POINTER_FROM_INT((int)entry->frameno);
+    if (BLI_ghash_lookup(stream->frames, frame_key) == segment) {
+      BLI_ghash_remove(stream->frames, frame_key, NULL, NULL);
+    }
+    /* Image data stays in the segment, it may still be read by other threads. */
+    memset(entry, 0, sizeof(*entry));
+    if (file == NULL) {
+      file = BLI_fopen(segment->path, "rb+");
+    }
+    if (file) {
+      seq_disk_cache_write_header_entry(file, entry, i);
+    }
+  }
+
+  if (file) {
+    fclose(file);
+  }
+
+  if (is_empty) {
+    seq_disk_cache_segment_remove(disk_cache, segment);
   }
 }
 
@@ -407,19 +816,54 @@ void seq_disk_cache_invalidate(SeqDiskCache *disk_cache,
                                Sequence *seq_changed,
                                int invalidate_types)
 {
-  int start;
-  int end;
+  char dir[FILE_MAXDIR];
+  seq_disk_cache_get_dir(disk_cache, scene, seq, dir, sizeof(dir));
+  const int start = SEQ_time_left_handle_frame_get(scene, seq_changed);
+  const int end = SEQ_time_right_handle_frame_get(scene, seq_changed);
+
+  /* Drop images waiting to be written. */
+  BLI_mutex_lock(&disk_cache->queue_mutex);
+  LISTBASE_FOREACH_MUTABLE (DiskCacheWriteJob *, job, &disk_cache->write_queue) {
+    if (seq_disk_cache_is_invalid(
+            &job->id, job->frame_index, seq, dir, invalidate_types, start, end)) {
+      BLI_remlink(&disk_cache->write_queue, job);
+      disk_cache->write_queue_size -= job->size_raw;
+      IMB_freeImBuf(job->ibuf);
+      MEM_freeN(job);
+    }
+  }
+  /* Image being written is discarded, see #seq_disk_cache_write_job. */
+  disk_cache->writing_job = NULL;
+  BLI_condition_notify_all(&disk_cache->queue_cond);
+  BLI_mutex_unlock(&disk_cache->queue_mutex);
 
-  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  BLI_rw_mutex_lock(&disk_cache->index_lock, THREAD_LOCK_WRITE);
+  disk_cache->invalidate_count++;
 
-  start = SEQ_time_left_handle_frame_get(scene, seq_changed) - DCACHE_IMAGES_PER_FILE;
-  end = SEQ_time_right_handle_frame_get(scene, seq_changed);
+  GHASH_FOREACH_BEGIN (DiskCacheStream *, stream, disk_cache->streams) {
+    if ((stream->id.cache_type & invalidate_types) && STREQ(stream->id.dir, dir)) {
+      seq_disk_cache_stream_load(disk_cache, stream);
+    }
+  }
+  GHASH_FOREACH_END();
 
-  seq_disk_cache_delete_invalid_files(disk_cache, scene, seq, invalidate_types, start, end);
+  LISTBASE_FOREACH_MUTABLE (DiskCacheSegment *, segment, &disk_cache->segments) {
+    const DiskCacheStream *stream = segment->stream;
+    if ((stream->id.cache_type & invalidate_types) && STREQ(stream->id.dir, dir)) {
+      seq_disk_cache_segment_invalidate(
+          disk_cache, segment, seq, dir, invalidate_types, start, end);
+    }
+  }
 
-  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+  BLI_rw_mutex_unlock(&disk_cache->index_lock);
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Writing
+ * \{ */
+
 static size_t deflate_imbuf_to_file(ImBuf *ibuf,
                                     FILE *file,
                                     int level,
@@ -433,253 +877,339 @@ static size_t deflate_imbuf_to_file(ImBuf *ibuf,
         data, header_entry->size_raw, file, header_entry->offset, level);
   }
 
-  fseek(file, header_entry->offset, SEEK_SET);
+  BLI_fseek(file, header_entry->offset, SEEK_SET);
   return fwrite(data, 1, header_entry->size_raw, file);
 }
 
-static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
+static void seq_disk_cache_init_header_entry(const DiskCacheWriteJob *job,
+                                             uint64_t offset,
+                                             DiskCacheHeaderEntry *entry)
 {
-  void *data = (ibuf->rect != NULL) ? (void *)ibuf->rect : (void *)ibuf->rect_float;
-  char header[4];
-  fseek(file, header_entry->offset, SEEK_SET);
-  if (fread(header, 1, sizeof(header), file) != sizeof(header)) {
-    return 0;
-  }
+  ImBuf *ibuf = job->ibuf;
 
-  /* Check if the data is compressed or raw. */
-  if (BLI_file_magic_is_zstd(header)) {
-    return BLI_file_unzstd_to_mem_at_pos(data, header_entry->size_raw, file, header_entry->offset);
-  }
+  memset(entry, 0, sizeof(*entry));
+  entry->encoding = (ENDIAN_ORDER == B_ENDIAN) ? 255 : 0;
+  entry->offset = offset;
+  entry->frameno = job->frame_index;
+  entry->size_raw = job->size_raw;
 
-  fseek(file, header_entry->offset, SEEK_SET);
-  return fread(data, 1, header_entry->size_raw, file);
+  /* Store colorspace name of ibuf. */
+  const char *colorspace_name = (ibuf->rect) ? IMB_colormanagement_get_rect_colorspace(ibuf) :
+                                               IMB_colormanagement_get_float_colorspace(ibuf);
+  BLI_strncpy(entry->colorspace_name, colorspace_name, sizeof(entry->colorspace_name));
 }
 
-static bool seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
+static void seq_disk_cache_write_job(SeqDiskCache *disk_cache, DiskCacheWriteJob *job)
 {
-  BLI_fseek(file, 0LL, SEEK_SET);
-  const size_t num_items_read = fread(header, sizeof(*header), 1, file);
-  if (num_items_read < 1) {
-    BLI_assert_msg(0, "unable to read disk cache header");
-    perror("unable to read disk cache header");
-    return false;
+  const int level = seq_disk_cache_compression_level();
+  const size_t size_max = (level > 0) ? ZSTD_compressBound(job->size_raw) : job->size_raw;
+
+  BLI_rw_mutex_lock(&disk_cache->index_lock, THREAD_LOCK_WRITE);
+  const int invalidate_count = disk_cache->invalidate_count;
+  DiskCacheStream *stream = seq_disk_cache_stream_ensure(disk_cache, &job->id);
+  seq_disk_cache_stream_load(disk_cache, stream);
+  DiskCacheSegment *segment = NULL;
+  if (!BLI_ghash_haskey(stream->frames, POINTER_FROM_INT(job->frame_index))) {
+    segment = seq_disk_cache_segment_get_for_write(disk_cache, stream, size_max);
   }
+  if (segment) {
+    atomic_add_and_fetch_int32(&segment->users, 1);
+  }
+  BLI_rw_mutex_unlock(&disk_cache->index_lock);
 
-  for (int i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
-    if ((ENDIAN_ORDER == B_ENDIAN) && header->entry[i].encoding == 0) {
-      BLI_endian_switch_uint64(&header->entry[i].frameno);
-      BLI_endian_switch_uint64(&header->entry[i].offset);
-      BLI_endian_switch_uint64(&header->entry[i].size_compressed);
-      BLI_endian_switch_uint64(&header->entry[i].size_raw);
+  if (segment == NULL) {
+    return;
+  }
+
+  /* Only this thread appends to segments, so data can be written without holding the lock. */
+  DiskCacheHeaderEntry entry;
+  seq_disk_cache_init_header_entry(job, segment->data_end, &entry);
+  FILE *file = BLI_fopen(segment->path, "rb+");
+  size_t bytes_written = 0;
+  if (file) {
+    bytes_written = deflate_imbuf_to_file(job->ibuf, file, level, &entry);
+    if (fflush(file) != 0) {
+      bytes_written = 0;
     }
   }
 
-  return true;
-}
+  BLI_rw_mutex_lock(&disk_cache->index_lock, THREAD_LOCK_WRITE);
+  if (bytes_written != 0 && !segment->removed &&
+      invalidate_count == disk_cache->invalidate_count) {
+    /* Last step is writing header, as image data can be overwritten,
+     * but missing data would cause problems. */
+    const int entry_index = seq_disk_cache_get_free_header_entry(&segment->header);
+    BLI_assert(entry_index != -1);
+    entry.size_compressed = bytes_written;
+    if (seq_disk_cache_write_header_entry(file, &entry, entry_index)) {
+      segment->header.entry[entry_index] = entry;
+      const uint64_t data_end = entry.offset + bytes_written;
+      disk_cache->size_total += data_end - segment->data_end;
+      segment->data_end = data_end;
+      segment->last_used = time(NULL);
+      BLI_ghash_reinsert(
+          stream->frames, POINTER_FROM_INT(job->frame_index), segment, NULL, NULL);
+    }
+  }
+  seq_disk_cache_enforce_limits(disk_cache);
+  BLI_rw_mutex_unlock(&disk_cache->index_lock);
 
-static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
-{
-  BLI_fseek(file, 0LL, SEEK_SET);
-  return fwrite(header, sizeof(*header), 1, file);
+  if (file) {
+    fclose(file);
+  }
+  seq_disk_cache_segment_unref(segment);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+static void *seq_disk_cache_writer_thread(void *disk_cache_v)
 {
-  int i;
-  uint64_t offset = sizeof(*header);
+  SeqDiskCache *disk_cache = disk_cache_v;
 
-  /* Lookup free entry, get offset for new data. */
-  for (i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
-    if (header->entry[i].size_compressed == 0) {
-      break;
-    }
-  }
+  BLI_mutex_lock(&disk_cache->queue_mutex);
+  while (!disk_cache->stop && disk_cache->write_queue.first) {
+    DiskCacheWriteJob *job = disk_cache->write_queue.first;
+    BLI_remlink(&disk_cache->write_queue, job);
+    disk_cache->writing_job = job;
+    BLI_mutex_unlock(&disk_cache->queue_mutex);
 
-  /* Attempt to write beyond set entry limit.
-   * Reset file header and start writing from beginning.
-   */
-  if (i == DCACHE_IMAGES_PER_FILE) {
-    i = 0;
-    memset(header, 0, sizeof(*header));
-  }
+    seq_disk_cache_write_job(disk_cache, job);
 
-  /* Calculate offset for image data. */
-  if (i > 0) {
-    offset = header->entry[i - 1].offset + header->entry[i - 1].size_compressed;
-  }
+    BLI_mutex_lock(&disk_cache->queue_mutex);
+    disk_cache->writing_job = NULL;
+    disk_cache->write_queue_size -= job->size_raw;
+    BLI_condition_notify_all(&disk_cache->queue_cond);
+    BLI_mutex_unlock(&disk_cache->queue_mutex);
 
-  if (ENDIAN_ORDER == B_ENDIAN) {
-    header->entry[i].encoding = 255;
-  }
-  else {
-    header->entry[i].encoding = 0;
+    IMB_freeImBuf(job->ibuf);
+    MEM_freeN(job);
+
+    BLI_mutex_lock(&disk_cache->queue_mutex);
   }
+  disk_cache->writer_running = false;
+  BLI_condition_notify_all(&disk_cache->queue_cond);
+  BLI_mutex_unlock(&disk_cache->queue_mutex);
 
-  header->entry[i].offset = offset;
-  header->entry[i].frameno = key->frame_index;
+  return NULL;
+}
 
-  /* Store colorspace name of ibuf. */
-  const char *colorspace_name;
-  if (ibuf->rect) {
-    header->entry[i].size_raw = ibuf->x * ibuf->y * ibuf->channels;
-    colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
-  }
-  else {
-    header->entry[i].size_raw = ibuf->x * ibuf->y * ibuf->channels * 4;
-    colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
+/* Must be called with locked queue mutex. */
+static void seq_disk_cache_writer_start(SeqDiskCache *disk_cache)
+{
+  if (disk_cache->writer_running) {
+    return;
   }
-  BLI_strncpy(
-      header->entry[i].colorspace_name, colorspace_name, sizeof(header->entry[i].colorspace_name));
 
-  return i;
+  /* Join the previous thread which has finished already. */
+  BLI_threadpool_remove(&disk_cache->threads, disk_cache);
+  disk_cache->writer_running = true;
+  BLI_threadpool_insert(&disk_cache->threads, disk_cache);
 }
 
-static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *header)
+/* Stop writing and drop images waiting to be written. */
+static void seq_disk_cache_writer_stop(SeqDiskCache *disk_cache)
 {
-  for (int i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
-    if (header->entry[i].frameno == key->frame_index) {
-      return i;
-    }
+  BLI_mutex_lock(&disk_cache->queue_mutex);
+  disk_cache->stop = true;
+  while (disk_cache->writer_running) {
+    BLI_condition_wait(&disk_cache->queue_cond, &disk_cache->queue_mutex);
   }
+  LISTBASE_FOREACH_MUTABLE (DiskCacheWriteJob *, job, &disk_cache->write_queue) {
+    IMB_freeImBuf(job->ibuf);
+    MEM_freeN(job);
+  }
+  BLI_listbase_clear(&disk_cache->write_queue);
+  disk_cache->write_queue_size = 0;
+  BLI_mutex_unlock(&disk_cache->queue_mutex);
 
-  return -1;
+  BLI_threadpool_end(&disk_cache->threads);
 }
 
 bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
 {
-  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return false;
+  }
 
-  char filepath[FILE_MAX];
+  DiskCacheWriteJob *job = MEM_callocN(sizeof(DiskCacheWriteJob), "SeqDiskCacheWriteJob");
+  seq_disk_cache_get_stream_id(disk_cache, key, &job->id);
+  job->frame_index = (int)key->frame_index;
+  job->size_raw = (size_t)ibuf->x * ibuf->y * ibuf->channels;
+  if (ibuf->rect == NULL) {
+    job->size_raw *= sizeof(float);
+  }
+  /* Image is not modified once it is cached, so it can be written without copying. */
+  IMB_refImBuf(ibuf);
+  job->ibuf = ibuf;
+
+  BLI_mutex_lock(&disk_cache->queue_mutex);
+  /* Wait for disk to catch up, rather than holding arbitrary amount of images in memory. */
+  while (disk_cache->write_queue_size > DCACHE_WRITE_QUEUE_SIZE_MAX &&
+         disk_cache->writer_running) {
+    BLI_condition_wait(&disk_cache->queue_cond, &disk_cache->queue_mutex);
+  }
+  BLI_addtail(&disk_cache->write_queue, job);
+  disk_cache->write_queue_size += job->size_raw;
+  seq_disk_cache_writer_start(disk_cache);
+  BLI_mutex_unlock(&disk_cache->queue_mutex);
 
-  seq_disk_cache_get_file_path(disk_cache, key, filepath, sizeof(filepath));
-  BLI_make_existing_file(filepath);
+  return true;
+}
 
-  FILE *file = BLI_fopen(filepath, "rb+");
-  if (!file) {
-    file = BLI_fopen(filepath, "wb+");
-    if (!file) {
-      BLI_mutex_unlock(&disk_cache->read_write_mutex);
-      return false;
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Reading
+ * \{ */
+
+static ImBuf *seq_disk_cache_write_queue_find(SeqDiskCache *disk_cache,
+                                              const DiskCacheStreamID *id,
+                                              int frame_index)
+{
+  ImBuf *ibuf = NULL;
+
+  BLI_mutex_lock(&disk_cache->queue_mutex);
+  DiskCacheWriteJob *job = disk_cache->writing_job;
+  if (job == NULL || job->frame_index != frame_index ||
+      !seq_disk_cache_stream_id_equals(&job->id, id)) {
+    for (job = disk_cache->write_queue.first; job; job = job->next) {
+      if (job->frame_index == frame_index && seq_disk_cache_stream_id_equals(&job->id, id)) {
+        break;
+      }
     }
-    seq_disk_cache_add_file_to_list(disk_cache, filepath);
   }
-
-  DiskCacheFile *cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, filepath);
-  DiskCacheHeader header;
-  memset(&header, 0, sizeof(header));
-  /* #BLI_make_existing_file() above may create an empty file. This is fine, don't attempt reading
-   * the header in that case. */
-  if (cache_file->fstat.st_size != 0 && !seq_disk_cache_read_header(file, &header)) {
-    fclose(file);
-    seq_disk_cache_delete_file(disk_cache, cache_file);
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return false;
+  if (job) {
+    ibuf = job->ibuf;
+    IMB_refImBuf(ibuf);
   }
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
+  BLI_mutex_unlock(&disk_cache->queue_mutex);
 
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+  return ibuf;
+}
 
-  if (bytes_written != 0) {
-    /* Last step is writing header, as image data can be overwritten,
-     * but missing data would cause problems.
-     */
-    header.entry[entry_index].size_compressed = bytes_written;
-    seq_disk_cache_write_header(file, &header);
-    seq_disk_cache_update_file(disk_cache, filepath);
-    fclose(file);
+/* Find segment containing image and copy its header entry. Returned segment must be released
+ * with #seq_disk_cache_segment_unref. */
+static DiskCacheSegment *seq_disk_cache_segment_find(SeqDiskCache *disk_cache,
+                                                     const DiskCacheStreamID *id,
+                                                     int frame_index,
+                                                     DiskCacheHeaderEntry *r_entry)
+{
+  BLI_rw_mutex_lock(&disk_cache->index_lock, THREAD_LOCK_READ);
+  DiskCacheStream *stream = seq_disk_cache_stream_find(disk_cache, id);
+  if (stream && !stream->loaded) {
+    /* Streams are never removed, so lock can be upgraded without looking up the stream again. */
+    BLI_rw_mutex_unlock(&disk_cache->index_lock);
+    BLI_rw_mutex_lock(&disk_cache->index_lock, THREAD_LOCK_WRITE);
+    seq_disk_cache_stream_load(disk_cache, stream);
+  }
 
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return true;
+  DiskCacheSegment *segment = NULL;
+  if (stream) {
+    segment = BLI_ghash_lookup(stream->frames, POINTER_FROM_INT(frame_index));
+  }
+  if (segment) {
+    const int entry_index = seq_disk_cache_get_header_entry(&segment->header, frame_index);
+    BLI_assert(entry_index != -1);
+    *r_entry = segment->header.entry[entry_index];
+    atomic_add_and_fetch_int32(&segment->users, 1);
+    /* Concurrent readers may race here, any of the values is good enough. */
+    atomic_cas_int64(&segment->last_used, segment->last_used, time(NULL));
   }
+  BLI_rw_mutex_unlock(&disk_cache->index_lock);
 
-  BLI_mutex_unlock(&disk_cache->read_write_mutex);
-  return false;
+  return segment;
 }
 
-ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
+static bool inflate_segment_to_imbuf(ImBuf *ibuf,
+                                     DiskCacheSegment *segment,
+                                     const DiskCacheHeaderEntry *header_entry)
 {
-  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  void *data = (ibuf->rect != NULL) ? (void *)ibuf->rect : (void *)ibuf->rect_float;
 
-  char filepath[FILE_MAX];
-  DiskCacheHeader header;
+  /* Compressed data always has zstd frame header, so it can't have the same size as raw data. */
+  if (header_entry->size_compressed == header_entry->size_raw) {
+    return BLI_mmap_read(segment->mmap, data, header_entry->offset, header_entry->size_raw);
+  }
 
-  seq_disk_cache_get_file_path(disk_cache, key, filepath, sizeof(filepath));
-  BLI_make_existing_file(filepath);
+  /* Copy out of the mapping, so IO errors are handled. */
+  void *compressed = MEM_mallocN(header_entry->size_compressed, __func__);
+  const bool ok = BLI_mmap_read(segment->mmap,
+                                compressed,
+                                header_entry->offset,
+                                header_entry->size_compressed) &&
+                  ZSTD_decompress(data,
+                                  header_entry->size_raw,
+                                  compressed,
+                                  header_entry->size_compressed) == header_entry->size_raw;
+  MEM_freeN(compressed);
+  return ok;
+}
 
-  FILE *file = BLI_fopen(filepath, "rb");
-  if (!file) {
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return NULL;
-  }
+ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
+{
+  DiskCacheStreamID id;
+  seq_disk_cache_get_stream_id(disk_cache, key, &id);
+  const int frame_index = (int)key->frame_index;
 
-  if (!seq_disk_cache_read_header(file, &header)) {
-    fclose(file);
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return NULL;
+  ImBuf *ibuf = seq_disk_cache_write_queue_find(disk_cache, &id, frame_index);
+  if (ibuf) {
+    return ibuf;
   }
-  int entry_index = seq_disk_cache_get_header_entry(key, &header);
+
+  DiskCacheHeaderEntry entry;
+  DiskCacheSegment *segment = seq_disk_cache_segment_find(disk_cache, &id, frame_index, &entry);
 
   /* Item not found. */
-  if (entry_index < 0) {
-    fclose(file);
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+  if (segment == NULL) {
     return NULL;
   }
 
-  ImBuf *ibuf;
   uint64_t size_char = (uint64_t)key->context.rectx * key->context.recty * 4;
   uint64_t size_float = (uint64_t)key->context.rectx * key->context.recty * 16;
-  size_t expected_size;
 
-  if (header.entry[entry_index].size_raw == size_char) {
-    expected_size = size_char;
+  if (entry.size_raw == size_char) {
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
-    IMB_colormanagement_assign_rect_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+    IMB_colormanagement_assign_rect_colorspace(ibuf, entry.colorspace_name);
   }
-  else if (header.entry[entry_index].size_raw == size_float) {
-    expected_size = size_float;
+  else if (entry.size_raw == size_float) {
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
-    IMB_colormanagement_assign_float_colorspace(ibuf, header.entry[entry_index].colorspace_name);
-  }
-  else {
-    fclose(file);
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return NULL;
+    IMB_colormanagement_assign_float_colorspace(ibuf, entry.colorspace_name);
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
-
-  /* Sanity check. */
-  if (bytes_read != expected_size) {
-    fclose(file);
+  if (ibuf && !inflate_segment_to_imbuf(ibuf, segment, &entry)) {
     IMB_freeImBuf(ibuf);
-    BLI_mutex_unlock(&disk_cache->read_write_mutex);
-    return NULL;
+    ibuf = NULL;
   }
-  BLI_file_touch(filepath);
-  seq_disk_cache_update_file(disk_cache, filepath);
-  fclose(file);
 
-  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+  seq_disk_cache_segment_unref(segment);
   return ibuf;
 }
 
+/** \} */
+
 SeqDiskCache *seq_disk_cache_create(Main *bmain, Scene *scene)
 {
   SeqDiskCache *disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
   disk_cache->bmain = bmain;
-  BLI_mutex_init(&disk_cache->read_write_mutex);
+  disk_cache->streams = BLI_ghash_str_new("SeqDiskCache streams");
+  BLI_rw_mutex_init(&disk_cache->index_lock);
+  BLI_mutex_init(&disk_cache->queue_mutex);
+  BLI_condition_init(&disk_cache->queue_cond);
+  BLI_threadpool_init(&disk_cache->threads, seq_disk_cache_writer_thread, 1);
   seq_disk_cache_handle_versioning(disk_cache);
   seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
   disk_cache->timestamp = scene->ed->disk_cache_timestamp;
-  BLI_mutex_unlock(&cache_create_lock);
   return disk_cache;
 }
 
 void seq_disk_cache_free(SeqDiskCache *disk_cache)
 {
-  BLI_freelistN(&disk_cache->files);
-  BLI_mutex_end(&disk_cache->read_write_mutex);
+  seq_disk_cache_writer_stop(disk_cache);
+
+  LISTBASE_FOREACH_MUTABLE (DiskCacheSegment *, segment, &disk_cache->segments) {
+    seq_disk_cache_segment_unref(segment);
+  }
+  BLI_ghash_free(disk_cache->streams, NULL, seq_disk_cache_stream_free);
+  BLI_rw_mutex_end(&disk_cache->index_lock);
+  BLI_mutex_end(&disk_cache->queue_mutex);
+  BLI_condition_end(&disk_cache->queue_cond);
   MEM_freeN(disk_cache);
 }
@@ -29,7 +29,6 @@ struct ImBuf *seq_disk_cache_read_file(struct SeqDiskCache *disk_cache, struct S
 bool seq_disk_cache_write_file(struct SeqDiskCache *disk_cache,
                                struct SeqCacheKey *key,
                                struct ImBuf *ibuf);
-bool seq_disk_cache_enforce_limits(struct SeqDiskCache *disk_cache);
 void seq_disk_cache_invalidate(struct SeqDiskCache *disk_cache,
                                struct Scene *scene,
                                struct Sequence *seq,
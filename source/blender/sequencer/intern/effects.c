@@ -140,16 +140,16 @@ static ImBuf *prepare_effect_imbufs(const SeqRenderData *context,
 
   if (!ibuf1 && !ibuf2 && !ibuf3) {
     /* hmmm, global float option ? */
-    out = IMB_allocImBuf(x, y, 32, IB_rect);
+    out = seq_imbuf_pool_alloc(x, y, false);
   }
   else if ((ibuf1 && ibuf1->rect_float) || (ibuf2 && ibuf2->rect_float) ||
            (ibuf3 && ibuf3->rect_float)) {
     /* if any inputs are rectfloat, output is float too */
 
-    out = IMB_allocImBuf(x, y, 32, IB_rectfloat);
+    out = seq_imbuf_pool_alloc(x, y, true);
   }
   else {
-    out = IMB_allocImBuf(x, y, 32, IB_rect);
+    out = seq_imbuf_pool_alloc(x, y, false);
   }
 
   if (out->rect_float) {
@@ -3309,6 +3309,10 @@ static int early_out_text(Sequence *seq, float UNUSED(fac))
   return EARLY_NO_INPUT;
 }
 
+/* Fonts are shared by all copies of text strips, which can be rendered concurrently by prefetch
+ * workers. BLF state is not thread safe, so drawing has to be serialized. */
+static ThreadMutex text_effect_mutex = BLI_MUTEX_INITIALIZER;
+
 static ImBuf *do_text_effect(const SeqRenderData *context,
                              Sequence *seq,
                              float UNUSED(timeline_frame),
@@ -3328,6 +3332,8 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
   int y_ofs, x, y;
   double proxy_size_comp;
 
+  BLI_mutex_lock(&text_effect_mutex);
+
   if (data->text_blf_id == SEQ_FONT_NOT_LOADED) {
     data->text_blf_id = -1;
 
@@ -3426,6 +3432,8 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
 
   BLF_disable(font, font_flags);
 
+  BLI_mutex_unlock(&text_effect_mutex);
+
   return out;
 }
 
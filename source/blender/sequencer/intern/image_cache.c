@@ -40,6 +40,7 @@
 
 #include "disk_cache.h"
 #include "image_cache.h"
+#include "image_cache_compression.h"
 #include "prefetch.h"
 #include "strip_time.h"
 
@@ -62,29 +63,46 @@
  * Only permanent (is_temp_cache = 0) cache entries are linked.
  * Putting #SEQ_CACHE_STORE_FINAL_OUT will reset linking
  *
+ * Prefetch workers render different frames at the same time, so every task (see #eSeqTaskId)
+ * links its entries in its own chain.
+ *
  * Only entire frame can be freed to release resources for new entries (recycling).
  * Once again, this is to reduce number of iterations, but also more controllable than removing
  * entries one by one in reverse order to their creation.
  *
  * User can exclude caching of some images. Such entries will have is_temp_cache set.
+ *
+ * Compression: When enabled, permanent entries are stored compressed (see
+ * `image_cache_compression.c`). Images are compressed before the cache is locked and decompressed
+ * on each lookup after the cache is unlocked, so that render threads don't block each other.
  */
 
 #define THUMB_CACHE_LIMIT 5000
 
+/** Number of tasks which can put entries into the cache at the same time. */
+#define SEQ_CACHE_TASKS_NUM (SEQ_TASK_PREFETCH_RENDER + SEQ_PREFETCH_MAX_WORKERS)
+
 typedef struct SeqCache {
   Main *bmain;
   struct GHash *hash;
   ThreadMutex iterator_mutex;
   struct BLI_mempool *keys_pool;
   struct BLI_mempool *items_pool;
-  struct SeqCacheKey *last_key;
+  /** Last linked key of every task. */
+  struct SeqCacheKey *last_key[SEQ_CACHE_TASKS_NUM];
   struct SeqDiskCache *disk_cache;
   int thumbnail_count;
+  /* Statistics of compressed entries. */
+  int compressed_count;
+  size_t compressed_size_raw;
+  size_t compressed_size;
 } SeqCache;
 
 typedef struct SeqCacheItem {
   struct SeqCache *cache_owner;
   struct ImBuf *ibuf;
+  /* Stored instead of `ibuf` when cache compression is used. */
+  struct SeqCompressedImage *compressed;
 } SeqCacheItem;
 
 static ThreadMutex cache_create_lock = BLI_MUTEX_INITIALIZER;
@@ -188,6 +206,11 @@ static size_t seq_cache_get_mem_total(void)
 static void seq_cache_keyfree(void *val)
 {
   SeqCacheKey *key = val;
+  SeqCache *cache = key->cache_owner;
+  /* The chain of the task continues without the key, like after putting a final image. */
+  if (cache->last_key[key->task_id] == key) {
+    cache->last_key[key->task_id] = NULL;
+  }
   BLI_mempool_free(key->cache_owner->keys_pool, key);
 }
 
@@ -199,6 +222,14 @@ static void seq_cache_valfree(void *val)
     IMB_freeImBuf(item->ibuf);
   }
 
+  if (item->compressed) {
+    SeqCache *cache = item->cache_owner;
+    cache->compressed_count--;
+    cache->compressed_size_raw -= seq_compressed_image_size_raw(item->compressed);
+    cache->compressed_size -= seq_compressed_image_size(item->compressed);
+    seq_compressed_image_free(item->compressed);
+  }
+
   BLI_mempool_free(item->cache_owner->items_pool, item);
 }
 
@@ -218,49 +249,87 @@ static int get_stored_types_flag(Scene *scene, SeqCacheKey *key)
   return flag;
 }
 
-static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
+static bool seq_cache_use_compression(Scene *scene, Sequence *seq, int type)
+{
+  if ((scene->ed->cache_flag & SEQ_CACHE_COMPRESS) == 0 || type == SEQ_CACHE_STORE_THUMBNAIL) {
+    return false;
+  }
+
+  /* Temporary entries are freed soon, compressing them would only waste time. */
+  SeqCacheKey key;
+  key.seq = seq;
+  key.type = type;
+  return (get_stored_types_flag(scene, &key) & type) != 0;
+}
+
+/**
+ * \param compressed: When not NULL, compressed image is stored instead of `ibuf` and the cache
+ * takes ownership of it.
+ */
+static void seq_cache_put_ex(Scene *scene,
+                             SeqCacheKey *key,
+                             ImBuf *ibuf,
+                             SeqCompressedImage *compressed)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
   SeqCacheItem *item;
   item = BLI_mempool_alloc(cache->items_pool);
   item->cache_owner = cache;
-  item->ibuf = ibuf;
+  item->ibuf = compressed ? NULL : ibuf;
+  item->compressed = compressed;
+
+  if (compressed) {
+    cache->compressed_count++;
+    cache->compressed_size_raw += seq_compressed_image_size_raw(compressed);
+    cache->compressed_size += seq_compressed_image_size(compressed);
+  }
 
   const int stored_types_flag = get_stored_types_flag(scene, key);
 
+  SeqCacheKey **last_key = &cache->last_key[key->task_id];
+
   /* Item stored for later use. */
   if (stored_types_flag & key->type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = *last_key;
   }
 
   /* Store pointer to last cached key. */
-  SeqCacheKey *temp_last_key = cache->last_key;
+  SeqCacheKey *temp_last_key = *last_key;
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
-    IMB_refImBuf(ibuf);
+    if (item->ibuf) {
+      IMB_refImBuf(ibuf);
+    }
 
     if (!key->is_temp_cache || key->type != SEQ_CACHE_STORE_THUMBNAIL) {
-      cache->last_key = key;
+      *last_key = key;
     }
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards.
-   * Item is already put in cache, so cache->last_key points to current key.
+   * Item is already put in cache, so last_key points to current key.
    */
   if (!key->is_temp_cache && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = *last_key;
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = NULL;
+    *last_key = NULL;
   }
 }
 
-static ImBuf *seq_cache_get_ex(SeqCache *cache, SeqCacheKey *key)
+/**
+ * \param r_compressed: Set to referenced compressed image if the entry is compressed. It must be
+ * decompressed and freed by the caller, after the cache is unlocked.
+ */
+static ImBuf *seq_cache_get_ex(SeqCache *cache,
+                               SeqCacheKey *key,
+                               SeqCompressedImage **r_compressed)
 {
   SeqCacheItem *item = BLI_ghash_lookup(cache->hash, key);
+  *r_compressed = NULL;
 
   if (item && item->ibuf) {
     IMB_refImBuf(item->ibuf);
@@ -268,9 +337,19 @@ static ImBuf *seq_cache_get_ex(SeqCache *cache, SeqCacheKey *key)
     return item->ibuf;
   }
 
+  if (item && item->compressed) {
+    seq_compressed_image_ref(item->compressed);
+    *r_compressed = item->compressed;
+  }
+
   return NULL;
 }
 
+static void seq_cache_links_reset(SeqCache *cache)
+{
+  memset(cache->last_key, 0, sizeof(cache->last_key));
+}
+
 static void seq_cache_relink_keys(SeqCacheKey *link_next, SeqCacheKey *link_prev)
 {
   if (link_next) {
@@ -407,7 +486,7 @@ static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
 
     /* This shouldn't happen, but better be safe than sorry. */
-    if (!item->ibuf) {
+    if (!item->ibuf && !item->compressed) {
       seq_cache_recycle_linked(scene, key);
       /* Can not continue iterating after linked remove. */
       BLI_ghashIterator_init(&gh_iter, cache->hash);
@@ -499,7 +578,6 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = NULL;
     cache->bmain = bmain;
     cache->thumbnail_count = 0;
     BLI_mutex_init(&cache->iterator_mutex);
@@ -512,6 +590,17 @@ static void seq_cache_create(Main *bmain, Scene *scene)
   BLI_mutex_unlock(&cache_create_lock);
 }
 
+static struct SeqDiskCache *seq_cache_disk_cache_ensure(SeqCache *cache,
+                                                        const SeqRenderData *context)
+{
+  BLI_mutex_lock(&cache_create_lock);
+  if (cache->disk_cache == NULL) {
+    cache->disk_cache = seq_disk_cache_create(context->bmain, context->scene);
+  }
+  BLI_mutex_unlock(&cache_create_lock);
+  return cache->disk_cache;
+}
+
 static void seq_cache_populate_key(SeqCacheKey *key,
                                    const SeqRenderData *context,
                                    Sequence *seq,
@@ -529,6 +618,7 @@ static void seq_cache_populate_key(SeqCacheKey *key,
   key->link_next = NULL;
   key->is_temp_cache = true;
   key->task_id = context->task_id;
+  BLI_assert(key->task_id < SEQ_CACHE_TASKS_NUM);
 }
 
 static SeqCacheKey *seq_cache_allocate_key(SeqCache *cache,
@@ -618,7 +708,7 @@ void SEQ_cache_cleanup(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
-  cache->last_key = NULL;
+  seq_cache_links_reset(cache);
   cache->thumbnail_count = 0;
   seq_cache_unlock(scene);
 }
@@ -678,7 +768,7 @@ void seq_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
-  cache->last_key = NULL;
+  seq_cache_links_reset(cache);
   seq_cache_unlock(scene);
 }
 
@@ -720,7 +810,7 @@ void seq_cache_thumbnail_cleanup(Scene *scene, rctf *view_area_safe)
       cache->thumbnail_count--;
     }
   }
-  cache->last_key = NULL;
+  seq_cache_links_reset(cache);
 }
 
 struct ImBuf *seq_cache_get(const SeqRenderData *context,
@@ -752,26 +842,29 @@ struct ImBuf *seq_cache_get(const SeqRenderData *context,
   seq_cache_lock(scene);
   SeqCache *cache = seq_cache_get_from_scene(scene);
   ImBuf *ibuf = NULL;
+  SeqCompressedImage *compressed = NULL;
   SeqCacheKey key;
 
   /* Try RAM cache: */
   if (cache && seq) {
     seq_cache_populate_key(&key, context, seq, timeline_frame, type);
-    ibuf = seq_cache_get_ex(cache, &key);
+    ibuf = seq_cache_get_ex(cache, &key, &compressed);
   }
   seq_cache_unlock(scene);
 
+  if (compressed) {
+    ibuf = seq_compressed_image_decompress(compressed);
+    seq_compressed_image_free(compressed);
+  }
+
   if (ibuf) {
     return ibuf;
   }
 
   /* Try disk cache: */
   if (seq_disk_cache_is_enabled(context->bmain)) {
-    if (cache->disk_cache == NULL) {
-      cache->disk_cache = seq_disk_cache_create(context->bmain, context->scene);
-    }
-
-    ibuf = seq_disk_cache_read_file(cache->disk_cache, &key);
+    struct SeqDiskCache *disk_cache = seq_cache_disk_cache_ensure(cache, context);
+    ibuf = seq_disk_cache_read_file(disk_cache, &key);
 
     if (ibuf == NULL) {
       return NULL;
@@ -780,7 +873,7 @@ struct ImBuf *seq_cache_get(const SeqRenderData *context,
     /* Store read image in RAM. Only recycle item for final type. */
     if (key.type != SEQ_CACHE_STORE_FINAL_OUT || seq_cache_recycle_item(scene)) {
       SeqCacheKey *new_key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
-      seq_cache_put_ex(scene, new_key, ibuf);
+      seq_cache_put_ex(scene, new_key, ibuf, NULL);
     }
   }
 
@@ -807,8 +900,12 @@ bool seq_cache_put_if_possible(
     return true;
   }
 
-  seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-  scene->ed->cache->last_key = NULL;
+  /* Entries of the frame which can't be stored are freed after it is rendered. */
+  SeqCache *cache = scene->ed->cache;
+  seq_cache_lock(scene);
+  seq_cache_set_temp_cache_linked(scene, cache->last_key[context->task_id]);
+  cache->last_key[context->task_id] = NULL;
+  seq_cache_unlock(scene);
   return false;
 }
 
@@ -838,11 +935,29 @@ void seq_cache_thumbnail_put(
     seq_cache_thumbnail_cleanup(scene, &view_area_safe);
   }
 
-  seq_cache_put_ex(scene, key, i);
+  seq_cache_put_ex(scene, key, i, NULL);
   cache->thumbnail_count++;
   seq_cache_unlock(scene);
 }
 
+/* Check RAM cache only, without decompressing the entry. */
+static bool seq_cache_has_entry(
+    Scene *scene, const SeqRenderData *context, Sequence *seq, float timeline_frame, int type)
+{
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (cache == NULL) {
+    return false;
+  }
+
+  SeqCacheKey key;
+  seq_cache_lock(scene);
+  seq_cache_populate_key(&key, context, seq, timeline_frame, type);
+  const bool has_entry = BLI_ghash_haskey(cache->hash, &key);
+  seq_cache_unlock(scene);
+
+  return has_entry;
+}
+
 void seq_cache_put(
     const SeqRenderData *context, Sequence *seq, float timeline_frame, int type, ImBuf *i)
 {
@@ -860,6 +975,9 @@ void seq_cache_put(
   }
 
   /* Prevent reinserting, it breaks cache key linking. */
+  if (seq_cache_has_entry(scene, context, seq, timeline_frame, type)) {
+    return;
+  }
   ImBuf *test = seq_cache_get(context, seq, timeline_frame, type);
   if (test) {
     IMB_freeImBuf(test);
@@ -870,20 +988,22 @@ void seq_cache_put(
     seq_cache_create(context->bmain, scene);
   }
 
+  SeqCompressedImage *compressed = NULL;
+  if (seq_cache_use_compression(scene, seq, type)) {
+    compressed = seq_compressed_image_create(i);
+  }
+
   seq_cache_lock(scene);
   SeqCache *cache = seq_cache_get_from_scene(scene);
   SeqCacheKey *key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
-  seq_cache_put_ex(scene, key, i);
+  seq_cache_put_ex(scene, key, i, compressed);
   seq_cache_unlock(scene);
 
   if (!key->is_temp_cache) {
     if (seq_disk_cache_is_enabled(context->bmain)) {
-      if (cache->disk_cache == NULL) {
-        seq_disk_cache_create(context->bmain, context->scene);
-      }
-
-      seq_disk_cache_write_file(cache->disk_cache, key, i);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
+      /* Image is written in background, cache size limit is enforced after writing. */
+      struct SeqDiskCache *disk_cache = seq_cache_disk_cache_ensure(cache, context);
+      seq_disk_cache_write_file(disk_cache, key, i);
     }
   }
 }
@@ -912,7 +1032,23 @@ void SEQ_cache_iterate(
     interrupt = callback_iter(userdata, key->seq, key->timeline_frame, key->type);
   }
 
-  cache->last_key = NULL;
+  seq_cache_links_reset(cache);
+  seq_cache_unlock(scene);
+}
+
+void SEQ_cache_stats_get(Scene *scene, SeqCacheStats *r_stats)
+{
+  memset(r_stats, 0, sizeof(*r_stats));
+
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (!cache) {
+    return;
+  }
+
+  seq_cache_lock(scene);
+  r_stats->compressed_count = cache->compressed_count;
+  r_stats->compressed_size_raw = cache->compressed_size_raw;
+  r_stats->compressed_size = cache->compressed_size;
   seq_cache_unlock(scene);
 }
 
@@ -0,0 +1,394 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+/** \file
+ * \ingroup sequencer
+ *
+ * Lossless compression of images stored in the RAM cache.
+ *
+ * Images are split into bands of rows which are compressed independently, so that compression
+ * and decompression can run in parallel. Bytes of pixels are reordered into planes before
+ * compressing (all first bytes, then all second bytes and so on), which puts similar bytes next
+ * to each other and considerably improves compression ratio of a fast compressor.
+ *
+ * Float bands are packed to half floats first when all values of the band can be represented
+ * exactly, otherwise full floats are stored.
+ */
+
+#include <string.h>
+
+#include <zstd.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_bits.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "atomic_ops.h"
+
+#include "image_cache_compression.h"
+
+#define SEQ_COMPRESSION_BAND_ROWS 64
+#define SEQ_COMPRESSION_LEVEL 1
+/* Images are not compressed when they don't get smaller than this portion of raw size. */
+#define SEQ_COMPRESSION_MAX_RATIO 0.9f
+
+typedef enum eCompressedBandFormat {
+  BAND_FORMAT_BYTE = 0,
+  BAND_FORMAT_HALF = 1,
+  BAND_FORMAT_FLOAT = 2,
+} eCompressedBandFormat;
+
+typedef struct CompressedBand {
+  void *data;
+  size_t size;
+  eCompressedBandFormat format;
+} CompressedBand;
+
+struct SeqCompressedImage {
+  int x, y, planes;
+  bool is_float;
+  char colorspace_name[64];
+
+  int num_bands;
+  CompressedBand *bands;
+
+  size_t size_raw;
+  size_t size;
+  int users;
+};
+
+/* -------------------------------------------------------------------- */
+/** \name Pixel Packing
+ * \{ */
+
+/* Convert float to half, returns false when the value can't be represented exactly. */
+static bool float_to_half_exact(const float value, uint16_t *r_half)
+{
+  const uint bits = float_as_uint(value);
+  const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+  const int exponent = (int)((bits >> 23) & 0xff) - 127;
+  const uint mantissa = bits & 0x7fffff;
+
+  if (exponent == -127) {
+    /* Zero, float denormals are too small for half. */
+    *r_half = sign;
+    return mantissa == 0;
+  }
+  if (exponent == 128) {
+    /* Infinity, NaN payload is not preserved. */
+    *r_half = sign | 0x7c00;
+    return mantissa == 0;
+  }
+  if (exponent > 15) {
+    return false;
+  }
+  if (exponent >= -14) {
+    *r_half = sign | (uint16_t)((exponent + 15) << 10) | (uint16_t)(mantissa >> 13);
+    return (mantissa & 0x1fff) == 0;
+  }
+  if (exponent >= -24) {
+    /* Half denormal. */
+    const uint full_mantissa = mantissa | 0x800000;
+    const int shift = -exponent - 1;
+    *r_half = sign | (uint16_t)(full_mantissa >> shift);
+    return (full_mantissa & ((1u << shift) - 1)) == 0;
+  }
+  return false;
+}
+
+static float half_to_float(const uint16_t half)
+{
+  const uint sign = (uint)(half & 0x8000) << 16;
+  const uint exponent = (half >> 10) & 0x1f;
+  const uint mantissa = half & 0x3ff;
+
+  if (exponent == 0) {
+    const float value = (float)mantissa * (1.0f / 16777216.0f);
+    return sign ? -value : value;
+  }
+  if (exponent == 31) {
+    return uint_as_float(sign | 0x7f800000 | (mantissa << 13));
+  }
+  return uint_as_float(sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+}
+
+static bool pack_half_exact(const float *values, const size_t num_values, uint16_t *r_halfs)
+{
+  for (size_t i = 0; i < num_values; i++) {
+    if (!float_to_half_exact(values[i], &r_halfs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Reorder bytes of elements into planes. */
+static void shuffle_bytes(uchar *dst, const uchar *src, const size_t num_elems, const int elem_size)
+{
+  for (int b = 0; b < elem_size; b++) {
+    uchar *plane = dst + b * num_elems;
+    for (size_t i = 0; i < num_elems; i++) {
+      plane[i] = src[i * elem_size + b];
+    }
+  }
+}
+
+static void unshuffle_bytes(uchar *dst,
+                            const uchar *src,
+                            const size_t num_elems,
+                            const int elem_size)
+{
+  for (int b = 0; b < elem_size; b++) {
+    const uchar *plane = src + b * num_elems;
+    for (size_t i = 0; i < num_elems; i++) {
+      dst[i * elem_size + b] = plane[i];
+    }
+  }
+}
+
+static int band_format_elem_size(const eCompressedBandFormat format)
+{
+  return format == BAND_FORMAT_HALF ? sizeof(uint16_t) : 4;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Compression
+ * \{ */
+
+typedef struct CompressTaskData {
+  const ImBuf *ibuf;
+  SeqCompressedImage *image;
+} CompressTaskData;
+
+static size_t band_num_values(const SeqCompressedImage *image, const int band_index)
+{
+  const int row_start = band_index * SEQ_COMPRESSION_BAND_ROWS;
+  const int num_rows = min_ii(SEQ_COMPRESSION_BAND_ROWS, image->y - row_start);
+  return (size_t)num_rows * image->x * 4;
+}
+
+static void compress_band_task(void *__restrict userdata,
+                               const int band_index,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CompressTaskData *data = (CompressTaskData *)userdata;
+  const ImBuf *ibuf = data->ibuf;
+  CompressedBand *band = &data->image->bands[band_index];
+  const size_t num_values = band_num_values(data->image, band_index);
+  const size_t offset = (size_t)band_index * SEQ_COMPRESSION_BAND_ROWS * ibuf->x * 4;
+
+  const void *src;
+  uint16_t *halfs = NULL;
+  if (ibuf->rect_float == NULL) {
+    src = (const uchar *)ibuf->rect + offset;
+    band->format = BAND_FORMAT_BYTE;
+  }
+  else {
+    halfs = MEM_mallocN(num_values * sizeof(uint16_t), __func__);
+    if (pack_half_exact(ibuf->rect_float + offset, num_values, halfs)) {
+      src = halfs;
+      band->format = BAND_FORMAT_HALF;
+    }
+    else {
+      src = ibuf->rect_float + offset;
+      band->format = BAND_FORMAT_FLOAT;
+    }
+  }
+
+  /* Byte pixels are shuffled as whole pixel, so each channel gets its own plane. */
+  const int elem_size = band_format_elem_size(band->format);
+  const size_t size_raw = (band->format == BAND_FORMAT_BYTE) ? num_values :
+                                                                num_values * elem_size;
+  uchar *shuffled = MEM_mallocN(size_raw, __func__);
+  shuffle_bytes(shuffled, src, size_raw / elem_size, elem_size);
+  MEM_SAFE_FREE(halfs);
+
+  const size_t bound = ZSTD_compressBound(size_raw);
+  void *compressed = MEM_mallocN(bound, __func__);
+  const size_t size = ZSTD_compress(compressed, bound, shuffled, size_raw, SEQ_COMPRESSION_LEVEL);
+  MEM_freeN(shuffled);
+
+  if (ZSTD_isError(size)) {
+    MEM_freeN(compressed);
+    return;
+  }
+
+  band->data = MEM_mallocN(size, "seq compressed band");
+  band->size = size;
+  memcpy(band->data, compressed, size);
+  MEM_freeN(compressed);
+}
+
+SeqCompressedImage *seq_compressed_image_create(ImBuf *ibuf)
+{
+  /* Only images that can be fully restored are compressed. */
+  if ((ibuf->rect == NULL) == (ibuf->rect_float == NULL) || ibuf->channels != 4 ||
+      ibuf->metadata != NULL || ibuf->x <= 0 || ibuf->y <= 0) {
+    return NULL;
+  }
+
+  SeqCompressedImage *image = MEM_callocN(sizeof(SeqCompressedImage), "SeqCompressedImage");
+  image->x = ibuf->x;
+  image->y = ibuf->y;
+  image->planes = ibuf->planes;
+  image->is_float = ibuf->rect_float != NULL;
+  image->users = 1;
+
+  const char *colorspace_name = image->is_float ? IMB_colormanagement_get_float_colorspace(ibuf) :
+                                                  IMB_colormanagement_get_rect_colorspace(ibuf);
+  STRNCPY(image->colorspace_name, colorspace_name);
+
+  image->num_bands = divide_ceil_u(ibuf->y, SEQ_COMPRESSION_BAND_ROWS);
+  image->bands = MEM_callocN(sizeof(CompressedBand) * image->num_bands, "seq compressed bands");
+  image->size_raw = (size_t)ibuf->x * ibuf->y * 4 * (image->is_float ? sizeof(float) : 1);
+
+  CompressTaskData data;
+  data.ibuf = ibuf;
+  data.image = image;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, image->num_bands, &data, compress_band_task, &settings);
+
+  bool success = true;
+  for (int i = 0; i < image->num_bands; i++) {
+    success &= image->bands[i].data != NULL;
+    image->size += image->bands[i].size;
+  }
+  image->size += sizeof(SeqCompressedImage) + sizeof(CompressedBand) * image->num_bands;
+
+  if (!success || image->size > image->size_raw * SEQ_COMPRESSION_MAX_RATIO) {
+    seq_compressed_image_free(image);
+    return NULL;
+  }
+
+  return image;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Decompression
+ * \{ */
+
+typedef struct DecompressTaskData {
+  const SeqCompressedImage *image;
+  ImBuf *ibuf;
+  bool failed;
+} DecompressTaskData;
+
+static void decompress_band_task(void *__restrict userdata,
+                                 const int band_index,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DecompressTaskData *data = (DecompressTaskData *)userdata;
+  const CompressedBand *band = &data->image->bands[band_index];
+  ImBuf *ibuf = data->ibuf;
+  const size_t num_values = band_num_values(data->image, band_index);
+  const size_t offset = (size_t)band_index * SEQ_COMPRESSION_BAND_ROWS * ibuf->x * 4;
+
+  const int elem_size = band_format_elem_size(band->format);
+  const size_t size_raw = (band->format == BAND_FORMAT_BYTE) ? num_values :
+                                                                num_values * elem_size;
+  uchar *shuffled = MEM_mallocN(size_raw, __func__);
+  const size_t size = ZSTD_decompress(shuffled, size_raw, band->data, band->size);
+
+  if (ZSTD_isError(size) || size != size_raw) {
+    MEM_freeN(shuffled);
+    data->failed = true;
+    return;
+  }
+
+  switch (band->format) {
+    case BAND_FORMAT_BYTE:
+      unshuffle_bytes((uchar *)ibuf->rect + offset, shuffled, size_raw / elem_size, elem_size);
+      break;
+    case BAND_FORMAT_FLOAT:
+      unshuffle_bytes(
+          (uchar *)(ibuf->rect_float + offset), shuffled, size_raw / elem_size, elem_size);
+      break;
+    case BAND_FORMAT_HALF: {
+      uint16_t *halfs = MEM_mallocN(size_raw, __func__);
+      unshuffle_bytes((uchar *)halfs, shuffled, num_values, elem_size);
+      float *values = ibuf->rect_float + offset;
+      for (size_t i = 0; i < num_values; i++) {
+        values[i] = half_to_float(halfs[i]);
+      }
+      MEM_freeN(halfs);
+      break;
+    }
+  }
+
+  MEM_freeN(shuffled);
+}
+
+ImBuf *seq_compressed_image_decompress(const SeqCompressedImage *image)
+{
+  ImBuf *ibuf = IMB_allocImBuf(
+      image->x, image->y, image->planes, image->is_float ? IB_rectfloat : IB_rect);
+
+  if (image->is_float) {
+    IMB_colormanagement_assign_float_colorspace(ibuf, image->colorspace_name);
+  }
+  else {
+    IMB_colormanagement_assign_rect_colorspace(ibuf, image->colorspace_name);
+  }
+
+  DecompressTaskData data;
+  data.image = image;
+  data.ibuf = ibuf;
+  data.failed = false;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, image->num_bands, &data, decompress_band_task, &settings);
+
+  if (data.failed) {
+    IMB_freeImBuf(ibuf);
+    return NULL;
+  }
+
+  return ibuf;
+}
+
+/** \} */
+
+void seq_compressed_image_ref(SeqCompressedImage *image)
+{
+  atomic_add_and_fetch_int32(&image->users, 1);
+}
+
+void seq_compressed_image_free(SeqCompressedImage *image)
+{
+  if (atomic_sub_and_fetch_int32(&image->users, 1) != 0) {
+    return;
+  }
+
+  for (int i = 0; i < image->num_bands; i++) {
+    MEM_SAFE_FREE(image->bands[i].data);
+  }
+  MEM_freeN(image->bands);
+  MEM_freeN(image);
+}
+
+size_t seq_compressed_image_size_raw(const SeqCompressedImage *image)
+{
+  return image->size_raw;
+}
+
+size_t seq_compressed_image_size(const SeqCompressedImage *image)
+{
+  return image->size;
+}
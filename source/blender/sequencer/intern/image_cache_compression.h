@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. All rights reserved. */
+
+#pragma once
+
+/** \file
+ * \ingroup sequencer
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ImBuf;
+
+typedef struct SeqCompressedImage SeqCompressedImage;
+
+/**
+ * Compress image for storing in the RAM cache. Returns NULL when the image can not be compressed,
+ * or when compression would not save enough memory to be worth the decompression cost.
+ */
+SeqCompressedImage *seq_compressed_image_create(struct ImBuf *ibuf);
+/**
+ * Decompress image to a new #ImBuf. Bands of the image are decompressed in parallel.
+ */
+struct ImBuf *seq_compressed_image_decompress(const SeqCompressedImage *image);
+/**
+ * Compressed images are reference counted, so they can be decompressed without locking the cache
+ * while the cache entry is being freed.
+ */
+void seq_compressed_image_ref(SeqCompressedImage *image);
+void seq_compressed_image_free(SeqCompressedImage *image);
+
+size_t seq_compressed_image_size_raw(const SeqCompressedImage *image);
+size_t seq_compressed_image_size(const SeqCompressedImage *image);
+
+#ifdef __cplusplus
+}
+#endif
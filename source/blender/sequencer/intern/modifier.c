@@ -1494,7 +1494,7 @@ ImBuf *SEQ_modifier_apply_stack(const SeqRenderData *context,
   ImBuf *processed_ibuf = ibuf;
 
   if (seq->modifiers.first && (seq->flag & SEQ_USE_LINEAR_MODIFIERS)) {
-    processed_ibuf = IMB_dupImBuf(ibuf);
+    processed_ibuf = IMB_makeSingleUser(processed_ibuf);
     SEQ_render_imbuf_from_sequencer_space(context->scene, processed_ibuf);
   }
 
@@ -1521,11 +1521,10 @@ ImBuf *SEQ_modifier_apply_stack(const SeqRenderData *context,
       }
 
       ImBuf *mask = modifier_mask_get(
-          smd, context, timeline_frame, frame_offset, ibuf->rect_float != NULL);
+          smd, context, timeline_frame, frame_offset, processed_ibuf->rect_float != NULL);
 
-      if (processed_ibuf == ibuf) {
-        processed_ibuf = IMB_dupImBuf(ibuf);
-      }
+      /* Modify the image in place unless it is shared with other users. */
+      processed_ibuf = IMB_makeSingleUser(processed_ibuf);
 
       smti->apply(smd, processed_ibuf, mask);
 
@@ -19,6 +19,9 @@ struct Sequence;
 }
 #endif
 
+/** Upper limit of frames rendered concurrently by prefetching. */
+#define SEQ_PREFETCH_MAX_WORKERS 16
+
 /**
  * Start or resume prefetching.
  */
@@ -9,6 +9,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "DNA_anim_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_sequence_types.h"
@@ -19,6 +21,8 @@
 #include "BLI_path_util.h"
 #include "BLI_session_uuid.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #ifdef WIN32
 #  include "BLI_winstuff.h"
@@ -33,6 +37,8 @@
 
 #include "DEG_depsgraph.h"
 
+#include "PIL_time.h"
+
 #include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
@@ -250,42 +256,48 @@ ImBuf *seq_proxy_fetch(const SeqRenderData *context, Sequence *seq, int timeline
   return NULL;
 }
 
-static void seq_proxy_build_frame(const SeqRenderData *context,
-                                  SeqRenderState *state,
-                                  Sequence *seq,
-                                  int timeline_frame,
-                                  int proxy_render_size,
-                                  const bool overwrite)
+typedef struct SeqProxyBuildFrameData {
+  const SeqRenderData *context;
+  Sequence *seq;
+  int timeline_frame;
+  /* Rendered strip image, shared by all proxy sizes. */
+  ImBuf *ibuf;
+  int proxy_render_sizes[IMB_PROXY_MAX_SLOT];
+} SeqProxyBuildFrameData;
+
+static void seq_proxy_build_frame(void *__restrict userdata,
+                                  const int iter,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
 {
+  const SeqProxyBuildFrameData *data = userdata;
+  const SeqRenderData *context = data->context;
+  Sequence *seq = data->seq;
+  const int proxy_render_size = data->proxy_render_sizes[iter];
   char name[PROXY_MAXFILE];
   int quality;
   int rectx, recty;
-  ImBuf *ibuf_tmp, *ibuf;
-  Scene *scene = context->scene;
-
-  if (!seq_proxy_get_fname(
-          scene, seq, timeline_frame, proxy_render_size, name, context->view_id)) {
+  ImBuf *ibuf;
+
+  if (!seq_proxy_get_fname(context->scene,
+                           seq,
+                           data->timeline_frame,
+                           proxy_render_size,
+                           name,
+                           context->view_id)) {
     return;
   }
 
-  if (!overwrite && BLI_exists(name)) {
-    return;
-  }
-
-  ibuf_tmp = seq_render_strip(context, state, seq, timeline_frame);
-
-  rectx = (proxy_render_size * ibuf_tmp->x) / 100;
-  recty = (proxy_render_size * ibuf_tmp->y) / 100;
+  rectx = (proxy_render_size * data->ibuf->x) / 100;
+  recty = (proxy_render_size * data->ibuf->y) / 100;
 
-  if (ibuf_tmp->x != rectx || ibuf_tmp->y != recty) {
-    ibuf = IMB_dupImBuf(ibuf_tmp);
-    IMB_metadata_copy(ibuf, ibuf_tmp);
-    IMB_freeImBuf(ibuf_tmp);
-    IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
+  /* Rendered image is shared by all sizes, always work on a copy. */
+  if (data->ibuf->x != rectx || data->ibuf->y != recty) {
+    ibuf = IMB_scale_into_new(data->ibuf, rectx, recty, IMB_SCALE_FILTER_BILINEAR, true);
   }
   else {
-    ibuf = ibuf_tmp;
+    ibuf = IMB_dupImBuf(data->ibuf);
   }
+  IMB_metadata_copy(ibuf, data->ibuf);
 
   /* depth = 32 is intentionally left in, otherwise ALPHA channels
    * won't work... */
@@ -308,6 +320,62 @@ static void seq_proxy_build_frame(const SeqRenderData *context,
   IMB_freeImBuf(ibuf);
 }
 
+/* Render strip once and build all requested proxy sizes from it. */
+static void seq_proxy_build_frame_all_sizes(const SeqRenderData *context,
+                                            SeqRenderState *state,
+                                            Sequence *seq,
+                                            int timeline_frame,
+                                            int size_flags,
+                                            const bool overwrite)
+{
+  static const int proxy_sizes[IMB_PROXY_MAX_SLOT] = {
+      IMB_PROXY_25, IMB_PROXY_50, IMB_PROXY_75, IMB_PROXY_100};
+  static const int proxy_render_sizes[IMB_PROXY_MAX_SLOT] = {25, 50, 75, 100};
+
+  SeqProxyBuildFrameData data = {NULL};
+  int num_sizes = 0;
+
+  for (int i = 0; i < IMB_PROXY_MAX_SLOT; i++) {
+    if ((size_flags & proxy_sizes[i]) == 0) {
+      continue;
+    }
+
+    char name[PROXY_MAXFILE];
+    if (!seq_proxy_get_fname(context->scene,
+                             seq,
+                             timeline_frame,
+                             proxy_render_sizes[i],
+                             name,
+                             context->view_id)) {
+      continue;
+    }
+    if (!overwrite && BLI_exists(name)) {
+      continue;
+    }
+
+    data.proxy_render_sizes[num_sizes++] = proxy_render_sizes[i];
+  }
+
+  if (num_sizes == 0) {
+    return;
+  }
+
+  data.ibuf = seq_render_strip(context, state, seq, timeline_frame);
+  if (data.ibuf == NULL) {
+    return;
+  }
+  data.context = context;
+  data.seq = seq;
+  data.timeline_frame = timeline_frame;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = num_sizes > 1;
+  BLI_task_parallel_range(0, num_sizes, &data, seq_proxy_build_frame, &settings);
+
+  IMB_freeImBuf(data.ibuf);
+}
+
 /**
  * Returns whether the file this context would read from even exist,
  * if not, don't create the context
@@ -525,18 +593,8 @@ void SEQ_proxy_rebuild(SeqIndexBuildContext *context,
   for (timeline_frame = SEQ_time_left_handle_frame_get(scene, seq);
        timeline_frame < SEQ_time_right_handle_frame_get(scene, seq);
        timeline_frame++) {
-    if (context->size_flags & IMB_PROXY_25) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 25, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_50) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 50, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_75) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 75, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_100) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 100, overwrite);
-    }
+    seq_proxy_build_frame_all_sizes(
+        &render_context, &state, seq, timeline_frame, context->size_flags, overwrite);
 
     *progress = (float)(timeline_frame - SEQ_time_left_handle_frame_get(scene, seq)) /
                 (SEQ_time_right_handle_frame_get(scene, seq) -
@@ -566,6 +624,118 @@ void SEQ_proxy_rebuild_finish(SeqIndexBuildContext *context, bool stop)
   MEM_freeN(context);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Parallel Rebuild
+ *
+ * Movies are decoded and encoded with multiple threads already, but a single file can't keep
+ * many cores busy. Multiple movies are built at the same time, each of them gets a share of the
+ * thread budget. Image strips are rendered one at a time by the calling thread meanwhile.
+ * \{ */
+
+#define SEQ_PROXY_THREADS_PER_MOVIE 8
+
+typedef struct SeqProxyRebuildData {
+  SeqIndexBuildContext **contexts;
+  float *progress;
+  int num_contexts;
+  int next_context;
+  int num_running;
+  short *stop;
+  short *do_update;
+} SeqProxyRebuildData;
+
+static void *seq_proxy_rebuild_thread(void *data_v)
+{
+  SeqProxyRebuildData *data = data_v;
+
+  while (!*data->stop && !G.is_break) {
+    const int i = atomic_fetch_and_add_int32(&data->next_context, 1);
+    if (i >= data->num_contexts) {
+      break;
+    }
+    SEQ_proxy_rebuild(data->contexts[i], data->stop, data->do_update, &data->progress[i]);
+    data->progress[i] = 1.0f;
+  }
+
+  atomic_sub_and_fetch_int32(&data->num_running, 1);
+  return NULL;
+}
+
+static float seq_proxy_rebuild_progress(const SeqProxyRebuildData *data, int num_contexts)
+{
+  float progress = 0.0f;
+  for (int i = 0; i < num_contexts; i++) {
+    progress += data->progress[i];
+  }
+  return progress / num_contexts;
+}
+
+void SEQ_proxy_rebuild_list(ListBase *queue, short *stop, short *do_update, float *progress)
+{
+  const int num_contexts = BLI_listbase_count(queue);
+  if (num_contexts == 0) {
+    return;
+  }
+
+  SeqProxyRebuildData data = {NULL};
+  data.contexts = MEM_malloc_arrayN(num_contexts, sizeof(*data.contexts), __func__);
+  data.progress = MEM_calloc_arrayN(num_contexts, sizeof(*data.progress), __func__);
+  data.stop = stop;
+  data.do_update = do_update;
+
+  /* Movies are built by worker threads, they are placed first. */
+  int num_movies = 0;
+  LISTBASE_FOREACH (LinkData *, link, queue) {
+    SeqIndexBuildContext *context = link->data;
+    if (context->index_context) {
+      data.contexts[num_movies++] = context;
+    }
+  }
+  int num_images = num_movies;
+  LISTBASE_FOREACH (LinkData *, link, queue) {
+    SeqIndexBuildContext *context = link->data;
+    if (context->index_context == NULL) {
+      data.contexts[num_images++] = context;
+    }
+  }
+  data.num_contexts = num_movies;
+
+  ListBase threads;
+  const int num_threads = min_ii(
+      max_ii(BLI_system_thread_count() / SEQ_PROXY_THREADS_PER_MOVIE, 1), num_movies);
+  if (num_threads > 0) {
+    data.num_running = num_threads;
+    BLI_threadpool_init(&threads, seq_proxy_rebuild_thread, num_threads);
+    for (int i = 0; i < num_threads; i++) {
+      BLI_threadpool_insert(&threads, &data);
+    }
+  }
+
+  for (int i = num_movies; i < num_contexts && !*stop && !G.is_break; i++) {
+    SEQ_proxy_rebuild(data.contexts[i], stop, do_update, &data.progress[i]);
+    data.progress[i] = 1.0f;
+    *progress = seq_proxy_rebuild_progress(&data, num_contexts);
+    *do_update = true;
+  }
+
+  if (num_threads > 0) {
+    while (atomic_add_and_fetch_int32(&data.num_running, 0) > 0) {
+      *progress = seq_proxy_rebuild_progress(&data, num_contexts);
+      *do_update = true;
+      PIL_sleep_ms(100);
+    }
+    BLI_threadpool_end(&threads);
+  }
+
+  *progress = seq_proxy_rebuild_progress(&data, num_contexts);
+  *do_update = true;
+
+  MEM_freeN(data.contexts);
+  MEM_freeN(data.progress);
+}
+
+/** \} */
+
 void SEQ_proxy_set(struct Sequence *seq, bool value)
 {
   if (value) {
@@ -22,6 +22,7 @@
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_rect.h"
+#include "BLI_threads.h"
 
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
@@ -78,9 +79,143 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      float timeline_frame,
                                      int chanshown);
 
-static ThreadMutex seq_render_mutex = BLI_MUTEX_INITIALIZER;
+/* Prefetch workers render different frames of their own scene copies concurrently, so they only
+ * need to be exclusive with rendering of the original scene. */
+static ThreadRWMutex seq_render_mutex = BLI_RWLOCK_INITIALIZER;
 SequencerDrawView sequencer_view3d_fn = NULL; /* NULL in background mode */
 
+/* -------------------------------------------------------------------- */
+/** \name Image buffer pool
+ *
+ * Intermediate images of render size are allocated and freed multiple times for every rendered
+ * frame. Pixels of images that are no longer used are kept in a small pool, so that they can be
+ * reused instead of allocating and clearing new memory for each image.
+ * \{ */
+
+#define SEQ_IMBUF_POOL_MAX_BUFFERS 8
+#define SEQ_IMBUF_POOL_MAX_MEMORY ((size_t)512 * 1024 * 1024)
+
+typedef struct SeqPoolBuffer {
+  struct SeqPoolBuffer *next, *prev;
+  void *data;
+  size_t size;
+} SeqPoolBuffer;
+
+static ListBase imbuf_pool_buffers = {NULL, NULL};
+static size_t imbuf_pool_mem_in_use = 0;
+static ThreadMutex imbuf_pool_mutex = BLI_MUTEX_INITIALIZER;
+
+static void seq_imbuf_pool_remove(SeqPoolBuffer *buffer)
+{
+  BLI_remlink(&imbuf_pool_buffers, buffer);
+  imbuf_pool_mem_in_use -= buffer->size;
+  MEM_freeN(buffer);
+}
+
+static void *seq_imbuf_pool_take(const size_t size)
+{
+  void *data = NULL;
+  BLI_mutex_lock(&imbuf_pool_mutex);
+  LISTBASE_FOREACH_BACKWARD (SeqPoolBuffer *, buffer, &imbuf_pool_buffers) {
+    if (buffer->size == size) {
+      data = buffer->data;
+      seq_imbuf_pool_remove(buffer);
+      break;
+    }
+  }
+  BLI_mutex_unlock(&imbuf_pool_mutex);
+  return data;
+}
+
+static bool seq_imbuf_pool_put(void *data, const size_t size)
+{
+  if (size > SEQ_IMBUF_POOL_MAX_MEMORY) {
+    return false;
+  }
+
+  BLI_mutex_lock(&imbuf_pool_mutex);
+  /* Free least recently released buffers to make room. */
+  while (imbuf_pool_buffers.first &&
+         (BLI_listbase_count_at_most(&imbuf_pool_buffers, SEQ_IMBUF_POOL_MAX_BUFFERS) ==
+              SEQ_IMBUF_POOL_MAX_BUFFERS ||
+          imbuf_pool_mem_in_use + size > SEQ_IMBUF_POOL_MAX_MEMORY)) {
+    SeqPoolBuffer *buffer = imbuf_pool_buffers.first;
+    MEM_freeN(buffer->data);
+    seq_imbuf_pool_remove(buffer);
+  }
+
+  SeqPoolBuffer *buffer = MEM_mallocN(sizeof(SeqPoolBuffer), __func__);
+  buffer->data = data;
+  buffer->size = size;
+  BLI_addtail(&imbuf_pool_buffers, buffer);
+  imbuf_pool_mem_in_use += size;
+  BLI_mutex_unlock(&imbuf_pool_mutex);
+  return true;
+}
+
+ImBuf *seq_imbuf_pool_alloc(int x, int y, bool use_float)
+{
+  const size_t size = (size_t)x * (size_t)y * 4 * (use_float ? sizeof(float) : sizeof(uchar));
+  void *data = seq_imbuf_pool_take(size);
+
+  if (data == NULL) {
+    return IMB_allocImBuf(x, y, 32, use_float ? IB_rectfloat : IB_rect);
+  }
+
+  /* Same state as freshly allocated pixels. */
+  memset(data, 0, size);
+
+  ImBuf *ibuf = IMB_allocImBuf(x, y, 32, 0);
+  if (use_float) {
+    ibuf->rect_float = data;
+    ibuf->mall |= IB_rectfloat;
+    ibuf->flags |= IB_rectfloat;
+  }
+  else {
+    ibuf->rect = data;
+    ibuf->mall |= IB_rect;
+    ibuf->flags |= IB_rect;
+  }
+  return ibuf;
+}
+
+void seq_imbuf_pool_release(ImBuf *ibuf)
+{
+  if (ibuf == NULL) {
+    return;
+  }
+
+  /* Pixels can only be reused when the image has no other users. */
+  if (ibuf->refcounter == 0 && ibuf->planes <= 32) {
+    const size_t num_pixels = (size_t)ibuf->x * (size_t)ibuf->y;
+    if (ibuf->rect && (ibuf->mall & IB_rect) &&
+        seq_imbuf_pool_put(ibuf->rect, num_pixels * 4 * sizeof(uchar))) {
+      ibuf->rect = NULL;
+      ibuf->mall &= ~IB_rect;
+    }
+    if (ibuf->rect_float && (ibuf->mall & IB_rectfloat) && ibuf->channels == 4 &&
+        seq_imbuf_pool_put(ibuf->rect_float, num_pixels * 4 * sizeof(float))) {
+      ibuf->rect_float = NULL;
+      ibuf->mall &= ~IB_rectfloat;
+    }
+  }
+
+  IMB_freeImBuf(ibuf);
+}
+
+void SEQ_render_imbuf_pool_free(void)
+{
+  BLI_mutex_lock(&imbuf_pool_mutex);
+  while (imbuf_pool_buffers.first) {
+    SeqPoolBuffer *buffer = imbuf_pool_buffers.first;
+    MEM_freeN(buffer->data);
+    seq_imbuf_pool_remove(buffer);
+  }
+  BLI_mutex_unlock(&imbuf_pool_mutex);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Color-space utility functions
  * \{ */
@@ -429,30 +564,6 @@ static void sequencer_image_crop_init(const Sequence *seq,
   BLI_rctf_init(r_crop, left, in->x - right, bottom, in->y - top);
 }
 
-static void sequencer_thumbnail_transform(ImBuf *in, ImBuf *out)
-{
-  float image_scale_factor = (float)out->x / in->x;
-  float transform_matrix[4][4];
-
-  /* Set to keep same loc,scale,rot but change scale to thumb size limit. */
-  const float scale_x = 1 * image_scale_factor;
-  const float scale_y = 1 * image_scale_factor;
-  const float image_center_offs_x = (out->x - in->x) / 2;
-  const float image_center_offs_y = (out->y - in->y) / 2;
-  const float pivot[3] = {in->x / 2, in->y / 2, 0.0f};
-
-  float rotation_matrix[3][3];
-  unit_m3(rotation_matrix);
-  loc_rot_size_to_mat4(transform_matrix,
-                       (const float[]){image_center_offs_x, image_center_offs_y, 0.0f},
-                       rotation_matrix,
-                       (const float[]){scale_x, scale_y, 1.0f});
-  transform_pivot_set_m4(transform_matrix, pivot);
-  invert_m4(transform_matrix);
-
-  IMB_transform(in, out, IMB_TRANSFORM_MODE_REGULAR, IMB_FILTER_NEAREST, transform_matrix, NULL);
-}
-
 /* Check whether transform introduces transparent ares in the result (happens when the transformed
  * image does not fully cover the render frame).
  *
@@ -571,6 +682,10 @@ static void multibuf(ImBuf *ibuf, const float fmul)
   }
 }
 
+/**
+ * Takes ownership of \a ibuf. Steps modifying pixels in place only duplicate the image when it is
+ * shared with other users (e.g. the cache), steps that don't change the image are skipped.
+ */
 static ImBuf *input_preprocess(const SeqRenderData *context,
                                Sequence *seq,
                                float timeline_frame,
@@ -578,48 +693,48 @@ static ImBuf *input_preprocess(const SeqRenderData *context,
                                const bool is_proxy_image)
 {
   Scene *scene = context->scene;
-  ImBuf *preprocessed_ibuf = NULL;
+  ImBuf *preprocessed_ibuf = ibuf;
 
   /* Deinterlace. */
   if ((seq->flag & SEQ_FILTERY) && !ELEM(seq->type, SEQ_TYPE_MOVIE, SEQ_TYPE_MOVIECLIP)) {
-    /* Change original image pointer to avoid another duplication in SEQ_USE_TRANSFORM. */
-    preprocessed_ibuf = IMB_makeSingleUser(ibuf);
-    ibuf = preprocessed_ibuf;
-
+    preprocessed_ibuf = IMB_makeSingleUser(preprocessed_ibuf);
     IMB_filtery(preprocessed_ibuf);
   }
 
-  if (sequencer_use_crop(seq) || sequencer_use_transform(seq) || context->rectx != ibuf->x ||
-      context->recty != ibuf->y) {
-    const int x = context->rectx;
-    const int y = context->recty;
-    preprocessed_ibuf = IMB_allocImBuf(x, y, 32, ibuf->rect_float ? IB_rectfloat : IB_rect);
+  if (sequencer_use_crop(seq) || sequencer_use_transform(seq) ||
+      context->rectx != preprocessed_ibuf->x || context->recty != preprocessed_ibuf->y) {
+    ImBuf *transformed_ibuf = seq_imbuf_pool_alloc(
+        context->rectx, context->recty, preprocessed_ibuf->rect_float != NULL);
 
-    sequencer_preprocess_transform_crop(ibuf, preprocessed_ibuf, context, seq, is_proxy_image);
+    sequencer_preprocess_transform_crop(
+        preprocessed_ibuf, transformed_ibuf, context, seq, is_proxy_image);
 
-    seq_imbuf_assign_spaces(scene, preprocessed_ibuf);
-    IMB_metadata_copy(preprocessed_ibuf, ibuf);
-    IMB_freeImBuf(ibuf);
-  }
-
-  /* Duplicate ibuf if we still have original. */
-  if (preprocessed_ibuf == NULL) {
-    preprocessed_ibuf = IMB_makeSingleUser(ibuf);
+    seq_imbuf_assign_spaces(scene, transformed_ibuf);
+    IMB_metadata_copy(transformed_ibuf, preprocessed_ibuf);
+    seq_imbuf_pool_release(preprocessed_ibuf);
+    preprocessed_ibuf = transformed_ibuf;
   }
 
   if (seq->flag & SEQ_FLIPX) {
+    preprocessed_ibuf = IMB_makeSingleUser(preprocessed_ibuf);
     IMB_flipx(preprocessed_ibuf);
   }
 
   if (seq->flag & SEQ_FLIPY) {
+    preprocessed_ibuf = IMB_makeSingleUser(preprocessed_ibuf);
     IMB_flipy(preprocessed_ibuf);
   }
 
   if (seq->sat != 1.0f) {
+    preprocessed_ibuf = IMB_makeSingleUser(preprocessed_ibuf);
     IMB_saturation(preprocessed_ibuf, seq->sat);
   }
 
   if (seq->flag & SEQ_MAKE_FLOAT) {
+    if (!preprocessed_ibuf->rect_float || preprocessed_ibuf->rect) {
+      preprocessed_ibuf = IMB_makeSingleUser(preprocessed_ibuf);
+    }
+
     if (!preprocessed_ibuf->rect_float) {
       seq_imbuf_to_sequencer_space(scene, preprocessed_ibuf, true);
     }
@@ -635,17 +750,13 @@ static ImBuf *input_preprocess(const SeqRenderData *context,
   }
 
   if (mul != 1.0f) {
+    preprocessed_ibuf = IMB_makeSingleUser(preprocessed_ibuf);
     multibuf(preprocessed_ibuf, mul);
   }
 
   if (seq->modifiers.first) {
-    ImBuf *ibuf_new = SEQ_modifier_apply_stack(context, seq, preprocessed_ibuf, timeline_frame);
-
-    if (ibuf_new != preprocessed_ibuf) {
-      IMB_metadata_copy(ibuf_new, preprocessed_ibuf);
-      IMB_freeImBuf(preprocessed_ibuf);
-      preprocessed_ibuf = ibuf_new;
-    }
+    preprocessed_ibuf = SEQ_modifier_apply_stack(
+        context, seq, preprocessed_ibuf, timeline_frame);
   }
 
   return preprocessed_ibuf;
@@ -851,11 +962,11 @@ static ImBuf *seq_render_effect_strip_impl(const SeqRenderData *context,
   }
 
   for (i = 0; i < 3; i++) {
-    IMB_freeImBuf(ibuf[i]);
+    seq_imbuf_pool_release(ibuf[i]);
   }
 
   if (out == NULL) {
-    out = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
+    out = seq_imbuf_pool_alloc(context->rectx, context->recty, false);
   }
 
   return out;
@@ -1879,20 +1990,20 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
         break;
       case EARLY_USE_INPUT_1:
         if (i == 0) {
-          out = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
+          out = seq_imbuf_pool_alloc(context->rectx, context->recty, false);
         }
         break;
       case EARLY_DO_EFFECT:
         if (i == 0) {
-          ImBuf *ibuf1 = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
+          ImBuf *ibuf1 = seq_imbuf_pool_alloc(context->rectx, context->recty, false);
           ImBuf *ibuf2 = seq_render_strip(context, state, seq, timeline_frame);
 
           out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
 
           seq_cache_put(context, seq_arr[i], timeline_frame, SEQ_CACHE_STORE_COMPOSITE, out);
 
-          IMB_freeImBuf(ibuf1);
-          IMB_freeImBuf(ibuf2);
+          seq_imbuf_pool_release(ibuf1);
+          seq_imbuf_pool_release(ibuf2);
         }
         break;
     }
@@ -1912,8 +2023,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
 
       out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
 
-      IMB_freeImBuf(ibuf1);
-      IMB_freeImBuf(ibuf2);
+      seq_imbuf_pool_release(ibuf1);
+      seq_imbuf_pool_release(ibuf2);
     }
 
     seq_cache_put(context, seq_arr[i], timeline_frame, SEQ_CACHE_STORE_COMPOSITE, out);
@@ -1961,7 +2072,8 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
   SEQ_relations_free_all_anim_ibufs(context->scene, timeline_frame);
 
   if (count && !out) {
-    BLI_mutex_lock(&seq_render_mutex);
+    BLI_rw_mutex_lock(&seq_render_mutex,
+                      context->is_prefetch_render ? THREAD_LOCK_READ : THREAD_LOCK_WRITE);
     out = seq_render_strip_stack(context, &state, channels, seqbasep, timeline_frame, chanshown);
 
     if (context->is_prefetch_render) {
@@ -1971,7 +2083,7 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
       seq_cache_put_if_possible(
           context, seq_arr[count - 1], timeline_frame, SEQ_CACHE_STORE_FINAL_OUT, out);
     }
-    BLI_mutex_unlock(&seq_render_mutex);
+    BLI_rw_mutex_unlock(&seq_render_mutex);
   }
 
   seq_prefetch_start(context, timeline_frame);
@@ -2061,8 +2173,7 @@ static ImBuf *seq_get_uncached_thumbnail(const SeqRenderData *context,
   }
 
   /* Scale ibuf to thumbnail size. */
-  ImBuf *scaled_ibuf = IMB_allocImBuf(rectx, recty, 32, ibuf->rect_float ? IB_rectfloat : IB_rect);
-  sequencer_thumbnail_transform(ibuf, scaled_ibuf);
+  ImBuf *scaled_ibuf = IMB_scale_into_new(ibuf, rectx, recty, IMB_SCALE_FILTER_BOX, false);
   seq_imbuf_assign_spaces(context->scene, scaled_ibuf);
   IMB_freeImBuf(ibuf);
 
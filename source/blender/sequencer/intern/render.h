@@ -59,6 +59,15 @@ struct ImBuf *seq_render_mask(const struct SeqRenderData *context,
                               float frame_index,
                               bool make_float);
 void seq_imbuf_assign_spaces(struct Scene *scene, struct ImBuf *ibuf);
+/**
+ * Allocate image with cleared pixels, reusing pixels of released images when possible.
+ */
+struct ImBuf *seq_imbuf_pool_alloc(int x, int y, bool use_float);
+/**
+ * Same as #IMB_freeImBuf, but pixels are kept for reuse by #seq_imbuf_pool_alloc when the image
+ * has no other users.
+ */
+void seq_imbuf_pool_release(struct ImBuf *ibuf);
 
 #ifdef __cplusplus
 }
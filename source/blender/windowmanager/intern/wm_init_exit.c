@@ -66,6 +66,7 @@
 #include "RE_pipeline.h" /* RE_ free stuff */
 
 #include "SEQ_clipboard.h" /* free seq clipboard */
+#include "SEQ_render.h"    /* free seq image pool */
 
 #include "IMB_thumbs.h"
 
@@ -535,6 +536,7 @@ void WM_exit_ex(bContext *C, const bool do_python)
   }
 
   SEQ_clipboard_free(); /* sequencer.c */
+  SEQ_render_imbuf_pool_free();
   BKE_tracking_clipboard_free();
   BKE_mask_clipboard_free();
   BKE_vfont_clipboard_free();
@@ -575,6 +575,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-time");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-pretty");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-uuid");
+  BLI_args_print_arg_doc(ba, "--debug-depsgraph-trace");
   BLI_args_print_arg_doc(ba, "--debug-ghost");
   BLI_args_print_arg_doc(ba, "--debug-wintab");
   BLI_args_print_arg_doc(ba, "--debug-gpu");
@@ -1065,6 +1066,20 @@ static int arg_handle_debug_mode_memory_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_debug_depsgraph_trace_doc[] =
+    "<filepath>\n"
+    "\tRecord a timeline of all dependency graph evaluations and write it to <filepath> on exit,\n"
+    "\tin the Chrome trace event format.";
+static int arg_handle_debug_depsgraph_trace(int argc, const char **argv, void *UNUSED(data))
+{
+  if (argc > 1) {
+    DEG_debug_trace_begin(argv[1]);
+    return 1;
+  }
+  printf("\nError: you must specify a path after '--debug-depsgraph-trace'.\n");
+  return 0;
+}
+
 static const char arg_handle_debug_value_set_doc[] =
     "<value>\n"
     "\tSet debug value of <value> on startup.";
@@ -2207,6 +2222,7 @@ void main_args_setup(bContext *C, bArgs *ba)
                "--debug-depsgraph-uuid",
                CB_EX(arg_handle_debug_mode_generic_set, depsgraph_uuid),
                (void *)G_DEBUG_DEPSGRAPH_UUID);
+  BLI_args_add(ba, NULL, "--debug-depsgraph-trace", CB(arg_handle_debug_depsgraph_trace), NULL);
   BLI_args_add(ba,
                NULL,
                "--debug-gpu-force-workarounds",
@@ -1,6 +1,7 @@
 # SPDX-License-Identifier: Apache-2.0
 
 import api
+import json
 import os
 
 
@@ -12,7 +13,7 @@ def _run(args):
     elapsed_time = 0.0
     num_frames = 0
 
-    while elapsed_time < 10.0:
+    while num_frames == 0 or elapsed_time < args['min_time']:
         scene = bpy.context.scene
         for i in range(scene.frame_start, scene.frame_end + 1):
             scene.frame_set(i)
@@ -26,6 +27,22 @@ def _run(args):
     return result
 
 
+def _thread_utilization(trace_filepath):
+    # Fraction of the available threads spent evaluating operations during depsgraph
+    # evaluations, from a trace written by --debug-depsgraph-trace.
+    with open(trace_filepath, 'r') as f:
+        trace = json.load(f)
+
+    events = trace['traceEvents']
+    evaluation_time = sum(event['dur'] for event in events if event.get('cat') == 'evaluation')
+    operations_time = sum(event['dur'] for event in events if event.get('cat') == 'operation')
+    num_threads = trace['otherData']['num_threads']
+
+    if evaluation_time == 0.0:
+        return 0.0
+    return operations_time / (evaluation_time * num_threads)
+
+
 class AnimationTest(api.Test):
     def __init__(self, filepath):
         self.filepath = filepath
@@ -37,8 +54,17 @@ class AnimationTest(api.Test):
         return "animation"
 
     def run(self, env, device_id):
-        args = {}
+        args = {'min_time': 10.0}
         result, _ = env.run_in_blender(_run, args, [self.filepath])
+
+        # Step through the frames once more while tracing, separately from the timing since
+        # tracing adds overhead. The trace is kept next to the log for inspection.
+        trace_filepath = env.log_file.parent / (env.log_file.stem + '.trace.json')
+        args = {'min_time': 0.0}
+        env.run_in_blender(_run, args, ['--debug-depsgraph-trace', str(trace_filepath), self.filepath])
+        if trace_filepath.exists():
+            result['depsgraph_thread_utilization'] = _thread_utilization(trace_filepath)
+
         return result
 
 